@@ -20,10 +20,9 @@ const std::string &at_command_frame::get_at_command() const
 
 at_command_frame::operator std::vector<uint8_t>() const
 {
-    std::vector<uint8_t> frame;
-
-    frame.push_back(api_identifier_value);
-    frame.push_back(frame_id);
+    std::vector<uint8_t> frame(layout::LENGTH);
+    layout::write<api_identifier_field>(frame.data(), api_identifier_value);
+    layout::write<frame_id_field>(frame.data(), frame_id);
     frame.insert(frame.end(), at_command.begin(), at_command.end());
     frame.insert(frame.end(), parameter.begin(), parameter.end());
 
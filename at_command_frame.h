@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "at_command.h"
+#include "field_layout.h"
 #include "frame_data.h"
 
 class at_command_frame : public frame_data
@@ -13,6 +14,10 @@ class at_command_frame : public frame_data
 public:
     static const std::vector<uint8_t> REGISTER_QUERY;
 
+    typedef next_field<api_identifier_field, uint8_t> frame_id_field;
+    // at command and parameter follow
+    typedef field_layout<api_identifier_field, frame_id_field> layout;
+
     at_command_frame(const std::string &command,
         const std::vector<uint8_t> &parameter = REGISTER_QUERY, bool test_frame_id = false);
 
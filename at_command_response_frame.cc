@@ -1,11 +1,9 @@
 #include "at_command_response_frame.h"
 
-const size_t at_command_response_frame::FRAME_ID_OFFSET
-    = frame_data::API_IDENTIFIER_OFFSET + sizeof(frame_data::api_identifier_value);
-const size_t at_command_response_frame::AT_COMMAND_OFFSET = FRAME_ID_OFFSET + sizeof(frame_id);
-const size_t at_command_response_frame::STATUS_OFFSET
-    = AT_COMMAND_OFFSET + sizeof(uint16_t) /* at_command */;
-const size_t at_command_response_frame::VALUE_OFFSET = STATUS_OFFSET + sizeof(status_value);
+const size_t at_command_response_frame::FRAME_ID_OFFSET = frame_id_field::OFFSET;
+const size_t at_command_response_frame::AT_COMMAND_OFFSET = at_command_field::OFFSET;
+const size_t at_command_response_frame::STATUS_OFFSET = status_field::OFFSET;
+const size_t at_command_response_frame::VALUE_OFFSET = layout::LENGTH;
 // note: value can be empty
 const size_t at_command_response_frame::MIN_FRAME_DATA_LENGTH = VALUE_OFFSET;
 const std::vector<uint8_t> at_command_response_frame::EMPTY_VALUE;
@@ -14,27 +12,22 @@ std::shared_ptr<at_command_response_frame> at_command_response_frame::parse_fram
     std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end)
 {
     auto size = static_cast<size_t>(std::distance(begin, end));
-    if (size < MIN_FRAME_DATA_LENGTH)
+    if (!layout::fits(size))
     {
         return nullptr;
     }
 
-    if (begin[frame_data::API_IDENTIFIER_OFFSET] != api_identifier::at_command_response)
+    const uint8_t *frame = &*begin;
+    if (layout::read<api_identifier_field>(frame) != api_identifier::at_command_response)
     {
         return nullptr;
     }
 
-    uint8_t frame_id = begin[FRAME_ID_OFFSET];
-    std::string at_command(begin + AT_COMMAND_OFFSET, begin + STATUS_OFFSET);
-    uint8_t status_value = begin[STATUS_OFFSET];
-    std::vector<uint8_t> value;
+    std::string at_command(frame + at_command_field::OFFSET, frame + at_command_field::END);
+    std::vector<uint8_t> value(frame + layout::LENGTH, frame + size);
 
-    if (size > VALUE_OFFSET)
-    {
-        value = std::vector<uint8_t>(begin + VALUE_OFFSET, end);
-    }
-
-    return std::make_shared<at_command_response_frame>(frame_id, at_command, status_value, value);
+    return allocate_pooled<at_command_response_frame>(layout::read<frame_id_field>(frame),
+        at_command, layout::read<status_field>(frame), value);
 }
 
 at_command_response_frame::at_command_response_frame(uint8_t frame_id,
@@ -56,10 +49,10 @@ const std::vector<uint8_t> &at_command_response_frame::get_value() const
 
 at_command_response_frame::operator std::vector<uint8_t>() const
 {
-    std::vector<uint8_t> frame;
-
-    frame.push_back(api_identifier_value);
-    frame.push_back(frame_id);
+    // note: at_command isn't necessarily two characters when constructed directly
+    std::vector<uint8_t> frame(at_command_field::OFFSET);
+    layout::write<api_identifier_field>(frame.data(), api_identifier_value);
+    layout::write<frame_id_field>(frame.data(), frame_id);
     frame.insert(frame.end(), at_command.cbegin(), at_command.cend());
     frame.push_back(status_value);
     frame.insert(frame.end(), value.cbegin(), value.cend());
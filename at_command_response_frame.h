@@ -7,7 +7,9 @@
 #include <string>
 #include <vector>
 
+#include "field_layout.h"
 #include "frame_data.h"
+#include "pool_allocator.h"
 
 class at_command_response_frame : public frame_data
 {
@@ -19,6 +21,14 @@ public:
     static const size_t MIN_FRAME_DATA_LENGTH;
     static const std::vector<uint8_t> EMPTY_VALUE;
 
+    typedef next_field<api_identifier_field, uint8_t> frame_id_field;
+    // two ascii characters
+    typedef next_field<frame_id_field, uint16_t> at_command_field;
+    typedef next_field<at_command_field, uint8_t> status_field;
+    // value follows
+    typedef field_layout<api_identifier_field, frame_id_field, at_command_field, status_field>
+        layout;
+
     static std::shared_ptr<at_command_response_frame> parse_frame(
         std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end);
 
@@ -1,13 +1,18 @@
 #include "beehive.h"
 
-const std::chrono::milliseconds beehive::WRITE_QUEUE_READ_TIMEOUT(5);
+const std::chrono::seconds beehive::NEIGHBOUR_DISCOVERY_INTERVAL(5);
+const std::chrono::seconds beehive::NEIGHBOUR_EXPIRATION_THRESHOLD(10);
+const std::chrono::seconds beehive::STATS_INTERVAL(60);
+const std::chrono::milliseconds beehive::ENDPOINT_ERROR_BACKOFF_SLEEP(200);
 
 beehive::beehive(const beehive_config &config, std::shared_ptr<communication_endpoint> endpoint)
     : socket_path(config.get_beehive_socket_path()), endpoint(endpoint),
       frame_writer_queue(
-          std::make_shared<threadsafe_blocking_queue<std::shared_ptr<std::vector<uint8_t>>>>()),
-      _channel_manager(config, frame_writer_queue),
-      _datagram_socket_manager(config, frame_writer_queue)
+          std::make_shared<threadsafe_blocking_queue<std::shared_ptr<frame_buffer>>>()),
+      timers(std::make_shared<timer_wheel>()), reactor(std::make_shared<socket_reactor>()),
+      _channel_manager(config, timers, reactor, frame_writer_queue),
+      _datagram_socket_manager(config, reactor, frame_writer_queue), queue_delay_frames(0),
+      total_queue_delay(0), max_queue_delay(0)
 {
 }
 
@@ -19,27 +24,38 @@ void beehive::run()
 
     std::thread request_handler(&beehive::request_handler, this);
     std::thread frame_processor(&beehive::frame_processor, this);
-    std::thread frame_io_scheduler(&beehive::frame_io_scheduler, this);
-    std::thread neighbour_discoverer(&beehive::neighbour_discoverer, this);
+    std::thread frame_receiver(&beehive::frame_receiver, this);
+    std::thread frame_transmitter(&beehive::frame_transmitter, this);
+    std::thread timer_service(&timer_wheel::run, timers);
+    std::thread reactor_service(&socket_reactor::run, reactor);
+    send_neighbour_discovery();
+    timers->schedule(STATS_INTERVAL, [this] { log_stats(); });
 
     request_handler.join();
     frame_processor.join();
-    frame_io_scheduler.join();
-    neighbour_discoverer.join();
+    frame_receiver.join();
+    frame_transmitter.join();
+    timer_service.join();
+    reactor_service.join();
 }
 
 void beehive::log_segment(const connection_tuple &key, std::shared_ptr<message_segment> segment)
 {
     std::string flags(4, ' ');
 
-    flags[0] = segment->is_ack() || segment->is_synack() ? 'A' : ' ';
+    flags[0] = segment->is_ack() || segment->is_synack() || segment->is_finack() ? 'A' : ' ';
     flags[1] = segment->is_rst() ? 'R' : ' ';
     flags[2] = segment->is_syn() || segment->is_synack() ? 'S' : ' ';
-    flags[3] = segment->is_fin() ? 'F' : ' ';
+    flags[3] = segment->is_fin() || segment->is_finack() ? 'F' : ' ';
 
-    LOG("recv  ", key.to_string(), "[", flags, "] type(", +segment->get_message_type(), "), msg [",
-        util::get_frame_hex(segment->get_message()), "] (", segment->get_message().size(),
-        " bytes)");
+    // note: ports of compact segments are only known once their connection ID is looked up
+    std::string id = segment->is_compact()
+        ? "id(" + std::to_string(segment->get_connection_id()) + ") "
+        : std::string();
+
+    LOG("recv  ", key.to_string(), id, "[", flags, "] type(", +segment->get_message_type(),
+        "), msg [", util::get_frame_hex(segment->get_message()), "] (",
+        segment->get_message_length(), " bytes)");
 }
 
 bool beehive::try_parse_ieee_address(const std::string &str, uint64_t &address)
@@ -141,7 +157,8 @@ void beehive::request_handler()
         }
         else if (tokens[0] == beehive_message::CONNECT)
         {
-            if (tokens.size() != 3)
+            // CONNECT:<address>:<port>[:NODELAY|:COALESCE][:COMPRESS]
+            if (tokens.size() < 3 || tokens.size() > 5)
             {
                 LOG_ERROR("invalid request");
                 beehive_message::send_message(client_socket_fd, beehive_message::INVALID);
@@ -162,7 +179,38 @@ void beehive::request_handler()
                 continue;
             }
 
-            _channel_manager.try_create_active_socket(client_socket_fd, destination_address, port);
+            auto policy = reliable_channel::default_send_policy;
+            bool compression = false;    // config default applied by channel_manager
+            bool options_valid = true;
+            for (size_t i = 3; i < tokens.size(); ++i)
+            {
+                if (tokens[i] == beehive_message::NODELAY)
+                {
+                    policy = reliable_channel::nodelay;
+                }
+                else if (tokens[i] == beehive_message::COALESCE)
+                {
+                    policy = reliable_channel::coalesce;
+                }
+                else if (tokens[i] == beehive_message::COMPRESS)
+                {
+                    compression = true;
+                }
+                else
+                {
+                    options_valid = false;
+                }
+            }
+
+            if (!options_valid)
+            {
+                LOG_ERROR("invalid connection option");
+                beehive_message::send_message(client_socket_fd, beehive_message::INVALID);
+                continue;
+            }
+
+            _channel_manager.try_create_active_socket(
+                client_socket_fd, destination_address, port, policy, compression);
         }
         else if (tokens[0] == beehive_message::SEND_DGRAM)
         {
@@ -196,6 +244,8 @@ void beehive::request_handler()
     }
 }
 
+// frames are parsed in place, a segment keeps the frame it arrived in and payload bytes are only
+// copied out by whoever hands them to a client
 void beehive::frame_processor()
 {
     LOG("starting frame_processor thread");
@@ -204,96 +254,166 @@ void beehive::frame_processor()
     {
         auto frame = frame_processor_queue.wait_and_pop();
 
-        if (frame->get_api_identifier() == frame_data::api_identifier::rx_packet_64)
+        // note: anything but an rx_packet_64 (e.g. a tx_status) is of no interest here
+        rx_packet_64_view rx_packet;
+        segment_view segment_header;
+        if (!rx_packet_64_view::parse(frame->begin(), frame->end(), rx_packet)
+            || !segment_view::parse(
+                rx_packet.get_rf_data_begin(), rx_packet.get_rf_data_end(), segment_header)
+            || !rx_packet.verify_checksums(segment_header))
         {
-            auto rx_packet = std::static_pointer_cast<rx_packet_64_frame>(frame->get_data());
-            auto segment = std::make_shared<message_segment>(rx_packet->get_rf_data());
-
-            uint16_t received_checksum = segment->get_checksum();
-            uint16_t computed_checksum = segment->compute_checksum();
-
-            if (received_checksum != computed_checksum)
-            {
-                continue;
-            }
+            continue;
+        }
 
-            uint64_t source_address = rx_packet->get_source_address();
-            uint64_t destination_address = rx_packet->is_broadcast_frame()
-                ? xbee_s1::BROADCAST_ADDRESS
-                : endpoint->get_address();
+        auto segment = message_segment::create_received(std::move(frame), segment_header);
+        uint64_t source_address = rx_packet.get_source_address();
+        uint64_t destination_address = rx_packet.is_broadcast_frame()
+            ? xbee_s1::BROADCAST_ADDRESS
+            : endpoint->get_address();
 
-            connection_tuple connection_key(source_address, segment->get_source_port(),
-                destination_address, segment->get_destination_port());
-            log_segment(connection_key, segment);
+        connection_tuple connection_key(source_address, segment->get_source_port(),
+            destination_address, segment->get_destination_port());
+        log_segment(connection_key, segment);
 
-            switch (segment->get_message_type())
-            {
-                case message_segment::type::stream_segment:
-                    _channel_manager.process_stream_segment(connection_key, segment);
-                    break;
+        switch (segment->get_message_type())
+        {
+            case message_segment::type::stream_segment:
+                _channel_manager.process_stream_segment(connection_key, segment);
+                break;
 
-                case message_segment::type::datagram_segment:
-                    _datagram_socket_manager.process_segment(source_address, segment);
-                    break;
+            case message_segment::type::datagram_segment:
+                _datagram_socket_manager.process_segment(source_address, segment);
+                break;
 
-                case message_segment::type::neighbour_discovery:
-                    process_neighbour_discovery_message(source_address, segment);
-                    break;
-            }
+            case message_segment::type::neighbour_discovery:
+                process_neighbour_discovery_message(source_address, segment);
+                break;
         }
     }
 }
 
-void beehive::frame_io_scheduler()
+// receive_frames blocks until the endpoint has something, frames are handed off as soon as they
+// are read
+void beehive::frame_receiver()
 {
-    LOG("starting frame_io_scheduler thread");
+    LOG("starting frame_receiver thread");
+
+    std::vector<frame_buffer_pool::unique_buffer> rx_frames;
 
     while (true)
     {
-        auto rx_frame = endpoint->receive_frame();
-        if (rx_frame != nullptr)
+        if (!endpoint->receive_frames(rx_frames))
         {
-            frame_processor_queue.push(rx_frame);    // TODO: bound this queue to a certain size?
+            std::this_thread::sleep_for(ENDPOINT_ERROR_BACKOFF_SLEEP);
         }
 
-        std::shared_ptr<std::vector<uint8_t>> tx_frame;
-        if (frame_writer_queue->timed_wait_and_pop(tx_frame, WRITE_QUEUE_READ_TIMEOUT))
+        for (auto &rx_frame : rx_frames)
         {
-            endpoint->transmit_frame(*tx_frame);
+            // TODO: bound this queue to a certain size?
+            frame_processor_queue.push(std::move(rx_frame));
         }
+
+        rx_frames.clear();
     }
 }
 
-void beehive::neighbour_discoverer()
+// sleeps until frames are queued, everything queued while the previous batch was being written
+// goes out on the next wakeup
+//  - note: the queueing delay is only recorded for frames stamped with set_queued_time, i.e. those
+//  of reliable channels and datagram sockets, handshake and discovery frames aren't
+void beehive::frame_transmitter()
 {
-    LOG("starting neighbour_discoverer thread");
+    LOG("starting frame_transmitter thread");
 
-    auto last_expiration_check = std::chrono::system_clock::now();
-    auto expiration_check_interval = std::chrono::seconds(10);
-    auto expiration_threshold = std::chrono::seconds(10);
-    auto segment
-        = std::make_shared<message_segment>(0, 0, 0, message_segment::type::neighbour_discovery,
-            message_segment::flag::none, message_segment::EMPTY_PAYLOAD);
-    uart_frame frame(std::make_shared<tx_request_64_frame>(xbee_s1::BROADCAST_ADDRESS, *segment));
+    std::vector<std::shared_ptr<frame_buffer>> tx_frames;
 
     while (true)
     {
-        frame_writer_queue->push(std::make_shared<std::vector<uint8_t>>(frame));
-        std::this_thread::sleep_for(std::chrono::seconds(5));
-        auto now = std::chrono::system_clock::now();
-
-        if (now - last_expiration_check > expiration_check_interval)
+        auto queued = frame_writer_queue->wait_and_pop_all();
+        auto now = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(queue_delay_lock);
+        for (; !queued.empty(); queued.pop())
         {
-            last_expiration_check = now;
+            // note: nullptr if a segment didn't fit in a frame, see uart_frame::encode_tx_request_64
+            if (queued.front() == nullptr)
+            {
+                continue;
+            }
 
-            for (auto &neighbour : neighbours.get_data())
+            auto queued_time = queued.front()->get_queued_time();
+            if (queued_time != std::chrono::steady_clock::time_point())
             {
-                if (now - neighbour.second.timestamp > expiration_threshold)
-                {
-                    neighbours.erase(neighbour.first);
-                }
+                auto delay = now - queued_time;
+                ++queue_delay_frames;
+                total_queue_delay += delay;
+                max_queue_delay = std::max(max_queue_delay, delay);
             }
+
+            tx_frames.push_back(queued.front());
         }
+
+        lock.unlock();
+
+        // note: frames of a failed batch are dropped, reliable channels retransmit theirs
+        if (!endpoint->transmit_frames(tx_frames))
+        {
+            std::this_thread::sleep_for(ENDPOINT_ERROR_BACKOFF_SLEEP);
+        }
+
+        tx_frames.clear();
+    }
+}
+
+// broadcasts a discovery request every NEIGHBOUR_DISCOVERY_INTERVAL, neighbours reply with an ack
+void beehive::send_neighbour_discovery()
+{
+    auto segment
+        = allocate_pooled<message_segment>(0, 0, 0, message_segment::type::neighbour_discovery,
+            message_segment::flag::none, message_segment::EMPTY_PAYLOAD);
+    frame_writer_queue->push(
+        uart_frame::encode_tx_request_64(xbee_s1::BROADCAST_ADDRESS, *segment));
+
+    timers->schedule(NEIGHBOUR_DISCOVERY_INTERVAL, [this] { send_neighbour_discovery(); });
+}
+
+// logs every STATS_INTERVAL how many allocations the pools of the frame and segment hot paths
+// kept off the heap, misses or a climbing high water mark point at a leak or an undersized pool,
+// and how long frames waited in frame_writer_queue for the endpoint since the previous call
+void beehive::log_stats()
+{
+    LOG("pool stats, message_segment: ", pool_allocator<message_segment>::get_stats().to_string());
+    LOG("pool stats, received segment: ", message_segment::get_received_pool_stats().to_string());
+    LOG("pool stats, uart_frame: ", pool_allocator<uart_frame>::get_stats().to_string());
+    LOG("pool stats, frame_buffer: ", pool_allocator<frame_buffer>::get_stats().to_string(),
+        ", idle buffers: ", frame_buffer_pool::get_default().get_idle_count());
+
+    std::unique_lock<std::mutex> lock(queue_delay_lock);
+    auto frames = queue_delay_frames;
+    auto mean_delay = frames == 0
+        ? std::chrono::steady_clock::duration(0)
+        : total_queue_delay / static_cast<std::chrono::steady_clock::rep>(frames);
+    auto max_delay = max_queue_delay;
+    queue_delay_frames = 0;
+    total_queue_delay = max_queue_delay = std::chrono::steady_clock::duration(0);
+    lock.unlock();
+
+    LOG("frame_writer_queue delay, frames: ", frames, ", mean: ",
+        std::chrono::duration_cast<std::chrono::microseconds>(mean_delay).count(), " us, max: ",
+        std::chrono::duration_cast<std::chrono::microseconds>(max_delay).count(), " us");
+
+    timers->schedule(STATS_INTERVAL, [this] { log_stats(); });
+}
+
+// note: expiry timer is rescheduled on every reply, the timestamp check only guards against a
+// reply racing with the timer
+void beehive::expire_neighbour(uint64_t address)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (neighbours.erase_if(address, [now](const neighbour_info &neighbour) {
+            return now - neighbour.timestamp >= NEIGHBOUR_EXPIRATION_THRESHOLD;
+        }) != 0)
+    {
+        LOG("neighbour expired: ", util::to_hex_string(address));
     }
 }
 
@@ -304,15 +424,23 @@ void beehive::process_neighbour_discovery_message(
     {
         // discovery request, reply with ack
         auto segment
-            = std::make_shared<message_segment>(0, 0, 0, message_segment::type::neighbour_discovery,
+            = allocate_pooled<message_segment>(0, 0, 0, message_segment::type::neighbour_discovery,
                 message_segment::flag::ack, message_segment::EMPTY_PAYLOAD);
-        uart_frame frame(std::make_shared<tx_request_64_frame>(source_address, *segment));
-        frame_writer_queue->push(std::make_shared<std::vector<uint8_t>>(frame));
+        frame_writer_queue->push(uart_frame::encode_tx_request_64(source_address, *segment));
     }
     else if (segment->is_ack())
     {
         LOG("discovered neighbour: ", util::to_hex_string(source_address));
-        neighbours[source_address]
-            = neighbour_info{source_address, std::chrono::system_clock::now()};
+
+        neighbour_info previous;
+        if (neighbours.try_get(source_address, previous))
+        {
+            timers->cancel(previous.expiry_timer_id);
+        }
+
+        auto expiry_timer_id = timers->schedule(NEIGHBOUR_EXPIRATION_THRESHOLD,
+            [this, source_address] { expire_neighbour(source_address); });
+        neighbours[source_address] = neighbour_info{
+            source_address, std::chrono::steady_clock::now(), expiry_timer_id};
     }
 }
@@ -1,13 +1,16 @@
 #ifndef BEEHIVE_H
 #define BEEHIVE_H
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <ios>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include <sys/socket.h>
@@ -20,10 +23,16 @@
 #include "communication_endpoint.h"
 #include "connection_tuple.h"
 #include "datagram_socket_manager.h"
+#include "frame_buffer.h"
+#include "frame_buffer_pool.h"
 #include "logger.h"
 #include "message_segment.h"
-#include "rx_packet_64_frame.h"
+#include "pool_allocator.h"
+#include "rx_packet_64_view.h"
+#include "segment_view.h"
+#include "socket_reactor.h"
 #include "threadsafe_unordered_map.h"
+#include "timer_wheel.h"
 #include "tx_request_64_frame.h"
 #include "uart_frame.h"
 #include "util.h"
@@ -35,7 +44,8 @@
 struct neighbour_info
 {
     uint64_t address;
-    std::chrono::system_clock::time_point timestamp;
+    std::chrono::steady_clock::time_point timestamp;
+    timer_wheel::timer_id expiry_timer_id;
 };
 
 class beehive
@@ -52,22 +62,37 @@ private:
 
     void request_handler();
     void frame_processor();
-    void frame_io_scheduler();
-    void neighbour_discoverer();
+    void frame_receiver();
+    void frame_transmitter();
+    void send_neighbour_discovery();
+    void log_stats();
+    void expire_neighbour(uint64_t address);
     void process_neighbour_discovery_message(
         uint64_t source_address, std::shared_ptr<message_segment> segment);
 
-    static const std::chrono::milliseconds WRITE_QUEUE_READ_TIMEOUT;
+    static const std::chrono::seconds NEIGHBOUR_DISCOVERY_INTERVAL;
+    static const std::chrono::seconds NEIGHBOUR_EXPIRATION_THRESHOLD;
+    static const std::chrono::seconds STATS_INTERVAL;
+    // how long frame_receiver/frame_transmitter back off for when the endpoint reports an error,
+    // keeps a broken endpoint from spinning them
+    static const std::chrono::milliseconds ENDPOINT_ERROR_BACKOFF_SLEEP;
 
     const std::string socket_path;
     std::shared_ptr<communication_endpoint> endpoint;
     // TODO: bound frame_writer_queue to a fixed size?
-    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<std::vector<uint8_t>>>>
-        frame_writer_queue;
-    threadsafe_blocking_queue<std::shared_ptr<uart_frame>> frame_processor_queue;
+    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<frame_buffer>>> frame_writer_queue;
+    threadsafe_blocking_queue<frame_buffer_pool::unique_buffer> frame_processor_queue;
+    std::shared_ptr<timer_wheel> timers;    // note: must be initialized before the managers
+    std::shared_ptr<socket_reactor> reactor;    // note: must be initialized before the managers
     channel_manager _channel_manager;
     datagram_socket_manager _datagram_socket_manager;
     threadsafe_unordered_map<uint64_t, neighbour_info> neighbours;
+    // how long frames waited in frame_writer_queue since the last log_stats, updated by
+    // frame_transmitter
+    std::mutex queue_delay_lock;
+    uint64_t queue_delay_frames;
+    std::chrono::steady_clock::duration total_queue_delay;
+    std::chrono::steady_clock::duration max_queue_delay;
 };
 
 #endif
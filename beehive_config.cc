@@ -2,14 +2,29 @@
 
 const std::string beehive_config::BEEHIVE_SOCKET_PATH_PREFIX = "beehive";
 const std::string beehive_config::BROADCAST_SERVER_SOCKET_PATH = "beehive_simulated_wireless";
+const uint16_t beehive_config::DEFAULT_MAX_WINDOW_SIZE = 64;
+const uint16_t beehive_config::WINDOW_SIZE_LIMIT = 1024;    // ~300 segments/s for up to 4s
+const uint16_t beehive_config::DEFAULT_ACK_FREQUENCY = 2;
+const std::chrono::milliseconds beehive_config::DEFAULT_ACK_DELAY(20);
+const std::chrono::milliseconds beehive_config::DEFAULT_COALESCE_DELAY(20);
+const std::chrono::milliseconds beehive_config::DEFAULT_KEEPALIVE_INTERVAL(5000);
+const std::chrono::milliseconds beehive_config::DEFAULT_IDLE_TIMEOUT(30000);
 
 beehive_config::beehive_config()
-    : beehive_socket_path(BEEHIVE_SOCKET_PATH_PREFIX)
+    : beehive_socket_path(BEEHIVE_SOCKET_PATH_PREFIX), max_window_size(DEFAULT_MAX_WINDOW_SIZE),
+      ack_frequency(DEFAULT_ACK_FREQUENCY), ack_delay(DEFAULT_ACK_DELAY),
+      coalesce_by_default(false), coalesce_delay(DEFAULT_COALESCE_DELAY),
+      compress_by_default(false), fec_by_default(false),
+      keepalive_interval(DEFAULT_KEEPALIVE_INTERVAL), idle_timeout(DEFAULT_IDLE_TIMEOUT)
 {
 }
 
 beehive_config::beehive_config(const std::string &beehive_socket_path)
-    : beehive_socket_path(beehive_socket_path)
+    : beehive_socket_path(beehive_socket_path), max_window_size(DEFAULT_MAX_WINDOW_SIZE),
+      ack_frequency(DEFAULT_ACK_FREQUENCY), ack_delay(DEFAULT_ACK_DELAY),
+      coalesce_by_default(false), coalesce_delay(DEFAULT_COALESCE_DELAY),
+      compress_by_default(false), fec_by_default(false),
+      keepalive_interval(DEFAULT_KEEPALIVE_INTERVAL), idle_timeout(DEFAULT_IDLE_TIMEOUT)
 {
 }
 
@@ -27,3 +42,93 @@ const std::string beehive_config::get_dgram_path_prefix() const
 {
     return beehive_socket_path + "_dgram";
 }
+
+uint16_t beehive_config::get_max_window_size() const
+{
+    return max_window_size;
+}
+
+void beehive_config::set_max_window_size(uint16_t max_window_size)
+{
+    this->max_window_size = max_window_size;
+}
+
+uint16_t beehive_config::get_ack_frequency() const
+{
+    return ack_frequency;
+}
+
+void beehive_config::set_ack_frequency(uint16_t ack_frequency)
+{
+    this->ack_frequency = ack_frequency;
+}
+
+std::chrono::milliseconds beehive_config::get_ack_delay() const
+{
+    return ack_delay;
+}
+
+void beehive_config::set_ack_delay(const std::chrono::milliseconds &ack_delay)
+{
+    this->ack_delay = ack_delay;
+}
+
+bool beehive_config::get_coalesce_by_default() const
+{
+    return coalesce_by_default;
+}
+
+void beehive_config::set_coalesce_by_default(bool coalesce_by_default)
+{
+    this->coalesce_by_default = coalesce_by_default;
+}
+
+std::chrono::milliseconds beehive_config::get_coalesce_delay() const
+{
+    return coalesce_delay;
+}
+
+void beehive_config::set_coalesce_delay(const std::chrono::milliseconds &coalesce_delay)
+{
+    this->coalesce_delay = coalesce_delay;
+}
+
+bool beehive_config::get_compress_by_default() const
+{
+    return compress_by_default;
+}
+
+void beehive_config::set_compress_by_default(bool compress_by_default)
+{
+    this->compress_by_default = compress_by_default;
+}
+
+bool beehive_config::get_fec_by_default() const
+{
+    return fec_by_default;
+}
+
+void beehive_config::set_fec_by_default(bool fec_by_default)
+{
+    this->fec_by_default = fec_by_default;
+}
+
+std::chrono::milliseconds beehive_config::get_keepalive_interval() const
+{
+    return keepalive_interval;
+}
+
+void beehive_config::set_keepalive_interval(const std::chrono::milliseconds &keepalive_interval)
+{
+    this->keepalive_interval = keepalive_interval;
+}
+
+std::chrono::milliseconds beehive_config::get_idle_timeout() const
+{
+    return idle_timeout;
+}
+
+void beehive_config::set_idle_timeout(const std::chrono::milliseconds &idle_timeout)
+{
+    this->idle_timeout = idle_timeout;
+}
@@ -1,6 +1,8 @@
 #ifndef BEEHIVE_CONFIG_H
 #define BEEHIVE_CONFIG_H
 
+#include <chrono>
+#include <cstdint>
 #include <string>
 
 class beehive_config
@@ -8,6 +10,16 @@ class beehive_config
 public:
     static const std::string BEEHIVE_SOCKET_PATH_PREFIX;
     static const std::string BROADCAST_SERVER_SOCKET_PATH;
+    static const uint16_t DEFAULT_MAX_WINDOW_SIZE;
+    // largest max_window_size accepted: more segments than a 250 kbit/s link carries within the
+    // longest retransmission timeout can't be in flight anyway, and every channel sizes its
+    // windows to max_window_size up front
+    static const uint16_t WINDOW_SIZE_LIMIT;
+    static const uint16_t DEFAULT_ACK_FREQUENCY;
+    static const std::chrono::milliseconds DEFAULT_ACK_DELAY;
+    static const std::chrono::milliseconds DEFAULT_COALESCE_DELAY;
+    static const std::chrono::milliseconds DEFAULT_KEEPALIVE_INTERVAL;
+    static const std::chrono::milliseconds DEFAULT_IDLE_TIMEOUT;
 
     beehive_config();
     beehive_config(const std::string &beehive_socket_path);
@@ -15,9 +27,50 @@ public:
     const std::string get_beehive_socket_path() const;
     const std::string get_channel_path_prefix() const;
     const std::string get_dgram_path_prefix() const;
+    uint16_t get_max_window_size() const;
+    void set_max_window_size(uint16_t max_window_size);
+    uint16_t get_ack_frequency() const;
+    void set_ack_frequency(uint16_t ack_frequency);
+    std::chrono::milliseconds get_ack_delay() const;
+    void set_ack_delay(const std::chrono::milliseconds &ack_delay);
+    bool get_coalesce_by_default() const;
+    void set_coalesce_by_default(bool coalesce_by_default);
+    std::chrono::milliseconds get_coalesce_delay() const;
+    void set_coalesce_delay(const std::chrono::milliseconds &coalesce_delay);
+    bool get_compress_by_default() const;
+    void set_compress_by_default(bool compress_by_default);
+    bool get_fec_by_default() const;
+    void set_fec_by_default(bool fec_by_default);
+    std::chrono::milliseconds get_keepalive_interval() const;
+    void set_keepalive_interval(const std::chrono::milliseconds &keepalive_interval);
+    std::chrono::milliseconds get_idle_timeout() const;
+    void set_idle_timeout(const std::chrono::milliseconds &idle_timeout);
 
 private:
     std::string beehive_socket_path;
+    // note: upper bound for a sender's congestion window and size of the receive window, both ends
+    // of a connection advertise theirs on SYN and use the smaller one
+    uint16_t max_window_size;
+    // delayed ACK policy: receivers acknowledge every ack_frequency in-order segments or after
+    // ack_delay, whichever comes first (ack_frequency of 1 disables delayed ACKs)
+    uint16_t ack_frequency;
+    std::chrono::milliseconds ack_delay;
+    // small write coalescing: senders fill segments up to the max segment length and flush partial
+    // ones coalesce_delay after their first byte was written, connections can opt in/out on CONNECT
+    bool coalesce_by_default;
+    std::chrono::milliseconds coalesce_delay;
+    // payload compression: requested by outgoing connections (which can also opt in on CONNECT)
+    // and applied to outgoing datagrams, incoming connections accept whatever their peer requests
+    bool compress_by_default;
+    // forward error correction: requested by outgoing connections, incoming connections accept
+    // whatever their peer requests, senders only send parity once they observe loss
+    bool fec_by_default;
+    // liveness of stream connections: a channel sends an ACK as keepalive once nothing was received
+    // from the peer for keepalive_interval (and again every interval while it stays silent), and
+    // is aborted once the silence reaches idle_timeout, which should span several keepalives and
+    // backed off retransmission timeouts
+    std::chrono::milliseconds keepalive_interval;
+    std::chrono::milliseconds idle_timeout;
 };
 
 #endif
@@ -4,6 +4,9 @@ const size_t beehive_message::MAX_SIZE = 100;
 const std::string beehive_message::LISTEN = std::string("LISTEN");
 const std::string beehive_message::LISTEN_DGRAM = std::string("LISTEN_DGRAM");
 const std::string beehive_message::CONNECT = std::string("CONNECT");
+const std::string beehive_message::NODELAY = std::string("NODELAY");
+const std::string beehive_message::COALESCE = std::string("COALESCE");
+const std::string beehive_message::COMPRESS = std::string("COMPRESS");
 const std::string beehive_message::ACCEPT = std::string("ACCEPT");
 const std::string beehive_message::CLOSE = std::string("CLOSE");
 const std::string beehive_message::SEND_DGRAM = std::string("SEND_DGRAM");
@@ -35,6 +38,31 @@ std::string beehive_message::read_message(int socket_fd)
     return std::string(buffer.data(), buffer.data() + buffer.size());
 }
 
+bool beehive_message::try_read_pending(int socket_fd, std::string &pending)
+{
+    std::vector<uint8_t> buffer;
+    int error;
+    ssize_t bytes_read = util::nonblocking_recv(socket_fd, buffer, MAX_SIZE, error);
+    if (bytes_read == 0)
+    {
+        return false;
+    }
+    else if (bytes_read == -1)
+    {
+        return error == EAGAIN || error == EWOULDBLOCK;
+    }
+
+    pending.append(buffer.begin(), buffer.end());
+    return true;
+}
+
+bool beehive_message::is_partial_message(
+    const std::string &message_type, const std::string &pending)
+{
+    return pending.size() < message_type.size()
+        && message_type.compare(0, pending.size(), pending) == 0;
+}
+
 void beehive_message::send_message(int socket_fd, const std::string &message)
 {
     auto bytes = reinterpret_cast<const uint8_t *>(message.c_str());
@@ -8,6 +8,8 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 
+#include <errno.h>
+
 #include "logger.h"
 #include "util.h"
 
@@ -17,12 +19,20 @@ public:
     static bool is_message(
         const std::string &message_type, const std::string &request);    // TODO: get rid of this?
     static std::string read_message(int socket_fd);
+    // appends whatever socket_fd has of a message to pending without blocking (for reactor
+    // handlers), returns false once the client closed the socket or on error
+    static bool try_read_pending(int socket_fd, std::string &pending);
+    // whether pending may still become a message of message_type once the rest of it arrives
+    static bool is_partial_message(const std::string &message_type, const std::string &pending);
     static void send_message(int socket_fd, const std::string &message);
 
     static const size_t MAX_SIZE;
     static const std::string LISTEN;
     static const std::string LISTEN_DGRAM;
     static const std::string CONNECT;
+    static const std::string NODELAY;
+    static const std::string COALESCE;
+    static const std::string COMPRESS;
     static const std::string ACCEPT;
     static const std::string CLOSE;
     static const std::string SEND_DGRAM;
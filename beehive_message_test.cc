@@ -0,0 +1,51 @@
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "beehive_message.h"
+
+namespace beehive_message_test
+{
+    TEST(BeehiveMessageTest, ConstValuesSpec)
+    {
+        ASSERT_EQ(100, beehive_message::MAX_SIZE);
+        ASSERT_EQ("CLOSE", beehive_message::CLOSE);
+        ASSERT_EQ(":", beehive_message::SEPARATOR);
+    }
+
+    TEST(BeehiveMessageTest, PartialMessageTest)
+    {
+        ASSERT_TRUE(beehive_message::is_partial_message(beehive_message::CLOSE, ""));
+        ASSERT_TRUE(beehive_message::is_partial_message(beehive_message::CLOSE, "CLO"));
+        ASSERT_FALSE(beehive_message::is_partial_message(beehive_message::CLOSE, "CLOSE"));
+        ASSERT_FALSE(beehive_message::is_partial_message(beehive_message::CLOSE, "CLX"));
+    }
+
+    // a message split across reads is put back together, reading never blocks
+    TEST(BeehiveMessageTest, TryReadPendingTest)
+    {
+        int fds[2];
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+
+        std::string pending;
+        ASSERT_TRUE(beehive_message::try_read_pending(fds[0], pending));
+        ASSERT_TRUE(pending.empty());
+
+        ASSERT_EQ(3, write(fds[1], "CLO", 3));
+        ASSERT_TRUE(beehive_message::try_read_pending(fds[0], pending));
+        ASSERT_EQ("CLO", pending);
+        ASSERT_FALSE(beehive_message::is_message(beehive_message::CLOSE, pending));
+
+        ASSERT_EQ(2, write(fds[1], "SE", 2));
+        ASSERT_TRUE(beehive_message::try_read_pending(fds[0], pending));
+        ASSERT_TRUE(beehive_message::is_message(beehive_message::CLOSE, pending));
+
+        close(fds[1]);
+        ASSERT_FALSE(beehive_message::try_read_pending(fds[0], pending));
+        close(fds[0]);
+    }
+}
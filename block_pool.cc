@@ -0,0 +1,96 @@
+#include "block_pool.h"
+
+const size_t block_pool::MAX_IDLE_BLOCKS = 1024;
+
+std::string block_pool_stats::to_string() const
+{
+    std::ostringstream oss;
+    oss << "hits: " << hits << ", misses: " << misses << ", in use: " << in_use
+        << ", high water: " << high_water;
+    return oss.str();
+}
+
+block_pool::block_pool()
+    : block_size(0), stats()
+{
+    // note: freeing a block never allocates
+    idle.reserve(MAX_IDLE_BLOCKS);
+}
+
+block_pool::~block_pool()
+{
+    for (void *block : idle)
+    {
+        ::operator delete(block);
+    }
+}
+
+void *block_pool::allocate(size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock(access_lock);
+        if (block_size == 0)
+        {
+            block_size = size;
+        }
+
+        if (size > block_size)
+        {
+            ++stats.misses;
+            return ::operator new(size);
+        }
+
+        ++stats.in_use;
+        stats.high_water = std::max(stats.high_water, stats.in_use);
+        if (!idle.empty())
+        {
+            ++stats.hits;
+            void *block = idle.back();
+            idle.pop_back();
+            return block;
+        }
+
+        ++stats.misses;
+    }
+
+    try
+    {
+        return ::operator new(block_size);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(access_lock);
+        --stats.in_use;
+        throw;
+    }
+}
+
+void block_pool::deallocate(void *block, size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock(access_lock);
+        if (size <= block_size)
+        {
+            --stats.in_use;
+            if (idle.size() < MAX_IDLE_BLOCKS)
+            {
+                idle.push_back(block);
+                return;
+            }
+        }
+    }
+
+    ::operator delete(block);
+}
+
+block_pool_stats block_pool::get_stats() const
+{
+    std::lock_guard<std::mutex> lock(access_lock);
+    return stats;
+}
+
+size_t block_pool::get_idle_count() const
+{
+    std::lock_guard<std::mutex> lock(access_lock);
+    return idle.size();
+}
@@ -0,0 +1,62 @@
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct block_pool_stats
+{
+    uint64_t hits;    // allocations served from an idle block
+    uint64_t misses;    // allocations that went to the heap
+    size_t in_use;
+    size_t high_water;    // most blocks in use at once
+
+    std::string to_string() const;
+};
+
+// recycles fixed size memory blocks for short lived objects (parsed frames, message segments),
+// once the pool is warmed up allocating one doesn't go to the heap, see pool_allocator
+//  - threadsafe, blocks may be freed on any thread
+//  - block size is set by the first allocation, larger allocations bypass the pool and are
+//  counted as misses
+//  - keeps at most MAX_IDLE_BLOCKS around, any freed beyond that go back to the heap
+class block_pool
+{
+public:
+    static const size_t MAX_IDLE_BLOCKS;
+
+    // pool shared by every allocation tagged with Tag
+    //  - note: never destroyed, objects allocated from it may outlive static destructors
+    template <typename Tag>
+    static block_pool &get()
+    {
+        static block_pool *pool = new block_pool();
+        return *pool;
+    }
+
+    block_pool();
+    block_pool(const block_pool &) = delete;
+    block_pool &operator=(const block_pool &) = delete;
+    ~block_pool();
+
+    // throws std::bad_alloc like operator new
+    void *allocate(size_t size);
+    // size has to be the one block was allocated with
+    void deallocate(void *block, size_t size);
+    block_pool_stats get_stats() const;
+    size_t get_idle_count() const;
+
+private:
+    mutable std::mutex access_lock;
+    size_t block_size;    // 0 until the first allocation
+    std::vector<void *> idle;
+    block_pool_stats stats;
+};
+
+#endif
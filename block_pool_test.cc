@@ -0,0 +1,140 @@
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "block_pool.h"
+#include "pool_allocator.h"
+
+namespace block_pool_test
+{
+    struct pool_allocator_test_tag
+    {
+    };
+
+    TEST(BlockPoolTest, ConstValuesSpec)
+    {
+        ASSERT_EQ(1024, block_pool::MAX_IDLE_BLOCKS);
+    }
+
+    TEST(BlockPoolTest, RecycleTest)
+    {
+        block_pool pool;
+        void *block = pool.allocate(32);
+        block_pool_stats stats = pool.get_stats();
+        ASSERT_EQ(0, stats.hits);
+        ASSERT_EQ(1, stats.misses);
+        ASSERT_EQ(1, stats.in_use);
+        ASSERT_EQ(0, pool.get_idle_count());
+
+        pool.deallocate(block, 32);
+        ASSERT_EQ(0, pool.get_stats().in_use);
+        ASSERT_EQ(1, pool.get_idle_count());
+
+        ASSERT_EQ(block, pool.allocate(32));
+        stats = pool.get_stats();
+        ASSERT_EQ(1, stats.hits);
+        ASSERT_EQ(1, stats.misses);
+        ASSERT_EQ(1, stats.in_use);
+        ASSERT_EQ(0, pool.get_idle_count());
+        pool.deallocate(block, 32);
+    }
+
+    TEST(BlockPoolTest, HighWaterTest)
+    {
+        block_pool pool;
+        std::vector<void *> blocks;
+        for (int i = 0; i < 3; ++i)
+        {
+            blocks.push_back(pool.allocate(16));
+        }
+
+        pool.deallocate(blocks.back(), 16);
+        blocks.pop_back();
+        pool.deallocate(blocks.back(), 16);
+        blocks.pop_back();
+        blocks.push_back(pool.allocate(16));
+
+        block_pool_stats stats = pool.get_stats();
+        ASSERT_EQ(1, stats.hits);
+        ASSERT_EQ(3, stats.misses);
+        ASSERT_EQ(2, stats.in_use);
+        ASSERT_EQ(3, stats.high_water);
+
+        for (void *block : blocks)
+        {
+            pool.deallocate(block, 16);
+        }
+    }
+
+    TEST(BlockPoolTest, SmallerBlockTest)
+    {
+        block_pool pool;
+        pool.deallocate(pool.allocate(32), 32);
+
+        // served from the 32 byte block
+        void *block = pool.allocate(8);
+        ASSERT_EQ(1, pool.get_stats().hits);
+        pool.deallocate(block, 8);
+        ASSERT_EQ(1, pool.get_idle_count());
+    }
+
+    TEST(BlockPoolTest, OversizedTest)
+    {
+        block_pool pool;
+        pool.deallocate(pool.allocate(16), 16);
+
+        // bypasses the pool, counted as a miss but never in use
+        void *block = pool.allocate(64);
+        block_pool_stats stats = pool.get_stats();
+        ASSERT_EQ(0, stats.hits);
+        ASSERT_EQ(2, stats.misses);
+        ASSERT_EQ(0, stats.in_use);
+        ASSERT_EQ(1, pool.get_idle_count());
+
+        pool.deallocate(block, 64);
+        ASSERT_EQ(0, pool.get_stats().in_use);
+        ASSERT_EQ(1, pool.get_idle_count());
+    }
+
+    TEST(BlockPoolTest, IdleLimitTest)
+    {
+        block_pool pool;
+        std::vector<void *> blocks;
+        for (size_t i = 0; i < block_pool::MAX_IDLE_BLOCKS + 1; ++i)
+        {
+            blocks.push_back(pool.allocate(8));
+        }
+
+        for (void *block : blocks)
+        {
+            pool.deallocate(block, 8);
+        }
+
+        ASSERT_EQ(block_pool::MAX_IDLE_BLOCKS, pool.get_idle_count());
+        ASSERT_EQ(0, pool.get_stats().in_use);
+        ASSERT_EQ(block_pool::MAX_IDLE_BLOCKS + 1, pool.get_stats().high_water);
+    }
+
+    TEST(BlockPoolTest, PoolAllocatorTest)
+    {
+        typedef pool_allocator<uint64_t, pool_allocator_test_tag> allocator;
+        block_pool &pool = block_pool::get<pool_allocator_test_tag>();
+
+        auto value = std::allocate_shared<uint64_t>(allocator(), 42);
+        ASSERT_EQ(42, *value);
+        ASSERT_EQ(1, allocator::get_stats().in_use);
+        const uint64_t *address = value.get();
+
+        value.reset();
+        ASSERT_EQ(0, allocator::get_stats().in_use);
+        ASSERT_EQ(1, pool.get_idle_count());
+
+        // object and control block are a single block, reused as a whole
+        value = std::allocate_shared<uint64_t>(allocator(), 7);
+        ASSERT_EQ(address, value.get());
+        ASSERT_EQ(1, allocator::get_stats().hits);
+        ASSERT_EQ(1, allocator::get_stats().misses);
+    }
+}
@@ -2,10 +2,15 @@
 
 uint32_t channel_manager::socket_suffix = 0;
 std::mutex channel_manager::socket_suffix_lock;
-
-channel_manager::channel_manager(const beehive_config &config,
-    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<std::vector<uint8_t>>>> write_queue)
-    : channel_path_prefix(config.get_channel_path_prefix()), write_queue(write_queue)
+const int channel_manager::HANDSHAKE_ATTEMPTS = 5;
+// TODO: make configurable
+const std::chrono::milliseconds channel_manager::HANDSHAKE_RETRY_INTERVAL(500);
+
+channel_manager::channel_manager(const beehive_config &config, std::shared_ptr<timer_wheel> timers,
+    std::shared_ptr<socket_reactor> reactor,
+    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<frame_buffer>>> write_queue)
+    : config(config), channel_path_prefix(config.get_channel_path_prefix()), timers(timers),
+      reactor(reactor), write_queue(write_queue)
 {
 }
 
@@ -25,7 +30,7 @@ bool channel_manager::try_create_passive_socket(int client_socket_fd, uint16_t l
     }
 
     connection_requests[listen_port]
-        = std::make_shared<threadsafe_blocking_queue<std::pair<uint64_t, uint16_t>>>();
+        = std::make_shared<threadsafe_blocking_queue<connection_request>>();
     beehive_message::send_message(client_socket_fd, beehive_message::OK);
 
     std::thread socket_manager(
@@ -34,11 +39,12 @@ bool channel_manager::try_create_passive_socket(int client_socket_fd, uint16_t l
     return true;
 }
 
-bool channel_manager::try_create_active_socket(
-    int client_socket_fd, uint64_t destination_address, uint16_t destination_port)
+bool channel_manager::try_create_active_socket(int client_socket_fd, uint64_t destination_address,
+    uint16_t destination_port, reliable_channel::send_policy policy, bool compression)
 {
     std::thread socket_manager(&channel_manager::active_socket_manager, this, client_socket_fd,
-        destination_address, destination_port);
+        destination_address, destination_port, policy,
+        compression || config.get_compress_by_default());
     socket_manager.detach();
     return true;
 }
@@ -46,7 +52,17 @@ bool channel_manager::try_create_active_socket(
 void channel_manager::process_stream_segment(
     connection_tuple connection_key, std::shared_ptr<message_segment> segment)
 {
-    if (!_port_manager.is_open(segment->get_destination_port()))
+    if (segment->is_compact())
+    {
+        auto source_address = connection_key.source_address;
+        if (!connection_ids.try_get(segment->get_connection_id(), connection_key)
+            || connection_key.source_address != source_address)
+        {
+            LOG("discarding frame for unknown connection id ", +segment->get_connection_id());
+            return;
+        }
+    }
+    else if (!_port_manager.is_open(segment->get_destination_port()))
     {
         LOG("discarding frame destined for port ", +segment->get_destination_port());
         return;
@@ -59,8 +75,9 @@ void channel_manager::process_stream_segment(
             = std::make_shared<threadsafe_blocking_queue<std::shared_ptr<message_segment>>>();
         if (segment_queue_map.try_add(connection_key, segment_queue))
         {
-            std::thread request_handler(
-                &channel_manager::incoming_connection_handler, this, connection_key, segment_queue);
+            std::thread request_handler(&channel_manager::incoming_connection_handler, this,
+                connection_key, segment_queue, segment->get_connection_options(),
+                segment->get_offered_connection_id(), segment->get_offered_window_size());
             request_handler.detach();
         }
     }
@@ -75,30 +92,35 @@ void channel_manager::process_stream_segment(
 }
 
 void channel_manager::incoming_connection_handler(connection_tuple connection_key,
-    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<message_segment>>> segment_queue)
+    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<message_segment>>> segment_queue,
+    uint8_t requested_options, uint8_t peer_connection_id, uint16_t peer_window_size)
 {
     LOG("starting incoming_connection_handler thread");
 
-    auto response = message_segment::create_synack(
-        connection_key.destination_port, connection_key.source_port);
-    uart_frame frame(
-        std::make_shared<tx_request_64_frame>(connection_key.source_address, *response));
-    bool ack_received = false;
-
-    for (int i = 0; i < 5; ++i)
-    {
-        // TODO: have generic write_frame method in xbee so we don't have to explicitly create uart
-        // frame every time?
-        write_queue->push(std::make_shared<std::vector<uint8_t>>(frame));
-        std::shared_ptr<message_segment> message;
-        // TODO: make timeout confiugurable
-        if (segment_queue->timed_wait_and_pop(message, std::chrono::milliseconds(500))
-            && message->is_ack())
-        {
-            ack_received = true;
-            break;
-        }
-    }
+    // every option this node knows of is accepted (as long as a connection ID is left for the
+    // compact header), unknown ones aren't echoed back
+    connection_settings settings{};
+    settings.compression = requested_options & message_segment::compression;
+    settings.compact_header = (requested_options & message_segment::compact_header)
+        && try_assign_connection_id(connection_key, settings.local_connection_id);
+    settings.forward_error_correction
+        = requested_options & message_segment::forward_error_correction;
+    settings.peer_connection_id = peer_connection_id;
+    settings.window_size = negotiate_window_size(connection_key, peer_window_size);
+
+    // the window size is echoed to peers that advertised theirs, the others use their own
+    uint8_t accepted_options = (settings.compression ? message_segment::compression : 0)
+        | (settings.compact_header ? message_segment::compact_header : 0)
+        | (settings.forward_error_correction ? message_segment::forward_error_correction : 0)
+        | (requested_options & message_segment::window_size);
+    auto response = message_segment::create_synack(connection_key.destination_port,
+        connection_key.source_port, accepted_options, settings.local_connection_id,
+        settings.window_size);
+    // TODO: have generic write_frame method in xbee so we don't have to explicitly create uart
+    // frame every time?
+    auto frame = uart_frame::encode_tx_request_64(connection_key.source_address, *response);
+    bool ack_received = try_handshake(
+        frame, segment_queue, [](const message_segment &message) { return message.is_ack(); });
 
     // TODO: known issue: as of current behavior, sender may start sending traffic while receiver
     // (here, above) is still waiting for ack_received
@@ -106,6 +128,7 @@ void channel_manager::incoming_connection_handler(connection_tuple connection_ke
     //  2 way communication
     if (!ack_received)
     {
+        release_connection_id(connection_key, settings.local_connection_id);
         return;
     }
 
@@ -113,10 +136,11 @@ void channel_manager::incoming_connection_handler(connection_tuple connection_ke
     if (request_queue == nullptr)
     {
         LOG_ERROR("request_queue is null");
+        release_connection_id(connection_key, settings.local_connection_id);
         return;
     }
 
-    request_queue->push(std::make_pair(connection_key.source_address, connection_key.source_port));
+    request_queue->push({connection_key.source_address, connection_key.source_port, settings});
 }
 
 uint32_t channel_manager::get_next_socket_suffix()
@@ -125,6 +149,63 @@ uint32_t channel_manager::get_next_socket_suffix()
     return socket_suffix++;
 }
 
+// takes the lowest free connection ID, fails once all of them are taken
+bool channel_manager::try_assign_connection_id(
+    connection_tuple connection_key, uint8_t &connection_id)
+{
+    for (uint16_t id = 0; id <= message_segment::CONNECTION_ID_MASK; ++id)
+    {
+        if (connection_ids.try_add(static_cast<uint8_t>(id), connection_key))
+        {
+            connection_id = static_cast<uint8_t>(id);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// note: only releases connection_id if it's still assigned to connection_key
+void channel_manager::release_connection_id(connection_tuple connection_key, uint8_t connection_id)
+{
+    connection_ids.erase_if(connection_id,
+        [&connection_key](const connection_tuple &value) { return value == connection_key; });
+}
+
+// transmits frame until a segment satisfying is_response arrives, retries are driven by the
+// shared timer_wheel which wakes the waiting thread by pushing a nullptr sentinel onto
+// segment_queue
+//  - note: a sentinel can outlive the handshake if its timer fires while the response is being
+//  processed, consumers of segment_queue must skip nullptr entries
+bool channel_manager::try_handshake(std::shared_ptr<frame_buffer> frame,
+    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<message_segment>>> segment_queue,
+    std::function<bool(const message_segment &)> is_response)
+{
+    for (int i = 0; i < HANDSHAKE_ATTEMPTS; ++i)
+    {
+        write_queue->push(frame);
+        auto retry_timer_id = timers->schedule(
+            HANDSHAKE_RETRY_INTERVAL, [segment_queue] { segment_queue->push(nullptr); });
+
+        while (true)
+        {
+            auto segment = segment_queue->wait_and_pop();
+            if (segment == nullptr)
+            {
+                break;
+            }
+
+            if (is_response(*segment))
+            {
+                timers->cancel(retry_timer_id);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
 void channel_manager::passive_socket_manager(int client_socket_fd, uint16_t listen_port)
 {
     LOG("starting passive_socket_manager thread for port ", +listen_port);
@@ -143,10 +224,10 @@ void channel_manager::passive_socket_manager(int client_socket_fd, uint16_t list
         if (beehive_message::is_message(beehive_message::ACCEPT, request_message))
         {
             LOG("waiting for client request on port ", +listen_port);
-            auto client_info = request_queue->wait_and_pop();
+            auto request = request_queue->wait_and_pop();
 
-            uint64_t source_address = client_info.first;
-            uint16_t source_port = client_info.second;
+            uint64_t source_address = request.source_address;
+            uint16_t source_port = request.source_port;
 
             LOG("received request on port ", +listen_port, " from (dest: ",
                 util::to_hex_string(source_address), ", port: ", +source_port, ")");
@@ -166,15 +247,15 @@ void channel_manager::passive_socket_manager(int client_socket_fd, uint16_t list
                 source_address, source_port, local_address, listen_port);
             beehive_message::send_message(client_socket_fd,
                 beehive_message::OK + beehive_message::SEPARATOR + communication_socket_path);
-            std::thread payload_read_handler(
-                &channel_manager::payload_read_handler, this, listen_socket_fd, connection_key);
+            std::thread payload_read_handler(&channel_manager::payload_read_handler, this,
+                listen_socket_fd, connection_key, request.settings);
             payload_read_handler.detach();
         }
     }
 }
 
-void channel_manager::active_socket_manager(
-    int control_socket_fd, uint64_t destination_address, uint16_t destination_port)
+void channel_manager::active_socket_manager(int control_socket_fd, uint64_t destination_address,
+    uint16_t destination_port, reliable_channel::send_policy policy, bool compression)
 {
     LOG("starting active_socket_manager thread for fd ", control_socket_fd, " (dest: ",
         util::to_hex_string(destination_address), ", port: ", +destination_port, ")");
@@ -196,35 +277,66 @@ void channel_manager::active_socket_manager(
     // TODO: if destination != localhost -> 3 way handshake
     // TODO: localhost communication will need to bypass xbee hardware and just do domain socket ->
     // domain socket forwarding?
+    connection_settings settings{};
+    settings.window_size = config.get_max_window_size();
     if (destination_address != local_address)
     {
-        auto segment = message_segment::create_syn(source_port, destination_port);
-        uart_frame frame(std::make_shared<tx_request_64_frame>(destination_address, *segment));
-        bool synack_received = false;
-
-        for (int i = 0; i < 5; ++i)
-        {
-            write_queue->push(std::make_shared<std::vector<uint8_t>>(frame));
-            std::shared_ptr<message_segment> response;
-            // TODO: make timeout configurable
-            if (segment_queue->timed_wait_and_pop(response, std::chrono::milliseconds(500))
-                && response->is_synack())
-            {
-                synack_received = true;
-                break;
-            }
-        }
+        // compact header is always requested, if a connection ID is left
+        settings.compression = compression;
+        settings.compact_header
+            = try_assign_connection_id(connection_key, settings.local_connection_id);
+        settings.forward_error_correction = config.get_fec_by_default();
+
+        uint8_t accepted_options = 0;
+        uint8_t peer_connection_id = 0;
+        uint16_t peer_window_size = 0;
+        auto segment = message_segment::create_syn(source_port, destination_port,
+            (settings.compression ? message_segment::compression : 0)
+                | (settings.compact_header ? message_segment::compact_header : 0)
+                | (settings.forward_error_correction ? message_segment::forward_error_correction
+                                                     : 0)
+                | message_segment::window_size,
+            settings.local_connection_id, settings.window_size);
+        auto frame = uart_frame::encode_tx_request_64(destination_address, *segment);
+        bool synack_received = try_handshake(
+            frame, segment_queue,
+            [&accepted_options, &peer_connection_id, &peer_window_size](
+                const message_segment &response) {
+                if (!response.is_synack())
+                {
+                    return false;
+                }
+
+                accepted_options = response.get_connection_options();
+                peer_connection_id = response.get_offered_connection_id();
+                peer_window_size = response.get_offered_window_size();
+                return true;
+            });
 
         if (!synack_received)
         {
             // TODO: error
+            release_connection_id(connection_key, settings.local_connection_id);
             return;
         }
 
         segment = message_segment::create_ack(source_port, destination_port);
         // TODO: hold shared_ptr to segment?
-        frame = uart_frame(std::make_shared<tx_request_64_frame>(destination_address, *segment));
-        write_queue->push(std::make_shared<std::vector<uint8_t>>(frame));
+        write_queue->push(uart_frame::encode_tx_request_64(destination_address, *segment));
+
+        // peers predating connection options send an empty SYNACK, i.e. decline everything
+        settings.compression
+            = settings.compression && (accepted_options & message_segment::compression);
+        settings.forward_error_correction = settings.forward_error_correction
+            && (accepted_options & message_segment::forward_error_correction);
+        if (settings.compact_header && !(accepted_options & message_segment::compact_header))
+        {
+            release_connection_id(connection_key, settings.local_connection_id);
+            settings.compact_header = false;
+        }
+
+        settings.peer_connection_id = peer_connection_id;
+        settings.window_size = negotiate_window_size(connection_key, peer_window_size);
     }
 
     std::string communication_socket_path = channel_path_prefix + "/"
@@ -235,18 +347,20 @@ void channel_manager::active_socket_manager(
     if (listen_socket_fd == -1)
     {
         LOG_ERROR("error creating communication socket");
+        release_connection_id(connection_key, settings.local_connection_id);
         return;
     }
 
     beehive_message::send_message(control_socket_fd,
         beehive_message::OK + beehive_message::SEPARATOR + communication_socket_path);
     std::thread payload_write_handler(&channel_manager::payload_write_handler, this,
-        control_socket_fd, listen_socket_fd, connection_key);
+        control_socket_fd, listen_socket_fd, connection_key, policy, settings);
     payload_write_handler.join();
     _port_manager.release_port(source_port);
 }
 
-void channel_manager::payload_read_handler(int listen_socket_fd, connection_tuple connection_key)
+void channel_manager::payload_read_handler(
+    int listen_socket_fd, connection_tuple connection_key, connection_settings settings)
 {
     LOG("starting payload_read_handler thread");
 
@@ -258,6 +372,11 @@ void channel_manager::payload_read_handler(int listen_socket_fd, connection_tupl
     }
 
     LOG("client connected to communication socket");
+    if (!util::try_configure_nonblocking_receive_timeout(communication_socket_fd))
+    {
+        // TODO: handle
+        return;
+    }
 
     auto segment_queue = segment_queue_map[connection_key];
     if (segment_queue == nullptr)
@@ -267,16 +386,19 @@ void channel_manager::payload_read_handler(int listen_socket_fd, connection_tupl
         return;
     }
 
-    // TODO: will need to keep ref to channel to signal close
-    auto channel = std::make_shared<reliable_channel>(
-        connection_key, communication_socket_fd, write_queue, segment_queue);
-    channel->start_receiving();
+    // note: passive side closes its outgoing direction once the client closes its socket
+    auto channel = std::make_shared<reliable_channel>(get_channel_config(settings), timers,
+        reactor, connection_key, communication_socket_fd, write_queue, segment_queue);
+    configure_channel(*channel, settings);
+    channel->start();
 
-    // TODO: close/cleanup communication_socket_fd
+    release_channel(connection_key, channel, segment_queue, communication_socket_fd,
+        listen_socket_fd, settings);
 }
 
-void channel_manager::payload_write_handler(
-    int control_socket_fd, int listen_socket_fd, connection_tuple connection_key)
+void channel_manager::payload_write_handler(int control_socket_fd, int listen_socket_fd,
+    connection_tuple connection_key, reliable_channel::send_policy policy,
+    connection_settings settings)
 {
     int communication_socket_fd = util::accept_connection(listen_socket_fd);
     if (communication_socket_fd == -1)
@@ -302,31 +424,103 @@ void channel_manager::payload_write_handler(
         return;
     }
 
-    auto channel = std::make_shared<reliable_channel>(
-        connection_key, communication_socket_fd, write_queue, segment_queue);
-    std::thread reliable_sender(&reliable_channel::start_sending, channel);
-
-    while (true)
-    {
-        std::string control_message = beehive_message::read_message(control_socket_fd);
-        if (control_message.empty())
+    auto channel = std::make_shared<reliable_channel>(get_channel_config(settings), timers,
+        reactor, connection_key, communication_socket_fd, write_queue, segment_queue);
+    channel->set_send_policy(policy);
+    configure_channel(*channel, settings);
+
+    // control messages are read on the reactor thread as they arrive (a message split across reads
+    // is put back together in pending), a client that closed its control socket is done with the
+    // connection as well
+    auto pending = std::make_shared<std::string>();
+    reactor->try_add(control_socket_fd, [this, control_socket_fd, channel, pending](uint32_t) {
+        if (!beehive_message::try_read_pending(control_socket_fd, *pending)
+            || beehive_message::is_message(beehive_message::CLOSE, *pending))
         {
-            // TODO: should exit here?
-            continue;
-        }
-
-        if (beehive_message::is_message(beehive_message::CLOSE, control_message))
-        {
-            // TODO: send fin to receiver
             // TODO: differentiate CLOSE vs SHUTDOWN?
             //  - close -> finish sending payload and then send fin
             //  - shutdown -> send immediate fin (disruptive disconnect)
 
             channel->request_channel_close();
-            break;
+            return;
+        }
+
+        if (!beehive_message::is_partial_message(beehive_message::CLOSE, *pending))
+        {
+            pending->clear();
         }
+
+        reactor->arm(control_socket_fd, EPOLLIN);
+    });
+    reactor->arm(control_socket_fd, EPOLLIN);
+
+    channel->start();
+    reactor->remove(control_socket_fd);
+    release_channel(connection_key, channel, segment_queue, communication_socket_fd,
+        listen_socket_fd, settings);
+}
+
+// window size both ends use, the smaller of their max window sizes: a receive window larger than
+// the peer's would let it be overrun, a smaller one leaves the peer's bandwidth unused
+//  - note: peers predating the window_size option advertise none (0) and use their own
+uint16_t channel_manager::negotiate_window_size(
+    connection_tuple connection_key, uint16_t peer_window_size) const
+{
+    uint16_t local_window_size = config.get_max_window_size();
+    if (peer_window_size == 0)
+    {
+        LOG_WARNING(connection_key.to_string(), " peer doesn't advertise a window size, assuming ",
+            local_window_size, " matches its max window size");
+        return local_window_size;
+    }
+
+    if (peer_window_size != local_window_size)
+    {
+        LOG_WARNING(connection_key.to_string(), " max window size mismatch (local: ",
+            local_window_size, ", peer: ", peer_window_size, "), using the smaller one");
+    }
+
+    return std::min(local_window_size, peer_window_size);
+}
+
+beehive_config channel_manager::get_channel_config(const connection_settings &settings) const
+{
+    beehive_config channel_config(config);
+    channel_config.set_max_window_size(settings.window_size);
+    return channel_config;
+}
+
+void channel_manager::configure_channel(
+    reliable_channel &channel, const connection_settings &settings) const
+{
+    channel.set_compression(settings.compression);
+    channel.set_forward_error_correction(settings.forward_error_correction);
+    if (settings.compact_header)
+    {
+        channel.set_peer_connection_id(settings.peer_connection_id);
+    }
+}
+
+// closes the sockets of a channel that was shut down, then stops routing segments to it once it's
+// done lingering
+//  - note: only removes segment_queue if it wasn't already replaced by a new connection reusing
+//  connection_key
+void channel_manager::release_channel(connection_tuple connection_key,
+    std::shared_ptr<reliable_channel> channel,
+    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<message_segment>>> segment_queue,
+    int communication_socket_fd, int listen_socket_fd, const connection_settings &settings)
+{
+    close(communication_socket_fd);
+    close(listen_socket_fd);
+    channel->linger();
+
+    if (settings.compact_header)
+    {
+        release_connection_id(connection_key, settings.local_connection_id);
     }
 
-    reliable_sender.join();
-    // TODO: close/cleanup communication_socket_fd + others
+    segment_queue_map.erase_if(connection_key,
+        [&segment_queue](
+            const std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<message_segment>>>
+                &value) { return value == segment_queue; });
 }
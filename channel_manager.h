@@ -1,7 +1,10 @@
 #ifndef CHANNEL_MANAGER_H
 #define CHANNEL_MANAGER_H
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -14,8 +17,10 @@
 #include "message_segment.h"
 #include "port_manager.h"
 #include "reliable_channel.h"
+#include "socket_reactor.h"
 #include "threadsafe_blocking_queue.h"
 #include "threadsafe_unordered_map.h"
+#include "timer_wheel.h"
 #include "tx_request_64_frame.h"
 #include "uart_frame.h"
 
@@ -23,46 +28,93 @@
 class channel_manager
 {
 public:
-    channel_manager(const beehive_config &config,
-        std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<std::vector<uint8_t>>>>
-            write_queue);
+    static const int HANDSHAKE_ATTEMPTS;
+    static const std::chrono::milliseconds HANDSHAKE_RETRY_INTERVAL;
+
+    channel_manager(const beehive_config &config, std::shared_ptr<timer_wheel> timers,
+        std::shared_ptr<socket_reactor> reactor,
+        std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<frame_buffer>>> write_queue);
 
     void set_local_address(uint64_t address);
     // TODO: no point of returning bool here?
     bool try_create_passive_socket(int client_socket_fd, uint16_t listen_port);
-    bool try_create_active_socket(
-        int client_socket_fd, uint64_t destination_address, uint16_t destination_port);
+    // compression is requested from the peer if either asked for here or enabled by default in
+    // config, the channel only compresses if the peer accepts
+    bool try_create_active_socket(int client_socket_fd, uint64_t destination_address,
+        uint16_t destination_port, reliable_channel::send_policy policy, bool compression);
     void process_stream_segment(
         connection_tuple connection_key, std::shared_ptr<message_segment> segment);
 
 private:
+    // per connection options agreed on in the handshake
+    struct connection_settings
+    {
+        bool compression;
+        bool compact_header;
+        bool forward_error_correction;
+        uint8_t local_connection_id;    // peer addresses its compact segments to this one
+        uint8_t peer_connection_id;    // compact segments sent to the peer are addressed to it
+        uint16_t window_size;    // the smaller max_window_size of both ends
+    };
+
+    // handshake completed by a peer, waiting on the local client to ACCEPT it
+    struct connection_request
+    {
+        uint64_t source_address;
+        uint16_t source_port;
+        connection_settings settings;
+    };
+
     static uint32_t get_next_socket_suffix();
 
+    // connection IDs are assigned per node, incoming compact segments are routed by connection ID
+    // alone (after checking the source address)
+    bool try_assign_connection_id(connection_tuple connection_key, uint8_t &connection_id);
+    void release_connection_id(connection_tuple connection_key, uint8_t connection_id);
+
+    bool try_handshake(std::shared_ptr<frame_buffer> frame,
+        std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<message_segment>>> segment_queue,
+        std::function<bool(const message_segment &)> is_response);
+
     void incoming_connection_handler(connection_tuple connection_key,
-        std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<message_segment>>> segment_queue);
+        std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<message_segment>>> segment_queue,
+        uint8_t requested_options, uint8_t peer_connection_id, uint16_t peer_window_size);
     // TODO: difference between client_socket_fd and control_socket_fd? same?
     void passive_socket_manager(int client_socket_fd, uint16_t listen_port);
-    void active_socket_manager(
-        int control_socket_fd, uint64_t destination_address, uint16_t destination_port);
-    void payload_read_handler(int listen_socket_fd, connection_tuple connection_key);
-    void payload_write_handler(
-        int control_socket_fd, int listen_socket_fd, connection_tuple connection_key);
+    void active_socket_manager(int control_socket_fd, uint64_t destination_address,
+        uint16_t destination_port, reliable_channel::send_policy policy, bool compression);
+    void payload_read_handler(int listen_socket_fd, connection_tuple connection_key,
+        connection_settings settings);
+    void payload_write_handler(int control_socket_fd, int listen_socket_fd,
+        connection_tuple connection_key, reliable_channel::send_policy policy,
+        connection_settings settings);
+    uint16_t negotiate_window_size(
+        connection_tuple connection_key, uint16_t peer_window_size) const;
+    beehive_config get_channel_config(const connection_settings &settings) const;
+    void configure_channel(reliable_channel &channel, const connection_settings &settings) const;
+    void release_channel(connection_tuple connection_key, std::shared_ptr<reliable_channel> channel,
+        std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<message_segment>>> segment_queue,
+        int communication_socket_fd, int listen_socket_fd, const connection_settings &settings);
 
     static uint32_t socket_suffix;
     static std::mutex socket_suffix_lock;
 
+    const beehive_config config;
     const std::string channel_path_prefix;
+    std::shared_ptr<timer_wheel> timers;
+    std::shared_ptr<socket_reactor> reactor;
     uint64_t local_address;
-    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<std::vector<uint8_t>>>> write_queue;
+    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<frame_buffer>>> write_queue;
     // TODO: separate segment maps for payload vs control segments?, separate state/connection
     // management into separate class?
     threadsafe_unordered_map<uint16_t,
-        std::shared_ptr<threadsafe_blocking_queue<std::pair<uint64_t, uint16_t>>>>
+        std::shared_ptr<threadsafe_blocking_queue<connection_request>>>
         connection_requests;
     threadsafe_unordered_map<connection_tuple,
         std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<message_segment>>>,
         connection_tuple_hasher>
         segment_queue_map;
+    threadsafe_unordered_map<uint8_t, connection_tuple> connection_ids;
     port_manager _port_manager;
 };
 
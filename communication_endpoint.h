@@ -3,9 +3,11 @@
 
 #include <cstdint>
 #include <memory>
+#include <utility>
 #include <vector>
 
-#include "uart_frame.h"
+#include "frame_buffer.h"
+#include "frame_buffer_pool.h"
 
 class communication_endpoint
 {
@@ -15,9 +17,35 @@ public:
     }
 
     virtual uint64_t get_address() = 0;
-    virtual void transmit_frame(const std::vector<uint8_t> &payload) = 0;
-    // TODO: change signature to return failure status as bool and frame payload as out param?
-    virtual std::shared_ptr<uart_frame> receive_frame() = 0;
+    virtual void transmit_frame(const frame_buffer &frame) = 0;
+    // complete uart frame as received (API mode 1 encoding), left to the caller to parse in place,
+    // nullptr if none arrived
+    virtual frame_buffer_pool::unique_buffer receive_frame() = 0;
+
+    // batch variants, endpoints override these to move several frames per system call
+    //  - both return false if the endpoint itself failed (rather than just having nothing to
+    //  receive), callers are expected to back off before trying again
+    virtual bool transmit_frames(const std::vector<std::shared_ptr<frame_buffer>> &frames)
+    {
+        for (auto &frame : frames)
+        {
+            transmit_frame(*frame);
+        }
+
+        return true;
+    }
+
+    // blocks like receive_frame, appends every complete frame available at that point to frames
+    virtual bool receive_frames(std::vector<frame_buffer_pool::unique_buffer> &frames)
+    {
+        auto frame = receive_frame();
+        if (frame != nullptr)
+        {
+            frames.push_back(std::move(frame));
+        }
+
+        return true;
+    }
 };
 
 #endif
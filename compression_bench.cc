@@ -0,0 +1,224 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "beehive_config.h"
+#include "connection_tuple.h"
+#include "message_segment.h"
+#include "reliable_channel.h"
+#include "socket_reactor.h"
+#include "threadsafe_blocking_queue.h"
+#include "timer_wheel.h"
+#include "tx_request_64_frame.h"
+#include "uart_frame.h"
+#include "util.h"
+
+// goodput of a single stream connection with and without payload compression, both endpoints run
+// in process and exchange frames over a simulated radio link
+//  - link: half duplex at the nominal xbee s1 air rate, frames from both directions are serialized
+//  and each one holds the link for as long as its uart frame takes to transmit (no loss)
+//  - payload: text telemetry records, the kind of traffic sensor nodes typically send
+// usage: compression_bench [payload bytes]
+namespace compression_bench
+{
+    typedef threadsafe_blocking_queue<std::shared_ptr<frame_buffer>> frame_queue;
+    typedef threadsafe_blocking_queue<std::shared_ptr<message_segment>> segment_queue;
+
+    const double LINK_BITS_PER_SECOND = 250000;
+    const size_t DEFAULT_PAYLOAD_LENGTH = 50000;
+
+    struct link_stats
+    {
+        uint64_t frames;
+        uint64_t bytes;
+    };
+
+    std::vector<uint8_t> create_telemetry(size_t length)
+    {
+        std::ostringstream oss;
+        for (size_t i = 0; static_cast<size_t>(oss.tellp()) < length; ++i)
+        {
+            oss << "node=0013a200407a" << 10 + i % 4 << " seq=" << i
+                << " temp=" << 20 + i % 7 << "." << i * 37 % 100 << " humidity=" << 40 + i % 11
+                << "." << i * 13 % 10 << " battery=3." << 70 + i % 5 << " status=OK\n";
+        }
+
+        auto telemetry = oss.str();
+        return std::vector<uint8_t>(telemetry.begin(), telemetry.begin() + length);
+    }
+
+    // delivers frame to the channel on the other end of the link once it has been on air
+    void transmit(std::shared_ptr<frame_buffer> frame, segment_queue &destination,
+        link_stats &stats)
+    {
+        std::this_thread::sleep_for(std::chrono::duration<double>(
+            static_cast<double>(frame->size()) * 8 / LINK_BITS_PER_SECOND));
+        ++stats.frames;
+        stats.bytes += frame->size();
+
+        std::vector<uint8_t> bytes(frame->begin(), frame->end());
+        auto parsed_frame = uart_frame::parse_frame(bytes.cbegin(), bytes.cend());
+        if (parsed_frame == nullptr)
+        {
+            return;
+        }
+
+        auto request = std::static_pointer_cast<tx_request_64_frame>(parsed_frame->get_data());
+        destination.push(std::make_shared<message_segment>(request->get_rf_data()));
+    }
+
+    void run_link(std::shared_ptr<frame_queue> a_out, std::shared_ptr<segment_queue> a_in,
+        std::shared_ptr<frame_queue> b_out, std::shared_ptr<segment_queue> b_in,
+        const std::atomic<bool> &running, link_stats &stats)
+    {
+        while (running)
+        {
+            std::shared_ptr<frame_buffer> frame;
+            bool idle = true;
+
+            if (a_out->try_pop(frame))
+            {
+                transmit(frame, *b_in, stats);
+                idle = false;
+            }
+
+            if (b_out->try_pop(frame))
+            {
+                transmit(frame, *a_in, stats);
+                idle = false;
+            }
+
+            if (idle && a_out->timed_wait_and_pop(frame, std::chrono::milliseconds(1)))
+            {
+                transmit(frame, *b_in, stats);
+            }
+        }
+    }
+
+    // sends payload from a to b, returns how long it took for b's client to receive all of it
+    std::chrono::microseconds run(
+        const std::vector<uint8_t> &payload, bool compression, link_stats &stats)
+    {
+        beehive_config config;
+        auto timers = std::make_shared<timer_wheel>();
+        std::thread timer_thread(&timer_wheel::run, timers);
+        auto reactor = std::make_shared<socket_reactor>();
+        std::thread reactor_thread(&socket_reactor::run, reactor);
+
+        auto a_out = std::make_shared<frame_queue>();
+        auto b_out = std::make_shared<frame_queue>();
+        auto a_in = std::make_shared<segment_queue>();
+        auto b_in = std::make_shared<segment_queue>();
+
+        // [0]: client end, [1]: channel end
+        int a_sockets[2];
+        int b_sockets[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, a_sockets) == -1
+            || socketpair(AF_UNIX, SOCK_STREAM, 0, b_sockets) == -1
+            || !util::try_configure_nonblocking_receive_timeout(a_sockets[1])
+            || !util::try_configure_nonblocking_receive_timeout(b_sockets[1]))
+        {
+            perror("socketpair");
+            exit(EXIT_FAILURE);
+        }
+
+        auto a = std::make_shared<reliable_channel>(config, timers, reactor,
+            connection_tuple(0xb, 1, 0xa, 49152), a_sockets[1], a_out, a_in);
+        auto b = std::make_shared<reliable_channel>(config, timers, reactor,
+            connection_tuple(0xa, 49152, 0xb, 1), b_sockets[1], b_out, b_in);
+        a->set_compression(compression);
+        b->set_compression(compression);
+
+        std::atomic<bool> running(true);
+        stats = link_stats();
+        std::thread link(run_link, a_out, a_in, b_out, b_in, std::cref(running), std::ref(stats));
+        std::thread a_thread(&reliable_channel::start, a);
+        std::thread b_thread(&reliable_channel::start, b);
+        shutdown(b_sockets[0], SHUT_WR);
+
+        auto start = std::chrono::steady_clock::now();
+        std::thread writer([&payload, &a_sockets, &a] {
+            util::send(a_sockets[0], payload);
+            a->request_channel_close();
+        });
+
+        size_t received = 0;
+        std::vector<uint8_t> buffer(4096);
+        while (received < payload.size())
+        {
+            ssize_t bytes_received = recv(b_sockets[0], buffer.data(), buffer.size(), 0);
+            if (bytes_received <= 0)
+            {
+                break;
+            }
+
+            received += bytes_received;
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        writer.join();
+        a_thread.join();
+        b_thread.join();
+        running = false;
+        link.join();
+        timers->stop();
+        timer_thread.join();
+        reactor->stop();
+        reactor_thread.join();
+
+        for (int fd : {a_sockets[0], a_sockets[1], b_sockets[0], b_sockets[1]})
+        {
+            close(fd);
+        }
+
+        if (received != payload.size())
+        {
+            fprintf(stderr, "received %zu of %zu bytes\n", received, payload.size());
+            exit(EXIT_FAILURE);
+        }
+
+        return elapsed;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t payload_length = compression_bench::DEFAULT_PAYLOAD_LENGTH;
+    if (argc > 1 && !util::try_parse_uint32_t(argv[1], payload_length))
+    {
+        fprintf(stderr, "usage: %s [payload bytes]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    auto payload = compression_bench::create_telemetry(payload_length);
+    printf("%zu bytes of telemetry over a %.0f kbit/s half duplex link\n", payload.size(),
+        compression_bench::LINK_BITS_PER_SECOND / 1000);
+
+    for (bool compression : {false, true})
+    {
+        compression_bench::link_stats stats;
+        auto elapsed = compression_bench::run(payload, compression, stats);
+        double seconds = elapsed.count() / 1e6;
+
+        printf("compression %-3s: %7.3f s, goodput %6.1f kbit/s, %5llu frames, %7llu bytes on "
+               "air\n",
+            compression ? "on" : "off", seconds, payload.size() * 8 / seconds / 1000,
+            static_cast<unsigned long long>(stats.frames),
+            static_cast<unsigned long long>(stats.bytes));
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,61 @@
+#include "congestion_controller.h"
+
+const uint16_t congestion_controller::MIN_WINDOW_SIZE = 1;
+const uint16_t congestion_controller::INITIAL_WINDOW_SIZE = 4;
+const uint16_t congestion_controller::MAX_WINDOW_SIZE = std::numeric_limits<uint16_t>::max() / 2;
+
+congestion_controller::congestion_controller(uint16_t max_window_size)
+    : max_window(std::min(std::max(max_window_size, MIN_WINDOW_SIZE), MAX_WINDOW_SIZE)),
+      window(std::min(INITIAL_WINDOW_SIZE, max_window)), slow_start_threshold(max_window),
+      acked_since_increase(0)
+{
+}
+
+void congestion_controller::on_ack(uint16_t acked_segments)
+{
+    for (uint16_t i = 0; i < acked_segments && window < max_window; ++i)
+    {
+        if (window < slow_start_threshold)
+        {
+            ++window;
+            continue;
+        }
+
+        if (++acked_since_increase >= window)
+        {
+            acked_since_increase = 0;
+            ++window;
+        }
+    }
+}
+
+// no ACKs arrived for an entire retransmission timeout, assume heavy congestion
+void congestion_controller::on_timeout()
+{
+    slow_start_threshold = std::max(static_cast<uint16_t>(window / 2), MIN_WINDOW_SIZE);
+    window = MIN_WINDOW_SIZE;
+    acked_since_increase = 0;
+}
+
+// isolated loss detected while ACKs are still flowing (i.e. fast retransmit)
+void congestion_controller::on_loss()
+{
+    slow_start_threshold = std::max(static_cast<uint16_t>(window / 2), MIN_WINDOW_SIZE);
+    window = slow_start_threshold;
+    acked_since_increase = 0;
+}
+
+uint16_t congestion_controller::get_window() const
+{
+    return window;
+}
+
+uint16_t congestion_controller::get_max_window() const
+{
+    return max_window;
+}
+
+uint16_t congestion_controller::get_slow_start_threshold() const
+{
+    return slow_start_threshold;
+}
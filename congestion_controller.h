@@ -0,0 +1,38 @@
+#ifndef CONGESTION_CONTROLLER_H
+#define CONGESTION_CONTROLLER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+// AIMD congestion window (in segments) for a reliable_channel sender
+//  - slow start: window grows by one segment per ACK until slow_start_threshold is reached
+//  - congestion avoidance: window grows by one segment per window's worth of ACKs
+//  - timeout: threshold halves and window collapses to MIN_WINDOW_SIZE
+//  - note: not threadsafe, owner is expected to serialize access
+class congestion_controller
+{
+public:
+    static const uint16_t MIN_WINDOW_SIZE;
+    static const uint16_t INITIAL_WINDOW_SIZE;
+    // selective repeat requires window size <= half the sequence number space
+    static const uint16_t MAX_WINDOW_SIZE;
+
+    congestion_controller(uint16_t max_window_size);
+
+    void on_ack(uint16_t acked_segments = 1);
+    void on_timeout();
+    void on_loss();
+
+    uint16_t get_window() const;
+    uint16_t get_max_window() const;
+    uint16_t get_slow_start_threshold() const;
+
+private:
+    uint16_t max_window;
+    uint16_t window;
+    uint16_t slow_start_threshold;
+    uint32_t acked_since_increase;
+};
+
+#endif
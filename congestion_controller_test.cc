@@ -0,0 +1,83 @@
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include "congestion_controller.h"
+
+namespace congestion_controller_test
+{
+    uint16_t any_max_window_size = 64;
+
+    TEST(CongestionControllerTest, ConstValuesSpec)
+    {
+        ASSERT_EQ(1, congestion_controller::MIN_WINDOW_SIZE);
+        ASSERT_EQ(4, congestion_controller::INITIAL_WINDOW_SIZE);
+        ASSERT_EQ(32767, congestion_controller::MAX_WINDOW_SIZE);
+    }
+
+    TEST(CongestionControllerTest, InitialWindowTest)
+    {
+        congestion_controller controller(any_max_window_size);
+        ASSERT_EQ(congestion_controller::INITIAL_WINDOW_SIZE, controller.get_window());
+        ASSERT_EQ(any_max_window_size, controller.get_slow_start_threshold());
+    }
+
+    TEST(CongestionControllerTest, MaxWindowClampTest)
+    {
+        ASSERT_EQ(congestion_controller::MIN_WINDOW_SIZE, congestion_controller(0).get_max_window());
+        ASSERT_EQ(congestion_controller::MAX_WINDOW_SIZE,
+            congestion_controller(0xffff).get_max_window());
+        ASSERT_EQ(2, congestion_controller(2).get_window());
+    }
+
+    TEST(CongestionControllerTest, SlowStartTest)
+    {
+        congestion_controller controller(any_max_window_size);
+        controller.on_ack(4);
+        ASSERT_EQ(8, controller.get_window());
+    }
+
+    TEST(CongestionControllerTest, WindowCappedAtMaxTest)
+    {
+        congestion_controller controller(any_max_window_size);
+        for (int i = 0; i < 1000; ++i)
+        {
+            controller.on_ack();
+        }
+
+        ASSERT_EQ(any_max_window_size, controller.get_window());
+    }
+
+    TEST(CongestionControllerTest, TimeoutTest)
+    {
+        congestion_controller controller(any_max_window_size);
+        controller.on_ack(12);
+        controller.on_timeout();
+        ASSERT_EQ(congestion_controller::MIN_WINDOW_SIZE, controller.get_window());
+        ASSERT_EQ(8, controller.get_slow_start_threshold());
+    }
+
+    TEST(CongestionControllerTest, CongestionAvoidanceTest)
+    {
+        congestion_controller controller(any_max_window_size);
+        controller.on_ack(12);
+        controller.on_timeout();
+        controller.on_ack(7);
+        ASSERT_EQ(8, controller.get_window());
+
+        // additive increase: one segment per window of ACKs
+        controller.on_ack(7);
+        ASSERT_EQ(8, controller.get_window());
+        controller.on_ack();
+        ASSERT_EQ(9, controller.get_window());
+    }
+
+    TEST(CongestionControllerTest, LossTest)
+    {
+        congestion_controller controller(any_max_window_size);
+        controller.on_ack(12);
+        controller.on_loss();
+        ASSERT_EQ(8, controller.get_window());
+        ASSERT_EQ(8, controller.get_slow_start_threshold());
+    }
+}
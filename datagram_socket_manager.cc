@@ -4,8 +4,11 @@ uint32_t datagram_socket_manager::socket_suffix = 0;
 std::mutex datagram_socket_manager::socket_suffix_lock;
 
 datagram_socket_manager::datagram_socket_manager(const beehive_config &config,
-    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<std::vector<uint8_t>>>> write_queue)
-    : dgram_path_prefix(config.get_dgram_path_prefix()), write_queue(write_queue)
+    std::shared_ptr<socket_reactor> reactor,
+    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<frame_buffer>>> write_queue)
+    : dgram_path_prefix(config.get_dgram_path_prefix()),
+      compress_datagrams(config.get_compress_by_default()), reactor(reactor),
+      write_queue(write_queue)
 {
 }
 
@@ -58,6 +61,23 @@ void datagram_socket_manager::process_segment(
         return;
     }
 
+    if (segment->is_compressed())
+    {
+        // note: a decompressed payload still has to fit in a segment
+        std::vector<uint8_t> payload;
+        if (!lz77_codec().decompress(
+                segment->get_message_begin(), segment->get_message_end(), payload)
+            || payload.size() > inline_buffer::CAPACITY)
+        {
+            LOG("discarding malformed compressed datagram");
+            return;
+        }
+
+        segment = allocate_pooled<message_segment>(segment->get_source_port(),
+            segment->get_destination_port(), segment->get_sequence_num(),
+            segment->get_message_type(), segment->get_message_flags(), payload);
+    }
+
     auto segment_queue = segment_queue_map.get_or_add(segment->get_destination_port(),
         std::make_shared<threadsafe_blocking_queue<datagram_segment>>());
     segment_queue->push(datagram_segment{source_address, segment});
@@ -84,31 +104,7 @@ void datagram_socket_manager::passive_socket_manager(int control_socket_fd, int
     }
 
     LOG("client connected to communication socket");
-
-    auto running = std::make_shared<bool>(true);    // TODO: cleaner way to share state?
-    std::thread payload_read_handler(&datagram_socket_manager::payload_read_handler, this,
-        communication_socket_fd, segment_queue, running);
-    std::thread payload_write_handler(&datagram_socket_manager::payload_write_handler, this,
-        communication_socket_fd, listen_port, running);
-
-    while (*running)
-    {
-        std::string control_message = beehive_message::read_message(control_socket_fd);
-        if (control_message.empty())
-        {
-            break;
-        }
-
-        // TODO: move away from using beehive_message::is_message?
-        if (beehive_message::is_message(beehive_message::CLOSE, control_message))
-        {
-            break;
-        }
-    }
-
-    *running = false;
-    payload_read_handler.join();
-    payload_write_handler.join();
+    run_socket(control_socket_fd, communication_socket_fd, listen_port, segment_queue);
     destroy_socket(listen_port);
 }
 
@@ -149,30 +145,7 @@ void datagram_socket_manager::active_socket_manager(int control_socket_fd)
     }
 
     LOG("client connected to communication socket");
-    auto running = std::make_shared<bool>(true);
-    std::thread payload_read_handler(&datagram_socket_manager::payload_read_handler, this,
-        communication_socket_fd, segment_queue, running);
-    std::thread payload_write_handler(&datagram_socket_manager::payload_write_handler, this,
-        communication_socket_fd, source_port, running);
-
-    while (*running)
-    {
-        std::string control_message = beehive_message::read_message(control_socket_fd);
-        if (control_message.empty())
-        {
-            break;
-        }
-
-        // TODO: move away from using beehive_message::is_message?
-        if (beehive_message::is_message(beehive_message::CLOSE, control_message))
-        {
-            break;
-        }
-    }
-
-    *running = false;
-    payload_read_handler.join();
-    payload_write_handler.join();
+    run_socket(control_socket_fd, communication_socket_fd, source_port, segment_queue);
     destroy_socket(source_port);
     // TODO: close listen_socket_fd
 }
@@ -183,24 +156,65 @@ void datagram_socket_manager::destroy_socket(uint16_t port)
     _port_manager.release_port(port);
 }
 
+void datagram_socket_manager::run_socket(int control_socket_fd, int communication_socket_fd,
+    uint16_t port, std::shared_ptr<threadsafe_blocking_queue<datagram_segment>> segment_queue)
+{
+    // handlers run on the reactor thread, closing is signalled to this one through segment_queue
+    auto close_socket = [segment_queue] { segment_queue->push(datagram_segment{0, nullptr}); };
+
+    reactor->try_add(
+        communication_socket_fd, [this, communication_socket_fd, port, close_socket](uint32_t) {
+            if (!payload_write_handler(communication_socket_fd, port))
+            {
+                close_socket();
+                return;
+            }
+
+            reactor->arm(communication_socket_fd, EPOLLIN);
+        });
+
+    auto pending = std::make_shared<std::string>();
+    reactor->try_add(control_socket_fd, [this, control_socket_fd, close_socket, pending](uint32_t) {
+        // TODO: move away from using beehive_message::is_message?
+        if (!beehive_message::try_read_pending(control_socket_fd, *pending)
+            || beehive_message::is_message(beehive_message::CLOSE, *pending))
+        {
+            close_socket();
+            return;
+        }
+
+        if (!beehive_message::is_partial_message(beehive_message::CLOSE, *pending))
+        {
+            pending->clear();
+        }
+
+        reactor->arm(control_socket_fd, EPOLLIN);
+    });
+
+    reactor->arm(communication_socket_fd, EPOLLIN);
+    reactor->arm(control_socket_fd, EPOLLIN);
+    payload_read_handler(communication_socket_fd, segment_queue);
+
+    reactor->remove(control_socket_fd);
+    reactor->remove(communication_socket_fd);
+}
+
 void datagram_socket_manager::payload_read_handler(int communication_socket_fd,
-    std::shared_ptr<threadsafe_blocking_queue<datagram_segment>> segment_queue,
-    std::shared_ptr<bool> running)
+    std::shared_ptr<threadsafe_blocking_queue<datagram_segment>> segment_queue)
 {
-    while (*running)
+    while (true)
     {
-        datagram_segment datagram;
-        // TODO: make timeout static, can make this larger, 1 second?
-        if (!segment_queue->timed_wait_and_pop(datagram, std::chrono::milliseconds(250)))
+        auto datagram = segment_queue->wait_and_pop();
+        if (datagram.segment == nullptr)
         {
-            continue;
+            return;
         }
 
         std::vector<uint8_t> buffer;
         util::pack_value_as_bytes(std::back_inserter(buffer), datagram.source_address);
         util::pack_value_as_bytes(std::back_inserter(buffer), datagram.segment->get_source_port());
-        buffer.insert(buffer.end(), datagram.segment->get_message().begin(),
-            datagram.segment->get_message().end());
+        buffer.insert(buffer.end(), datagram.segment->get_message_begin(),
+            datagram.segment->get_message_end());
 
         // TODO: will this have to be configured to be nonblocking?
         if (util::send(communication_socket_fd, buffer) == -1)
@@ -211,12 +225,11 @@ void datagram_socket_manager::payload_read_handler(int communication_socket_fd,
     }
 }
 
-void datagram_socket_manager::payload_write_handler(
-    int communication_socket_fd, uint16_t source_port, std::shared_ptr<bool> running)
+bool datagram_socket_manager::payload_write_handler(
+    int communication_socket_fd, uint16_t source_port)
 {
-    while (*running)
+    while (true)
     {
-        // TODO: configure nonblocking socket or use MSG_DONTWAIT?
         int error;
         std::vector<uint8_t> buffer;
         ssize_t bytes_read = util::nonblocking_recv(communication_socket_fd, buffer,
@@ -224,18 +237,11 @@ void datagram_socket_manager::payload_write_handler(
 
         if (bytes_read == 0)
         {
-            break;
+            return false;
         }
         else if (bytes_read == -1)
         {
-            if (error == EAGAIN || error == EWOULDBLOCK)
-            {
-                // TODO: add to beehive_config?
-                std::this_thread::sleep_for(std::chrono::milliseconds(25));
-                continue;
-            }
-
-            break;
+            return error == EAGAIN || error == EWOULDBLOCK;
         }
         else if (static_cast<uint64_t>(bytes_read) < sizeof(uint64_t) + sizeof(uint16_t))
         {
@@ -246,9 +252,30 @@ void datagram_socket_manager::payload_write_handler(
         uint16_t destination_port = util::unpack_bytes_to_width<uint16_t>(std::begin(buffer) + 8);
 
         auto payload = std::vector<uint8_t>(std::begin(buffer), std::begin(buffer) + bytes_read);
-        auto segment = std::make_shared<message_segment>(source_port, destination_port, 0,
-            message_segment::type::datagram_segment, message_segment::flag::none, payload);
-        uart_frame frame(std::make_shared<tx_request_64_frame>(destination_address, *segment));
-        write_queue->push(std::make_shared<std::vector<uint8_t>>(frame));
+        bool compressed = false;
+
+        if (compress_datagrams)
+        {
+            std::vector<uint8_t> compressed_payload;
+            size_t consumed = lz77_codec().compress(
+                payload.cbegin(), payload.cend(), payload.size() - 1, compressed_payload);
+            compressed = consumed == payload.size();
+
+            if (compressed)
+            {
+                payload.swap(compressed_payload);
+            }
+        }
+
+        auto segment = allocate_pooled<message_segment>(source_port, destination_port, 0,
+            message_segment::type::datagram_segment, message_segment::flag::none, payload,
+            compressed);
+        auto frame = uart_frame::encode_tx_request_64(destination_address, *segment);
+        if (frame != nullptr)
+        {
+            frame->set_queued_time(std::chrono::steady_clock::now());
+        }
+
+        write_queue->push(frame);
     }
 }
@@ -17,8 +17,13 @@
 
 #include "beehive_config.h"
 #include "beehive_message.h"
+#include "inline_buffer.h"
+#include "logger.h"
+#include "lz77_codec.h"
 #include "message_segment.h"
+#include "pool_allocator.h"
 #include "port_manager.h"
+#include "socket_reactor.h"
 #include "threadsafe_blocking_queue.h"
 #include "threadsafe_unordered_map.h"
 #include "tx_request_64_frame.h"
@@ -27,15 +32,14 @@
 struct datagram_segment
 {
     uint64_t source_address;
-    std::shared_ptr<message_segment> segment;
+    std::shared_ptr<message_segment> segment;    // nullptr: socket is being closed
 };
 
 class datagram_socket_manager
 {
 public:
-    datagram_socket_manager(const beehive_config &config,
-        std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<std::vector<uint8_t>>>>
-            write_queue);
+    datagram_socket_manager(const beehive_config &config, std::shared_ptr<socket_reactor> reactor,
+        std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<frame_buffer>>> write_queue);
 
     bool try_create_passive_socket(int control_socket_fd, uint16_t listen_port);
     bool try_create_active_socket(int control_socket_fd);
@@ -48,17 +52,24 @@ private:
         std::shared_ptr<threadsafe_blocking_queue<datagram_segment>> segment_queue);
     void active_socket_manager(int control_socket_fd);
     void destroy_socket(uint16_t port);
+    // both sockets are watched by the reactor, incoming datagrams are delivered on the calling
+    // thread until either the client or its control socket closes
+    void run_socket(int control_socket_fd, int communication_socket_fd, uint16_t port,
+        std::shared_ptr<threadsafe_blocking_queue<datagram_segment>> segment_queue);
     void payload_read_handler(int communication_socket_fd,
-        std::shared_ptr<threadsafe_blocking_queue<datagram_segment>> segment_queue,
-        std::shared_ptr<bool> running);
-    void payload_write_handler(
-        int communication_socket_fd, uint16_t source_port, std::shared_ptr<bool> running);
+        std::shared_ptr<threadsafe_blocking_queue<datagram_segment>> segment_queue);
+    // sends every datagram the client has written so far, returns false once the client is gone
+    bool payload_write_handler(int communication_socket_fd, uint16_t source_port);
 
     static uint32_t socket_suffix;
     static std::mutex socket_suffix_lock;
 
     const std::string dgram_path_prefix;
-    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<std::vector<uint8_t>>>> write_queue;
+    // note: datagrams are compressed on their own (no dictionary carried over, they may be lost or
+    // reordered), and only sent compressed if that makes them smaller
+    const bool compress_datagrams;
+    std::shared_ptr<socket_reactor> reactor;
+    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<frame_buffer>>> write_queue;
     threadsafe_unordered_map<uint16_t, std::shared_ptr<threadsafe_blocking_queue<datagram_segment>>>
         segment_queue_map;
     port_manager _port_manager;
@@ -0,0 +1,138 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "escape_codec.h"
+#include "uart_frame.h"
+#include "util.h"
+
+// throughput of API mode 2 escaping and unescaping with each special byte scan kernel
+//  - frame: a maximum size uart frame, the unit xbee_s1 escapes on every write
+//  - stream: a burst of serial line input, the unit frame_parser unescapes on every read
+//  - payload bytes are uniformly random (roughly one special byte in 64) or text, which holds none
+// usage: escape_bench [iterations]
+namespace escape_bench
+{
+    const uint32_t DEFAULT_ITERATIONS = 200000;
+    const size_t STREAM_LENGTH = 4096;
+
+    std::vector<uint8_t> create_random_data(size_t length)
+    {
+        std::mt19937 generator(7);
+        std::uniform_int_distribution<uint32_t> distribution(0x00, 0xff);
+        std::vector<uint8_t> data(length);
+        for (auto &byte : data)
+        {
+            byte = static_cast<uint8_t>(distribution(generator));
+        }
+
+        return data;
+    }
+
+    std::vector<uint8_t> create_text_data(size_t length)
+    {
+        const char text[] = "node=0013a200407a10 seq=42 temp=21.37 humidity=44.9 status=OK\n";
+        std::vector<uint8_t> data(length);
+        for (size_t i = 0; i < length; ++i)
+        {
+            data[i] = static_cast<uint8_t>(text[i % (sizeof(text) - 1)]);
+        }
+
+        return data;
+    }
+
+    const char *get_kernel_name(escape_codec::kernel scan_kernel)
+    {
+        switch (scan_kernel)
+        {
+            case escape_codec::byte_loop:
+                return "byte_loop";
+
+            case escape_codec::sse2:
+                return "sse2";
+
+            case escape_codec::avx2:
+                return "avx2";
+
+            default:
+                return "unknown";
+        }
+    }
+
+    void run(const char *name, const std::vector<uint8_t> &data, uint32_t iterations)
+    {
+        printf("%s (%zu bytes)\n", name, data.size());
+
+        for (auto scan_kernel : {escape_codec::byte_loop, escape_codec::sse2, escape_codec::avx2})
+        {
+            if (!escape_codec::is_supported(scan_kernel))
+            {
+                printf("  %-10s not supported\n", get_kernel_name(scan_kernel));
+                continue;
+            }
+
+            escape_codec codec(scan_kernel);
+            std::vector<uint8_t> escaped;
+            std::vector<uint8_t> unescaped;
+            escaped.reserve(data.size() * 2);
+            unescaped.reserve(data.size());
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < iterations; ++i)
+            {
+                escaped.clear();
+                codec.escape(data.data(), data.data() + data.size(), escaped);
+            }
+
+            auto escape_time = std::chrono::steady_clock::now() - start;
+
+            start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < iterations; ++i)
+            {
+                unescaped.clear();
+                if (!codec.unescape(escaped.data(), escaped.data() + escaped.size(), unescaped))
+                {
+                    fprintf(stderr, "unescape failed\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+
+            auto unescape_time = std::chrono::steady_clock::now() - start;
+            if (unescaped != data)
+            {
+                fprintf(stderr, "round trip mismatch\n");
+                exit(EXIT_FAILURE);
+            }
+
+            auto bytes = static_cast<double>(data.size()) * iterations;
+            printf("  %-10s escape %8.1f MB/s   unescape %8.1f MB/s\n",
+                get_kernel_name(scan_kernel),
+                bytes / std::chrono::duration<double>(escape_time).count() / 1e6,
+                bytes / std::chrono::duration<double>(unescape_time).count() / 1e6);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t iterations = escape_bench::DEFAULT_ITERATIONS;
+    if (argc > 1 && !util::try_parse_uint32_t(argv[1], iterations))
+    {
+        fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    escape_bench::run("random frame", escape_bench::create_random_data(uart_frame::MAX_FRAME_SIZE),
+        iterations);
+    escape_bench::run("text frame", escape_bench::create_text_data(uart_frame::MAX_FRAME_SIZE),
+        iterations);
+    escape_bench::run("random stream", escape_bench::create_random_data(escape_bench::STREAM_LENGTH),
+        iterations / 16);
+    escape_bench::run("text stream", escape_bench::create_text_data(escape_bench::STREAM_LENGTH),
+        iterations / 16);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,222 @@
+#include "escape_codec.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ESCAPE_CODEC_X86
+#endif
+
+bool escape_codec::is_supported(kernel scan_kernel)
+{
+    switch (scan_kernel)
+    {
+        case kernel::byte_loop:
+            return true;
+
+#ifdef ESCAPE_CODEC_X86
+        case kernel::sse2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+
+        case kernel::avx2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+
+        default:
+            return false;
+    }
+}
+
+escape_codec::kernel escape_codec::get_fastest_kernel()
+{
+    static const kernel fastest = is_supported(kernel::avx2)
+        ? kernel::avx2
+        : is_supported(kernel::sse2) ? kernel::sse2 : kernel::byte_loop;
+    return fastest;
+}
+
+bool escape_codec::is_special(uint8_t byte)
+{
+    return byte == uart_frame::FRAME_DELIMITER || byte == uart_frame::ESCAPE
+        || byte == uart_frame::XON || byte == uart_frame::XOFF;
+}
+
+escape_codec::escape_codec()
+    : scan_kernel(get_fastest_kernel())
+{
+}
+
+escape_codec::escape_codec(kernel scan_kernel)
+    : scan_kernel(is_supported(scan_kernel) ? scan_kernel : get_fastest_kernel())
+{
+}
+
+escape_codec::kernel escape_codec::get_kernel() const
+{
+    return scan_kernel;
+}
+
+size_t escape_codec::find_special(const uint8_t *begin, const uint8_t *end) const
+{
+    switch (scan_kernel)
+    {
+        case kernel::sse2:
+            return find_special_sse2(begin, end);
+
+        case kernel::avx2:
+            return find_special_avx2(begin, end);
+
+        default:
+            return find_special_byte_loop(begin, end);
+    }
+}
+
+void escape_codec::escape(
+    const uint8_t *begin, const uint8_t *end, std::vector<uint8_t> &output) const
+{
+    output.reserve(output.size() + static_cast<size_t>(end - begin));
+
+    while (begin != end)
+    {
+        size_t run = find_special(begin, end);
+        output.insert(output.end(), begin, begin + run);
+        begin += run;
+
+        if (begin == end)
+        {
+            break;
+        }
+
+        output.push_back(uart_frame::ESCAPE);
+        output.push_back(*begin ^ uart_frame::XOR_CONST);
+        ++begin;
+    }
+}
+
+bool escape_codec::unescape(
+    const uint8_t *begin, const uint8_t *end, std::vector<uint8_t> &output) const
+{
+    output.reserve(output.size() + static_cast<size_t>(end - begin));
+
+    while (begin != end)
+    {
+        size_t run = find_special(begin, end);
+        output.insert(output.end(), begin, begin + run);
+        begin += run;
+
+        if (begin == end)
+        {
+            break;
+        }
+
+        if (*begin != uart_frame::ESCAPE || end - begin < 2)
+        {
+            return false;
+        }
+
+        output.push_back(begin[1] ^ uart_frame::XOR_CONST);
+        begin += 2;
+    }
+
+    return true;
+}
+
+size_t escape_codec::find_special_byte_loop(const uint8_t *begin, const uint8_t *end)
+{
+    const uint8_t *position = begin;
+    while (position != end && !is_special(*position))
+    {
+        ++position;
+    }
+
+    return static_cast<size_t>(position - begin);
+}
+
+#ifdef ESCAPE_CODEC_X86
+
+__attribute__((target("sse2")))
+size_t escape_codec::find_special_sse2(const uint8_t *begin, const uint8_t *end)
+{
+    const __m128i delimiter = _mm_set1_epi8(static_cast<char>(uart_frame::FRAME_DELIMITER));
+    const __m128i escape = _mm_set1_epi8(static_cast<char>(uart_frame::ESCAPE));
+    const __m128i xon = _mm_set1_epi8(static_cast<char>(uart_frame::XON));
+    const __m128i xoff = _mm_set1_epi8(static_cast<char>(uart_frame::XOFF));
+    const uint8_t *position = begin;
+
+    for (; end - position >= static_cast<ptrdiff_t>(sizeof(__m128i)); position += sizeof(__m128i))
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(position));
+        __m128i matches = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, delimiter), _mm_cmpeq_epi8(block, escape)),
+            _mm_or_si128(_mm_cmpeq_epi8(block, xon), _mm_cmpeq_epi8(block, xoff)));
+
+        // one bit per byte, lowest bit is the first byte
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+        if (mask != 0)
+        {
+            return static_cast<size_t>(position - begin) + __builtin_ctz(mask);
+        }
+    }
+
+    return static_cast<size_t>(position - begin) + find_special_byte_loop(position, end);
+}
+
+__attribute__((target("avx2")))
+size_t escape_codec::find_special_avx2(const uint8_t *begin, const uint8_t *end)
+{
+    const __m256i delimiter = _mm256_set1_epi8(static_cast<char>(uart_frame::FRAME_DELIMITER));
+    const __m256i escape = _mm256_set1_epi8(static_cast<char>(uart_frame::ESCAPE));
+    const __m256i xon = _mm256_set1_epi8(static_cast<char>(uart_frame::XON));
+    const __m256i xoff = _mm256_set1_epi8(static_cast<char>(uart_frame::XOFF));
+    const uint8_t *position = begin;
+
+    for (; end - position >= static_cast<ptrdiff_t>(sizeof(__m256i)); position += sizeof(__m256i))
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(position));
+        __m256i matches = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, delimiter), _mm256_cmpeq_epi8(block, escape)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, xon), _mm256_cmpeq_epi8(block, xoff)));
+
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+        if (mask != 0)
+        {
+            return static_cast<size_t>(position - begin) + __builtin_ctz(mask);
+        }
+    }
+
+    // note: a frame is at most a few blocks long, so the remainder is worth a 16 byte step, it is
+    // done here rather than in find_special_sse2() to stay clear of SSE/AVX transition penalties
+    if (end - position >= static_cast<ptrdiff_t>(sizeof(__m128i)))
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(position));
+        __m128i matches = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, _mm256_castsi256_si128(delimiter)),
+                _mm_cmpeq_epi8(block, _mm256_castsi256_si128(escape))),
+            _mm_or_si128(_mm_cmpeq_epi8(block, _mm256_castsi256_si128(xon)),
+                _mm_cmpeq_epi8(block, _mm256_castsi256_si128(xoff))));
+
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+        if (mask != 0)
+        {
+            return static_cast<size_t>(position - begin) + __builtin_ctz(mask);
+        }
+
+        position += sizeof(__m128i);
+    }
+
+    return static_cast<size_t>(position - begin) + find_special_byte_loop(position, end);
+}
+
+#else
+
+size_t escape_codec::find_special_sse2(const uint8_t *begin, const uint8_t *end)
+{
+    return find_special_byte_loop(begin, end);
+}
+
+size_t escape_codec::find_special_avx2(const uint8_t *begin, const uint8_t *end)
+{
+    return find_special_byte_loop(begin, end);
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef ESCAPE_CODEC_H
+#define ESCAPE_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "uart_frame.h"
+
+// byte stuffing of API mode 2 (AP=2): FRAME_DELIMITER, ESCAPE, XON and XOFF are sent as ESCAPE
+// followed by the byte XOR XOR_CONST
+//  - frames are mostly plain bytes, so both directions search for the next special byte and copy
+//  everything before it in one go, the search compares a whole vector of bytes against all four
+//  special bytes at once
+//  - kernel: byte_loop compares one byte at a time, sse2 16 bytes and avx2 32 bytes per step (the
+//  remainder goes through the next narrower kernel), the fastest one the cpu supports is picked at
+//  runtime
+//  - note: the leading delimiter of a frame is never escaped, see uart_frame::escape_frame()
+class escape_codec
+{
+public:
+    enum kernel : uint8_t
+    {
+        byte_loop,
+        sse2,
+        avx2
+    };
+
+    static bool is_supported(kernel scan_kernel);
+    static kernel get_fastest_kernel();
+    static bool is_special(uint8_t byte);
+
+    escape_codec();
+    // falls back to get_fastest_kernel() if scan_kernel isn't supported on this machine
+    explicit escape_codec(kernel scan_kernel);
+
+    kernel get_kernel() const;
+
+    // offset of the first special byte in [begin, end), end - begin if there is none
+    size_t find_special(const uint8_t *begin, const uint8_t *end) const;
+    // appends [begin, end) to output with every special byte escaped
+    void escape(const uint8_t *begin, const uint8_t *end, std::vector<uint8_t> &output) const;
+    // appends the decoded bytes to output, returns false if a special byte other than ESCAPE
+    // appears unescaped or the data ends in the middle of an escape sequence
+    bool unescape(const uint8_t *begin, const uint8_t *end, std::vector<uint8_t> &output) const;
+
+private:
+    static size_t find_special_byte_loop(const uint8_t *begin, const uint8_t *end);
+    static size_t find_special_sse2(const uint8_t *begin, const uint8_t *end);
+    static size_t find_special_avx2(const uint8_t *begin, const uint8_t *end);
+
+    kernel scan_kernel;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "escape_codec.h"
+#include "uart_frame.h"
+
+namespace escape_codec_test
+{
+    std::vector<escape_codec> get_supported_codecs()
+    {
+        std::vector<escape_codec> codecs;
+        for (auto scan_kernel : {escape_codec::byte_loop, escape_codec::sse2, escape_codec::avx2})
+        {
+            if (escape_codec::is_supported(scan_kernel))
+            {
+                codecs.push_back(escape_codec(scan_kernel));
+            }
+        }
+
+        return codecs;
+    }
+
+    TEST(EscapeCodecTest, KernelSupportTest)
+    {
+        ASSERT_TRUE(escape_codec::is_supported(escape_codec::byte_loop));
+        ASSERT_TRUE(escape_codec::is_supported(escape_codec::get_fastest_kernel()));
+        ASSERT_EQ(escape_codec::byte_loop, escape_codec(escape_codec::byte_loop).get_kernel());
+        ASSERT_EQ(escape_codec::get_fastest_kernel(), escape_codec().get_kernel());
+    }
+
+    TEST(EscapeCodecTest, IsSpecialTest)
+    {
+        size_t special_bytes = 0;
+        for (uint32_t byte = 0; byte <= 0xff; ++byte)
+        {
+            special_bytes += escape_codec::is_special(static_cast<uint8_t>(byte));
+        }
+
+        ASSERT_EQ(4, special_bytes);
+        ASSERT_TRUE(escape_codec::is_special(uart_frame::FRAME_DELIMITER));
+        ASSERT_TRUE(escape_codec::is_special(uart_frame::ESCAPE));
+        ASSERT_TRUE(escape_codec::is_special(uart_frame::XON));
+        ASSERT_TRUE(escape_codec::is_special(uart_frame::XOFF));
+    }
+
+    TEST(EscapeCodecTest, FindSpecialTest)
+    {
+        for (auto &codec : get_supported_codecs())
+        {
+            // covers the vector loops as well as the remainder
+            for (size_t length : {0, 1, 15, 16, 17, 31, 32, 33, 100})
+            {
+                std::vector<uint8_t> data(length, 'a');
+                ASSERT_EQ(length, codec.find_special(data.data(), data.data() + length));
+
+                for (size_t offset = 0; offset < length; ++offset)
+                {
+                    data.assign(length, 'a');
+                    data[offset] = uart_frame::XOFF;
+                    if (offset + 1 < length)
+                    {
+                        data[offset + 1] = uart_frame::FRAME_DELIMITER;
+                    }
+
+                    ASSERT_EQ(offset, codec.find_special(data.data(), data.data() + length))
+                        << "kernel: " << +codec.get_kernel() << ", length: " << length;
+                }
+            }
+        }
+    }
+
+    TEST(EscapeCodecTest, EscapeTest)
+    {
+        std::vector<uint8_t> data{'a', 0x7e, 'b', 0x7d, 0x11, 0x13, 'c'};
+        std::vector<uint8_t> escaped{'a', 0x7d, 0x5e, 'b', 0x7d, 0x5d, 0x7d, 0x31, 0x7d, 0x33, 'c'};
+
+        for (auto &codec : get_supported_codecs())
+        {
+            std::vector<uint8_t> output{'x'};
+            codec.escape(data.data(), data.data() + data.size(), output);
+            ASSERT_EQ('x', output.front());
+            ASSERT_EQ(escaped, std::vector<uint8_t>(output.begin() + 1, output.end()));
+
+            std::vector<uint8_t> unescaped;
+            ASSERT_TRUE(codec.unescape(escaped.data(), escaped.data() + escaped.size(), unescaped));
+            ASSERT_EQ(data, unescaped);
+        }
+    }
+
+    TEST(EscapeCodecTest, RoundTripTest)
+    {
+        std::vector<uint8_t> data;
+        for (uint32_t byte = 0; byte <= 0xff; ++byte)
+        {
+            data.push_back(static_cast<uint8_t>(byte));
+        }
+
+        for (auto &codec : get_supported_codecs())
+        {
+            std::vector<uint8_t> escaped;
+            codec.escape(data.data(), data.data() + data.size(), escaped);
+            ASSERT_EQ(data.size() + 4, escaped.size());
+            for (auto byte : escaped)
+            {
+                ASSERT_TRUE(byte == uart_frame::ESCAPE || !escape_codec::is_special(byte));
+            }
+
+            std::vector<uint8_t> unescaped;
+            ASSERT_TRUE(codec.unescape(escaped.data(), escaped.data() + escaped.size(), unescaped));
+            ASSERT_EQ(data, unescaped);
+        }
+    }
+
+    TEST(EscapeCodecTest, UnescapeMalformedTest)
+    {
+        escape_codec codec;
+        std::vector<uint8_t> output;
+
+        // ends in the middle of an escape sequence
+        std::vector<uint8_t> truncated{'a', 0x7d};
+        ASSERT_FALSE(codec.unescape(truncated.data(), truncated.data() + truncated.size(), output));
+
+        // delimiter can't be part of escaped data
+        std::vector<uint8_t> delimiter{'a', 0x7e, 'b'};
+        ASSERT_FALSE(codec.unescape(delimiter.data(), delimiter.data() + delimiter.size(), output));
+    }
+}
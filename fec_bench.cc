@@ -0,0 +1,340 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "beehive_config.h"
+#include "connection_tuple.h"
+#include "message_segment.h"
+#include "reliable_channel.h"
+#include "socket_reactor.h"
+#include "threadsafe_blocking_queue.h"
+#include "timer_wheel.h"
+#include "tx_request_64_frame.h"
+#include "uart_frame.h"
+#include "util.h"
+
+// goodput and latency of a single stream connection with and without forward error correction,
+// both endpoints run in process and exchange frames over a simulated lossy radio link
+//  - link: half duplex at the nominal xbee s1 air rate, frames from both directions are serialized,
+//  each one holds the link for as long as its uart frame takes to transmit and is then dropped
+//  with the given probability (independently of every other frame, ACKs included)
+//  - queue delay: how long frames waited for the link after the channel queued them
+//  - bulk: time for the receiving client to get a large payload written all at once
+//  - records: small fixed size records written at a steady rate, latency is measured from the
+//  write to the receiving client reading the whole record
+// usage: fec_bench [payload bytes]
+namespace fec_bench
+{
+    typedef threadsafe_blocking_queue<std::shared_ptr<frame_buffer>> frame_queue;
+    typedef threadsafe_blocking_queue<std::shared_ptr<message_segment>> segment_queue;
+
+    const double LINK_BITS_PER_SECOND = 250000;
+    const size_t DEFAULT_PAYLOAD_LENGTH = 20000;
+    const size_t RECORD_LENGTH = 48;
+    const size_t RECORD_COUNT = 200;
+    const std::chrono::milliseconds RECORD_INTERVAL(20);
+    const std::vector<double> LOSS_RATES{0.05, 0.1, 0.2};
+
+    struct link_stats
+    {
+        uint64_t frames;
+        uint64_t frames_lost;
+        std::chrono::microseconds total_queue_delay;
+        std::chrono::microseconds max_queue_delay;
+
+        double get_mean_queue_delay_ms() const
+        {
+            return frames == 0 ? 0 : total_queue_delay.count() / 1000.0 / frames;
+        }
+    };
+
+    class lossy_link
+    {
+    public:
+        lossy_link(double loss_rate)
+            : loss_rate(loss_rate), random(1), stats()
+        {
+        }
+
+        // delivers frame to the channel on the other end of the link once it has been on air,
+        // unless it gets lost on the way
+        void transmit(std::shared_ptr<frame_buffer> frame, segment_queue &destination)
+        {
+            auto queue_delay = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - frame->get_queued_time());
+            stats.total_queue_delay += queue_delay;
+            stats.max_queue_delay = std::max(stats.max_queue_delay, queue_delay);
+
+            std::this_thread::sleep_for(std::chrono::duration<double>(
+                static_cast<double>(frame->size()) * 8 / LINK_BITS_PER_SECOND));
+            ++stats.frames;
+
+            if (std::uniform_real_distribution<double>(0, 1)(random) < loss_rate)
+            {
+                ++stats.frames_lost;
+                return;
+            }
+
+            std::vector<uint8_t> bytes(frame->begin(), frame->end());
+            auto parsed_frame = uart_frame::parse_frame(bytes.cbegin(), bytes.cend());
+            if (parsed_frame == nullptr)
+            {
+                return;
+            }
+
+            auto request = std::static_pointer_cast<tx_request_64_frame>(parsed_frame->get_data());
+            destination.push(std::make_shared<message_segment>(request->get_rf_data()));
+        }
+
+        void run(std::shared_ptr<frame_queue> a_out, std::shared_ptr<segment_queue> a_in,
+            std::shared_ptr<frame_queue> b_out, std::shared_ptr<segment_queue> b_in,
+            const std::atomic<bool> &running)
+        {
+            while (running)
+            {
+                std::shared_ptr<frame_buffer> frame;
+                bool idle = true;
+
+                if (a_out->try_pop(frame))
+                {
+                    transmit(frame, *b_in);
+                    idle = false;
+                }
+
+                if (b_out->try_pop(frame))
+                {
+                    transmit(frame, *a_in);
+                    idle = false;
+                }
+
+                if (idle && a_out->timed_wait_and_pop(frame, std::chrono::milliseconds(1)))
+                {
+                    transmit(frame, *b_in);
+                }
+            }
+        }
+
+        link_stats get_stats() const
+        {
+            return stats;
+        }
+
+    private:
+        double loss_rate;
+        std::mt19937 random;
+        link_stats stats;
+    };
+
+    // connects a to b over the link, runs writer on a's client end and reader on b's client end
+    // and returns how long it took for reader to finish
+    std::chrono::microseconds run(double loss_rate, bool fec, std::function<void(int)> writer,
+        std::function<void(int)> reader, link_stats &stats)
+    {
+        beehive_config config;
+        auto timers = std::make_shared<timer_wheel>();
+        std::thread timer_thread(&timer_wheel::run, timers);
+        auto reactor = std::make_shared<socket_reactor>();
+        std::thread reactor_thread(&socket_reactor::run, reactor);
+
+        auto a_out = std::make_shared<frame_queue>();
+        auto b_out = std::make_shared<frame_queue>();
+        auto a_in = std::make_shared<segment_queue>();
+        auto b_in = std::make_shared<segment_queue>();
+
+        // [0]: client end, [1]: channel end
+        int a_sockets[2];
+        int b_sockets[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, a_sockets) == -1
+            || socketpair(AF_UNIX, SOCK_STREAM, 0, b_sockets) == -1
+            || !util::try_configure_nonblocking_receive_timeout(a_sockets[1])
+            || !util::try_configure_nonblocking_receive_timeout(b_sockets[1]))
+        {
+            perror("socketpair");
+            exit(EXIT_FAILURE);
+        }
+
+        auto a = std::make_shared<reliable_channel>(config, timers, reactor,
+            connection_tuple(0xb, 1, 0xa, 49152), a_sockets[1], a_out, a_in);
+        auto b = std::make_shared<reliable_channel>(config, timers, reactor,
+            connection_tuple(0xa, 49152, 0xb, 1), b_sockets[1], b_out, b_in);
+        a->set_forward_error_correction(fec);
+        b->set_forward_error_correction(fec);
+
+        std::atomic<bool> running(true);
+        lossy_link link(loss_rate);
+        std::thread link_thread(&lossy_link::run, &link, a_out, a_in, b_out, b_in,
+            std::cref(running));
+        std::thread a_thread(&reliable_channel::start, a);
+        std::thread b_thread(&reliable_channel::start, b);
+        shutdown(b_sockets[0], SHUT_WR);
+
+        auto start = std::chrono::steady_clock::now();
+        std::thread writer_thread([&writer, &a_sockets, &a] {
+            writer(a_sockets[0]);
+            a->request_channel_close();
+        });
+
+        reader(b_sockets[0]);
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        writer_thread.join();
+        a_thread.join();
+        b_thread.join();
+        running = false;
+        link_thread.join();
+        timers->stop();
+        timer_thread.join();
+        reactor->stop();
+        reactor_thread.join();
+
+        for (int fd : {a_sockets[0], a_sockets[1], b_sockets[0], b_sockets[1]})
+        {
+            close(fd);
+        }
+
+        stats = link.get_stats();
+        return elapsed;
+    }
+
+    // reads exactly length bytes, exits if the stream ends early
+    void receive(int fd, uint8_t *buffer, size_t length)
+    {
+        size_t received = 0;
+        while (received < length)
+        {
+            ssize_t bytes_received = recv(fd, buffer + received, length - received, 0);
+            if (bytes_received <= 0)
+            {
+                fprintf(stderr, "received %zu of %zu bytes\n", received, length);
+                exit(EXIT_FAILURE);
+            }
+
+            received += bytes_received;
+        }
+    }
+
+    void run_bulk(size_t payload_length, double loss_rate, bool fec)
+    {
+        std::vector<uint8_t> payload(payload_length);
+        for (size_t i = 0; i < payload.size(); ++i)
+        {
+            payload[i] = static_cast<uint8_t>(i * 7 + i / 251);
+        }
+
+        std::vector<uint8_t> received(payload.size());
+        link_stats stats;
+        auto elapsed = run(
+            loss_rate, fec, [&payload](int fd) { util::send(fd, payload); },
+            [&received](int fd) { receive(fd, received.data(), received.size()); }, stats);
+
+        if (received != payload)
+        {
+            fprintf(stderr, "payload corrupted\n");
+            exit(EXIT_FAILURE);
+        }
+
+        double seconds = elapsed.count() / 1e6;
+        printf("  bulk     fec %-3s: %7.3f s, goodput %6.1f kbit/s, %5llu frames (%llu lost), "
+               "queue delay mean %6.1f ms, max %6.1f ms\n",
+            fec ? "on" : "off", seconds, payload.size() * 8 / seconds / 1000,
+            static_cast<unsigned long long>(stats.frames),
+            static_cast<unsigned long long>(stats.frames_lost), stats.get_mean_queue_delay_ms(),
+            stats.max_queue_delay.count() / 1000.0);
+    }
+
+    void run_records(double loss_rate, bool fec)
+    {
+        std::vector<std::chrono::steady_clock::time_point> sent(RECORD_COUNT);
+        std::vector<std::chrono::microseconds> latencies;
+        std::mutex sent_lock;
+
+        auto writer = [&sent, &sent_lock](int fd) {
+            auto next = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < RECORD_COUNT; ++i)
+            {
+                std::vector<uint8_t> record(RECORD_LENGTH, static_cast<uint8_t>(i));
+                std::unique_lock<std::mutex> lock(sent_lock);
+                sent[i] = std::chrono::steady_clock::now();
+                lock.unlock();
+
+                util::send(fd, record);
+                next += RECORD_INTERVAL;
+                std::this_thread::sleep_until(next);
+            }
+        };
+
+        auto reader = [&sent, &sent_lock, &latencies](int fd) {
+            std::vector<uint8_t> record(RECORD_LENGTH);
+            for (size_t i = 0; i < RECORD_COUNT; ++i)
+            {
+                receive(fd, record.data(), record.size());
+                auto now = std::chrono::steady_clock::now();
+
+                std::lock_guard<std::mutex> lock(sent_lock);
+                latencies.push_back(
+                    std::chrono::duration_cast<std::chrono::microseconds>(now - sent[i]));
+            }
+        };
+
+        link_stats stats;
+        run(loss_rate, fec, writer, reader, stats);
+
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&latencies](size_t p) {
+            return latencies[std::min(latencies.size() - 1, latencies.size() * p / 100)].count()
+                / 1000.0;
+        };
+
+        printf("  records  fec %-3s: latency p50 %7.1f ms, p90 %7.1f ms, p99 %7.1f ms, max %7.1f "
+               "ms, %5llu frames, queue delay mean %6.1f ms, max %6.1f ms\n",
+            fec ? "on" : "off", percentile(50), percentile(90), percentile(99),
+            latencies.back().count() / 1000.0, static_cast<unsigned long long>(stats.frames),
+            stats.get_mean_queue_delay_ms(), stats.max_queue_delay.count() / 1000.0);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t payload_length = fec_bench::DEFAULT_PAYLOAD_LENGTH;
+    if (argc > 1 && !util::try_parse_uint32_t(argv[1], payload_length))
+    {
+        fprintf(stderr, "usage: %s [payload bytes]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("%u byte bulk transfer and %zu %zu byte records every %lld ms over a %.0f kbit/s half "
+           "duplex link\n",
+        payload_length, fec_bench::RECORD_COUNT, fec_bench::RECORD_LENGTH,
+        static_cast<long long>(fec_bench::RECORD_INTERVAL.count()),
+        fec_bench::LINK_BITS_PER_SECOND / 1000);
+
+    for (double loss_rate : fec_bench::LOSS_RATES)
+    {
+        printf("loss %.0f%%\n", loss_rate * 100);
+        for (bool fec : {false, true})
+        {
+            fec_bench::run_bulk(payload_length, loss_rate, fec);
+        }
+
+        for (bool fec : {false, true})
+        {
+            fec_bench::run_records(loss_rate, fec);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
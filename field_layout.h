@@ -0,0 +1,106 @@
+#ifndef FIELD_LAYOUT_H
+#define FIELD_LAYOUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "util.h"
+
+// fixed size field of a wire format: a T stored MSB first, Offset bytes into a frame
+//  - read() and write() are a single memcpy and a byte swap, see util::swap_big_endian()
+//  - note: unchecked on their own, the frame is checked once against the field_layout the field is
+//  part of
+template <typename T, size_t Offset>
+struct field
+{
+    typedef T value_type;
+
+    static constexpr size_t OFFSET = Offset;
+    static constexpr size_t END = Offset + sizeof(T);
+
+    static T read(const uint8_t *frame)
+    {
+        return util::unpack_bytes_to_width<T>(frame + OFFSET);
+    }
+
+    static void write(uint8_t *frame, T value)
+    {
+        util::pack_value_as_bytes(frame + OFFSET, value);
+    }
+};
+
+template <typename T, size_t Offset>
+constexpr size_t field<T, Offset>::OFFSET;
+template <typename T, size_t Offset>
+constexpr size_t field<T, Offset>::END;
+
+// field of type T right after Previous
+template <typename Previous, typename T>
+using next_field = field<T, Previous::END>;
+
+// whether Fields are laid out back to back from Offset on, END is where the last one ends
+template <size_t Offset, typename... Fields>
+struct contiguous_fields
+{
+    static constexpr bool value = true;
+    static constexpr size_t END = Offset;
+};
+
+template <size_t Offset, typename Field, typename... Fields>
+struct contiguous_fields<Offset, Field, Fields...>
+{
+    static constexpr bool value
+        = Field::OFFSET == Offset && contiguous_fields<Field::END, Fields...>::value;
+    static constexpr size_t END = contiguous_fields<Field::END, Fields...>::END;
+};
+
+// whether Field is one of Fields
+template <typename Field, typename... Fields>
+struct contains_field : std::false_type
+{
+};
+
+template <typename Field, typename First, typename... Fields>
+struct contains_field<Field, First, Fields...>
+    : std::integral_constant<bool,
+          std::is_same<Field, First>::value || contains_field<Field, Fields...>::value>
+{
+};
+
+// fixed part of a frame (e.g. everything in front of the rf data), Fields have to follow each other
+// from offset 0 on without gaps
+//  - fits() is the one bounds check a frame needs, past it every field of the layout can be read
+//  - reading or writing a field that isn't part of the layout doesn't compile
+template <typename... Fields>
+struct field_layout
+{
+    static_assert(contiguous_fields<0, Fields...>::value,
+        "fields have to follow each other from offset 0 on");
+
+    static constexpr size_t LENGTH = contiguous_fields<0, Fields...>::END;
+
+    static bool fits(size_t frame_length)
+    {
+        return frame_length >= LENGTH;
+    }
+
+    template <typename Field>
+    static typename Field::value_type read(const uint8_t *frame)
+    {
+        static_assert(contains_field<Field, Fields...>::value, "field isn't part of the layout");
+        return Field::read(frame);
+    }
+
+    template <typename Field>
+    static void write(uint8_t *frame, typename Field::value_type value)
+    {
+        static_assert(contains_field<Field, Fields...>::value, "field isn't part of the layout");
+        Field::write(frame, value);
+    }
+};
+
+template <typename... Fields>
+constexpr size_t field_layout<Fields...>::LENGTH;
+
+#endif
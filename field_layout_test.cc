@@ -0,0 +1,53 @@
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "field_layout.h"
+
+namespace field_layout_test
+{
+    typedef field<uint8_t, 0> type_field;
+    typedef next_field<type_field, uint64_t> address_field;
+    typedef next_field<address_field, uint16_t> port_field;
+    typedef field_layout<type_field, address_field, port_field> layout;
+
+    TEST(FieldLayoutTest, ConstValuesSpec)
+    {
+        ASSERT_EQ(0, type_field::OFFSET);
+        ASSERT_EQ(1, type_field::END);
+        ASSERT_EQ(1, address_field::OFFSET);
+        ASSERT_EQ(9, address_field::END);
+        ASSERT_EQ(9, port_field::OFFSET);
+        ASSERT_EQ(11, port_field::END);
+        ASSERT_EQ(11, layout::LENGTH);
+    }
+
+    TEST(FieldLayoutTest, FitsTest)
+    {
+        ASSERT_FALSE(layout::fits(0));
+        ASSERT_FALSE(layout::fits(layout::LENGTH - 1));
+        ASSERT_TRUE(layout::fits(layout::LENGTH));
+        ASSERT_TRUE(layout::fits(layout::LENGTH + 1));
+    }
+
+    TEST(FieldLayoutTest, ReadTest)
+    {
+        std::vector<uint8_t> frame{
+            0x7e, 0x00, 0x13, 0xa2, 0x00, 0x40, 0xa1, 0xb2, 0xc3, 0x12, 0x34, 0xff};
+        ASSERT_EQ(0x7e, layout::read<type_field>(frame.data()));
+        ASSERT_EQ(0x0013a20040a1b2c3, layout::read<address_field>(frame.data()));
+        ASSERT_EQ(0x1234, layout::read<port_field>(frame.data()));
+    }
+
+    TEST(FieldLayoutTest, WriteTest)
+    {
+        std::vector<uint8_t> frame(layout::LENGTH + 1, 0xff);
+        layout::write<type_field>(frame.data(), 0x7e);
+        layout::write<address_field>(frame.data(), 0x0013a20040a1b2c3);
+        layout::write<port_field>(frame.data(), 0x1234);
+        ASSERT_EQ(std::vector<uint8_t>({0x7e, 0x00, 0x13, 0xa2, 0x00, 0x40, 0xa1, 0xb2, 0xc3, 0x12,
+                      0x34, 0xff}),
+            frame);
+    }
+}
@@ -0,0 +1,120 @@
+#include "frame_buffer.h"
+
+#include "uart_frame.h"
+
+const size_t frame_buffer::CAPACITY = uart_frame::MAX_FRAME_SIZE;
+// 3 byte uart header, 11 byte tx_request_64 header (checked in frame_buffer_test), spelled out as
+// tx_request_64_frame::RF_DATA_OFFSET isn't guaranteed to be initialized before this is
+const size_t frame_buffer::HEADROOM = 14;
+
+frame_buffer::frame_buffer()
+    : storage(CAPACITY), front(HEADROOM), back(HEADROOM), queued_time(0)
+{
+}
+
+void frame_buffer::clear()
+{
+    clear(HEADROOM);
+}
+
+void frame_buffer::clear(size_t headroom)
+{
+    front = std::min(headroom, storage.size());
+    back = front;
+    queued_time = 0;
+}
+
+uint8_t *frame_buffer::prepend(size_t length)
+{
+    if (length > front)
+    {
+        return nullptr;
+    }
+
+    front -= length;
+    return storage.data() + front;
+}
+
+uint8_t *frame_buffer::append(size_t length)
+{
+    if (length > get_tailroom())
+    {
+        return nullptr;
+    }
+
+    back += length;
+    return storage.data() + back - length;
+}
+
+bool frame_buffer::append(const uint8_t *data, size_t length)
+{
+    uint8_t *destination = append(length);
+    if (destination == nullptr)
+    {
+        return false;
+    }
+
+    std::copy(data, data + length, destination);
+    return true;
+}
+
+bool frame_buffer::resize(size_t length)
+{
+    if (length > storage.size() - front)
+    {
+        return false;
+    }
+
+    back = front + length;
+    return true;
+}
+
+const uint8_t *frame_buffer::data() const
+{
+    return storage.data() + front;
+}
+
+const uint8_t *frame_buffer::begin() const
+{
+    return data();
+}
+
+const uint8_t *frame_buffer::end() const
+{
+    return storage.data() + back;
+}
+
+std::vector<uint8_t>::const_iterator frame_buffer::cbegin() const
+{
+    return storage.cbegin() + front;
+}
+
+std::vector<uint8_t>::const_iterator frame_buffer::cend() const
+{
+    return storage.cbegin() + back;
+}
+
+size_t frame_buffer::size() const
+{
+    return back - front;
+}
+
+size_t frame_buffer::get_headroom() const
+{
+    return front;
+}
+
+size_t frame_buffer::get_tailroom() const
+{
+    return storage.size() - back;
+}
+
+void frame_buffer::set_queued_time(std::chrono::steady_clock::time_point time)
+{
+    queued_time = time.time_since_epoch().count();
+}
+
+std::chrono::steady_clock::time_point frame_buffer::get_queued_time() const
+{
+    return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(queued_time));
+}
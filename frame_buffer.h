@@ -0,0 +1,58 @@
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// byte buffer for a uart frame, content of an outgoing one starts HEADROOM bytes in so a segment
+// can be written once and the tx_request and uart headers prepended in place around it afterwards
+//  - fixed capacity: a frame never grows past uart_frame::MAX_FRAME_SIZE, storage is allocated once
+//  and reused when the buffer is recycled by frame_buffer_pool
+//  - received frames are read in with no headroom and parsed in place, see rx_packet_64_view
+//  - note: a queued frame is never modified, it may be written again for a retransmission
+class frame_buffer
+{
+public:
+    static const size_t CAPACITY;
+    static const size_t HEADROOM;    // uart_frame header + tx_request_64_frame header
+
+    frame_buffer();
+
+    // drops the content, the next byte appended goes HEADROOM bytes in
+    void clear();
+    void clear(size_t headroom);
+    // both return where the length new bytes go, nullptr (buffer left as is) if they don't fit
+    uint8_t *prepend(size_t length);
+    uint8_t *append(size_t length);
+    bool append(const uint8_t *data, size_t length);
+    // grows or shrinks the content at the back (new bytes are left as they are), false if it
+    // doesn't fit, e.g. to trim a buffer appended to for a read to the bytes that were read
+    bool resize(size_t length);
+
+    const uint8_t *data() const;
+    const uint8_t *begin() const;
+    const uint8_t *end() const;
+    // same range as begin() and end(), for parsing with the functions that take vector iterators
+    std::vector<uint8_t>::const_iterator cbegin() const;
+    std::vector<uint8_t>::const_iterator cend() const;
+    size_t size() const;
+    size_t get_headroom() const;
+    size_t get_tailroom() const;
+    // when the frame was last queued for transmission, lets the writer of the frame queue measure
+    // how long frames wait for the endpoint, time_point() if it wasn't queued since clear()
+    //  - note: a retransmission may queue the frame again while it's still being written
+    void set_queued_time(std::chrono::steady_clock::time_point time);
+    std::chrono::steady_clock::time_point get_queued_time() const;
+
+private:
+    std::vector<uint8_t> storage;
+    size_t front;    // offset of the first byte of content
+    size_t back;    // offset one past the last byte of content
+    std::atomic<std::chrono::steady_clock::rep> queued_time;    // ticks since the clock's epoch
+};
+
+#endif
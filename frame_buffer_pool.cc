@@ -0,0 +1,59 @@
+#include "frame_buffer_pool.h"
+
+const size_t frame_buffer_pool::MAX_IDLE_BUFFERS = 256;
+
+frame_buffer_pool &frame_buffer_pool::get_default()
+{
+    static frame_buffer_pool pool;
+    return pool;
+}
+
+frame_buffer_pool::frame_buffer_pool()
+    : idle(std::make_shared<idle_list>())
+{
+}
+
+std::shared_ptr<frame_buffer> frame_buffer_pool::acquire()
+{
+    unique_buffer buffer = acquire_unique();
+    recycler deleter = buffer.get_deleter();
+    return std::shared_ptr<frame_buffer>(
+        buffer.release(), std::move(deleter), pool_allocator<frame_buffer>());
+}
+
+frame_buffer_pool::unique_buffer frame_buffer_pool::acquire_unique()
+{
+    std::unique_ptr<frame_buffer> buffer;
+    {
+        std::lock_guard<std::mutex> lock(idle->access_lock);
+        if (!idle->buffers.empty())
+        {
+            buffer = std::move(idle->buffers.back());
+            idle->buffers.pop_back();
+        }
+    }
+
+    if (buffer == nullptr)
+    {
+        buffer.reset(new frame_buffer());
+    }
+
+    buffer->clear();
+    return unique_buffer(buffer.release(), recycler{idle});
+}
+
+size_t frame_buffer_pool::get_idle_count() const
+{
+    std::lock_guard<std::mutex> lock(idle->access_lock);
+    return idle->buffers.size();
+}
+
+void frame_buffer_pool::recycler::operator()(frame_buffer *buffer) const
+{
+    std::unique_ptr<frame_buffer> owner(buffer);
+    std::lock_guard<std::mutex> lock(idle->access_lock);
+    if (idle->buffers.size() < MAX_IDLE_BUFFERS)
+    {
+        idle->buffers.push_back(std::move(owner));
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef FRAME_BUFFER_POOL_H
+#define FRAME_BUFFER_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "frame_buffer.h"
+#include "pool_allocator.h"
+
+// recycles frame_buffers: acquire() hands out an empty buffer which goes back to the pool once
+// the last shared_ptr to it is dropped (e.g. once the frame was acked and written for the last time)
+//  - threadsafe, buffers may be released on any thread and may outlive the pool
+//  - keeps at most MAX_IDLE_BUFFERS around, any released beyond that are freed
+//  - shared_ptr control blocks of acquire() come from a block_pool, acquire_unique() does without
+//  one
+class frame_buffer_pool
+{
+private:
+    struct idle_list;
+
+public:
+    // deleter of unique_buffer, hands the buffer back to the pool it came from
+    struct recycler
+    {
+        void operator()(frame_buffer *buffer) const;
+
+        std::shared_ptr<idle_list> idle;
+    };
+
+    typedef std::unique_ptr<frame_buffer, recycler> unique_buffer;
+
+    static const size_t MAX_IDLE_BUFFERS;
+
+    // pool shared by every producer of outgoing frames and every endpoint receiving frames
+    static frame_buffer_pool &get_default();
+
+    frame_buffer_pool();
+    frame_buffer_pool(const frame_buffer_pool &) = delete;
+    frame_buffer_pool &operator=(const frame_buffer_pool &) = delete;
+
+    std::shared_ptr<frame_buffer> acquire();
+    // single owner at a time (e.g. a received frame on its way to being parsed), no allocation
+    // once the pool is warmed up
+    unique_buffer acquire_unique();
+    size_t get_idle_count() const;
+
+private:
+    // separate from the pool so buffers released after the pool is gone still have a home
+    struct idle_list
+    {
+        std::mutex access_lock;
+        std::vector<std::unique_ptr<frame_buffer>> buffers;
+    };
+
+    std::shared_ptr<idle_list> idle;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "frame_buffer_pool.h"
+
+namespace frame_buffer_pool_test
+{
+    TEST(FrameBufferPoolTest, ConstValuesSpec)
+    {
+        ASSERT_EQ(256, frame_buffer_pool::MAX_IDLE_BUFFERS);
+    }
+
+    TEST(FrameBufferPoolTest, RecycleTest)
+    {
+        frame_buffer_pool pool;
+        ASSERT_EQ(0, pool.get_idle_count());
+
+        auto buffer = pool.acquire();
+        const frame_buffer *address = buffer.get();
+        buffer->append(10);
+        ASSERT_EQ(0, pool.get_idle_count());
+
+        // a copy (e.g. a retransmission still queued) keeps the buffer out of the pool
+        auto copy = buffer;
+        buffer.reset();
+        ASSERT_EQ(0, pool.get_idle_count());
+        copy.reset();
+        ASSERT_EQ(1, pool.get_idle_count());
+
+        buffer = pool.acquire();
+        ASSERT_EQ(address, buffer.get());
+        ASSERT_EQ(0, buffer->size());
+        ASSERT_EQ(0, pool.get_idle_count());
+    }
+
+    TEST(FrameBufferPoolTest, AcquireUniqueTest)
+    {
+        frame_buffer_pool pool;
+        auto buffer = pool.acquire_unique();
+        const frame_buffer *address = buffer.get();
+        buffer->append(10);
+
+        // moving it along (e.g. through a queue) doesn't release it
+        auto moved = std::move(buffer);
+        ASSERT_EQ(0, pool.get_idle_count());
+        moved.reset();
+        ASSERT_EQ(1, pool.get_idle_count());
+
+        // both flavours draw from the same idle buffers
+        auto shared = pool.acquire();
+        ASSERT_EQ(address, shared.get());
+        ASSERT_EQ(0, shared->size());
+    }
+
+    TEST(FrameBufferPoolTest, MaxIdleTest)
+    {
+        frame_buffer_pool pool;
+        {
+            std::vector<std::shared_ptr<frame_buffer>> buffers;
+            for (size_t i = 0; i < frame_buffer_pool::MAX_IDLE_BUFFERS + 1; ++i)
+            {
+                buffers.push_back(pool.acquire());
+            }
+        }
+
+        ASSERT_EQ(frame_buffer_pool::MAX_IDLE_BUFFERS, pool.get_idle_count());
+    }
+
+    TEST(FrameBufferPoolTest, OutlivePoolTest)
+    {
+        std::shared_ptr<frame_buffer> buffer;
+        {
+            frame_buffer_pool pool;
+            buffer = pool.acquire();
+        }
+
+        buffer->append(1);
+        buffer.reset();
+    }
+}
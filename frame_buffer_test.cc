@@ -0,0 +1,113 @@
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "frame_buffer.h"
+#include "tx_request_64_frame.h"
+#include "uart_frame.h"
+
+namespace frame_buffer_test
+{
+    TEST(FrameBufferTest, ConstValuesSpec)
+    {
+        ASSERT_EQ(uart_frame::MAX_FRAME_SIZE, frame_buffer::CAPACITY);
+        ASSERT_EQ(uart_frame::HEADER_LENGTH + tx_request_64_frame::RF_DATA_OFFSET,
+            frame_buffer::HEADROOM);
+    }
+
+    TEST(FrameBufferTest, EmptyTest)
+    {
+        frame_buffer buffer;
+        ASSERT_EQ(0, buffer.size());
+        ASSERT_EQ(frame_buffer::HEADROOM, buffer.get_headroom());
+        ASSERT_EQ(frame_buffer::CAPACITY - frame_buffer::HEADROOM, buffer.get_tailroom());
+        ASSERT_EQ(buffer.begin(), buffer.end());
+    }
+
+    TEST(FrameBufferTest, PrependAppendTest)
+    {
+        frame_buffer buffer;
+        std::vector<uint8_t> payload{'a', 'b', 'c'};
+        ASSERT_TRUE(buffer.append(payload.data(), payload.size()));
+
+        uint8_t *header = buffer.prepend(2);
+        ASSERT_NE(nullptr, header);
+        header[0] = 'x';
+        header[1] = 'y';
+        *buffer.append(1) = 'z';
+
+        ASSERT_EQ(std::vector<uint8_t>({'x', 'y', 'a', 'b', 'c', 'z'}),
+            std::vector<uint8_t>(buffer.begin(), buffer.end()));
+        ASSERT_EQ(buffer.data(), buffer.begin());
+        ASSERT_EQ(frame_buffer::HEADROOM - 2, buffer.get_headroom());
+    }
+
+    TEST(FrameBufferTest, OutOfRoomTest)
+    {
+        frame_buffer buffer;
+        ASSERT_EQ(nullptr, buffer.prepend(frame_buffer::HEADROOM + 1));
+        ASSERT_NE(nullptr, buffer.prepend(frame_buffer::HEADROOM));
+        ASSERT_EQ(nullptr, buffer.prepend(1));
+
+        std::vector<uint8_t> payload(buffer.get_tailroom() + 1, 'a');
+        ASSERT_FALSE(buffer.append(payload.data(), payload.size()));
+        ASSERT_EQ(frame_buffer::HEADROOM, buffer.size());
+        ASSERT_TRUE(buffer.append(payload.data(), payload.size() - 1));
+        ASSERT_EQ(frame_buffer::CAPACITY, buffer.size());
+    }
+
+    TEST(FrameBufferTest, ClearTest)
+    {
+        frame_buffer buffer;
+        buffer.prepend(3);
+        buffer.append(5);
+        buffer.clear();
+        ASSERT_EQ(0, buffer.size());
+        ASSERT_EQ(frame_buffer::HEADROOM, buffer.get_headroom());
+    }
+
+    TEST(FrameBufferTest, ClearHeadroomTest)
+    {
+        frame_buffer buffer;
+        buffer.clear(0);
+        ASSERT_EQ(0, buffer.get_headroom());
+        ASSERT_EQ(frame_buffer::CAPACITY, buffer.get_tailroom());
+
+        buffer.clear(frame_buffer::CAPACITY + 1);
+        ASSERT_EQ(0, buffer.get_tailroom());
+    }
+
+    TEST(FrameBufferTest, ResizeTest)
+    {
+        frame_buffer buffer;
+        buffer.clear(0);
+        uint8_t *destination = buffer.append(buffer.get_tailroom());
+        destination[0] = 'a';
+        destination[1] = 'b';
+
+        // e.g. trimmed to what a read returned
+        ASSERT_TRUE(buffer.resize(2));
+        ASSERT_EQ(std::vector<uint8_t>({'a', 'b'}),
+            std::vector<uint8_t>(buffer.cbegin(), buffer.cend()));
+        ASSERT_EQ(buffer.begin(), &*buffer.cbegin());
+        ASSERT_FALSE(buffer.resize(frame_buffer::CAPACITY + 1));
+        ASSERT_EQ(2, buffer.size());
+        ASSERT_TRUE(buffer.resize(frame_buffer::CAPACITY));
+    }
+
+    // a pooled buffer is cleared before reuse, the time it was last queued doesn't carry over
+    TEST(FrameBufferTest, QueuedTimeTest)
+    {
+        frame_buffer buffer;
+        ASSERT_EQ(std::chrono::steady_clock::time_point(), buffer.get_queued_time());
+
+        auto now = std::chrono::steady_clock::now();
+        buffer.set_queued_time(now);
+        ASSERT_EQ(now, buffer.get_queued_time());
+
+        buffer.clear();
+        ASSERT_EQ(std::chrono::steady_clock::time_point(), buffer.get_queued_time());
+    }
+}
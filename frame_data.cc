@@ -1,7 +1,7 @@
 #include "frame_data.h"
 
 const uint8_t frame_data::FRAME_ID_DISABLE_RESPONSE_FRAME = 0;
-const size_t frame_data::API_IDENTIFIER_OFFSET = 0;
+const size_t frame_data::API_IDENTIFIER_OFFSET = api_identifier_field::OFFSET;
 uint8_t frame_data::next_frame_id = 1;
 std::mutex frame_data::frame_id_lock;
 
@@ -10,6 +10,12 @@ frame_data::frame_data(uint8_t api_identifier_value)
 {
 }
 
+void frame_data::write_to(inline_buffer &buffer) const
+{
+    auto frame = static_cast<std::vector<uint8_t>>(*this);
+    buffer.append(frame.cbegin(), frame.cend());
+}
+
 uint8_t frame_data::get_next_frame_id()
 {
     std::lock_guard<std::mutex> lock(frame_id_lock);
@@ -5,6 +5,9 @@
 #include <mutex>
 #include <vector>
 
+#include "field_layout.h"
+#include "inline_buffer.h"
+
 // TODO: rename this class to indicate that it's an interface?
 // TODO: derived classes should throw exception if payload > 100bytes
 // TODO: create typedefs for common fields? i.e. api_identifier_t, frame_id_t, etc ?
@@ -16,6 +19,9 @@ public:
     static const uint8_t FRAME_ID_DISABLE_RESPONSE_FRAME;
     static const size_t API_IDENTIFIER_OFFSET;
 
+    // leading field of every frame, frame types lay out their fields after it
+    typedef field<uint8_t, 0> api_identifier_field;
+
     const uint8_t api_identifier_value;
 
     enum api_identifier : uint8_t
@@ -30,6 +36,10 @@ public:
     static uint8_t get_next_frame_id();
 
     virtual operator std::vector<uint8_t>() const = 0;
+    // appends the same bytes as the vector conversion to buffer, see uart_frame::encode()
+    //  - note: goes through the vector conversion unless overridden, frames on the data path
+    //  serialize straight into buffer
+    virtual void write_to(inline_buffer &buffer) const;
 
 protected:
     frame_data(uint8_t api_identifier_value);
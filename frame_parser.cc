@@ -0,0 +1,234 @@
+#include "frame_parser.h"
+
+const size_t frame_parser::CAPACITY = 512;
+
+frame_parser::frame_parser()
+    : frame_parser(false)
+{
+}
+
+frame_parser::frame_parser(bool escaped)
+    : ring(CAPACITY), head(0), count(0), escaped(escaped), escape_pending(false), head_position(0),
+      bytes_discarded(0), invalid_frames(0)
+{
+}
+
+size_t frame_parser::feed(const uint8_t *data, size_t length)
+{
+    if (escaped)
+    {
+        return feed_escaped(data, length);
+    }
+
+    size_t accepted = std::min(length, get_free_space());
+    push(data, accepted);
+    return accepted;
+}
+
+std::shared_ptr<uart_frame> frame_parser::next_frame()
+{
+    frame_buffer frame;
+    while (next_frame(frame))
+    {
+        auto parsed_frame = uart_frame::parse_frame(frame.cbegin(), frame.cend());
+        if (parsed_frame != nullptr)
+        {
+            return parsed_frame;
+        }
+
+        ++invalid_frames;
+    }
+
+    return nullptr;
+}
+
+bool frame_parser::next_frame(frame_buffer &frame)
+{
+    while (count > 0)
+    {
+        if (!is_delimiter(uart_frame::FRAME_DELIMITER_OFFSET))
+        {
+            size_t skipped = find_delimiter(1);
+            discard(skipped);
+            bytes_discarded += skipped;
+            continue;
+        }
+
+        if (count < uart_frame::HEADER_LENGTH)
+        {
+            return false;
+        }
+
+        size_t frame_length = uart_frame::HEADER_LENGTH
+            + (at(uart_frame::LENGTH_MSB_OFFSET) << 8 | at(uart_frame::LENGTH_LSB_OFFSET))
+            + sizeof(uint8_t);    // checksum
+        if (frame_length < uart_frame::MIN_FRAME_SIZE || frame_length > uart_frame::MAX_FRAME_SIZE)
+        {
+            discard(1);
+            ++invalid_frames;
+            continue;
+        }
+
+        // note: in API mode 1 a delimiter byte can be part of a frame, only escaped streams tell
+        size_t next_delimiter = escaped ? find_delimiter(1) : count;
+        if (next_delimiter < std::min(frame_length, count))
+        {
+            discard(next_delimiter);
+            ++invalid_frames;
+            continue;
+        }
+
+        if (count < frame_length)
+        {
+            return false;
+        }
+
+        // the ring may wrap around in the middle of the frame
+        frame.clear(0);
+        uint8_t *destination = frame.append(frame_length);
+        size_t first_part = std::min(frame_length, ring.size() - head);
+        std::copy(ring.begin() + head, ring.begin() + head + first_part, destination);
+        std::copy(
+            ring.begin(), ring.begin() + (frame_length - first_part), destination + first_part);
+
+        // ignore frame header and trailing checksum
+        uint8_t calculated_checksum = uart_frame::compute_checksum(
+            frame.cbegin() + uart_frame::HEADER_LENGTH, frame.cend() - 1);
+        if (calculated_checksum != *(frame.cend() - 1))
+        {
+            discard(1);
+            ++invalid_frames;
+            continue;
+        }
+
+        discard(frame_length);
+        return true;
+    }
+
+    return false;
+}
+
+void frame_parser::clear()
+{
+    head_position += count;
+    head = 0;
+    count = 0;
+    escape_pending = false;
+    delimiters.clear();
+}
+
+size_t frame_parser::size() const
+{
+    return count;
+}
+
+size_t frame_parser::get_free_space() const
+{
+    return ring.size() - count;
+}
+
+uint64_t frame_parser::get_bytes_discarded() const
+{
+    return bytes_discarded;
+}
+
+uint64_t frame_parser::get_invalid_frames() const
+{
+    return invalid_frames;
+}
+
+// unescapes while feeding, a run of plain bytes is copied up to the next special byte in one go
+size_t frame_parser::feed_escaped(const uint8_t *data, size_t length)
+{
+    size_t position = 0;
+
+    while (position < length && get_free_space() > 0)
+    {
+        uint8_t byte = data[position];
+        if (byte == uart_frame::FRAME_DELIMITER)
+        {
+            // a delimiter always starts a new frame, even right after an ESCAPE
+            escape_pending = false;
+            delimiters.push_back(head_position + count);
+            push(&byte, 1);
+            ++position;
+        }
+        else if (escape_pending)
+        {
+            escape_pending = false;
+            byte ^= uart_frame::XOR_CONST;
+            push(&byte, 1);
+            ++position;
+        }
+        else if (byte == uart_frame::ESCAPE)
+        {
+            escape_pending = true;
+            ++position;
+        }
+        else
+        {
+            // note: XON/XOFF shouldn't show up unescaped, if they do they are kept as is
+            size_t run = std::min(get_free_space(),
+                1 + codec.find_special(data + position + 1, data + length));
+            push(data + position, run);
+            position += run;
+        }
+    }
+
+    return position;
+}
+
+void frame_parser::push(const uint8_t *data, size_t length)
+{
+    size_t tail = (head + count) % ring.size();
+    size_t first_part = std::min(length, ring.size() - tail);
+    std::copy(data, data + first_part, ring.begin() + tail);
+    std::copy(data + first_part, data + length, ring.begin());
+    count += length;
+}
+
+uint8_t frame_parser::at(size_t offset) const
+{
+    return ring[(head + offset) % ring.size()];
+}
+
+bool frame_parser::is_delimiter(size_t offset) const
+{
+    return find_delimiter(offset) == offset;
+}
+
+size_t frame_parser::find_delimiter(size_t offset) const
+{
+    if (escaped)
+    {
+        // note: delimiters before head are dropped by discard()
+        for (auto position : delimiters)
+        {
+            if (position >= head_position + offset)
+            {
+                return static_cast<size_t>(position - head_position);
+            }
+        }
+
+        return count;
+    }
+
+    while (offset < count && at(offset) != uart_frame::FRAME_DELIMITER)
+    {
+        ++offset;
+    }
+
+    return std::min(offset, count);
+}
+
+void frame_parser::discard(size_t length)
+{
+    head = (head + length) % ring.size();
+    count -= length;
+    head_position += length;
+
+    while (!delimiters.empty() && delimiters.front() < head_position)
+    {
+        delimiters.pop_front();
+    }
+}
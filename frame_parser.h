@@ -0,0 +1,69 @@
+#ifndef FRAME_PARSER_H
+#define FRAME_PARSER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "escape_codec.h"
+#include "frame_buffer.h"
+#include "uart_frame.h"
+
+// incremental uart frame parser for a byte stream read off the serial line in arbitrary chunks,
+// bytes are fed into a fixed capacity ring and complete frames are taken out as soon as their last
+// byte arrived
+//  - resynchronizes on the frame delimiter: bytes before a delimiter are discarded, as is a
+//  delimiter followed by an impossible length or a frame failing its checksum (the search for the
+//  next frame starts at the byte after it)
+//  - a frame that is still incomplete is kept until the rest of it is fed
+//  - escaped (API mode 2): bytes are unescaped as they are fed and the ring only ever holds
+//  unescaped bytes, the stream positions of unescaped delimiters are kept on the side since only
+//  those can start a frame, a frame cut short by one is discarded
+//  - note: not threadsafe, owner is expected to serialize access
+class frame_parser
+{
+public:
+    static const size_t CAPACITY;
+
+    frame_parser();
+    explicit frame_parser(bool escaped);
+
+    // returns how many bytes were taken, less than length only once the ring is full
+    size_t feed(const uint8_t *data, size_t length);
+    // nullptr if no complete frame is buffered
+    std::shared_ptr<uart_frame> next_frame();
+    // copies the next complete frame into frame (replacing its content, no headroom) without
+    // parsing it, false if there is none
+    bool next_frame(frame_buffer &frame);
+    void clear();
+
+    size_t size() const;
+    size_t get_free_space() const;
+    uint64_t get_bytes_discarded() const;
+    uint64_t get_invalid_frames() const;
+
+private:
+    size_t feed_escaped(const uint8_t *data, size_t length);
+    void push(const uint8_t *data, size_t length);
+    uint8_t at(size_t offset) const;
+    bool is_delimiter(size_t offset) const;
+    // offset of the first delimiter at or after offset, count if there is none
+    size_t find_delimiter(size_t offset) const;
+    void discard(size_t count);
+
+    std::vector<uint8_t> ring;
+    size_t head;
+    size_t count;
+    bool escaped;
+    bool escape_pending;    // last byte fed was an ESCAPE
+    uint64_t head_position;    // stream position of the byte at head
+    std::deque<uint64_t> delimiters;    // stream positions of unescaped delimiters, escaped only
+    escape_codec codec;
+    uint64_t bytes_discarded;    // not counting bytes of discarded frames
+    uint64_t invalid_frames;
+};
+
+#endif
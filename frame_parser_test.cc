@@ -0,0 +1,210 @@
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "frame_buffer.h"
+#include "frame_parser.h"
+#include "tx_request_64_frame.h"
+#include "uart_frame.h"
+
+namespace frame_parser_test
+{
+    std::vector<uint8_t> get_any_frame(uint8_t payload_byte)
+    {
+        return uart_frame(std::make_shared<tx_request_64_frame>(
+            0x0013a20040a1b2c3, std::vector<uint8_t>{payload_byte, 'b', 'c'}));
+    }
+
+    size_t feed(frame_parser &parser, const std::vector<uint8_t> &bytes)
+    {
+        return parser.feed(bytes.data(), bytes.size());
+    }
+
+    std::vector<uint8_t> get_rf_data(std::shared_ptr<uart_frame> frame)
+    {
+        return std::static_pointer_cast<tx_request_64_frame>(frame->get_data())->get_rf_data();
+    }
+
+    TEST(FrameParserTest, ConstValuesSpec)
+    {
+        ASSERT_EQ(512, frame_parser::CAPACITY);
+    }
+
+    TEST(FrameParserTest, SingleFrameTest)
+    {
+        frame_parser parser;
+        ASSERT_EQ(nullptr, parser.next_frame());
+
+        auto frame = get_any_frame('a');
+        ASSERT_EQ(frame.size(), feed(parser, frame));
+        auto parsed_frame = parser.next_frame();
+        ASSERT_NE(nullptr, parsed_frame);
+        ASSERT_EQ(std::vector<uint8_t>({'a', 'b', 'c'}), get_rf_data(parsed_frame));
+        ASSERT_EQ(0, parser.size());
+        ASSERT_EQ(nullptr, parser.next_frame());
+    }
+
+    TEST(FrameParserTest, IncrementalTest)
+    {
+        frame_parser parser;
+        auto frame = get_any_frame('a');
+
+        // one byte at a time, the frame is only complete once its checksum arrived
+        for (size_t i = 0; i < frame.size() - 1; ++i)
+        {
+            parser.feed(&frame[i], 1);
+            ASSERT_EQ(nullptr, parser.next_frame());
+        }
+
+        parser.feed(&frame.back(), 1);
+        ASSERT_NE(nullptr, parser.next_frame());
+    }
+
+    TEST(FrameParserTest, MultipleFramesTest)
+    {
+        frame_parser parser;
+        auto first = get_any_frame('a');
+        auto second = get_any_frame('z');
+        std::vector<uint8_t> bytes(first);
+        bytes.insert(bytes.end(), second.begin(), second.end());
+        bytes.insert(bytes.end(), second.begin(), second.begin() + 5);
+        feed(parser, bytes);
+
+        ASSERT_EQ('a', get_rf_data(parser.next_frame())[0]);
+        ASSERT_EQ('z', get_rf_data(parser.next_frame())[0]);
+        ASSERT_EQ(nullptr, parser.next_frame());
+        ASSERT_EQ(5, parser.size());
+    }
+
+    TEST(FrameParserTest, ResynchronizeTest)
+    {
+        frame_parser parser;
+        auto frame = get_any_frame('a');
+        feed(parser, {0x00, 0x11, 0x22});
+        feed(parser, frame);
+
+        ASSERT_NE(nullptr, parser.next_frame());
+        ASSERT_EQ(3, parser.get_bytes_discarded());
+        ASSERT_EQ(0, parser.get_invalid_frames());
+    }
+
+    TEST(FrameParserTest, InvalidLengthTest)
+    {
+        frame_parser parser;
+        auto frame = get_any_frame('a');
+
+        // stray delimiter followed by a length no frame can have
+        feed(parser, {uart_frame::FRAME_DELIMITER, 0xff, 0xff});
+        feed(parser, frame);
+
+        ASSERT_NE(nullptr, parser.next_frame());
+        ASSERT_EQ(1, parser.get_invalid_frames());
+    }
+
+    TEST(FrameParserTest, InvalidChecksumTest)
+    {
+        frame_parser parser;
+        auto corrupt = get_any_frame('a');
+        ++corrupt[corrupt.size() - 2];
+        feed(parser, corrupt);
+        feed(parser, get_any_frame('z'));
+
+        auto parsed_frame = parser.next_frame();
+        ASSERT_NE(nullptr, parsed_frame);
+        ASSERT_EQ('z', get_rf_data(parsed_frame)[0]);
+        ASSERT_EQ(1, parser.get_invalid_frames());
+        ASSERT_EQ(0, parser.size());
+    }
+
+    TEST(FrameParserTest, FullTest)
+    {
+        frame_parser parser;
+        std::vector<uint8_t> bytes(frame_parser::CAPACITY + 1, 0x00);
+        ASSERT_EQ(frame_parser::CAPACITY, feed(parser, bytes));
+        ASSERT_EQ(0, parser.get_free_space());
+
+        ASSERT_EQ(nullptr, parser.next_frame());
+        ASSERT_EQ(frame_parser::CAPACITY, parser.get_free_space());
+    }
+
+    TEST(FrameParserTest, WraparoundTest)
+    {
+        frame_parser parser;
+        std::vector<uint8_t> bytes(frame_parser::CAPACITY - 5, 0x00);
+        feed(parser, bytes);
+        ASSERT_EQ(nullptr, parser.next_frame());
+
+        auto frame = get_any_frame('a');
+        feed(parser, frame);
+        ASSERT_EQ('a', get_rf_data(parser.next_frame())[0]);
+    }
+
+    TEST(FrameParserTest, NextFrameBufferTest)
+    {
+        frame_parser parser;
+        frame_buffer buffer;
+        ASSERT_FALSE(parser.next_frame(buffer));
+
+        // wraps around the end of the ring, comes out contiguous with no headroom
+        std::vector<uint8_t> bytes(frame_parser::CAPACITY - 5, 0x00);
+        feed(parser, bytes);
+        ASSERT_FALSE(parser.next_frame(buffer));
+        auto frame = get_any_frame('a');
+        feed(parser, frame);
+
+        ASSERT_TRUE(parser.next_frame(buffer));
+        ASSERT_EQ(frame, std::vector<uint8_t>(buffer.cbegin(), buffer.cend()));
+        ASSERT_EQ(0, buffer.get_headroom());
+        ASSERT_FALSE(parser.next_frame(buffer));
+        ASSERT_EQ(0, parser.size());
+    }
+
+    TEST(FrameParserTest, ClearTest)
+    {
+        frame_parser parser;
+        auto frame = get_any_frame('a');
+        parser.feed(frame.data(), 5);
+        parser.clear();
+        ASSERT_EQ(0, parser.size());
+
+        feed(parser, frame);
+        ASSERT_NE(nullptr, parser.next_frame());
+    }
+
+    TEST(FrameParserTest, EscapedFrameTest)
+    {
+        frame_parser parser(true);
+
+        // payload bytes that need escaping, split right after an ESCAPE
+        auto frame = uart_frame::escape_frame(get_any_frame(uart_frame::FRAME_DELIMITER));
+        ASSERT_EQ(uart_frame::ESCAPE, frame[15]);
+        feed(parser, std::vector<uint8_t>(frame.begin(), frame.begin() + 16));
+        ASSERT_EQ(nullptr, parser.next_frame());
+        feed(parser, std::vector<uint8_t>(frame.begin() + 16, frame.end()));
+
+        auto parsed_frame = parser.next_frame();
+        ASSERT_NE(nullptr, parsed_frame);
+        ASSERT_EQ(std::vector<uint8_t>({uart_frame::FRAME_DELIMITER, 'b', 'c'}),
+            get_rf_data(parsed_frame));
+        ASSERT_EQ(0, parser.size());
+        ASSERT_EQ(0, parser.get_invalid_frames());
+    }
+
+    TEST(FrameParserTest, EscapedResynchronizeTest)
+    {
+        frame_parser parser(true);
+        auto frame = uart_frame::escape_frame(get_any_frame('a'));
+
+        // frame cut short by the next one is dropped without waiting for bytes it claims to have
+        auto truncated = std::vector<uint8_t>(frame.begin(), frame.begin() + 8);
+        feed(parser, truncated);
+        feed(parser, frame);
+
+        ASSERT_EQ('a', get_rf_data(parser.next_frame())[0]);
+        ASSERT_EQ(1, parser.get_invalid_frames());
+        ASSERT_EQ(0, parser.get_bytes_discarded());
+        ASSERT_EQ(0, parser.size());
+    }
+}
@@ -0,0 +1,69 @@
+#include "inline_buffer.h"
+
+const size_t inline_buffer::CAPACITY;
+
+inline_buffer::inline_buffer()
+    : length(0)
+{
+}
+
+inline_buffer::inline_buffer(const std::vector<uint8_t> &bytes)
+    : inline_buffer(bytes.cbegin(), bytes.cend())
+{
+}
+
+uint8_t *inline_buffer::append(size_t length)
+{
+    if (length > CAPACITY - this->length)
+    {
+        throw std::length_error("inline_buffer: capacity exceeded");
+    }
+
+    this->length += length;
+    return storage.data() + this->length - length;
+}
+
+void inline_buffer::push_back(uint8_t byte)
+{
+    *append(sizeof(byte)) = byte;
+}
+
+void inline_buffer::clear()
+{
+    length = 0;
+}
+
+size_t inline_buffer::size() const
+{
+    return length;
+}
+
+bool inline_buffer::empty() const
+{
+    return length == 0;
+}
+
+const uint8_t *inline_buffer::data() const
+{
+    return storage.data();
+}
+
+const uint8_t *inline_buffer::begin() const
+{
+    return data();
+}
+
+const uint8_t *inline_buffer::end() const
+{
+    return data() + length;
+}
+
+uint8_t inline_buffer::operator[](size_t index) const
+{
+    return storage[index];
+}
+
+inline_buffer::operator std::vector<uint8_t>() const
+{
+    return std::vector<uint8_t>(begin(), end());
+}
@@ -0,0 +1,69 @@
+#ifndef INLINE_BUFFER_H
+#define INLINE_BUFFER_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+// byte buffer with fixed capacity and inline storage for frame-sized data (rf data, segment
+// payloads, serialized frames), an object holding one takes a single allocation or lives on the
+// stack
+//  - CAPACITY is the largest uart frame, everything carried in a frame fits as well
+//  - growing past CAPACITY throws std::length_error, the way a vector would past max_size()
+//  - note: CAPACITY is spelled out (checked against uart_frame::MAX_FRAME_SIZE in
+//  inline_buffer_test) as the size of the storage has to be a constant expression
+class inline_buffer
+{
+public:
+    static const size_t CAPACITY = 115;
+
+    typedef uint8_t value_type;
+    typedef const uint8_t *const_iterator;
+
+    inline_buffer();
+    inline_buffer(const std::vector<uint8_t> &bytes);
+
+    template <typename Iterator>
+    inline_buffer(Iterator begin, Iterator end)
+        : length(0)
+    {
+        append(begin, end);
+    }
+
+    template <typename Iterator>
+    void assign(Iterator begin, Iterator end)
+    {
+        clear();
+        append(begin, end);
+    }
+
+    template <typename Iterator>
+    void append(Iterator begin, Iterator end)
+    {
+        std::copy(begin, end, append(static_cast<size_t>(std::distance(begin, end))));
+    }
+
+    // grows the buffer by length bytes to be filled in place and returns where they start
+    uint8_t *append(size_t length);
+    void push_back(uint8_t byte);
+    void clear();
+
+    size_t size() const;
+    bool empty() const;
+    const uint8_t *data() const;
+    const uint8_t *begin() const;
+    const uint8_t *end() const;
+    uint8_t operator[](size_t index) const;
+
+    operator std::vector<uint8_t>() const;
+
+private:
+    std::array<uint8_t, CAPACITY> storage;
+    size_t length;
+};
+
+#endif
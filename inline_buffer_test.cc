@@ -0,0 +1,79 @@
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "inline_buffer.h"
+#include "uart_frame.h"
+
+namespace inline_buffer_test
+{
+    std::vector<uint8_t> any_bytes{'t', 'e', 's', 't'};
+
+    TEST(InlineBufferTest, ConstValuesSpec)
+    {
+        ASSERT_EQ(uart_frame::MAX_FRAME_SIZE, inline_buffer::CAPACITY);
+    }
+
+    TEST(InlineBufferTest, EmptyTest)
+    {
+        inline_buffer buffer;
+        ASSERT_TRUE(buffer.empty());
+        ASSERT_EQ(0, buffer.size());
+        ASSERT_EQ(buffer.begin(), buffer.end());
+    }
+
+    TEST(InlineBufferTest, FromVectorTest)
+    {
+        inline_buffer buffer(any_bytes);
+        ASSERT_EQ(any_bytes.size(), buffer.size());
+        ASSERT_EQ(any_bytes, static_cast<std::vector<uint8_t>>(buffer));
+        ASSERT_EQ('e', buffer[1]);
+    }
+
+    TEST(InlineBufferTest, AppendTest)
+    {
+        inline_buffer buffer;
+        buffer.push_back('t');
+        uint8_t *appended = buffer.append(2);
+        appended[0] = 'e';
+        appended[1] = 's';
+        buffer.append(any_bytes.cend() - 1, any_bytes.cend());
+        ASSERT_EQ(any_bytes, static_cast<std::vector<uint8_t>>(buffer));
+
+        // storage is inline, appending never moves what's already there
+        ASSERT_EQ(buffer.data() + 1, appended);
+    }
+
+    TEST(InlineBufferTest, AssignTest)
+    {
+        inline_buffer buffer(any_bytes);
+        buffer.assign(any_bytes.cbegin() + 2, any_bytes.cend());
+        ASSERT_EQ(std::vector<uint8_t>({'s', 't'}), static_cast<std::vector<uint8_t>>(buffer));
+
+        buffer.clear();
+        ASSERT_TRUE(buffer.empty());
+    }
+
+    TEST(InlineBufferTest, CopyTest)
+    {
+        inline_buffer buffer(any_bytes);
+        inline_buffer copy = buffer;
+        buffer.clear();
+        ASSERT_EQ(any_bytes, static_cast<std::vector<uint8_t>>(copy));
+        ASSERT_NE(buffer.data(), copy.data());
+    }
+
+    TEST(InlineBufferTest, CapacityExceededTest)
+    {
+        std::vector<uint8_t> full(inline_buffer::CAPACITY, 0xff);
+        inline_buffer buffer(full);
+        ASSERT_EQ(inline_buffer::CAPACITY, buffer.size());
+        ASSERT_THROW(buffer.push_back(0x00), std::length_error);
+        ASSERT_EQ(inline_buffer::CAPACITY, buffer.size());
+
+        std::vector<uint8_t> too_long(inline_buffer::CAPACITY + 1, 0xff);
+        ASSERT_THROW(inline_buffer{too_long}, std::length_error);
+    }
+}
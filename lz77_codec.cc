@@ -0,0 +1,198 @@
+#include "lz77_codec.h"
+
+const size_t lz77_codec::WINDOW_SIZE = 4096;
+const size_t lz77_codec::MIN_MATCH_LENGTH = 3;
+const size_t lz77_codec::MAX_MATCH_LENGTH = MIN_MATCH_LENGTH + 0x0f;
+const size_t lz77_codec::MATCH_LENGTH = 2;
+const size_t lz77_codec::ITEMS_PER_CONTROL_BYTE = 8;
+const size_t lz77_codec::HASH_BITS = 12;
+const size_t lz77_codec::MAX_CHAIN_LENGTH = 32;
+
+lz77_codec::lz77_codec()
+{
+}
+
+size_t lz77_codec::compress(std::vector<uint8_t>::const_iterator begin,
+    std::vector<uint8_t>::const_iterator end, size_t max_output_length,
+    std::vector<uint8_t> &output)
+{
+    size_t history_length = get_history_length();
+    buffer.assign(history.end() - history_length, history.end());
+    buffer.insert(buffer.end(), begin, end);
+    head.assign(static_cast<size_t>(1) << HASH_BITS, -1);
+    previous.resize(buffer.size());
+
+    auto insert_position = [this](size_t position) {
+        if (position + MIN_MATCH_LENGTH <= buffer.size())
+        {
+            auto h = hash(position);
+            previous[position] = head[h];
+            head[h] = static_cast<int32_t>(position);
+        }
+    };
+
+    for (size_t position = 0; position < history_length; ++position)
+    {
+        insert_position(position);
+    }
+
+    size_t output_limit = output.size() + max_output_length;
+    size_t control_byte_index = 0;
+    size_t item = ITEMS_PER_CONTROL_BYTE;
+    size_t position = history_length;
+
+    while (position < buffer.size())
+    {
+        size_t match_length = 0;
+        size_t match_distance = 0;
+
+        if (position + MIN_MATCH_LENGTH <= buffer.size())
+        {
+            size_t max_length = std::min(MAX_MATCH_LENGTH, buffer.size() - position);
+            int32_t candidate = head[hash(position)];
+
+            for (size_t chain = 0; candidate != -1 && chain < MAX_CHAIN_LENGTH; ++chain)
+            {
+                auto match_begin = static_cast<size_t>(candidate);
+                size_t distance = position - match_begin;
+                if (distance > WINDOW_SIZE)
+                {
+                    break;
+                }
+
+                size_t length = 0;
+                while (length < max_length
+                    && buffer[match_begin + length] == buffer[position + length])
+                {
+                    ++length;
+                }
+
+                if (length > match_length)
+                {
+                    match_length = length;
+                    match_distance = distance;
+
+                    if (length == max_length)
+                    {
+                        break;
+                    }
+                }
+
+                candidate = previous[match_begin];
+            }
+        }
+
+        bool match = match_length >= MIN_MATCH_LENGTH;
+        size_t control_byte_length = item == ITEMS_PER_CONTROL_BYTE ? 1 : 0;
+
+        // a literal might still fit where a match doesn't
+        if (match && output.size() + control_byte_length + MATCH_LENGTH > output_limit)
+        {
+            match = false;
+        }
+
+        if (output.size() + control_byte_length + (match ? MATCH_LENGTH : 1) > output_limit)
+        {
+            break;
+        }
+
+        if (item == ITEMS_PER_CONTROL_BYTE)
+        {
+            control_byte_index = output.size();
+            output.push_back(0);
+            item = 0;
+        }
+
+        size_t length = 1;
+        if (match)
+        {
+            output[control_byte_index] |= 1 << item;
+            output.push_back(static_cast<uint8_t>((match_distance - 1) >> 4));
+            output.push_back(static_cast<uint8_t>(
+                ((match_distance - 1) & 0x0f) << 4 | (match_length - MIN_MATCH_LENGTH)));
+            length = match_length;
+        }
+        else
+        {
+            output.push_back(buffer[position]);
+        }
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            insert_position(position++);
+        }
+
+        ++item;
+    }
+
+    return position - history_length;
+}
+
+bool lz77_codec::decompress(
+    const uint8_t *begin, const uint8_t *end, std::vector<uint8_t> &output) const
+{
+    size_t history_length = get_history_length();
+    std::vector<uint8_t> decoded(history.end() - history_length, history.end());
+
+    while (begin != end)
+    {
+        uint8_t control_byte = *begin++;
+
+        for (size_t item = 0; item < ITEMS_PER_CONTROL_BYTE && begin != end; ++item)
+        {
+            if (!(control_byte & (1 << item)))
+            {
+                decoded.push_back(*begin++);
+                continue;
+            }
+
+            if (std::distance(begin, end) < static_cast<ptrdiff_t>(MATCH_LENGTH))
+            {
+                return false;
+            }
+
+            size_t distance = (static_cast<size_t>(begin[0]) << 4 | begin[1] >> 4) + 1;
+            size_t length = (begin[1] & 0x0f) + MIN_MATCH_LENGTH;
+            begin += MATCH_LENGTH;
+
+            if (distance > decoded.size())
+            {
+                return false;
+            }
+
+            // note: source and destination may overlap (distance < length), copy byte by byte
+            for (size_t i = 0; i < length; ++i)
+            {
+                uint8_t byte = decoded[decoded.size() - distance];
+                decoded.push_back(byte);
+            }
+        }
+    }
+
+    output.insert(output.end(), decoded.begin() + history_length, decoded.end());
+    return true;
+}
+
+void lz77_codec::update_history(
+    std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end)
+{
+    history.insert(history.end(), begin, end);
+
+    // trim in bulk rather than on every call
+    if (history.size() > 2 * WINDOW_SIZE)
+    {
+        history.erase(history.begin(), history.end() - WINDOW_SIZE);
+    }
+}
+
+size_t lz77_codec::hash(size_t position) const
+{
+    uint32_t value = static_cast<uint32_t>(buffer[position]) << 16
+        | static_cast<uint32_t>(buffer[position + 1]) << 8 | buffer[position + 2];
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+size_t lz77_codec::get_history_length() const
+{
+    return std::min(history.size(), WINDOW_SIZE);
+}
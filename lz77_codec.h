@@ -0,0 +1,59 @@
+#ifndef LZ77_CODEC_H
+#define LZ77_CODEC_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// LZ77 codec (LZSS flavour) with a sliding dictionary that persists across calls, meant to be used
+// once per direction of a flow: segments are tiny, so most of the savings come from back references
+// into payload that was sent earlier
+//  - compressed data is a sequence of groups of up to 8 items, each group preceded by a control
+//  byte whose bit i (LSB first) tells whether item i is a literal byte (0) or a match (1)
+//  - match: 2 bytes, [distance - 1 (12 bits)][length - MIN_MATCH_LENGTH (4 bits)], distance is
+//  counted back from the current position across the dictionary and everything decoded so far
+//  - note: both ends must feed update_history() the exact same uncompressed bytes in the same order
+//  (every payload, whether it was sent compressed or not), i.e. only usable on in-order streams
+//  - note: not threadsafe, owner is expected to serialize access
+class lz77_codec
+{
+public:
+    static const size_t WINDOW_SIZE;
+    static const size_t MIN_MATCH_LENGTH;
+    static const size_t MAX_MATCH_LENGTH;
+    static const size_t MATCH_LENGTH;    // encoded size of a match
+    static const size_t ITEMS_PER_CONTROL_BYTE;
+
+    lz77_codec();
+
+    // compresses the longest prefix of [begin, end) that fits in max_output_length bytes, appends
+    // it to output and returns the number of input bytes consumed
+    //  - note: dictionary is left as is, pass the consumed bytes to update_history() once they're
+    //  committed
+    size_t compress(std::vector<uint8_t>::const_iterator begin,
+        std::vector<uint8_t>::const_iterator end, size_t max_output_length,
+        std::vector<uint8_t> &output);
+    // appends decoded data to output, returns false if the data is malformed (e.g. refers past the
+    // start of the dictionary), dictionary is left as is
+    bool decompress(
+        const uint8_t *begin, const uint8_t *end, std::vector<uint8_t> &output) const;
+    void update_history(
+        std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end);
+
+private:
+    static const size_t HASH_BITS;
+    static const size_t MAX_CHAIN_LENGTH;
+
+    size_t hash(size_t position) const;
+    size_t get_history_length() const;
+
+    std::vector<uint8_t> history;    // holds at least the last WINDOW_SIZE bytes seen
+
+    // compress() scratch space, kept around to avoid reallocating for every segment
+    std::vector<uint8_t> buffer;    // dictionary followed by the input
+    std::vector<int32_t> head;    // most recent position of each hash
+    std::vector<int32_t> previous;    // previous position with the same hash, per position
+};
+
+#endif
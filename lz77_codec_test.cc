@@ -0,0 +1,135 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "lz77_codec.h"
+
+namespace lz77_codec_test
+{
+    std::vector<uint8_t> any_telemetry(
+        const std::string &line = "node=0013a200 temp=21.37 hum=45.20 pres=1013.25\n")
+    {
+        return std::vector<uint8_t>(line.begin(), line.end());
+    }
+
+    // compresses all of input with sender and checks receiver decodes it back, returns compressed
+    // length
+    size_t round_trip(lz77_codec &sender, lz77_codec &receiver, const std::vector<uint8_t> &input)
+    {
+        std::vector<uint8_t> compressed;
+        size_t consumed = sender.compress(input.begin(), input.end(), SIZE_MAX, compressed);
+        EXPECT_EQ(input.size(), consumed);
+        sender.update_history(input.begin(), input.end());
+
+        std::vector<uint8_t> decompressed;
+        EXPECT_TRUE(receiver.decompress(
+            compressed.data(), compressed.data() + compressed.size(), decompressed));
+        EXPECT_EQ(input, decompressed);
+        receiver.update_history(decompressed.begin(), decompressed.end());
+
+        return compressed.size();
+    }
+
+    TEST(Lz77CodecTest, ConstValuesSpec)
+    {
+        ASSERT_EQ(4096, lz77_codec::WINDOW_SIZE);
+        ASSERT_EQ(3, lz77_codec::MIN_MATCH_LENGTH);
+        ASSERT_EQ(18, lz77_codec::MAX_MATCH_LENGTH);
+        ASSERT_EQ(2, lz77_codec::MATCH_LENGTH);
+        ASSERT_EQ(8, lz77_codec::ITEMS_PER_CONTROL_BYTE);
+    }
+
+    TEST(Lz77CodecTest, EmptyInputTest)
+    {
+        lz77_codec sender, receiver;
+        ASSERT_EQ(0, round_trip(sender, receiver, std::vector<uint8_t>()));
+    }
+
+    TEST(Lz77CodecTest, LiteralsTest)
+    {
+        lz77_codec codec;
+        std::vector<uint8_t> input{'a', 'b', 'c'};
+        std::vector<uint8_t> compressed;
+        ASSERT_EQ(3, codec.compress(input.begin(), input.end(), SIZE_MAX, compressed));
+        ASSERT_EQ(std::vector<uint8_t>({0x00, 'a', 'b', 'c'}), compressed);
+    }
+
+    TEST(Lz77CodecTest, OverlappingMatchTest)
+    {
+        lz77_codec sender, receiver;
+        std::vector<uint8_t> input(100, 'x');
+        ASSERT_LT(round_trip(sender, receiver, input), 20);
+    }
+
+    TEST(Lz77CodecTest, HistoryImprovesCompressionTest)
+    {
+        lz77_codec sender, receiver;
+        auto first = round_trip(sender, receiver, any_telemetry());
+        auto second = round_trip(
+            sender, receiver, any_telemetry("node=0013a200 temp=21.41 hum=45.18 pres=1013.22\n"));
+
+        ASSERT_LT(second, first / 2);
+    }
+
+    TEST(Lz77CodecTest, MaxOutputLengthTest)
+    {
+        lz77_codec sender, receiver;
+        std::vector<uint8_t> input;
+        for (int i = 0; i < 200; ++i)
+        {
+            input.push_back(static_cast<uint8_t>(i * 37 + i / 7));
+        }
+
+        std::vector<uint8_t> compressed;
+        size_t consumed = sender.compress(input.begin(), input.end(), 50, compressed);
+        ASSERT_LE(compressed.size(), 50);
+        ASSERT_GT(consumed, 0);
+        ASSERT_LT(consumed, input.size());
+
+        std::vector<uint8_t> decompressed;
+        ASSERT_TRUE(receiver.decompress(
+            compressed.data(), compressed.data() + compressed.size(), decompressed));
+        ASSERT_EQ(std::vector<uint8_t>(input.begin(), input.begin() + consumed), decompressed);
+    }
+
+    TEST(Lz77CodecTest, CompressLeavesHistoryTest)
+    {
+        lz77_codec sender, receiver;
+        auto input = any_telemetry();
+        std::vector<uint8_t> discarded;
+        sender.compress(input.begin(), input.end(), SIZE_MAX, discarded);
+
+        // nothing was committed, so nothing may be referenced either
+        round_trip(sender, receiver, input);
+    }
+
+    TEST(Lz77CodecTest, WindowSlidesTest)
+    {
+        lz77_codec sender, receiver;
+        for (int i = 0; i < 500; ++i)
+        {
+            round_trip(sender, receiver,
+                any_telemetry("seq=" + std::to_string(i) + " node=0013a200 temp=21.37\n"));
+        }
+    }
+
+    TEST(Lz77CodecTest, DecompressReferenceBeforeHistoryTest)
+    {
+        lz77_codec codec;
+        std::vector<uint8_t> compressed{0x01, 0x00, 0x10};
+        std::vector<uint8_t> decompressed;
+        ASSERT_FALSE(codec.decompress(
+            compressed.data(), compressed.data() + compressed.size(), decompressed));
+    }
+
+    TEST(Lz77CodecTest, DecompressTruncatedMatchTest)
+    {
+        lz77_codec codec;
+        std::vector<uint8_t> compressed{0x02, 'a', 0x00};
+        std::vector<uint8_t> decompressed;
+        ASSERT_FALSE(codec.decompress(
+            compressed.data(), compressed.data() + compressed.size(), decompressed));
+    }
+}
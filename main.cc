@@ -1,3 +1,4 @@
+#include <chrono>
 #include <cstdlib>
 #include <fstream>
 #include <memory>
@@ -5,6 +6,7 @@
 
 #include "beehive.h"
 #include "beehive_config.h"
+#include "congestion_controller.h"
 #include "logger.h"
 #include "simulated_communication_endpoint.h"
 #include "util.h"
@@ -23,7 +25,16 @@ int main(int argc, char *argv[])
     bool custom_socket_path = false;
 
     uint32_t packet_loss_percent = 0;
+    uint32_t max_window_size = beehive_config::DEFAULT_MAX_WINDOW_SIZE;
+    uint32_t ack_frequency = beehive_config::DEFAULT_ACK_FREQUENCY;
+    uint32_t ack_delay_ms = static_cast<uint32_t>(beehive_config::DEFAULT_ACK_DELAY.count());
+    bool coalesce = false;
+    uint32_t coalesce_delay_ms
+        = static_cast<uint32_t>(beehive_config::DEFAULT_COALESCE_DELAY.count());
+    bool compress = false;
+    bool fec = false;
     uint32_t baud = xbee_s1::DEFAULT_BAUD;
+    uint8_t api_mode = xbee_s1::DEFAULT_API_MODE;
     std::string device = xbee_s1::DEFAULT_DEVICE;
     beehive_config config;
 
@@ -121,6 +132,99 @@ int main(int argc, char *argv[])
 
             ++i;
         }
+        else if (std::string(argv[i]) == "--max-window")
+        {
+            if (i + 1 == argc)
+            {
+                LOG_ERROR("window size not supplied");
+                return EXIT_FAILURE;
+            }
+
+            if (!util::try_parse_uint32_t(argv[i + 1], max_window_size))
+            {
+                LOG_ERROR("failed to parse window size: ", argv[i + 1]);
+                return EXIT_FAILURE;
+            }
+
+            if (max_window_size < congestion_controller::MIN_WINDOW_SIZE
+                || max_window_size > beehive_config::WINDOW_SIZE_LIMIT)
+            {
+                LOG_ERROR("invalid window size: ", max_window_size);
+                return EXIT_FAILURE;
+            }
+
+            ++i;
+        }
+        else if (std::string(argv[i]) == "--ack-every")
+        {
+            if (i + 1 == argc)
+            {
+                LOG_ERROR("ack frequency not supplied");
+                return EXIT_FAILURE;
+            }
+
+            if (!util::try_parse_uint32_t(argv[i + 1], ack_frequency))
+            {
+                LOG_ERROR("failed to parse ack frequency: ", argv[i + 1]);
+                return EXIT_FAILURE;
+            }
+
+            if (ack_frequency < 1 || ack_frequency > congestion_controller::MAX_WINDOW_SIZE)
+            {
+                LOG_ERROR("invalid ack frequency: ", ack_frequency);
+                return EXIT_FAILURE;
+            }
+
+            ++i;
+        }
+        else if (std::string(argv[i]) == "--ack-delay")
+        {
+            if (i + 1 == argc)
+            {
+                LOG_ERROR("ack delay not supplied");
+                return EXIT_FAILURE;
+            }
+
+            if (!util::try_parse_uint32_t(argv[i + 1], ack_delay_ms))
+            {
+                LOG_ERROR("failed to parse ack delay: ", argv[i + 1]);
+                return EXIT_FAILURE;
+            }
+
+            ++i;
+        }
+        else if (std::string(argv[i]) == "--coalesce")
+        {
+            coalesce = true;
+        }
+        else if (std::string(argv[i]) == "--coalesce-delay")
+        {
+            if (i + 1 == argc)
+            {
+                LOG_ERROR("coalesce delay not supplied");
+                return EXIT_FAILURE;
+            }
+
+            if (!util::try_parse_uint32_t(argv[i + 1], coalesce_delay_ms))
+            {
+                LOG_ERROR("failed to parse coalesce delay: ", argv[i + 1]);
+                return EXIT_FAILURE;
+            }
+
+            ++i;
+        }
+        else if (std::string(argv[i]) == "--compress")
+        {
+            compress = true;
+        }
+        else if (std::string(argv[i]) == "--fec")
+        {
+            fec = true;
+        }
+        else if (std::string(argv[i]) == "--escaped")
+        {
+            api_mode = xbee_s1::API_MODE_ESCAPED;
+        }
         else
         {
             LOG_ERROR("invalid argument: ", argv[i]);
@@ -136,6 +240,7 @@ int main(int argc, char *argv[])
      *  - settings to write:
      *      + ATAP : "1"
      *          - enable API mode without escape characters
+     *          - "2" with --escaped, needed if anything on the serial line uses XON/XOFF
      *      + ATMY : 0xffff
      *          - enable 64 bit addressing mode
      *      - ATID : 0xf00d (mm.. f00d?)
@@ -170,11 +275,12 @@ int main(int argc, char *argv[])
     {
         if (reset)
         {
-            return xbee_s1(device).reset_firmware_settings() ? EXIT_SUCCESS : EXIT_FAILURE;
+            xbee_s1 xbee(device, xbee_s1::FACTORY_DEFAULT_BAUD, api_mode);
+            return xbee.reset_firmware_settings() ? EXIT_SUCCESS : EXIT_FAILURE;
         }
         else if (configure)
         {
-            return xbee_s1(device, baud).configure_firmware_settings()
+            return xbee_s1(device, baud, api_mode).configure_firmware_settings()
                 ? EXIT_SUCCESS
                 : EXIT_FAILURE;
         }
@@ -186,14 +292,16 @@ int main(int argc, char *argv[])
         }
         else if (read_xbee_config)
         {
-            return xbee_s1(device, baud).read_configuration_registers()
+            return xbee_s1(device, baud, api_mode).read_configuration_registers()
                 ? EXIT_SUCCESS
                 : EXIT_FAILURE;
         }
         else if (test_xbee)
         {
             // TODO: get rid of this flag? just use --read-xbee-config
-            return xbee_s1(device, baud).read_and_set_address() ? EXIT_SUCCESS : EXIT_FAILURE;
+            return xbee_s1(device, baud, api_mode).read_and_set_address()
+                ? EXIT_SUCCESS
+                : EXIT_FAILURE;
         }
         else
         {
@@ -204,7 +312,7 @@ int main(int argc, char *argv[])
             }
             else
             {
-                endpoint = std::make_shared<xbee_communication_endpoint>(device, baud);
+                endpoint = std::make_shared<xbee_communication_endpoint>(device, baud, api_mode);
             }
 
             // ensure uniqueness of socket paths when testing multiple devices on a single machine
@@ -214,6 +322,14 @@ int main(int argc, char *argv[])
                     + util::to_hex_string(endpoint->get_address()));
             }
 
+            config.set_max_window_size(static_cast<uint16_t>(max_window_size));
+            config.set_ack_frequency(static_cast<uint16_t>(ack_frequency));
+            config.set_ack_delay(std::chrono::milliseconds(ack_delay_ms));
+            config.set_coalesce_by_default(coalesce);
+            config.set_coalesce_delay(std::chrono::milliseconds(coalesce_delay_ms));
+            config.set_compress_by_default(compress);
+            config.set_fec_by_default(fec);
+
             LOG("address:   ", util::to_hex_string(endpoint->get_address()));
             LOG("server:    ./server_stream.py beehive", util::to_hex_string(endpoint->get_address()));
             LOG("client:    ./client_stream.py beehive", util::to_hex_string(endpoint->get_address()));
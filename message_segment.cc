@@ -2,86 +2,199 @@
 
 const uint16_t message_segment::CHECKSUM_TARGET = 0xffff;
 const uint8_t message_segment::MESSAGE_FLAGS_MASK = 0x0f;
+const uint8_t message_segment::MESSAGE_TYPE_MASK = 0x07;
+const uint8_t message_segment::COMPRESSED_MASK = 0x80;
 const size_t message_segment::MESSAGE_TYPE_SHIFT_BITS = 4;
-const size_t message_segment::SOURCE_PORT_OFFSET = 0;
-const size_t message_segment::DESTINATION_PORT_OFFSET = SOURCE_PORT_OFFSET + sizeof(source_port);
-const size_t message_segment::SEQUENCE_NUM_OFFSET
-    = DESTINATION_PORT_OFFSET + sizeof(destination_port);
-const size_t message_segment::CHECKSUM_OFFSET = SEQUENCE_NUM_OFFSET + sizeof(sequence_num);
-const size_t message_segment::FLAGS_OFFSET = CHECKSUM_OFFSET + sizeof(checksum);
-const size_t message_segment::MESSAGE_OFFSET = FLAGS_OFFSET + sizeof(flags);
+const size_t message_segment::SOURCE_PORT_OFFSET = source_port_field::OFFSET;
+const size_t message_segment::DESTINATION_PORT_OFFSET = destination_port_field::OFFSET;
+const size_t message_segment::SEQUENCE_NUM_OFFSET = sequence_num_field::OFFSET;
+const size_t message_segment::CHECKSUM_OFFSET = checksum_field::OFFSET;
+const size_t message_segment::FLAGS_OFFSET = flags_field::OFFSET;
+const size_t message_segment::MESSAGE_OFFSET = header_layout::LENGTH;
 const size_t message_segment::MIN_SEGMENT_LENGTH = MESSAGE_OFFSET;
+// note: tx_request_64 and rx_packet_64 frame data headers are the same length
 const size_t message_segment::MAX_SEGMENT_LENGTH = uart_frame::MAX_FRAME_SIZE
-    - uart_frame::HEADER_LENGTH - sizeof(frame_data::api_identifier_value)
-    - sizeof(uint8_t) /* tx: frame_id, rx: rssi */ - sizeof(uint64_t) /* tx/rx: address */
-    - sizeof(uint8_t) /* tx/rx: options */ - sizeof(source_port) - sizeof(destination_port)
-    - sizeof(sequence_num) - sizeof(uint8_t) /* checksum */ - sizeof(checksum) - sizeof(flags);
+    - uart_frame::header_layout::LENGTH - tx_request_64_frame::layout::LENGTH
+    - sizeof(uint8_t) /* checksum */ - header_layout::LENGTH;
+const uint8_t message_segment::COMPACT_HEADER_MARKER = 0xf0;
+const uint8_t message_segment::CONNECTION_ID_MASK = 0x7f;
+const uint16_t message_segment::MIN_RESERVED_PORT = 0xf000;
+const size_t message_segment::COMPACT_FLAGS_OFFSET = compact_flags_field::OFFSET;
+const size_t message_segment::CONNECTION_ID_OFFSET = connection_id_field::OFFSET;
+const size_t message_segment::COMPACT_SEQUENCE_NUM_OFFSET = compact_sequence_num_field::OFFSET;
+const size_t message_segment::COMPACT_CHECKSUM_OFFSET = compact_checksum_field::OFFSET;
+const size_t message_segment::COMPACT_MESSAGE_OFFSET = compact_header_layout::LENGTH;
+const size_t message_segment::MIN_COMPACT_SEGMENT_LENGTH = COMPACT_MESSAGE_OFFSET;
+const size_t message_segment::MAX_COMPACT_SEGMENT_LENGTH
+    = MAX_SEGMENT_LENGTH + MIN_SEGMENT_LENGTH - MIN_COMPACT_SEGMENT_LENGTH;
 const std::vector<uint8_t> message_segment::EMPTY_PAYLOAD;
 
+// a received segment along with the frame its payload is viewed in
+struct message_segment::received_segment
+{
+    received_segment(frame_buffer_pool::unique_buffer frame, const segment_view &view)
+        : frame(std::move(frame)), segment(view)
+    {
+    }
+
+    frame_buffer_pool::unique_buffer frame;
+    message_segment segment;
+};
+
 message_segment::message_segment(uint16_t source_port, uint16_t destination_port,
-    uint16_t sequence_num, uint8_t type, uint8_t flags, const std::vector<uint8_t> &message)
+    uint16_t sequence_num, uint8_t type, uint8_t flags, const inline_buffer &message,
+    bool compressed)
     : source_port(source_port), destination_port(destination_port), sequence_num(sequence_num),
-      flags(0), message(message)
+      flags(compressed ? COMPRESSED_MASK : 0), compact(false), connection_id(0), message(message),
+      message_begin(this->message.begin()), message_end(this->message.end())
 {
-    this->flags += type << MESSAGE_TYPE_SHIFT_BITS;
+    this->flags += (type & MESSAGE_TYPE_MASK) << MESSAGE_TYPE_SHIFT_BITS;
     this->flags += flags & MESSAGE_FLAGS_MASK;
     checksum = compute_checksum();
 }
 
 message_segment::message_segment(const std::vector<uint8_t> &segment)
+    : compact(false), connection_id(0), message_begin(message.begin()), message_end(message.end())
 {
-    if (segment.size() < MIN_SEGMENT_LENGTH)
+    segment_view view;
+    if (!segment_view::parse(segment.data(), segment.data() + segment.size(), view))
     {
         // TODO: dont' use ctor directly, create separate method that can indicate failure/success
         return;
     }
 
-    source_port = util::unpack_bytes_to_width<uint16_t>(segment.begin() + SOURCE_PORT_OFFSET);
-    destination_port
-        = util::unpack_bytes_to_width<uint16_t>(segment.begin() + DESTINATION_PORT_OFFSET);
-    sequence_num = util::unpack_bytes_to_width<uint16_t>(segment.begin() + SEQUENCE_NUM_OFFSET);
-    checksum = util::unpack_bytes_to_width<uint16_t>(segment.begin() + CHECKSUM_OFFSET);
-    flags = segment[FLAGS_OFFSET];
+    // copying takes the payload out of segment
+    *this = message_segment(view);
+}
 
-    if (segment.size() > MESSAGE_OFFSET)
+message_segment::message_segment(const message_segment &other)
+    : source_port(other.source_port), destination_port(other.destination_port),
+      sequence_num(other.sequence_num), checksum(other.checksum), flags(other.flags),
+      compact(other.compact), connection_id(other.connection_id),
+      message(other.message_begin, other.message_end), message_begin(message.begin()),
+      message_end(message.end())
+{
+}
+
+message_segment::message_segment(const segment_view &view)
+    : source_port(view.get_source_port()), destination_port(view.get_destination_port()),
+      sequence_num(view.get_sequence_num()), checksum(view.get_checksum()),
+      flags(view.get_flags()), compact(view.is_compact()), connection_id(view.get_connection_id()),
+      message_begin(view.get_message_begin()), message_end(view.get_message_end())
+{
+}
+
+message_segment &message_segment::operator=(const message_segment &other)
+{
+    if (this == &other)
     {
-        message = std::vector<uint8_t>(segment.begin() + MESSAGE_OFFSET, segment.end());
+        return *this;
     }
+
+    source_port = other.source_port;
+    destination_port = other.destination_port;
+    sequence_num = other.sequence_num;
+    checksum = other.checksum;
+    flags = other.flags;
+    compact = other.compact;
+    connection_id = other.connection_id;
+    message.assign(other.message_begin, other.message_end);
+    message_begin = message.begin();
+    message_end = message.end();
+    return *this;
 }
 
-std::shared_ptr<message_segment> message_segment::create_syn(
-    uint16_t source_port, uint16_t destination_port)
+// aliases the segment inside the allocation that owns frame, the frame goes back to its pool once
+// the last reference to the segment is dropped
+std::shared_ptr<message_segment> message_segment::create_received(
+    frame_buffer_pool::unique_buffer frame, const segment_view &view)
 {
-    return std::make_shared<message_segment>(
-        source_port, destination_port, 0, type::stream_segment, flag::syn, EMPTY_PAYLOAD);
+    auto received = allocate_pooled<received_segment>(std::move(frame), view);
+    return std::shared_ptr<message_segment>(received, &received->segment);
 }
 
-std::shared_ptr<message_segment> message_segment::create_synack(
-    uint16_t source_port, uint16_t destination_port)
+block_pool_stats message_segment::get_received_pool_stats()
+{
+    return pool_allocator<received_segment>::get_stats();
+}
+
+std::shared_ptr<message_segment> message_segment::create_syn(uint16_t source_port,
+    uint16_t destination_port, uint8_t connection_options, uint8_t connection_id,
+    uint16_t window_size)
+{
+    return allocate_pooled<message_segment>(source_port, destination_port, 0,
+        type::stream_segment, flag::syn,
+        encode_connection_options(connection_options, connection_id, window_size));
+}
+
+std::shared_ptr<message_segment> message_segment::create_synack(uint16_t source_port,
+    uint16_t destination_port, uint8_t connection_options, uint8_t connection_id,
+    uint16_t window_size)
 {
-    return std::make_shared<message_segment>(source_port, destination_port, 0, type::stream_segment,
-        flag::syn | flag::ack, EMPTY_PAYLOAD);
+    return allocate_pooled<message_segment>(source_port, destination_port, 0, type::stream_segment,
+        flag::syn | flag::ack,
+        encode_connection_options(connection_options, connection_id, window_size));
 }
 
 std::shared_ptr<message_segment> message_segment::create_ack(
     uint16_t source_port, uint16_t destination_port, uint16_t sequence_number)
 {
-    return std::make_shared<message_segment>(source_port, destination_port, sequence_number,
+    return allocate_pooled<message_segment>(source_port, destination_port, sequence_number,
         type::stream_segment, flag::ack, EMPTY_PAYLOAD);
 }
 
+// stream data ACK, acknowledgement state is carried in the payload rather than the sequence number
+std::shared_ptr<message_segment> message_segment::create_selective_ack(
+    uint16_t source_port, uint16_t destination_port, const selective_ack &ack)
+{
+    return allocate_pooled<message_segment>(source_port, destination_port, 0, type::stream_segment,
+        flag::ack, static_cast<std::vector<uint8_t>>(ack));
+}
+
+std::shared_ptr<message_segment> message_segment::create_selective_ack(uint16_t source_port,
+    uint16_t destination_port, const selective_ack &ack, uint16_t sequence_number,
+    const std::vector<uint8_t> &payload, bool compressed)
+{
+    inline_buffer message(static_cast<std::vector<uint8_t>>(ack));
+    message.append(payload.cbegin(), payload.cend());
+
+    return allocate_pooled<message_segment>(source_port, destination_port, sequence_number,
+        type::stream_segment, flag::ack, message, compressed);
+}
+
 std::shared_ptr<message_segment> message_segment::create_rst(
     uint16_t source_port, uint16_t destination_port)
 {
-    return std::make_shared<message_segment>(
+    return allocate_pooled<message_segment>(
         source_port, destination_port, 0, type::stream_segment, flag::rst, EMPTY_PAYLOAD);
 }
 
 std::shared_ptr<message_segment> message_segment::create_fin(
-    uint16_t source_port, uint16_t destination_port)
+    uint16_t source_port, uint16_t destination_port, uint16_t sequence_number)
+{
+    return allocate_pooled<message_segment>(source_port, destination_port, sequence_number,
+        type::stream_segment, flag::fin, EMPTY_PAYLOAD);
+}
+
+std::shared_ptr<message_segment> message_segment::create_finack(
+    uint16_t source_port, uint16_t destination_port, uint16_t sequence_number)
+{
+    return allocate_pooled<message_segment>(source_port, destination_port, sequence_number,
+        type::stream_segment, flag::fin | flag::ack, EMPTY_PAYLOAD);
+}
+
+std::shared_ptr<message_segment> message_segment::create_parity(uint16_t source_port,
+    uint16_t destination_port, uint16_t first_sequence_number, const std::vector<uint8_t> &parity)
 {
-    return std::make_shared<message_segment>(
-        source_port, destination_port, 0, type::stream_segment, flag::fin, EMPTY_PAYLOAD);
+    return allocate_pooled<message_segment>(source_port, destination_port, first_sequence_number,
+        type::stream_segment, flag::syn | flag::fin, parity);
+}
+
+void message_segment::set_connection_id(uint8_t connection_id)
+{
+    compact = true;
+    this->connection_id = connection_id & CONNECTION_ID_MASK;
+    checksum = compute_checksum();
 }
 
 uint16_t message_segment::get_source_port() const
@@ -104,15 +217,22 @@ uint16_t message_segment::get_checksum() const
     return checksum;
 }
 
+// note: the connection ID takes the place of the ports in compact segments
 uint16_t message_segment::compute_checksum() const
 {
-    return CHECKSUM_TARGET - source_port - destination_port - sequence_num - flags
-        - std::accumulate(message.begin(), message.end(), static_cast<uint16_t>(0));
+    return compute_checksum(compact ? connection_id : source_port + destination_port, sequence_num,
+        flags, std::accumulate(message_begin, message_end, static_cast<uint16_t>(0)));
+}
+
+uint16_t message_segment::compute_checksum(
+    uint16_t address, uint16_t sequence_num, uint8_t flags, uint16_t message_sum)
+{
+    return CHECKSUM_TARGET - address - sequence_num - flags - message_sum;
 }
 
 uint8_t message_segment::get_message_type() const
 {
-    return flags >> MESSAGE_TYPE_SHIFT_BITS;
+    return (flags >> MESSAGE_TYPE_SHIFT_BITS) & MESSAGE_TYPE_MASK;
 }
 
 uint8_t message_segment::get_message_flags() const
@@ -150,9 +270,75 @@ bool message_segment::is_synack() const
     return get_message_flags() == (flag::syn | flag::ack);
 }
 
-const std::vector<uint8_t> &message_segment::get_message() const
+bool message_segment::is_finack() const
+{
+    return get_message_flags() == (flag::fin | flag::ack);
+}
+
+bool message_segment::is_parity() const
+{
+    return get_message_flags() == (flag::syn | flag::fin);
+}
+
+bool message_segment::is_compressed() const
+{
+    return flags & COMPRESSED_MASK;
+}
+
+bool message_segment::is_compact() const
+{
+    return compact;
+}
+
+uint8_t message_segment::get_connection_id() const
 {
-    return message;
+    return connection_id;
+}
+
+uint8_t message_segment::get_connection_options() const
+{
+    return message_begin == message_end ? 0 : message_begin[0];
+}
+
+uint8_t message_segment::get_offered_connection_id() const
+{
+    return get_message_length() > 1 && (message_begin[0] & compact_header) ? message_begin[1] : 0;
+}
+
+uint16_t message_segment::get_offered_window_size() const
+{
+    if (message_begin == message_end || !(message_begin[0] & connection_option::window_size))
+    {
+        return 0;
+    }
+
+    size_t offset = (message_begin[0] & compact_header) ? 2 : 1;
+    if (get_message_length() < offset + sizeof(uint16_t))
+    {
+        return 0;
+    }
+
+    return static_cast<uint16_t>(message_begin[offset] << 8 | message_begin[offset + 1]);
+}
+
+const uint8_t *message_segment::get_message_begin() const
+{
+    return message_begin;
+}
+
+const uint8_t *message_segment::get_message_end() const
+{
+    return message_end;
+}
+
+size_t message_segment::get_message_length() const
+{
+    return static_cast<size_t>(std::distance(message_begin, message_end));
+}
+
+std::vector<uint8_t> message_segment::get_message() const
+{
+    return std::vector<uint8_t>(message_begin, message_end);
 }
 
 bool message_segment::operator<(const message_segment &rhs) const
@@ -162,14 +348,72 @@ bool message_segment::operator<(const message_segment &rhs) const
 
 message_segment::operator std::vector<uint8_t>() const
 {
-    std::vector<uint8_t> segment;
-
-    util::pack_value_as_bytes(std::back_inserter(segment), source_port);
-    util::pack_value_as_bytes(std::back_inserter(segment), destination_port);
-    util::pack_value_as_bytes(std::back_inserter(segment), sequence_num);
-    util::pack_value_as_bytes(std::back_inserter(segment), checksum);
-    segment.push_back(flags);
-    segment.insert(segment.end(), message.begin(), message.end());
+    std::vector<uint8_t> segment(get_header_length());
+    write_header(segment.data());
+    segment.insert(segment.end(), message_begin, message_end);
 
     return segment;
 }
+
+bool message_segment::write_to(frame_buffer &buffer) const
+{
+    uint8_t *segment = buffer.append(get_header_length() + get_message_length());
+    if (segment == nullptr)
+    {
+        return false;
+    }
+
+    write_header(segment);
+    std::copy(message_begin, message_end, segment + get_header_length());
+    return true;
+}
+
+size_t message_segment::get_header_length() const
+{
+    return compact ? compact_header_layout::LENGTH : header_layout::LENGTH;
+}
+
+void message_segment::write_header(uint8_t *segment) const
+{
+    if (compact)
+    {
+        compact_header_layout::write<compact_flags_field>(
+            segment, COMPACT_HEADER_MARKER | (flags & MESSAGE_FLAGS_MASK));
+        compact_header_layout::write<connection_id_field>(
+            segment, (flags & COMPRESSED_MASK) | connection_id);
+        compact_header_layout::write<compact_sequence_num_field>(segment, sequence_num);
+        compact_header_layout::write<compact_checksum_field>(segment, checksum);
+        return;
+    }
+
+    header_layout::write<source_port_field>(segment, source_port);
+    header_layout::write<destination_port_field>(segment, destination_port);
+    header_layout::write<sequence_num_field>(segment, sequence_num);
+    header_layout::write<checksum_field>(segment, checksum);
+    header_layout::write<flags_field>(segment, flags);
+}
+
+// note: no options are sent as an empty payload
+inline_buffer message_segment::encode_connection_options(
+    uint8_t connection_options, uint8_t connection_id, uint16_t window_size)
+{
+    inline_buffer payload;
+    if (connection_options == 0)
+    {
+        return payload;
+    }
+
+    payload.push_back(connection_options);
+    if (connection_options & compact_header)
+    {
+        payload.push_back(connection_id);
+    }
+
+    if (connection_options & connection_option::window_size)
+    {
+        payload.push_back(static_cast<uint8_t>(window_size >> 8));
+        payload.push_back(static_cast<uint8_t>(window_size));
+    }
+
+    return payload;
+}
@@ -5,31 +5,80 @@
 #include <iterator>
 #include <memory>
 #include <numeric>
+#include <utility>
 #include <vector>
 
+#include "field_layout.h"
+#include "frame_buffer.h"
+#include "frame_buffer_pool.h"
 #include "frame_data.h"
+#include "inline_buffer.h"
+#include "pool_allocator.h"
+#include "segment_view.h"
+#include "selective_ack.h"
 #include "uart_frame.h"
 #include "util.h"
 
 // TODO: consistency: s/sequence_num/sequence_number/
 
+// received segments don't copy their payload out of the frame it arrived in, see create_received()
+//  - payloads of segments created here are held inline, a segment is a single allocation taken
+//  from a block_pool
+//  - note: copies of a segment always own their payload
 class message_segment
 {
 public:
     static const uint16_t CHECKSUM_TARGET;
     static const uint8_t MESSAGE_FLAGS_MASK;
+    static const uint8_t MESSAGE_TYPE_MASK;
+    static const uint8_t COMPRESSED_MASK;
     static const size_t MESSAGE_TYPE_SHIFT_BITS;
     static const size_t SOURCE_PORT_OFFSET;
     static const size_t DESTINATION_PORT_OFFSET;
     static const size_t SEQUENCE_NUM_OFFSET;
     static const size_t CHECKSUM_OFFSET;
-    // note: 4 MSB of flags field reserved for type value, 4 LSB for flags value
+    // note: MSB of flags field marks a compressed message, next 3 bits hold the type value and the
+    // 4 LSB the flags value
     static const size_t FLAGS_OFFSET;
     static const size_t MESSAGE_OFFSET;
     static const size_t MIN_SEGMENT_LENGTH;
     static const size_t MAX_SEGMENT_LENGTH;
+    // compact header: stream segments of a connection that negotiated it on SYN carry the ID the
+    // receiver assigned to the connection instead of both ports
+    //  - layout: [marker (4 bits) | flags (4 bits)][compressed (1 bit) | connection ID (7 bits)]
+    //  [sequence num (2)][checksum (2)]
+    //  - note: ports from MIN_RESERVED_PORT up are never assigned, so a full header (which starts
+    //  with the source port) never starts with the marker
+    static const uint8_t COMPACT_HEADER_MARKER;
+    static const uint8_t CONNECTION_ID_MASK;
+    static const uint16_t MIN_RESERVED_PORT;
+    static const size_t COMPACT_FLAGS_OFFSET;
+    static const size_t CONNECTION_ID_OFFSET;
+    static const size_t COMPACT_SEQUENCE_NUM_OFFSET;
+    static const size_t COMPACT_CHECKSUM_OFFSET;
+    static const size_t COMPACT_MESSAGE_OFFSET;
+    static const size_t MIN_COMPACT_SEGMENT_LENGTH;
+    static const size_t MAX_COMPACT_SEGMENT_LENGTH;
     static const std::vector<uint8_t> EMPTY_PAYLOAD;
 
+    typedef field<uint16_t, 0> source_port_field;
+    typedef next_field<source_port_field, uint16_t> destination_port_field;
+    typedef next_field<destination_port_field, uint16_t> sequence_num_field;
+    typedef next_field<sequence_num_field, uint16_t> checksum_field;
+    typedef next_field<checksum_field, uint8_t> flags_field;
+    // message follows
+    typedef field_layout<source_port_field, destination_port_field, sequence_num_field,
+        checksum_field, flags_field>
+        header_layout;
+    typedef field<uint8_t, 0> compact_flags_field;
+    typedef next_field<compact_flags_field, uint8_t> connection_id_field;
+    typedef next_field<connection_id_field, uint16_t> compact_sequence_num_field;
+    typedef next_field<compact_sequence_num_field, uint16_t> compact_checksum_field;
+    // message follows
+    typedef field_layout<compact_flags_field, connection_id_field, compact_sequence_num_field,
+        compact_checksum_field>
+        compact_header_layout;
+
     enum type : uint8_t
     {
         stream_segment = 0,
@@ -46,28 +95,79 @@ public:
         fin = 0x8,
     };
 
+    // options requested in the payload of a SYN, the SYNACK echoes the ones that were accepted
+    enum connection_option : uint8_t
+    {
+        compression = 0x1,    // stream payloads may be lz77_codec compressed, see reliable_channel
+        // followed by the connection ID the sender of the SYN/SYNACK wants to be addressed with
+        compact_header = 0x2,
+        // parity segments may be sent along with stream data, see reliable_channel
+        forward_error_correction = 0x4,
+        // followed by the max window size of the sender of the SYN (big endian, after the
+        // connection ID if there is one), the SYNACK echoes the window size both ends use
+        window_size = 0x8,
+    };
+
     // TODO: will need to have field for final_destination and treat tx_request's destination field
     // as next-hop field to implement routing
     message_segment(uint16_t source_port, uint16_t destination_port, uint16_t sequence_num,
-        uint8_t type, uint8_t flags, const std::vector<uint8_t> &message);
+        uint8_t type, uint8_t flags, const inline_buffer &message, bool compressed = false);
     message_segment(const std::vector<uint8_t> &segment);
+    message_segment(const message_segment &other);
 
-    static std::shared_ptr<message_segment> create_syn(
-        uint16_t source_port, uint16_t destination_port);
-    static std::shared_ptr<message_segment> create_synack(
-        uint16_t source_port, uint16_t destination_port);
+    message_segment &operator=(const message_segment &other);
+
+    // segment as received, frame is kept for as long as the segment is around and the payload is
+    // read in place, view has to be parsed from frame
+    //  - note: allocated along with the reference count, a single allocation per received segment
+    static std::shared_ptr<message_segment> create_received(
+        frame_buffer_pool::unique_buffer frame, const segment_view &view);
+    // block_pool create_received() allocates from
+    static block_pool_stats get_received_pool_stats();
+
+    // note: connection_id is only sent with the compact_header option, window_size only with the
+    // window_size option
+    static std::shared_ptr<message_segment> create_syn(uint16_t source_port,
+        uint16_t destination_port, uint8_t connection_options = 0, uint8_t connection_id = 0,
+        uint16_t window_size = 0);
+    static std::shared_ptr<message_segment> create_synack(uint16_t source_port,
+        uint16_t destination_port, uint8_t connection_options = 0, uint8_t connection_id = 0,
+        uint16_t window_size = 0);
     static std::shared_ptr<message_segment> create_ack(
         uint16_t source_port, uint16_t destination_port, uint16_t sequence_number = 0);
+    static std::shared_ptr<message_segment> create_selective_ack(
+        uint16_t source_port, uint16_t destination_port, const selective_ack &ack);
+    // ACK piggybacked on a data segment, ack block is followed by payload
+    static std::shared_ptr<message_segment> create_selective_ack(uint16_t source_port,
+        uint16_t destination_port, const selective_ack &ack, uint16_t sequence_number,
+        const std::vector<uint8_t> &payload, bool compressed = false);
     static std::shared_ptr<message_segment> create_rst(
         uint16_t source_port, uint16_t destination_port);
+    // sequence_number of a stream FIN is the one following the last data segment
     static std::shared_ptr<message_segment> create_fin(
-        uint16_t source_port, uint16_t destination_port);
+        uint16_t source_port, uint16_t destination_port, uint16_t sequence_number = 0);
+    static std::shared_ptr<message_segment> create_finack(
+        uint16_t source_port, uint16_t destination_port, uint16_t sequence_number = 0);
+    // forward error correction parity (flags syn|fin, never sent on a handshake) of the block of
+    // stream segments starting at first_sequence_number, payload is an encoded xor_parity
+    static std::shared_ptr<message_segment> create_parity(uint16_t source_port,
+        uint16_t destination_port, uint16_t first_sequence_number,
+        const std::vector<uint8_t> &parity);
+
+    // switches a stream segment over to the compact header, connection_id is the one assigned by
+    // the receiver
+    void set_connection_id(uint8_t connection_id);
 
+    // note: both 0 for compact segments, look up the connection by connection ID instead
     uint16_t get_source_port() const;
     uint16_t get_destination_port() const;
     uint16_t get_sequence_num() const;
     uint16_t get_checksum() const;
     uint16_t compute_checksum() const;
+    // address is the connection ID of a compact segment and the sum of both ports otherwise,
+    // message_sum the 16 bit sum of the payload bytes
+    static uint16_t compute_checksum(
+        uint16_t address, uint16_t sequence_num, uint8_t flags, uint16_t message_sum);
     uint8_t get_message_type() const;
     uint8_t get_message_flags() const;
     bool flags_empty() const;
@@ -76,18 +176,53 @@ public:
     bool is_syn() const;
     bool is_fin() const;
     bool is_synack() const;
-    const std::vector<uint8_t> &get_message() const;
+    bool is_finack() const;
+    bool is_parity() const;
+    // note: only applies to the payload, an ACK block preceding it is never compressed
+    bool is_compressed() const;
+    bool is_compact() const;
+    uint8_t get_connection_id() const;
+    // connection options of a SYN or SYNACK
+    uint8_t get_connection_options() const;
+    // connection ID offered along with the compact_header option of a SYN or SYNACK
+    uint8_t get_offered_connection_id() const;
+    // window size offered along with the window_size option of a SYN or SYNACK, 0 if there is none
+    uint16_t get_offered_window_size() const;
+    const uint8_t *get_message_begin() const;
+    const uint8_t *get_message_end() const;
+    size_t get_message_length() const;
+    // copy of the payload, get_message_begin() and get_message_end() read it in place
+    std::vector<uint8_t> get_message() const;
 
     bool operator<(const message_segment &rhs) const;
     operator std::vector<uint8_t>() const;
+    // appends the encoded segment to buffer, same bytes as the vector conversion, false if it
+    // doesn't fit
+    bool write_to(frame_buffer &buffer) const;
 
 private:
+    struct received_segment;
+
+    // payload is viewed in place, see create_received()
+    explicit message_segment(const segment_view &view);
+
+    static inline_buffer encode_connection_options(
+        uint8_t connection_options, uint8_t connection_id, uint16_t window_size);
+
+    size_t get_header_length() const;
+    // writes the full or compact header to the get_header_length() bytes at segment
+    void write_header(uint8_t *segment) const;
+
     uint16_t source_port;
     uint16_t destination_port;
     uint16_t sequence_num;
     uint16_t checksum;
-    uint8_t flags;    // bits 0-3: message flags, bits 4-7: message type
-    std::vector<uint8_t> message;
+    uint8_t flags;    // bits 0-3: message flags, bits 4-6: message type, bit 7: compressed
+    bool compact;
+    uint8_t connection_id;
+    inline_buffer message;    // payload, unless it is viewed in place in a received frame
+    const uint8_t *message_begin;
+    const uint8_t *message_end;
 };
 
 #endif
@@ -1,10 +1,14 @@
 #include <cstdint>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include <gtest/gtest.h>
 
+#include "frame_buffer.h"
+#include "frame_buffer_pool.h"
 #include "message_segment.h"
+#include "segment_view.h"
 
 namespace message_segment_test
 {
@@ -37,6 +41,8 @@ namespace message_segment_test
     {
         ASSERT_EQ(0xffff, message_segment::CHECKSUM_TARGET);
         ASSERT_EQ(0x0f, message_segment::MESSAGE_FLAGS_MASK);
+        ASSERT_EQ(0x07, message_segment::MESSAGE_TYPE_MASK);
+        ASSERT_EQ(0x80, message_segment::COMPRESSED_MASK);
         ASSERT_EQ(4, message_segment::MESSAGE_TYPE_SHIFT_BITS);
 
         ASSERT_EQ(0, message_segment::SOURCE_PORT_OFFSET);
@@ -47,6 +53,16 @@ namespace message_segment_test
         ASSERT_EQ(9, message_segment::MESSAGE_OFFSET);
         ASSERT_EQ(9, message_segment::MIN_SEGMENT_LENGTH);
         ASSERT_EQ(91, message_segment::MAX_SEGMENT_LENGTH);
+        ASSERT_EQ(0xf0, message_segment::COMPACT_HEADER_MARKER);
+        ASSERT_EQ(0x7f, message_segment::CONNECTION_ID_MASK);
+        ASSERT_EQ(0xf000, message_segment::MIN_RESERVED_PORT);
+        ASSERT_EQ(0, message_segment::COMPACT_FLAGS_OFFSET);
+        ASSERT_EQ(1, message_segment::CONNECTION_ID_OFFSET);
+        ASSERT_EQ(2, message_segment::COMPACT_SEQUENCE_NUM_OFFSET);
+        ASSERT_EQ(4, message_segment::COMPACT_CHECKSUM_OFFSET);
+        ASSERT_EQ(6, message_segment::COMPACT_MESSAGE_OFFSET);
+        ASSERT_EQ(6, message_segment::MIN_COMPACT_SEGMENT_LENGTH);
+        ASSERT_EQ(94, message_segment::MAX_COMPACT_SEGMENT_LENGTH);
         ASSERT_EQ(std::vector<uint8_t>(), message_segment::EMPTY_PAYLOAD);
 
         ASSERT_EQ(sizeof(uint8_t), sizeof(message_segment::type));
@@ -60,6 +76,12 @@ namespace message_segment_test
         ASSERT_EQ(0x2, message_segment::flag::rst);
         ASSERT_EQ(0x4, message_segment::flag::syn);
         ASSERT_EQ(0x8, message_segment::flag::fin);
+
+        ASSERT_EQ(sizeof(uint8_t), sizeof(message_segment::connection_option));
+        ASSERT_EQ(0x1, message_segment::connection_option::compression);
+        ASSERT_EQ(0x2, message_segment::connection_option::compact_header);
+        ASSERT_EQ(0x4, message_segment::connection_option::forward_error_correction);
+        ASSERT_EQ(0x8, message_segment::connection_option::window_size);
     }
 
     TEST(MessageSegmentTest, CreateSynTest)
@@ -69,6 +91,64 @@ namespace message_segment_test
         ASSERT_EQ(message_segment::flag::syn, msg->get_message_flags());
     }
 
+    TEST(MessageSegmentTest, CreateSynConnectionOptionsTest)
+    {
+        ASSERT_EQ(0, message_segment::create_syn(any_source_port, any_destination_port)
+                         ->get_connection_options());
+
+        std::shared_ptr<message_segment> msg = message_segment::create_syn(any_source_port,
+            any_destination_port, message_segment::connection_option::compression);
+        ASSERT_TRUE(msg->is_syn());
+        ASSERT_EQ(message_segment::connection_option::compression, msg->get_connection_options());
+
+        msg = message_segment::create_synack(any_source_port, any_destination_port,
+            message_segment::connection_option::compression);
+        ASSERT_TRUE(msg->is_synack());
+        ASSERT_EQ(message_segment::connection_option::compression, msg->get_connection_options());
+        ASSERT_EQ(0, msg->get_offered_connection_id());
+    }
+
+    TEST(MessageSegmentTest, CreateSynConnectionIdTest)
+    {
+        std::shared_ptr<message_segment> msg = message_segment::create_syn(any_source_port,
+            any_destination_port, message_segment::connection_option::compact_header, 42);
+        ASSERT_EQ(std::vector<uint8_t>({message_segment::connection_option::compact_header, 42}),
+            msg->get_message());
+        ASSERT_EQ(42, msg->get_offered_connection_id());
+
+        // ID is only sent along with the option
+        msg = message_segment::create_synack(any_source_port, any_destination_port,
+            message_segment::connection_option::compression, 42);
+        ASSERT_EQ(std::vector<uint8_t>({message_segment::connection_option::compression}),
+            msg->get_message());
+        ASSERT_EQ(0, msg->get_offered_connection_id());
+    }
+
+    TEST(MessageSegmentTest, CreateSynWindowSizeTest)
+    {
+        std::shared_ptr<message_segment> msg = message_segment::create_syn(any_source_port,
+            any_destination_port, message_segment::connection_option::window_size, 0, 0x0102);
+        ASSERT_EQ(
+            std::vector<uint8_t>({message_segment::connection_option::window_size, 0x01, 0x02}),
+            msg->get_message());
+        ASSERT_EQ(0x0102, msg->get_offered_window_size());
+
+        // follows the connection ID
+        msg = message_segment::create_synack(any_source_port, any_destination_port,
+            message_segment::connection_option::compact_header
+                | message_segment::connection_option::window_size,
+            42, 512);
+        ASSERT_EQ(42, msg->get_offered_connection_id());
+        ASSERT_EQ(512, msg->get_offered_window_size());
+
+        // window size is only sent along with the option
+        msg = message_segment::create_syn(any_source_port, any_destination_port,
+            message_segment::connection_option::compression, 0, 512);
+        ASSERT_EQ(std::vector<uint8_t>({message_segment::connection_option::compression}),
+            msg->get_message());
+        ASSERT_EQ(0, msg->get_offered_window_size());
+    }
+
     TEST(MessageSegmentTest, CreateSynAckTest)
     {
         std::shared_ptr<message_segment> msg
@@ -84,6 +164,29 @@ namespace message_segment_test
         ASSERT_EQ(message_segment::flag::ack, msg->get_message_flags());
     }
 
+    TEST(MessageSegmentTest, CreateSelectiveAckTest)
+    {
+        selective_ack ack(any_sequence_number, 1, std::vector<uint8_t>{0x80});
+        std::shared_ptr<message_segment> msg = message_segment::create_selective_ack(
+            any_source_port, any_destination_port, ack);
+        ASSERT_TRUE(msg->is_ack());
+        ASSERT_EQ(static_cast<std::vector<uint8_t>>(ack), msg->get_message());
+    }
+
+    TEST(MessageSegmentTest, CreatePiggybackedSelectiveAckTest)
+    {
+        selective_ack ack(any_sequence_number, 1);
+        std::vector<uint8_t> payload{0x01, 0x02};
+        std::shared_ptr<message_segment> msg = message_segment::create_selective_ack(
+            any_source_port, any_destination_port, ack, any_sequence_number + 1, payload);
+        ASSERT_TRUE(msg->is_ack());
+        ASSERT_EQ(any_sequence_number + 1, msg->get_sequence_num());
+
+        std::vector<uint8_t> expected = ack;
+        expected.insert(expected.end(), payload.begin(), payload.end());
+        ASSERT_EQ(expected, msg->get_message());
+    }
+
     TEST(MessageSegmentTest, CreateFinTest)
     {
         std::shared_ptr<message_segment> msg
@@ -91,6 +194,25 @@ namespace message_segment_test
         ASSERT_EQ(message_segment::flag::fin, msg->get_message_flags());
     }
 
+    TEST(MessageSegmentTest, CreateFinAckTest)
+    {
+        std::shared_ptr<message_segment> msg = message_segment::create_finack(
+            any_source_port, any_destination_port, any_sequence_number);
+        ASSERT_EQ(
+            message_segment::flag::fin | message_segment::flag::ack, msg->get_message_flags());
+        ASSERT_EQ(any_sequence_number, msg->get_sequence_num());
+    }
+
+    TEST(MessageSegmentTest, CreateParityTest)
+    {
+        std::shared_ptr<message_segment> msg = message_segment::create_parity(
+            any_source_port, any_destination_port, any_sequence_number, any_message);
+        ASSERT_EQ(
+            message_segment::flag::syn | message_segment::flag::fin, msg->get_message_flags());
+        ASSERT_EQ(any_sequence_number, msg->get_sequence_num());
+        ASSERT_EQ(any_message, msg->get_message());
+    }
+
     TEST(MessageSegmentTest, GetSourcePortTest)
     {
         std::shared_ptr<message_segment> msg
@@ -182,6 +304,94 @@ namespace message_segment_test
         ASSERT_TRUE(msg->is_synack());
     }
 
+    TEST(MessageSegmentTest, IsFinAckTest)
+    {
+        std::shared_ptr<message_segment> msg
+            = message_segment::create_finack(any_source_port, any_destination_port);
+        ASSERT_TRUE(msg->is_finack());
+        ASSERT_FALSE(msg->is_fin());
+        ASSERT_FALSE(msg->is_ack());
+    }
+
+    TEST(MessageSegmentTest, IsParityTest)
+    {
+        std::shared_ptr<message_segment> msg = message_segment::create_parity(
+            any_source_port, any_destination_port, any_sequence_number, any_message);
+        ASSERT_TRUE(msg->is_parity());
+        ASSERT_FALSE(msg->is_syn());
+        ASSERT_FALSE(msg->is_fin());
+
+        // flags survive the compact header
+        msg->set_connection_id(3);
+        message_segment parsed(static_cast<std::vector<uint8_t>>(*msg));
+        ASSERT_TRUE(parsed.is_parity());
+        ASSERT_FALSE(get_valid_message_segment().is_parity());
+    }
+
+    TEST(MessageSegmentTest, IsCompressedTest)
+    {
+        message_segment msg(any_destination_port, any_destination_port, any_sequence_number,
+            message_segment::type::datagram_segment, any_flags, any_message, true);
+        ASSERT_TRUE(msg.is_compressed());
+        ASSERT_EQ(message_segment::type::datagram_segment, msg.get_message_type());
+        ASSERT_EQ(any_flags, msg.get_message_flags());
+        ASSERT_EQ(msg.compute_checksum(), msg.get_checksum());
+
+        message_segment parsed(static_cast<std::vector<uint8_t>>(msg));
+        ASSERT_TRUE(parsed.is_compressed());
+        ASSERT_FALSE(get_valid_message_segment().is_compressed());
+    }
+
+    TEST(MessageSegmentTest, CompactHeaderTest)
+    {
+        message_segment msg(any_destination_port, any_destination_port, any_sequence_number,
+            message_segment::type::stream_segment, message_segment::flag::ack, any_message, true);
+        ASSERT_FALSE(msg.is_compact());
+
+        msg.set_connection_id(0x15);
+        ASSERT_TRUE(msg.is_compact());
+        ASSERT_EQ(0x15, msg.get_connection_id());
+        ASSERT_EQ(msg.compute_checksum(), msg.get_checksum());
+
+        std::vector<uint8_t> encoded = msg;
+        ASSERT_EQ(message_segment::MIN_COMPACT_SEGMENT_LENGTH + any_message.size(), encoded.size());
+        ASSERT_EQ(0xf1, encoded[0]);
+        ASSERT_EQ(0x95, encoded[1]);
+
+        message_segment parsed(encoded);
+        ASSERT_TRUE(parsed.is_compact());
+        ASSERT_EQ(0x15, parsed.get_connection_id());
+        ASSERT_EQ(0, parsed.get_source_port());
+        ASSERT_EQ(0, parsed.get_destination_port());
+        ASSERT_EQ(any_sequence_number, parsed.get_sequence_num());
+        ASSERT_EQ(message_segment::type::stream_segment, parsed.get_message_type());
+        ASSERT_TRUE(parsed.is_ack());
+        ASSERT_TRUE(parsed.is_compressed());
+        ASSERT_EQ(any_message, parsed.get_message());
+        ASSERT_EQ(parsed.compute_checksum(), parsed.get_checksum());
+    }
+
+    TEST(MessageSegmentTest, CompactHeaderChecksumCoversConnectionIdTest)
+    {
+        message_segment msg(any_destination_port, any_destination_port, any_sequence_number,
+            message_segment::type::stream_segment, message_segment::flag::none, any_message);
+        msg.set_connection_id(1);
+
+        std::vector<uint8_t> encoded = msg;
+        encoded[message_segment::CONNECTION_ID_OFFSET] = 2;
+        message_segment parsed(encoded);
+        ASSERT_NE(parsed.compute_checksum(), parsed.get_checksum());
+    }
+
+    TEST(MessageSegmentTest, FullHeaderIsNotCompactTest)
+    {
+        message_segment msg(message_segment::MIN_RESERVED_PORT - 1, any_destination_port,
+            any_sequence_number, any_type, any_flags, any_message);
+        message_segment parsed(static_cast<std::vector<uint8_t>>(msg));
+        ASSERT_FALSE(parsed.is_compact());
+        ASSERT_EQ(message_segment::MIN_RESERVED_PORT - 1, parsed.get_source_port());
+    }
+
     TEST(MessageSegmentTest, GetMessageTest)
     {
         message_segment msg = get_valid_message_segment();
@@ -204,4 +414,64 @@ namespace message_segment_test
             std::vector<uint8_t>({0xff, 0xff, 0x00, 0xab, 0x00, 0x7b, 0xfd, 0x16, 0x04, 0x74, 0x65,
                 0x73, 0x74}));
     }
+
+    TEST(MessageSegmentTest, WriteToTest)
+    {
+        message_segment msg = get_valid_message_segment();
+        message_segment compact = get_valid_message_segment();
+        compact.set_connection_id(0x05);
+
+        for (auto &segment : {msg, compact})
+        {
+            frame_buffer buffer;
+            ASSERT_TRUE(segment.write_to(buffer));
+            ASSERT_EQ(static_cast<std::vector<uint8_t>>(segment),
+                std::vector<uint8_t>(buffer.begin(), buffer.end()));
+        }
+
+        frame_buffer full;
+        full.append(full.get_tailroom() - 1);
+        ASSERT_FALSE(msg.write_to(full));
+    }
+
+    TEST(MessageSegmentTest, CreateReceivedTest)
+    {
+        frame_buffer_pool pool;
+        auto frame = pool.acquire_unique();
+        frame->clear(0);
+        // note: any_source_port is reserved, a header starting with it reads as a compact one
+        uint16_t source_port = 0x1234;
+        message_segment segment(source_port, any_destination_port, any_sequence_number, any_type,
+            any_flags, any_message);
+        ASSERT_TRUE(segment.write_to(*frame));
+        const uint8_t *payload = frame->end() - any_message.size();
+
+        segment_view view;
+        ASSERT_TRUE(segment_view::parse(frame->begin(), frame->end(), view));
+        auto received = message_segment::create_received(std::move(frame), view);
+        ASSERT_EQ(source_port, received->get_source_port());
+        ASSERT_EQ(any_sequence_number, received->get_sequence_num());
+        ASSERT_EQ(received->compute_checksum(), received->get_checksum());
+        ASSERT_EQ(any_message, received->get_message());
+        ASSERT_EQ(payload, &*received->get_message_begin());
+
+        // the frame goes back to the pool along with the segment, copies own their payload
+        message_segment copy = *received;
+        received.reset();
+        ASSERT_EQ(1, pool.get_idle_count());
+        ASSERT_NE(payload, &*copy.get_message_begin());
+        ASSERT_EQ(any_message, copy.get_message());
+        ASSERT_EQ(copy.compute_checksum(), copy.get_checksum());
+    }
+
+    TEST(MessageSegmentTest, CopyAssignmentTest)
+    {
+        message_segment segment = get_valid_message_segment_empty_message();
+        {
+            message_segment other = get_valid_message_segment();
+            segment = other;
+        }
+        ASSERT_EQ(any_message, segment.get_message());
+        ASSERT_EQ(get_valid_message_segment().get_checksum(), segment.get_checksum());
+    }
 }
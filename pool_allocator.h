@@ -0,0 +1,69 @@
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "block_pool.h"
+
+// allocator drawing from block_pool::get<Tag>(), meant for std::allocate_shared() (object and
+// control block in one pooled block), see allocate_pooled()
+//  - rebinding keeps Tag, every allocation made through one tag comes from the same pool
+//  - note: allocations of different sizes under one tag only share the pool up to the size of the
+//  first one, tag each call site that allocates something else
+template <typename T, typename Tag = T>
+class pool_allocator
+{
+public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef pool_allocator<U, Tag> other;
+    };
+
+    pool_allocator() = default;
+
+    template <typename U>
+    pool_allocator(const pool_allocator<U, Tag> &)
+    {
+    }
+
+    T *allocate(size_t n)
+    {
+        return static_cast<T *>(block_pool::get<Tag>().allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, size_t n)
+    {
+        block_pool::get<Tag>().deallocate(p, n * sizeof(T));
+    }
+
+    static block_pool_stats get_stats()
+    {
+        return block_pool::get<Tag>().get_stats();
+    }
+};
+
+template <typename T, typename U, typename Tag>
+bool operator==(const pool_allocator<T, Tag> &, const pool_allocator<U, Tag> &)
+{
+    return true;
+}
+
+template <typename T, typename U, typename Tag>
+bool operator!=(const pool_allocator<T, Tag> &, const pool_allocator<U, Tag> &)
+{
+    return false;
+}
+
+// std::make_shared() with the object and its control block taken from T's pool
+template <typename T, typename... Args>
+std::shared_ptr<T> allocate_pooled(Args &&... args)
+{
+    return std::allocate_shared<T>(pool_allocator<T>(), std::forward<Args>(args)...);
+}
+
+#endif
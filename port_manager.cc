@@ -1,7 +1,8 @@
 #include "port_manager.h"
 
 const uint16_t port_manager::MAX_LISTEN_PORT = std::numeric_limits<uint16_t>::max() / 2;
-const uint16_t port_manager::MAX_EPHEMERAL_PORT = std::numeric_limits<uint16_t>::max();
+// note: everything past this is reserved, see message_segment::MIN_RESERVED_PORT
+const uint16_t port_manager::MAX_EPHEMERAL_PORT = 0xefff;
 
 port_manager::port_manager()
     : mt(rd()), dist(MAX_LISTEN_PORT + 1, MAX_EPHEMERAL_PORT)
@@ -1,336 +1,1231 @@
 #include "reliable_channel.h"
 
-reliable_channel::reliable_channel(connection_tuple connection_key, int communication_socket_fd,
-    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<std::vector<uint8_t>>>> write_queue,
+const std::chrono::microseconds reliable_channel::RETRANSMIT_TIMER_RESOLUTION(5000);
+const uint16_t reliable_channel::FAST_RETRANSMIT_THRESHOLD = 3;
+const uint16_t reliable_channel::MAX_FIN_RETRANSMISSIONS = 4;
+const int reliable_channel::LINGER_RETRANSMISSION_TIMEOUTS = 2;
+const size_t reliable_channel::COMPRESSION_READ_FACTOR = 4;
+const double reliable_channel::LOSS_ESTIMATE_GAIN = 1.0 / 32;
+const double reliable_channel::MIN_FEC_LOSS_RATE = 0.01;
+const double reliable_channel::FEC_LOSSES_PER_BLOCK = 0.5;
+const uint8_t reliable_channel::MIN_FEC_BLOCK_LENGTH = 2;
+const std::chrono::milliseconds reliable_channel::PARITY_FLUSH_DELAY(10);
+const std::chrono::milliseconds reliable_channel::NO_RECEIVE_TIMEOUT
+    = std::chrono::milliseconds::max();
+
+std::string reliable_channel_stats::to_string() const
+{
+    std::ostringstream oss;
+    oss << "sent: " << segments_sent << ", retransmitted: " << segments_retransmitted
+        << ", fast retransmits: " << fast_retransmits << ", received: " << segments_received
+        << ", rtt samples: " << rtt_samples << ", acks sent: " << acks_sent
+        << ", acks piggybacked: " << acks_piggybacked << ", window probes: " << window_probes
+        << ", payload bytes: " << payload_bytes_sent << " (" << payload_bytes_encoded
+        << " encoded)"
+        << ", parity sent: " << parity_segments_sent << ", recovered: " << segments_recovered
+        << ", fec block: " << static_cast<int>(fec_block_length)
+        << ", peer rwnd: " << peer_receive_window << ", cwnd: " << congestion_window
+        << ", srtt: " << smoothed_rtt.count() << "us, rttvar: " << rtt_variance.count()
+        << "us, rto: " << retransmission_timeout.count() << "us";
+    return oss.str();
+}
+
+reliable_channel::reliable_channel(const beehive_config &config,
+    std::shared_ptr<timer_wheel> timers, std::shared_ptr<socket_reactor> reactor,
+    connection_tuple connection_key, int communication_socket_fd,
+    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<frame_buffer>>> write_queue,
     std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<message_segment>>>
         incoming_segment_queue)
-    : connection_key(connection_key), communication_socket_fd(communication_socket_fd),
-      write_queue(write_queue), incoming_segment_queue(incoming_segment_queue), window_base(0),
-      next_sequence_number(0), window_size(25), sequence_number_wrapped(false),
-      channel_close_requested(false), sending(false), fin_received(false),
-      retransmission_timeout_int_ms(500), retransmission_timeout(retransmission_timeout_int_ms),
-      segment_queue_read_timeout(25)
+    : timers(timers), reactor(reactor), connection_key(connection_key),
+      communication_socket_fd(communication_socket_fd), write_queue(write_queue),
+      incoming_segment_queue(incoming_segment_queue),
+      window_size(config.get_max_window_size()),
+      send_window_base(0), next_sequence_number(0), congestion(window_size),
+      channel_close_requested(false), outgoing_closing(false), outgoing_closed(false),
+      coalescing(config.get_coalesce_by_default()), coalesce_delay(config.get_coalesce_delay()),
+      compressing(false), compression_read_length(0), compact_header(false), peer_connection_id(0),
+      segment_payload_length(message_segment::MAX_SEGMENT_LENGTH), fec_enabled(false),
+      loss_estimate(0), fec_block_length(0), fec_block_first(0), sending(false),
+      retransmit_timer_id(timer_wheel::INVALID_TIMER_ID), fin_sent(false), fin_sequence_number(0),
+      fin_retransmit_count(0),
+      peer_cumulative_ack(0), peer_receive_window(window_size), send_window(window_size),
+      receive_window_base(0), delivery_base(0), fin_received(false), incoming_closed(false),
+      aborted(false), keepalive_interval(config.get_keepalive_interval()),
+      idle_timeout(config.get_idle_timeout()),
+      receive_window(window_size), fec_history(0), last_advertised_window(window_size),
+      ack_frequency(config.get_ack_frequency()),
+      ack_delay(config.get_ack_delay()), pending_ack(no_ack), unacked_segments(0), stats()
 {
+    stats.peer_receive_window = peer_receive_window;
+    stats.congestion_window = congestion.get_window();
+    stats.retransmission_timeout = rtt.get_retransmission_timeout();
 }
 
-void reliable_channel::start_sending()
+void reliable_channel::start()
 {
     sending = true;
-    std::thread timer(&reliable_channel::retransmit_timer, this);
+    last_received = std::chrono::steady_clock::now();
+    keepalive_deadline = last_received + keepalive_interval;
+    schedule_retransmit_timer(get_stats().retransmission_timeout);
 
-    // TODO: verify how often send loop is happening
-    // TODO: might be race condition here, try opening channel, sleep and then send small
-    // payload, might finish loop before actually tx-ing payload (or send channel_close_request
-    // before segment_buffer has a chance to be populated?)
-    while (!(segment_buffer.empty() && channel_close_requested))
+    // client socket readiness only needs to wake the channel up, see receive_segment
+    auto segment_queue = incoming_segment_queue;
+    reactor->try_add(
+        communication_socket_fd, [segment_queue](uint32_t) { segment_queue->push(nullptr); });
+
+    while (sending || !incoming_closed)    // TODO: what other conditions should signal stop?
     {
-        // TODO: small sleep here?
+        arm_client_socket();
+        receive_segments(get_receive_timeout());
+        if (aborted)
+        {
+            break;
+        }
+
+        // note: the peer's keepalives keep a connection that is merely idle alive
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_received >= idle_timeout)
+        {
+            LOG(connection_key.to_string(), " peer unresponsive, aborting channel");
+            abort_channel(true);
+            break;
+        }
+
+        if (now >= keepalive_deadline)
+        {
+            keepalive_deadline = now + keepalive_interval;
+            send_selective_ack();
+        }
+
+        deliver_payloads();
         send_segments_in_window();
-        listen_for_acks();
+
+        // anything not piggybacked on outgoing data goes out as a standalone ACK
+        if (ack_due())
+        {
+            send_selective_ack();
+        }
+
+        if (send_complete())
+        {
+            send_fin();
+        }
+    }
+
+    if (pending_ack != no_ack && !aborted)
+    {
+        send_selective_ack();
     }
 
-    sending = false;    // TODO: does this need to be locked?
+    reactor->remove(communication_socket_fd);
 
-    // TODO: send fin here, wait for ack?
-    // TODO: verify might have to swap src/dest?
-    auto fin
-        = message_segment::create_fin(connection_key.destination_port, connection_key.source_port);
-    uart_frame frame(std::make_shared<tx_request_64_frame>(connection_key.source_address, *fin));
+    std::unique_lock<std::mutex> lock(access_lock);
+    timers->cancel(retransmit_timer_id);
+    lock.unlock();
 
-    // TODO: util::repeat
-    for (int i = 0; i < 10; ++i)
+    LOG(connection_key.to_string(), " channel stats: ", get_stats().to_string());
+}
+
+void reliable_channel::request_channel_close()
+{
+    channel_close_requested = true;
+    incoming_segment_queue->push(nullptr);
+}
+
+void reliable_channel::set_send_policy(send_policy policy)
+{
+    if (policy != default_send_policy)
     {
-        write_queue->push(std::make_shared<std::vector<uint8_t>>(frame));
+        coalescing = policy == coalesce;
     }
+}
 
-    timer.join();
+void reliable_channel::set_compression(bool enabled)
+{
+    compressing = enabled;
 }
 
-void reliable_channel::start_receiving()
+// note: fec_history is only sized to the window once FEC is enabled, most channels never need it
+void reliable_channel::set_forward_error_correction(bool enabled)
 {
-    receive_segments_in_window();
+    fec_enabled = enabled;
+    fec_history = sequence_ring<receive_slot>(enabled ? window_size : 0);
 }
 
-void reliable_channel::request_channel_close()
+void reliable_channel::set_peer_connection_id(uint8_t connection_id)
 {
-    channel_close_requested = true;
+    compact_header = true;
+    peer_connection_id = connection_id;
+    segment_payload_length = message_segment::MAX_COMPACT_SEGMENT_LENGTH;
 }
 
-// TODO: needed? need way for sender to indicate payload channel has closed as well as receiver
-// to receive fin and notify application layer
-//  -> will also need to send fin from receiver -> sender (when?)
-void reliable_channel::received_fin()
+reliable_channel_stats reliable_channel::get_stats() const
 {
-    fin_received = true;
+    std::lock_guard<std::mutex> lock(access_lock);
+    return stats;
 }
 
-void reliable_channel::retransmit_timed_out_unacked_segments()
+// returns duration until the oldest unacked segment times out (next retransmit timer interval)
+std::chrono::microseconds reliable_channel::retransmit_timed_out_unacked_segments()
 {
     std::lock_guard<std::mutex> lock(access_lock);
-    auto now = std::chrono::system_clock::now();
+    auto now = std::chrono::steady_clock::now();
+    auto oldest_sent = std::chrono::steady_clock::time_point::max();
+    auto outstanding = static_cast<uint16_t>(next_sequence_number - send_window_base);
+    bool timed_out = false;
 
-    // TODO: re-write retransmit_queue to be a map, when ack is received, remove segment from
-    // it, will speed up channel teardown
     // TODO: while (... && sending), no need to continue re-tx once tx complete
-    while (!retransmit_queue.empty())
+    for (uint16_t i = 0; i < outstanding; ++i)
     {
-        // TODO: make aliases vars instead of using .first, .second ?
-        std::pair<std::chrono::system_clock::time_point, uint16_t> segment_info
-            = retransmit_queue.top();
-        auto delta
-            = std::chrono::duration_cast<std::chrono::milliseconds>(now - segment_info.first);
+        auto sequence_number = static_cast<uint16_t>(send_window_base + i);
+        if (!send_window.contains(sequence_number))
+        {
+            continue;
+        }
 
-        if (delta < retransmission_timeout)
+        auto &slot = send_window.at(sequence_number);
+        if (now - slot.last_sent >= rtt.get_retransmission_timeout())
         {
-            return;
+            // back off once per timeout event rather than once per retransmitted segment
+            if (!timed_out)
+            {
+                rtt.backoff();
+
+                // a window probe timing out says nothing about congestion
+                if (in_window(peer_cumulative_ack, peer_receive_window, sequence_number))
+                {
+                    congestion.on_timeout();
+                }
+
+                stats.retransmission_timeout = rtt.get_retransmission_timeout();
+                stats.congestion_window = congestion.get_window();
+                timed_out = true;
+            }
+
+            slot.last_sent = now;
+            ++slot.retransmit_count;
+            ++stats.segments_retransmitted;
+
+            queue_frame(slot.frame);
         }
 
-        // ACK for segment received, remove from retransmit queue
-        if (segment_buffer.count(segment_info.second) == 0)
+        oldest_sent = std::min(oldest_sent, slot.last_sent);
+    }
+
+    // FIN is retransmitted until the peer answers with a FIN|ACK, backing off like data does
+    //  - note: only a few attempts, everything before the FIN was already ACK'd so giving up loses
+    //  nothing, it only means the peer already closed and our FIN|ACK got lost
+    if (fin_sent && sending)
+    {
+        if (now - fin_last_sent >= rtt.get_retransmission_timeout())
         {
-            retransmit_queue.pop();
-            continue;
+            if (fin_retransmit_count == MAX_FIN_RETRANSMISSIONS)
+            {
+                LOG(connection_key.to_string(), " FIN not acknowledged, closing");
+                sending = false;
+                incoming_segment_queue->push(nullptr);
+            }
+            else
+            {
+                rtt.backoff();
+                stats.retransmission_timeout = rtt.get_retransmission_timeout();
+                fin_last_sent = now;
+                ++fin_retransmit_count;
+                ++stats.segments_retransmitted;
+                queue_frame(fin_frame);
+            }
         }
 
-        retransmit_queue.pop();
-        retransmit_queue.push(
-            std::make_pair(std::chrono::system_clock::now(), segment_info.second));
-        auto segment = segment_buffer[segment_info.second];
-        uart_frame frame(
-            std::make_shared<tx_request_64_frame>(connection_key.source_address, *segment));
-        write_queue->push(std::make_shared<std::vector<uint8_t>>(frame));
+        oldest_sent = std::min(oldest_sent, fin_last_sent);
     }
+
+    if (oldest_sent == std::chrono::steady_clock::time_point::max())
+    {
+        return rtt.get_retransmission_timeout();
+    }
+
+    auto next_timeout = oldest_sent + rtt.get_retransmission_timeout() - now;
+    return std::max(std::chrono::duration_cast<std::chrono::microseconds>(next_timeout),
+        RETRANSMIT_TIMER_RESOLUTION);
+}
+
+void reliable_channel::schedule_retransmit_timer(const std::chrono::microseconds &timeout)
+{
+    std::weak_ptr<reliable_channel> channel = shared_from_this();
+    auto id = timers->schedule(timeout, [channel] { retransmitter(channel); });
+
+    std::lock_guard<std::mutex> lock(access_lock);
+    retransmit_timer_id = id;
 }
 
-void reliable_channel::retransmitter(
-    const boost::system::error_code & /*e*/, boost::asio::deadline_timer *timer)
+// note: runs on the timer_wheel thread, channel may have been torn down in the meantime
+void reliable_channel::retransmitter(std::weak_ptr<reliable_channel> channel)
 {
-    retransmit_timed_out_unacked_segments();
+    auto owner = channel.lock();
+    if (owner == nullptr)
+    {
+        return;
+    }
+
+    auto next_timeout = owner->retransmit_timed_out_unacked_segments();
 
-    if (sending)
+    if (owner->sending)
     {
-        timer->expires_at(
-            timer->expires_at() + boost::posix_time::milliseconds(retransmission_timeout_int_ms));
-        timer->async_wait(boost::bind(
-            &reliable_channel::retransmitter, this, boost::asio::placeholders::error, timer));
+        owner->schedule_retransmit_timer(next_timeout);
     }
 }
 
-void reliable_channel::retransmit_timer()
+// wraps segment in a tx_request addressed to the peer, the resulting buffer is never modified once
+// queued so the same frame can be pushed onto write_queue again for retransmissions
+std::shared_ptr<frame_buffer> reliable_channel::encode_frame(message_segment segment) const
 {
-    // TODO: can same io_service be used by multiple deadline_timers?
-    boost::asio::io_service io;
-    boost::asio::deadline_timer timer(
-        io, boost::posix_time::milliseconds(retransmission_timeout_int_ms));
-    timer.async_wait(boost::bind(
-        &reliable_channel::retransmitter, this, boost::asio::placeholders::error, &timer));
-    io.run();
+    if (compact_header)
+    {
+        segment.set_connection_id(peer_connection_id);
+    }
 
-    // TODO: need to prevent this thread from exiting? (no?) or keep ref to io_service to stop
-    // it/cleanup?
+    return uart_frame::encode_tx_request_64(connection_key.source_address, segment);
 }
 
-bool reliable_channel::in_window(uint16_t sequence_number) const
+// stamps frame with the time it's queued so the writer can tell how long it waited for the endpoint
+void reliable_channel::queue_frame(std::shared_ptr<frame_buffer> frame)
 {
-    uint16_t upper = static_cast<uint16_t>(window_base + window_size - 1);
-    return ((window_base < upper && (window_base <= sequence_number && sequence_number <= upper))
-        || (upper < window_base && (sequence_number <= upper || window_base <= sequence_number)));
+    if (frame != nullptr)
+    {
+        frame->set_queued_time(std::chrono::steady_clock::now());
+    }
+
+    write_queue->push(frame);
 }
 
-bool reliable_channel::in_previous_window(uint16_t sequence_number) const
+// note: relies on unsigned wraparound, i.e. sequence_number - base is the forward distance from
+// base to sequence_number in the sequence number space
+bool reliable_channel::in_window(uint16_t base, uint16_t size, uint16_t sequence_number)
 {
-    auto previous_window_base = static_cast<uint16_t>(window_base - window_size);
-    uint16_t upper = static_cast<uint16_t>(previous_window_base + window_size - 1);
-    return ((previous_window_base < upper
-                && (previous_window_base <= sequence_number && sequence_number <= upper))
-        || (upper < previous_window_base
-                && (sequence_number <= upper || previous_window_base <= sequence_number)));
+    return static_cast<uint16_t>(sequence_number - base) < size;
+}
 
-    // TODO: can factor out above logic so this method just invokes something like:
-    // return in_window(static_cast<uint16_t>(window_base - window_size), window_size,
-    // sequence_number);
+// sender side check for whether another segment fits in both the current congestion window and
+// the window last advertised by the peer
+bool reliable_channel::send_window_open() const
+{
+    std::lock_guard<std::mutex> lock(access_lock);
+    if (!in_window(send_window_base, congestion.get_window(), next_sequence_number))
+    {
+        return false;
+    }
+
+    // once everything outstanding is ACK'd, a closed peer window still lets a single probe segment
+    // out, its retransmissions keep asking until an ACK reopens the window
+    return in_window(peer_cumulative_ack, peer_receive_window, next_sequence_number)
+        || send_window.empty();
 }
 
-// segment_buffer is used to hold sent + un-ACK'd segments
-void reliable_channel::send_segments_in_window()
+// everything the client wrote has been ACK'd and the FIN is yet to be sent
+bool reliable_channel::send_complete() const
 {
-    bool sent_segments = false;
+    std::lock_guard<std::mutex> lock(access_lock);
+    return !fin_sent && outgoing_closed && send_window.empty();
+}
 
-    // send as many segments as window size allows
-    while (in_window(next_sequence_number))
+// send_window is used to hold sent + un-ACK'd segments
+void reliable_channel::send_segments_in_window()
+{
+    // send as many segments as congestion window allows
+    while (!outgoing_closed && send_window_open())
     {
-        int error;
-        std::vector<uint8_t> buffer;
-        ssize_t bytes_read = util::nonblocking_recv(
-            communication_socket_fd, buffer, message_segment::MAX_SEGMENT_LENGTH, error);
+        // piggyback any pending ACK on the next data segment, as long as it leaves reasonable room
+        // for payload
+        std::shared_ptr<selective_ack> ack;
+        if (pending_ack != no_ack)
+        {
+            ack = std::make_shared<selective_ack>(build_selective_ack());
+            if (ack->get_length() > segment_payload_length / 2)
+            {
+                ack = nullptr;
+            }
+        }
 
-        if (bytes_read == 0)
+        size_t max_payload_length
+            = segment_payload_length - (ack != nullptr ? ack->get_length() : 0);
+        // parity of a block has to fit in a segment of its own
+        uint8_t parity_block_length = fec_block_length;
+        if (parity_block_length != 0)
         {
-            // TODO: have flag here, if this occurs, tear down channel ?
-            sending = false;
+            max_payload_length = std::min(
+                max_payload_length, segment_payload_length - xor_parity::HEADER_LENGTH);
+        }
+
+        // read ahead when compressing, a segment can hold more client bytes than its length (as
+        // much as the compression achieved so far suggests, so incompressible bytes don't pile up)
+        size_t max_read_length = max_payload_length;
+        if (compressing)
+        {
+            max_read_length = max_payload_length * COMPRESSION_READ_FACTOR;
+            if (compression_read_length != 0)
+            {
+                max_read_length = std::min(
+                    max_read_length, std::max(max_payload_length, compression_read_length));
+            }
+        }
+        bool client_drained = outgoing_closing;
+
+        if (!outgoing_closing && coalesce_buffer.size() < max_read_length)
+        {
+            int error;
+            std::vector<uint8_t> buffer;
+            ssize_t bytes_read = util::nonblocking_recv(communication_socket_fd, buffer,
+                max_read_length - coalesce_buffer.size(), error);
+
+            if (bytes_read == 0)
+            {
+                outgoing_closing = true;
+            }
+            else if (bytes_read == -1)
+            {
+                // client asked to close, only finish once everything it wrote beforehand is sent
+                if ((error != EAGAIN && error != EWOULDBLOCK) || channel_close_requested)
+                {
+                    outgoing_closing = true;
+                }
+            }
+            else
+            {
+                if (coalesce_buffer.empty())
+                {
+                    coalesce_deadline = std::chrono::steady_clock::now() + coalesce_delay;
+                }
+
+                coalesce_buffer.insert(coalesce_buffer.end(), buffer.begin(), buffer.end());
+            }
+
+            client_drained = bytes_read <= 0;
+        }
+
+        if (coalesce_buffer.empty())
+        {
+            outgoing_closed = outgoing_closing;
             break;
         }
-        else if (bytes_read == -1)
+
+        // partial segments are held back while coalescing until the flush delay expires, unless
+        // the client has nothing left to send
+        bool flush = !coalescing || outgoing_closing
+            || coalesce_buffer.size() >= max_read_length
+            || std::chrono::steady_clock::now() >= coalesce_deadline;
+
+        if (!flush)
         {
-            if (error == EAGAIN || error == EWOULDBLOCK)
+            if (client_drained)
             {
                 break;
             }
 
-            sending = false;
-            return;
+            continue;
         }
 
-        buffer.resize(bytes_read);
-        auto segment = std::make_shared<message_segment>(connection_key.destination_port,
-            connection_key.source_port, next_sequence_number, message_segment::type::stream_segment,
-            message_segment::flag::none, buffer);
+        std::vector<uint8_t> buffer;
+        size_t consumed = 0;
+        bool compressed = false;
+
+        if (compressing)
+        {
+            consumed = outgoing_codec.compress(
+                coalesce_buffer.cbegin(), coalesce_buffer.cend(), max_payload_length, buffer);
+            compressed = consumed > buffer.size();
+        }
+
+        if (!compressed)
+        {
+            consumed = std::min(coalesce_buffer.size(), max_payload_length);
+            buffer.assign(coalesce_buffer.begin(), coalesce_buffer.begin() + consumed);
+        }
+
+        auto payload_end = coalesce_buffer.begin() + consumed;
+        if (compressing)
+        {
+            compression_read_length = compressed ? 2 * consumed : max_payload_length;
+
+            // peer sees every payload in order, compressed or not, and updates its dictionary alike
+            outgoing_codec.update_history(coalesce_buffer.cbegin(), payload_end);
+        }
+
+        coalesce_buffer.erase(coalesce_buffer.begin(), payload_end);
+        if (!coalesce_buffer.empty())
+        {
+            // whatever is left over starts waiting on a flush anew
+            coalesce_deadline = std::chrono::steady_clock::now() + coalesce_delay;
+        }
+
+        auto sequence_number = next_sequence_number;
+        auto frame = encode_frame(message_segment(connection_key.destination_port,
+            connection_key.source_port, sequence_number, message_segment::type::stream_segment,
+            message_segment::flag::none, buffer, compressed));
 
         std::unique_lock<std::mutex> lock(access_lock);
         ++next_sequence_number;
-        if (next_sequence_number == 0)
+
+        auto now = std::chrono::steady_clock::now();
+        auto &slot = send_window.insert(sequence_number);
+        slot.frame = frame;
+        slot.first_sent = now;
+        slot.last_sent = now;
+        slot.retransmit_count = 0;
+        slot.fast_retransmitted = false;
+        // until the block is complete its length is only known to be at most parity_block_length,
+        // see send_parity
+        slot.fast_retransmit_threshold = FAST_RETRANSMIT_THRESHOLD;
+        if (parity_block_length > fec_parity.get_block_length())
         {
-            sequence_number_wrapped = true;
+            slot.fast_retransmit_threshold
+                += parity_block_length - 1 - fec_parity.get_block_length();
         }
 
-        segment_buffer[segment->get_sequence_num()] = segment;
-        retransmit_queue.push(
-            std::make_pair(std::chrono::system_clock::now(), segment->get_sequence_num()));
-        sent_segments = true;
+        slot.reported_missing = false;
+        ++stats.segments_sent;
+        stats.window_probes
+            += !in_window(peer_cumulative_ack, peer_receive_window, sequence_number);
+        stats.acks_piggybacked += ack != nullptr;
+        stats.payload_bytes_sent += consumed;
+        stats.payload_bytes_encoded += buffer.size();
         lock.unlock();
 
-        // TODO: save entire frame in buffer?
-        uart_frame frame(
-            std::make_shared<tx_request_64_frame>(connection_key.source_address, *segment));
-        write_queue->push(std::make_shared<std::vector<uint8_t>>(frame));
+        // note: retransmissions only carry the payload (slot.frame), the ACK would be stale by then
+        if (ack != nullptr)
+        {
+            frame = encode_frame(*message_segment::create_selective_ack(
+                connection_key.destination_port, connection_key.source_port, *ack,
+                sequence_number, buffer, compressed));
+            pending_ack = no_ack;
+            unacked_segments = 0;
+            last_advertised_window = ack->get_receive_window();
+        }
+
+        queue_frame(frame);
+
+        if (fec_enabled)
+        {
+            add_to_parity_block(sequence_number, buffer, compressed, parity_block_length);
+        }
+    }
+
+    if (fec_parity.get_block_length() != 0
+        && std::chrono::steady_clock::now() >= fec_flush_deadline)
+    {
+        send_parity();
     }
 }
 
-// TODO: this is called by methods that already aqcuired lock
-//      - have way to indicate whether methods acquire lock vs don't?
-// tries to advance window_base to un-ACK'd segment with smallest sequence number (accounting
-// for wraparound)
-void reliable_channel::try_advance_window_base()
+// parity goes out right after the last segment of its block, a block left over from before parity
+// was turned off is flushed early
+void reliable_channel::add_to_parity_block(uint16_t sequence_number,
+    const std::vector<uint8_t> &payload, bool compressed, uint8_t block_length)
 {
-    if (segment_buffer.empty())
+    if (block_length == 0)
     {
-        window_base = next_sequence_number;
+        send_parity();
         return;
     }
 
-    auto entry = segment_buffer.lower_bound(window_base);
-    if (entry != segment_buffer.end())
+    if (fec_parity.get_block_length() == 0)
+    {
+        fec_block_first = sequence_number;
+        fec_flush_deadline = std::chrono::steady_clock::now() + PARITY_FLUSH_DELAY;
+    }
+
+    fec_parity.add(payload.cbegin(), payload.cend(), compressed);
+
+    if (fec_parity.get_block_length() >= block_length)
+    {
+        send_parity();
+    }
+}
+
+// note: parity segments are never retransmitted, a block that can't be recovered is left to the
+// usual retransmissions
+void reliable_channel::send_parity()
+{
+    if (fec_parity.get_block_length() == 0)
     {
-        window_base = entry->first;
         return;
     }
 
-    // if upper bound of window has wrapped around and window_base hasn't, lower_bound won't
-    // return anything since now unacked_sequence_nummber may be less than window_base, in this
-    // case check again from 0
-    if (sequence_number_wrapped)
+    uint8_t block_length = fec_parity.get_block_length();
+    queue_frame(encode_frame(*message_segment::create_parity(connection_key.destination_port,
+        connection_key.source_port, fec_block_first, fec_parity)));
+    fec_parity.clear();
+
+    std::lock_guard<std::mutex> lock(access_lock);
+    ++stats.parity_segments_sent;
+
+    // block may have been cut short, only the segments actually sent after a hole delay it
+    for (uint8_t i = 0; i < block_length; ++i)
     {
-        entry = segment_buffer.lower_bound(0);
-        if (entry != segment_buffer.end())
+        auto sequence_number = static_cast<uint16_t>(fec_block_first + i);
+        if (send_window.contains(sequence_number))
         {
-            window_base = entry->first;
-            sequence_number_wrapped = false;    // reset wrapped flag
-            return;
+            send_window.at(sequence_number).fast_retransmit_threshold
+                = FAST_RETRANSMIT_THRESHOLD + block_length - 1 - i;
         }
     }
 }
 
-void reliable_channel::listen_for_acks()
+// closes the outgoing direction, the peer keeps receiving until it sees this, retransmissions are
+// handled by the retransmit timer
+void reliable_channel::send_fin()
 {
-    std::shared_ptr<message_segment> segment;
+    std::lock_guard<std::mutex> lock(access_lock);
+    fin_sent = true;
+    fin_sequence_number = next_sequence_number;
+    fin_last_sent = std::chrono::steady_clock::now();
+    fin_retransmit_count = 0;
+    fin_frame = encode_frame(*message_segment::create_fin(
+        connection_key.destination_port, connection_key.source_port, fin_sequence_number));
+    queue_frame(fin_frame);
+}
+
+void reliable_channel::send_finack(uint16_t sequence_number)
+{
+    queue_frame(encode_frame(*message_segment::create_finack(
+        connection_key.destination_port, connection_key.source_port, sequence_number)));
+}
+
+// tears the channel down without a FIN exchange, e.g. once the incoming stream can't be recovered:
+// nothing else is delivered, the client socket is shut down in both directions and the peer is sent
+// an RST (unless it sent one itself)
+void reliable_channel::abort_channel(bool notify_peer)
+{
+    if (notify_peer)
+    {
+        queue_frame(encode_frame(*message_segment::create_rst(
+            connection_key.destination_port, connection_key.source_port)));
+    }
+
+    aborted = true;
+    sending = false;
+    incoming_closed = true;
+    shutdown(communication_socket_fd, SHUT_RDWR);
+}
+
+// keeps answering retransmitted FINs for a couple of retransmission timeouts after shutdown in
+// case the last FIN|ACK was lost, anything else arriving in the meantime is ignored
+void reliable_channel::linger()
+{
+    auto linger_deadline = std::chrono::steady_clock::now()
+        + LINGER_RETRANSMISSION_TIMEOUTS * get_stats().retransmission_timeout;
+
+    for (auto now = std::chrono::steady_clock::now(); now < linger_deadline;
+         now = std::chrono::steady_clock::now())
+    {
+        std::shared_ptr<message_segment> segment;
+        auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(linger_deadline - now);
+
+        if (incoming_segment_queue->timed_wait_and_pop(segment, timeout) && segment != nullptr
+            && segment->is_fin())
+        {
+            send_finack(segment->get_sequence_num());
+        }
+    }
+}
 
-    // listen for ACKs (until failure)
-    while (incoming_segment_queue->timed_wait_and_pop(segment, segment_queue_read_timeout))
+// clears every segment covered by ack from send_window in a single pass over the outstanding
+// range [send_window_base, next_sequence_number) and advances send_window_base to the oldest
+// unacked segment
+void reliable_channel::process_selective_ack(const selective_ack &ack)
+{
+    std::lock_guard<std::mutex> lock(access_lock);
+    auto outstanding = static_cast<uint16_t>(next_sequence_number - send_window_base);
+    auto cumulative_ack = ack.get_cumulative_ack();
+
+    // cumulative ack must fall within [send_window_base, next_sequence_number], anything else is
+    // stale
+    if (!in_window(send_window_base, outstanding + 1, cumulative_ack))
     {
-        if (in_window(segment->get_sequence_num()))
+        return;
+    }
+
+    peer_cumulative_ack = cumulative_ack;
+    peer_receive_window = ack.get_receive_window();
+    stats.peer_receive_window = peer_receive_window;
+
+    auto acked_prefix_length = static_cast<uint16_t>(cumulative_ack - send_window_base);
+    auto is_acknowledged = [&](uint16_t i) {
+        return i < acked_prefix_length
+            || ack.is_selectively_acknowledged(static_cast<uint16_t>(send_window_base + i));
+    };
+
+    // segments acknowledged above a hole are evidence that it was lost rather than delayed
+    uint16_t acknowledged_above = 0;
+    for (uint16_t i = acked_prefix_length; i < outstanding; ++i)
+    {
+        acknowledged_above += is_acknowledged(i);
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    auto next_window_base = next_sequence_number;
+    bool next_window_base_found = false;
+    uint16_t acked_segments = 0;
+    bool loss_detected = false;
+    bool rtt_sample_found = false;
+    std::chrono::steady_clock::time_point rtt_sample_first_sent;
+
+    for (uint16_t i = 0; i < outstanding; ++i)
+    {
+        auto sequence_number = static_cast<uint16_t>(send_window_base + i);
+        bool acknowledged = is_acknowledged(i);
+        if (acknowledged && i >= acked_prefix_length)
+        {
+            --acknowledged_above;
+        }
+
+        if (!send_window.contains(sequence_number))
         {
-            std::lock_guard<std::mutex> lock(access_lock);
-            segment_buffer.erase(segment->get_sequence_num());
+            continue;
+        }
+
+        auto &slot = send_window.at(sequence_number);
+        if (acknowledged)
+        {
+            // only the newest segment is sampled since older ones may have waited on a hole
+            if (slot.retransmit_count == 0)
+            {
+                rtt_sample_found = true;
+                rtt_sample_first_sent = slot.first_sent;
+            }
 
-            if (segment->get_sequence_num() == window_base)
+            if (fec_enabled)
             {
-                try_advance_window_base();
+                update_loss_estimate(slot.retransmit_count != 0 || slot.reported_missing);
             }
+
+            slot.frame = nullptr;
+            send_window.erase(sequence_number);
+            ++acked_segments;
+            continue;
         }
+
+        if (!next_window_base_found)
+        {
+            next_window_base = sequence_number;
+            next_window_base_found = true;
+        }
+
+        slot.reported_missing = slot.reported_missing || acknowledged_above != 0;
+
+        // fast retransmit: resend a hole once enough later segments made it through instead of
+        // waiting for the retransmit timer, at most once per hole (timer takes over after that)
+        if (!slot.fast_retransmitted && acknowledged_above >= slot.fast_retransmit_threshold)
+        {
+            slot.fast_retransmitted = true;
+            slot.last_sent = now;
+            ++slot.retransmit_count;
+            ++stats.segments_retransmitted;
+            ++stats.fast_retransmits;
+            loss_detected = true;
+
+            queue_frame(slot.frame);
+        }
+    }
+
+    send_window_base = next_window_base;
+
+    if (acked_segments != 0)
+    {
+        congestion.on_ack(acked_segments);
+    }
+
+    // one window reduction per ACK regardless of how many holes it revealed
+    if (loss_detected)
+    {
+        congestion.on_loss();
+    }
+
+    stats.congestion_window = congestion.get_window();
+
+    if (rtt_sample_found)
+    {
+        rtt.add_sample(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - rtt_sample_first_sent));
+        ++stats.rtt_samples;
+        stats.smoothed_rtt = rtt.get_smoothed_rtt();
+        stats.rtt_variance = rtt.get_rtt_variance();
+        stats.retransmission_timeout = rtt.get_retransmission_timeout();
     }
 }
 
-// TODO: locking needed in receiver? nothing else modifying segment_buffer, so not needed for
-// now
-//      - should lock all access to segment_buffer? - easier to refactor it to threadsafe_map?
-void reliable_channel::receive_segments_in_window()
+// picks the parity block length for the current loss estimate: the longest block still expected
+// to lose no more than FEC_LOSSES_PER_BLOCK segments
+//  - note: caller must hold access_lock
+void reliable_channel::update_loss_estimate(bool lost)
 {
-    while (!fin_received)    // TODO: what other conditions should signal stop?
+    loss_estimate += LOSS_ESTIMATE_GAIN * ((lost ? 1.0 : 0.0) - loss_estimate);
+
+    uint8_t block_length = 0;
+    if (loss_estimate >= MIN_FEC_LOSS_RATE)
     {
-        std::shared_ptr<message_segment> segment;
-        if (!incoming_segment_queue->timed_wait_and_pop(segment, segment_queue_read_timeout))
+        block_length = static_cast<uint8_t>(std::max<double>(MIN_FEC_BLOCK_LENGTH,
+            std::min<double>(xor_parity::MAX_BLOCK_LENGTH, FEC_LOSSES_PER_BLOCK / loss_estimate)));
+    }
+
+    fec_block_length = block_length;
+    stats.fec_block_length = block_length;
+}
+
+// receive_window slots not taken up by payloads still waiting on the client
+uint16_t reliable_channel::get_receive_buffer_space() const
+{
+    return window_size - static_cast<uint16_t>(receive_window_base - delivery_base);
+}
+
+// number of segments past receive_window_base the peer may send: what's left of receive_window,
+// further limited by the room left in the client socket's send buffer so a slow client throttles
+// the peer before undelivered payloads pile up in receive_window
+//  - note: a compressed segment may decompress to up to COMPRESSION_READ_FACTOR times its length
+//  (see send_segments_in_window), the socket space is accounted for accordingly
+uint16_t reliable_channel::get_advertised_receive_window() const
+{
+    uint16_t window = get_receive_buffer_space();
+    ssize_t socket_space = util::get_send_buffer_space(communication_socket_fd);
+
+    if (socket_space != -1)
+    {
+        size_t delivered_length = compressing
+            ? segment_payload_length * COMPRESSION_READ_FACTOR
+            : segment_payload_length;
+        window = static_cast<uint16_t>(std::min(static_cast<size_t>(window),
+            static_cast<size_t>(socket_space) / delivered_length));
+    }
+
+    return window;
+}
+
+// note: may extend past what was advertised, anything that fits in receive_window is kept
+bool reliable_channel::in_receive_window(uint16_t sequence_number) const
+{
+    return in_window(receive_window_base, get_receive_buffer_space(), sequence_number);
+}
+
+bool reliable_channel::in_previous_receive_window(uint16_t sequence_number) const
+{
+    return in_window(
+        static_cast<uint16_t>(receive_window_base - window_size), window_size, sequence_number);
+}
+
+// waits up to timeout for incoming segments, then drains everything that has already arrived so a
+// single ACK covers the whole batch
+void reliable_channel::receive_segments(const std::chrono::milliseconds &timeout)
+{
+    std::shared_ptr<message_segment> segment;
+    bool segment_received = true;
+
+    if (timeout == NO_RECEIVE_TIMEOUT)
+    {
+        segment = incoming_segment_queue->wait_and_pop();
+    }
+    else
+    {
+        segment_received = incoming_segment_queue->timed_wait_and_pop(segment, timeout);
+    }
+
+    while (segment_received)
+    {
+        auto urgency = receive_segment(segment);
+        if (urgency == delayed_ack)
         {
-            // TODO: try reduce amount of busy wait?
-            continue;
+            if (pending_ack == no_ack)
+            {
+                ack_deadline = std::chrono::steady_clock::now() + ack_delay;
+            }
+
+            ++unacked_segments;
         }
 
-        // TODO: handle fin packets here, will be written to same channel as payload bits ->
-        // separate channels?
-        if (segment->is_fin())
+        pending_ack = std::max(pending_ack, urgency);
+        segment_received = incoming_segment_queue->try_pop(segment);
+    }
+}
+
+// handles the ACK and/or payload carried by segment, returns how soon the peer should be sent an
+// ACK
+reliable_channel::ack_urgency reliable_channel::receive_segment(
+    std::shared_ptr<message_segment> segment)
+{
+    // wakeup sentinel: client socket readiness, close request or a stale handshake retry (see
+    // channel_manager::try_handshake)
+    if (segment == nullptr || aborted)
+    {
+        return no_ack;
+    }
+
+    last_received = std::chrono::steady_clock::now();
+    keepalive_deadline = last_received + keepalive_interval;
+
+    if (segment->is_rst())
+    {
+        LOG(connection_key.to_string(), " reset by peer");
+        abort_channel(false);
+        return no_ack;
+    }
+
+    if (segment->is_fin())
+    {
+        // only accepted once everything before it has been received, otherwise the peer
+        // retransmits it, answered every time since a duplicate means the FIN|ACK was lost
+        //  - note: end of stream is signalled to the client once everything before it has been
+        //  delivered, see deliver_payloads
+        if (segment->get_sequence_num() == receive_window_base)
         {
-            // TODO: can just break here
-            // TODO: factor out code that reads writes to domain socket so if there are still
-            // frames that haven't been written to domain socket after fin is received, we can
-            // finish transfering them
             fin_received = true;
-            continue;
+            send_finack(segment->get_sequence_num());
         }
 
-        // TODO: verify: next_sequence_number not used in receiver code?
-        auto sequence_number = segment->get_sequence_num();
-        if (in_window(sequence_number))
+        return no_ack;
+    }
+
+    if (segment->is_finack())
+    {
+        std::lock_guard<std::mutex> lock(access_lock);
+        if (fin_sent && segment->get_sequence_num() == fin_sequence_number)
         {
-            auto ack = message_segment::create_ack(
-                connection_key.destination_port, connection_key.source_port, sequence_number);
-            uart_frame frame(
-                std::make_shared<tx_request_64_frame>(connection_key.source_address, *ack));
-            write_queue->push(std::make_shared<std::vector<uint8_t>>(frame));
+            sending = false;
+        }
 
-            // buffer segment if we haven't seen it before
-            if (segment_buffer.count(sequence_number) == 0)
+        return no_ack;
+    }
+
+    if (segment->is_parity())
+    {
+        return receive_parity(*segment);
+    }
+
+    auto payload_begin = segment->get_message_begin();
+    auto payload_end = segment->get_message_end();
+
+    if (segment->is_ack())
+    {
+        auto ack = selective_ack::parse(payload_begin, payload_end);
+        if (ack == nullptr)
+        {
+            // e.g. handshake ACK
+            return no_ack;
+        }
+
+        process_selective_ack(*ack);
+
+        // remainder (if any) is payload the ACK was piggybacked on
+        payload_begin += ack->get_length();
+    }
+    else if (!segment->flags_empty())
+    {
+        return no_ack;
+    }
+
+    if (payload_begin == payload_end)
+    {
+        return no_ack;
+    }
+
+    return receive_payload(
+        segment->get_sequence_num(), payload_begin, payload_end, segment->is_compressed());
+}
+
+// buffers payload and delivers any in-order payloads to the application layer, returns how soon
+// the sender should be sent an ACK
+reliable_channel::ack_urgency reliable_channel::receive_payload(
+    uint16_t sequence_number, const uint8_t *begin, const uint8_t *end, bool compressed)
+{
+    std::unique_lock<std::mutex> lock(access_lock);
+    ++stats.segments_received;
+    lock.unlock();
+
+    if (in_receive_window(sequence_number))
+    {
+        // anything but the next expected segment arriving with no holes pending is acked at once:
+        // out-of-order arrivals, gap fills (out-of-order segments already buffered) and duplicates
+        auto undelivered = static_cast<uint16_t>(receive_window_base - delivery_base);
+        bool holes_pending = receive_window.size() > undelivered;
+        bool next_in_order = sequence_number == receive_window_base && !holes_pending;
+        ack_urgency urgency = next_in_order ? delayed_ack : immediate_ack;
+
+        // buffer payload if we haven't seen it before
+        if (!receive_window.contains(sequence_number))
+        {
+            auto &slot = receive_window.insert(sequence_number);
+            slot.payload.assign(begin, end);
+            slot.compressed = compressed;
+
+            if (fec_enabled)
             {
-                segment_buffer[sequence_number] = segment;
+                auto &entry = fec_history.insert(sequence_number);
+                entry.payload.assign(begin, end);
+                entry.compressed = compressed;
             }
+        }
 
-            // TODO: could buffer these and send as chunk?
-            //  -> will be writing to domain socket, will buffering before sending make a
-            //  difference?
-            // send segments to application layer
-            while (segment_buffer.count(window_base) != 0)
+        // dictionary only covers in-order payloads, so decompression has to wait until then
+        while (receive_window.contains(receive_window_base))
+        {
+            auto &slot = receive_window.at(receive_window_base++);
+            if (slot.compressed)
             {
-                auto payload = segment_buffer[window_base]->get_message();
-                if (util::send(communication_socket_fd, payload) == -1)
+                std::vector<uint8_t> payload;
+                if (!compressing
+                    || !incoming_codec.decompress(
+                        slot.payload.data(), slot.payload.data() + slot.payload.size(), payload))
                 {
-                    LOG_ERROR("channel corrupted");
-                    // TODO: some way to signal client that IPC failure has occurred -> reliable
-                    // channel corrupted?
-                    // TODO: have beehive_context/state object that tracks these counters, i.e.
-                    // beehive_state.increment_corrupted_channels
+                    // no way to recover the stream past this point, what came before it still
+                    // reaches the client
+                    LOG_ERROR(connection_key.to_string(), " payload corrupted, resetting channel");
+                    --receive_window_base;
+                    deliver_payloads();
+                    abort_channel(true);
+                    return no_ack;
                 }
 
-                segment_buffer.erase(window_base++);
+                slot.payload.swap(payload);
+                slot.compressed = false;
             }
+
+            if (compressing)
+            {
+                incoming_codec.update_history(slot.payload.cbegin(), slot.payload.cend());
+            }
+        }
+
+        // hand them over right away, only what the client can't take yet is kept around
+        deliver_payloads();
+        return urgency;
+    }
+
+    // past what receive_window can hold while the client catches up, most likely a probe of a
+    // closed window: answer it so the sender learns the current window
+    if (in_window(receive_window_base, window_size, sequence_number))
+    {
+        return immediate_ack;
+    }
+
+    // TODO: Kurose excplitily defines this range, other source says to ack
+    // 'anything outside window' ... will both work?
+    // duplicate of an already delivered segment, previous ACK was likely lost
+    return in_previous_receive_window(sequence_number) ? immediate_ack : no_ack;
+}
+
+// rebuilds the segment missing from the block covered by segment's parity, as long as it's the only
+// one missing, returns how soon the sender should be sent an ACK
+reliable_channel::ack_urgency reliable_channel::receive_parity(const message_segment &segment)
+{
+    if (!fec_enabled)
+    {
+        return no_ack;
+    }
+
+    auto parity = xor_parity::parse(segment.get_message_begin(), segment.get_message_end());
+    if (parity == nullptr)
+    {
+        return no_ack;
+    }
+
+    uint16_t missing_sequence_number = 0;
+    bool missing = false;
+    uint8_t block_length = parity->get_block_length();
+
+    for (uint8_t i = 0; i < block_length; ++i)
+    {
+        auto sequence_number = static_cast<uint16_t>(segment.get_sequence_num() + i);
+        if (fec_history.contains(sequence_number))
+        {
+            auto &entry = fec_history.at(sequence_number);
+            parity->remove(entry.payload.cbegin(), entry.payload.cend(), entry.compressed);
+        }
+        else if (missing)
+        {
+            // more than one lost, left to retransmissions
+            return no_ack;
         }
-        else if (in_previous_window(sequence_number))
+        else
         {
-            // TODO: Kurose excplitily defines this range, other source says to ack
-            // 'anything outside window' ... will both work?
+            missing_sequence_number = sequence_number;
+            missing = true;
+        }
+    }
 
-            auto ack = message_segment::create_ack(
-                connection_key.destination_port, connection_key.source_port, sequence_number);
-            uart_frame frame(
-                std::make_shared<tx_request_64_frame>(connection_key.source_address, *ack));
-            write_queue->push(std::make_shared<std::vector<uint8_t>>(frame));
+    std::vector<uint8_t> payload;
+    bool compressed;
+    if (!missing || !in_receive_window(missing_sequence_number)
+        || !parity->get_remaining_payload(payload, compressed))
+    {
+        return no_ack;
+    }
+
+    std::unique_lock<std::mutex> lock(access_lock);
+    ++stats.segments_recovered;
+    lock.unlock();
+
+    return receive_payload(
+        missing_sequence_number, payload.data(), payload.data() + payload.size(), compressed);
+}
+
+// writes in-order payloads to the client for as long as its socket accepts them, whatever doesn't
+// fit stays in receive_window (shrinking the advertised window) and is retried on the next pass
+void reliable_channel::deliver_payloads()
+{
+    // TODO: could buffer these and send as chunk?
+    //  -> will be writing to domain socket, will buffering before sending make a
+    //  difference?
+    while (delivery_base != receive_window_base)
+    {
+        auto &payload = receive_window.at(delivery_base).payload;
+        int error;
+        ssize_t bytes_sent = util::nonblocking_send(communication_socket_fd, payload, error);
+
+        if (bytes_sent == -1)
+        {
+            if (error == EAGAIN || error == EWOULDBLOCK)
+            {
+                break;
+            }
+
+            LOG_ERROR("channel corrupted");
+            // TODO: some way to signal client that IPC failure has occurred -> reliable
+            // channel corrupted?
+            // TODO: have beehive_context/state object that tracks these counters, i.e.
+            // beehive_state.increment_corrupted_channels
+
+            // client can't take anything anymore, drop the rest rather than stall the peer
+            while (delivery_base != receive_window_base)
+            {
+                receive_window.erase(delivery_base++);
+            }
+
+            break;
+        }
+
+        if (static_cast<size_t>(bytes_sent) < payload.size())
+        {
+            payload.erase(payload.begin(), payload.begin() + bytes_sent);
+            break;
         }
+
+        receive_window.erase(delivery_base++);
+    }
+
+    if (fin_received && !incoming_closed && delivery_base == receive_window_base)
+    {
+        // signal end of stream to the client, it can still keep sending
+        incoming_closed = true;
+        shutdown(communication_socket_fd, SHUT_WR);
+    }
+
+    // window update: a peer held back by a (nearly) closed window is told as soon as the client
+    // caught up instead of waiting on its next probe
+    if (last_advertised_window < window_size / 2
+        && get_advertised_receive_window() >= window_size / 2)
+    {
+        pending_ack = immediate_ack;
+    }
+}
+
+// how long to wait for incoming segments before the delayed ACK timer (if armed), the coalescing
+// or parity flush delay (if pending) or the keepalive deadline expires
+std::chrono::milliseconds reliable_channel::get_receive_timeout() const
+{
+    auto now = std::chrono::steady_clock::now();
+    auto timeout = NO_RECEIVE_TIMEOUT;
+
+    if (pending_ack != no_ack)
+    {
+        timeout = std::min(
+            timeout, std::chrono::duration_cast<std::chrono::milliseconds>(ack_deadline - now));
+    }
+
+    // also wake up in time to flush a partially filled segment or parity block
+    //  - note: a full window holds back coalesced bytes until an ACK opens it, there's no point in
+    //  waking up for their deadline before then
+    if (!coalesce_buffer.empty() && send_window_open())
+    {
+        timeout = std::min(timeout,
+            std::chrono::duration_cast<std::chrono::milliseconds>(coalesce_deadline - now));
+    }
+
+    if (fec_parity.get_block_length() != 0)
+    {
+        timeout = std::min(timeout,
+            std::chrono::duration_cast<std::chrono::milliseconds>(fec_flush_deadline - now));
+    }
+
+    // keepalive, also bounds how late an unresponsive peer is noticed
+    timeout = std::min(
+        timeout, std::chrono::duration_cast<std::chrono::milliseconds>(keepalive_deadline - now));
+
+    return std::max(timeout, std::chrono::milliseconds::zero());
+}
+
+// asks the reactor for the client socket readiness the channel can act on: client payload while
+// the send window is open, and room in the socket while payloads (or a window update) are held
+// back by a client that isn't reading
+void reliable_channel::arm_client_socket()
+{
+    uint32_t events = 0;
+    if (!outgoing_closing && send_window_open())
+    {
+        events |= EPOLLIN;
+    }
+
+    if (delivery_base != receive_window_base || last_advertised_window < window_size / 2)
+    {
+        events |= EPOLLOUT;
+    }
+
+    if (events != 0)
+    {
+        reactor->arm(communication_socket_fd, events);
     }
 }
+
+// out-of-order arrivals, gap fills and duplicates are acknowledged right away so the sender learns
+// about holes (or their repair) without waiting on the delayed ACK timer
+bool reliable_channel::ack_due() const
+{
+    return pending_ack == immediate_ack
+        || (pending_ack == delayed_ack
+               && (unacked_segments >= ack_frequency
+                      || std::chrono::steady_clock::now() >= ack_deadline));
+}
+
+// acknowledges everything received so far: receive_window_base is the next in-order segment
+// expected, buffered out-of-order segments are reported in the bitmap
+selective_ack reliable_channel::build_selective_ack() const
+{
+    selective_ack ack(receive_window_base, get_advertised_receive_window());
+    size_t out_of_order
+        = receive_window.size() - static_cast<uint16_t>(receive_window_base - delivery_base);
+    size_t max_bitmap_length = std::min(static_cast<size_t>((window_size + 7) / 8),
+        segment_payload_length - selective_ack::BITMAP_OFFSET);
+
+    // note: receive_window_base itself is never buffered, it would have been delivered
+    for (uint16_t i = 1; i < window_size && out_of_order != 0; ++i)
+    {
+        auto sequence_number = static_cast<uint16_t>(receive_window_base + i);
+        if (receive_window.contains(sequence_number))
+        {
+            ack.set_received(sequence_number, max_bitmap_length);
+            --out_of_order;
+        }
+    }
+
+    return ack;
+}
+
+void reliable_channel::send_selective_ack()
+{
+    auto ack = build_selective_ack();
+    queue_frame(encode_frame(*message_segment::create_selective_ack(
+        connection_key.destination_port, connection_key.source_port, ack)));
+
+    pending_ack = no_ack;
+    unacked_segments = 0;
+    last_advertised_window = ack.get_receive_window();
+
+    std::lock_guard<std::mutex> lock(access_lock);
+    ++stats.acks_sent;
+}
@@ -1,12 +1,14 @@
 #ifndef RELIABLE_CHANNEL_H
 #define RELIABLE_CHANNEL_H
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
-#include <map>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <sstream>
+#include <string>
 #include <vector>
 
 #include <sys/socket.h>
@@ -14,97 +16,288 @@
 
 #include <errno.h>
 
-#include <boost/asio.hpp>
-#include <boost/bind.hpp>
-#include <boost/date_time/posix_time/posix_time.hpp>
-
+#include "beehive_config.h"
+#include "congestion_controller.h"
 #include "connection_tuple.h"
 #include "logger.h"
+#include "lz77_codec.h"
 #include "message_segment.h"
+#include "rtt_estimator.h"
+#include "selective_ack.h"
+#include "sequence_ring.h"
+#include "socket_reactor.h"
 #include "threadsafe_blocking_queue.h"
+#include "timer_wheel.h"
 #include "tx_request_64_frame.h"
 #include "uart_frame.h"
 #include "util.h"
 #include "xbee_s1.h"
+#include "xor_parity.h"
 
 // TODO: make note of sender requiring SO_RCVTIMEO set (can we check for this?) or just set it
 // within class?
 //      - use getsockopt to check for this -> exception if not set
-//  - might be neater to have reader()/writer() thread logic inside this class as public members
-// TODO: need to verify: when sender requests CLOSE, send FIN only after current payload is sent?
-// currently might be stopping loop early causing retransmission queue not to be fully retransmitted
-// TODO: are we using a monotonic/steady clock?
-// TODO: don't need to use timer... can manage ticks ourself?
-//  - is boost deadline_timer safe from clock skew? -> boost steady_timer ?
 
 // TODO: create structure similar to transmission control block (tcp) to hold connection state? ->
 // reliable_channel_state ?
 
-// TODO: how to deal with bidirectional communication? currently algorithm is simplex
-//  - can we leverage same code to allow full duplex? e.g. after handshake is done?
-//      - how will we distinguish sequence numbers if running algorithm separately for send+recv?
-//          - flip MSB for send/recv?, would make seq_num_t::max() = 2^(width - 1)
-class reliable_channel
+// full duplex: each endpoint runs an independent selective repeat sender and receiver over the same
+// connection, each direction with its own sequence number space
+//  - data segments: flags none, payload is the application data
+//  - ACK segments: flags ack, payload is a selective_ack block optionally followed by application
+//  data (ACK piggybacked on a reverse direction data segment, sequence number applies to the data)
+//  - flow control: every ACK advertises how many segments past its cumulative ACK the receiver can
+//  take, bounded by undelivered payload in its receive window and by how much the local client
+//  has left unread on its socket, senders never have more than that outstanding (besides a single
+//  probe segment while the window is closed, retransmitted on the usual timer until it reopens)
+//  - each direction is closed independently by a FIN once all of its data has been ACK'd: the FIN
+//  carries the sequence number following the last data segment and is retransmitted on the usual
+//  timer until the peer answers with a FIN|ACK, the channel shuts down once both directions are
+//  closed and can then linger briefly to answer retransmitted FINs in case its FIN|ACK was lost
+//  - compression (if negotiated on connection setup): payloads are compressed against a sliding
+//  dictionary of everything sent before in that direction and flagged as such, the receiver
+//  decompresses them in order before delivery, payloads that don't shrink are sent as is
+//  - the channel thread only wakes up for events: incoming segments, client socket readiness
+//  (reported by the socket_reactor through the incoming segment queue, armed only while the
+//  channel can act on it) and its own deadlines (delayed ACK, coalescing and parity flushes)
+//  - forward error correction (if negotiated on connection setup): once the sender observes loss,
+//  every block of consecutive data segments is followed by an xor_parity segment (flags syn|fin,
+//  sequence number of the first segment in the block), the receiver rebuilds a single missing
+//  segment of a block from it without waiting on a retransmission, block length shrinks as the
+//  loss rate grows so that about one segment in every two blocks is lost
+
+struct reliable_channel_stats
+{
+    uint64_t segments_sent;
+    uint64_t segments_retransmitted;
+    uint64_t fast_retransmits;
+    uint64_t segments_received;
+    uint64_t rtt_samples;
+    uint64_t acks_sent;
+    uint64_t acks_piggybacked;
+    uint64_t window_probes;
+    uint64_t payload_bytes_sent;    // client bytes, before compression
+    uint64_t payload_bytes_encoded;    // bytes those took up in segments
+    uint64_t parity_segments_sent;
+    uint64_t segments_recovered;    // rebuilt from parity segments
+    uint8_t fec_block_length;    // 0 while no parity is being sent
+    uint16_t peer_receive_window;
+    uint16_t congestion_window;
+    std::chrono::microseconds smoothed_rtt;
+    std::chrono::microseconds rtt_variance;
+    std::chrono::microseconds retransmission_timeout;
+
+    std::string to_string() const;
+};
+
+// note: must be owned by a shared_ptr, retransmit timer callbacks only hold a weak_ptr to it
+class reliable_channel : public std::enable_shared_from_this<reliable_channel>
 {
 public:
-    reliable_channel(connection_tuple connection_key, int communication_socket_fd,
-        std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<std::vector<uint8_t>>>>
-            write_queue,
+    reliable_channel(const beehive_config &config, std::shared_ptr<timer_wheel> timers,
+        std::shared_ptr<socket_reactor> reactor, connection_tuple connection_key, int communication_socket_fd,
+        std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<frame_buffer>>> write_queue,
         std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<message_segment>>>
             incoming_segment_queue);
 
-    void start_sending();
-    void start_receiving();
+    // how small client writes are turned into segments, requested per connection on CONNECT
+    enum send_policy : uint8_t
+    {
+        default_send_policy = 0,    // per beehive_config
+        nodelay,                    // each client write is sent as soon as the window allows
+        coalesce,                   // fill segments, flush partial ones after the coalesce delay
+    };
+
+    // runs both directions of the channel until each has been closed by a FIN
+    void start();
+    // answers retransmitted FINs for a short while once start() returned, incoming segments must
+    // still be routed to the channel until then
+    void linger();
+    // finish sending buffered payload and close the outgoing direction
     void request_channel_close();
-    void received_fin();
+    void set_send_policy(send_policy policy);
+    // must match on both ends and be set before start()
+    void set_compression(bool enabled);
+    // must match on both ends and be set before start()
+    void set_forward_error_correction(bool enabled);
+    // sends every segment with the compact header addressed to the connection ID the peer assigned
+    // on connection setup, must be set before start()
+    void set_peer_connection_id(uint8_t connection_id);
+    reliable_channel_stats get_stats() const;
 
 private:
-    void retransmit_timed_out_unacked_segments();
-    void retransmitter(const boost::system::error_code & /*e*/, boost::asio::deadline_timer *timer);
-    void retransmit_timer();
-    bool in_window(uint16_t sequence_number) const;
-    bool in_previous_window(uint16_t sequence_number) const;
+    // how soon the receiver should acknowledge an incoming segment, ordered by urgency
+    enum ack_urgency
+    {
+        no_ack = 0,
+        delayed_ack,
+        immediate_ack,
+    };
+
+    std::chrono::microseconds retransmit_timed_out_unacked_segments();
+    void schedule_retransmit_timer(const std::chrono::microseconds &timeout);
+    static void retransmitter(std::weak_ptr<reliable_channel> channel);
+    static bool in_window(uint16_t base, uint16_t size, uint16_t sequence_number);
+    // note: takes a copy, segments are switched over to the compact header if negotiated
+    std::shared_ptr<frame_buffer> encode_frame(message_segment segment) const;
+    void queue_frame(std::shared_ptr<frame_buffer> frame);
+
+    // sender
+    bool send_window_open() const;
+    bool send_complete() const;
     void send_segments_in_window();
-    void try_advance_window_base();
-    void listen_for_acks();
-    void receive_segments_in_window();
+    void send_fin();
+    void send_finack(uint16_t sequence_number);
+    void abort_channel(bool notify_peer);
+    void process_selective_ack(const selective_ack &ack);
+    void update_loss_estimate(bool lost);
+    void add_to_parity_block(uint16_t sequence_number, const std::vector<uint8_t> &payload,
+        bool compressed, uint8_t block_length);
+    void send_parity();
+
+    // receiver
+    uint16_t get_receive_buffer_space() const;
+    uint16_t get_advertised_receive_window() const;
+    bool in_receive_window(uint16_t sequence_number) const;
+    bool in_previous_receive_window(uint16_t sequence_number) const;
+    void receive_segments(const std::chrono::milliseconds &timeout);
+    ack_urgency receive_segment(std::shared_ptr<message_segment> segment);
+    ack_urgency receive_payload(
+        uint16_t sequence_number, const uint8_t *begin, const uint8_t *end, bool compressed);
+    ack_urgency receive_parity(const message_segment &segment);
+    void deliver_payloads();
+    std::chrono::milliseconds get_receive_timeout() const;
+    void arm_client_socket();
+    bool ack_due() const;
+    selective_ack build_selective_ack() const;
+    void send_selective_ack();
 
-    struct timestamp_compare
+    static const std::chrono::microseconds RETRANSMIT_TIMER_RESOLUTION;
+    // segments acknowledged past a hole before it is retransmitted without waiting on the timer
+    static const uint16_t FAST_RETRANSMIT_THRESHOLD;
+    // unanswered FIN retransmissions before the peer is considered gone
+    static const uint16_t MAX_FIN_RETRANSMISSIONS;
+    // how long to keep answering FINs after shutdown, in retransmission timeouts
+    static const int LINGER_RETRANSMISSION_TIMEOUTS;
+    // upper bound on the client bytes read per segment while compressing, in multiples of the
+    // segment payload length
+    static const size_t COMPRESSION_READ_FACTOR;
+    // loss rate estimate: exponentially weighted average of whether each ACK'd segment was lost
+    // first (retransmitted or reported missing by the peer), updated with this gain
+    static const double LOSS_ESTIMATE_GAIN;
+    // no parity is sent below this loss rate
+    static const double MIN_FEC_LOSS_RATE;
+    // expected segment losses per parity block (only a single one can be recovered)
+    static const double FEC_LOSSES_PER_BLOCK;
+    static const uint8_t MIN_FEC_BLOCK_LENGTH;
+    // how long a partial block may wait on more segments before its parity is sent anyway
+    static const std::chrono::milliseconds PARITY_FLUSH_DELAY;
+    // get_receive_timeout() result when no deadline is pending, waits on the next event
+    static const std::chrono::milliseconds NO_RECEIVE_TIMEOUT;
+
+    // sender state of a sent + un-ACK'd segment
+    struct send_slot
     {
-        bool operator()(const std::pair<std::chrono::system_clock::time_point, uint16_t> &lhs,
-            const std::pair<std::chrono::system_clock::time_point, uint16_t> &rhs)
-        {
-            return lhs.first > rhs.first;
-        }
+        // encoded uart frame (payload only, never a piggybacked ACK), shared by every transmission
+        std::shared_ptr<frame_buffer> frame;
+        std::chrono::steady_clock::time_point first_sent;
+        std::chrono::steady_clock::time_point last_sent;    // times out after current rto
+        // only segments that were never retransmitted are used for rtt sampling since the ACK of
+        // a retransmitted segment is ambiguous
+        uint16_t retransmit_count;
+        bool fast_retransmitted;
+        // segments ACK'd past it before a fast retransmit, raised by the rest of its parity block
+        // so that the receiver gets a chance to recover it from the parity first
+        uint16_t fast_retransmit_threshold;
+        bool reported_missing;    // peer ACK'd segments past it, counts as lost for loss_estimate
+    };
+
+    // receiver state of a received but undelivered segment
+    struct receive_slot
+    {
+        std::vector<uint8_t> payload;
+        bool compressed;    // until decompressed, which happens once it is in order
     };
 
     mutable std::mutex access_lock;
+    std::shared_ptr<timer_wheel> timers;
+    std::shared_ptr<socket_reactor> reactor;
     connection_tuple connection_key;
     int communication_socket_fd;
     // TODO: outbound_frame_queue ?
-    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<std::vector<uint8_t>>>> write_queue;
+    std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<frame_buffer>>> write_queue;
     std::shared_ptr<threadsafe_blocking_queue<std::shared_ptr<message_segment>>>
         incoming_segment_queue;
 
     // TODO: define sequence_number_t, etc -> in common header file?
-    uint16_t window_base;
-    uint16_t next_sequence_number;
     uint16_t window_size;    // note: must be <= uint16_t::max() / 2
 
-    bool sequence_number_wrapped;
-    bool channel_close_requested;
-    bool sending;
-    bool fin_received;
+    // sender state, shared with retransmit timer callbacks (guarded by access_lock)
+    uint16_t send_window_base;
+    uint16_t next_sequence_number;
+    congestion_controller congestion;    // limits how much of window_size a sender may use
+    std::atomic<bool> channel_close_requested;
+    bool outgoing_closing;    // client is done, flush what's left and close
+    bool outgoing_closed;    // no more payload will be sent
+    bool coalescing;
+    std::chrono::milliseconds coalesce_delay;
+    std::vector<uint8_t> coalesce_buffer;    // client payload not yet sent in a segment
+    std::chrono::steady_clock::time_point coalesce_deadline;
+    bool compressing;
+    // client bytes to read ahead for the next segment while compressing: twice what the previous
+    // one took if it compressed, a segment's worth if it didn't, 0 until the first one is sent
+    size_t compression_read_length;
+    lz77_codec outgoing_codec;
+    bool compact_header;
+    uint8_t peer_connection_id;
+    size_t segment_payload_length;    // max payload of a segment, depends on the header used
+    bool fec_enabled;
+    double loss_estimate;
+    std::atomic<uint8_t> fec_block_length;    // 0 while loss_estimate is below MIN_FEC_LOSS_RATE
+    xor_parity fec_parity;    // of the segments sent so far in the current block
+    uint16_t fec_block_first;
+    std::chrono::steady_clock::time_point fec_flush_deadline;
+    std::atomic<bool> sending;    // until the outgoing direction is closed by an ACK'd FIN
+    timer_wheel::timer_id retransmit_timer_id;
+    bool fin_sent;
+    uint16_t fin_sequence_number;
+    std::shared_ptr<frame_buffer> fin_frame;
+    std::chrono::steady_clock::time_point fin_last_sent;
+    uint16_t fin_retransmit_count;
+    // last flow control window advertised by the peer, relative to its cumulative ACK
+    uint16_t peer_cumulative_ack;
+    uint16_t peer_receive_window;
+    rtt_estimator rtt;
+    sequence_ring<send_slot> send_window;    // sent + un-ACK'd segments
 
-    int retransmission_timeout_int_ms;    // TODO: type?
-    std::chrono::milliseconds retransmission_timeout;
-    std::chrono::milliseconds segment_queue_read_timeout;    // TODO: make static -> move these into global state/config object
+    // receiver state, only accessed from the channel thread
+    uint16_t receive_window_base;    // next in-order segment expected
+    uint16_t delivery_base;    // oldest in-order segment not yet fully written to the client
+    bool fin_received;
+    bool incoming_closed;    // FIN received and everything before it delivered
+    bool aborted;    // reset by either end, see abort_channel
+    std::chrono::steady_clock::time_point last_received;    // any segment from the peer
+    std::chrono::steady_clock::time_point keepalive_deadline;
+    // keepalive policy, the peer is considered gone once it was silent for idle_timeout (e.g. out
+    // of range without a FIN), see beehive_config
+    std::chrono::milliseconds keepalive_interval;
+    std::chrono::milliseconds idle_timeout;
+    // payloads received but not yet delivered: in-order ones in [delivery_base,
+    // receive_window_base) waiting on the client, and out-of-order ones past receive_window_base
+    sequence_ring<receive_slot> receive_window;
+    lz77_codec incoming_codec;
+    // payloads as received (i.e. still compressed, if they were) of the last window_size segments,
+    // kept past delivery for rebuilding segments from parity, empty unless fec_enabled
+    sequence_ring<receive_slot> fec_history;
+    uint16_t last_advertised_window;
+    // delayed ACK policy, see beehive_config
+    uint16_t ack_frequency;
+    std::chrono::milliseconds ack_delay;
+    ack_urgency pending_ack;
+    uint16_t unacked_segments;    // in-order segments received since the last ACK
+    std::chrono::steady_clock::time_point ack_deadline;
 
-    std::map<uint16_t, std::shared_ptr<message_segment>> segment_buffer;
-    std::priority_queue<std::pair<std::chrono::system_clock::time_point, uint16_t>,
-        std::vector<std::pair<std::chrono::system_clock::time_point, uint16_t>>,
-        timestamp_compare>
-        retransmit_queue;    // TODO: rewrite to use map?
+    reliable_channel_stats stats;
 };
 
 #endif
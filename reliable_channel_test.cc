@@ -0,0 +1,555 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "beehive_config.h"
+#include "connection_tuple.h"
+#include "inline_buffer.h"
+#include "message_segment.h"
+#include "reliable_channel.h"
+#include "selective_ack.h"
+#include "socket_reactor.h"
+#include "threadsafe_blocking_queue.h"
+#include "timer_wheel.h"
+#include "tx_request_64_frame.h"
+#include "uart_frame.h"
+#include "util.h"
+
+namespace reliable_channel_test
+{
+    typedef threadsafe_blocking_queue<std::shared_ptr<frame_buffer>> frame_queue;
+    typedef threadsafe_blocking_queue<std::shared_ptr<message_segment>> segment_queue;
+
+    const uint64_t LOCAL_ADDRESS = 0xa;
+    const uint64_t PEER_ADDRESS = 0xb;
+    const uint16_t LOCAL_PORT = 49152;
+    const uint16_t PEER_PORT = 1;
+
+    // timer wheel and reactor threads the channels of a test share
+    class channel_services
+    {
+    public:
+        channel_services()
+            : timers(std::make_shared<timer_wheel>()), reactor(std::make_shared<socket_reactor>()),
+              timer_thread(&timer_wheel::run, timers), reactor_thread(&socket_reactor::run, reactor)
+        {
+        }
+
+        ~channel_services()
+        {
+            timers->stop();
+            timer_thread.join();
+            reactor->stop();
+            reactor_thread.join();
+        }
+
+        std::shared_ptr<timer_wheel> timers;
+        std::shared_ptr<socket_reactor> reactor;
+        std::thread timer_thread;
+        std::thread reactor_thread;
+    };
+
+    // reliable_channel on the channel end of a client socket pair, frames it sends are queued on
+    // out and segments pushed onto in are what it receives
+    class test_channel
+    {
+    public:
+        test_channel(const beehive_config &config, channel_services &services, bool local = true)
+            : out(std::make_shared<frame_queue>()), in(std::make_shared<segment_queue>())
+        {
+            socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+            util::try_configure_nonblocking_receive_timeout(sockets[1]);
+
+            connection_tuple key = local
+                ? connection_tuple(PEER_ADDRESS, PEER_PORT, LOCAL_ADDRESS, LOCAL_PORT)
+                : connection_tuple(LOCAL_ADDRESS, LOCAL_PORT, PEER_ADDRESS, PEER_PORT);
+            channel = std::make_shared<reliable_channel>(
+                config, services.timers, services.reactor, key, sockets[1], out, in);
+        }
+
+        // note: a channel still running is reset by its peer
+        ~test_channel()
+        {
+            if (thread.joinable())
+            {
+                in->push(message_segment::create_rst(PEER_PORT, LOCAL_PORT));
+                thread.join();
+            }
+
+            close(sockets[0]);
+            close(sockets[1]);
+        }
+
+        void start()
+        {
+            thread = std::thread(&reliable_channel::start, channel);
+        }
+
+        int get_client_fd() const
+        {
+            return sockets[0];
+        }
+
+        // cpu time the channel thread has used so far
+        std::chrono::nanoseconds get_cpu_time()
+        {
+            clockid_t clock;
+            timespec time;
+            if (pthread_getcpuclockid(thread.native_handle(), &clock) != 0
+                || clock_gettime(clock, &time) != 0)
+            {
+                return std::chrono::nanoseconds::max();
+            }
+
+            return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+        }
+
+        std::shared_ptr<frame_queue> out;
+        std::shared_ptr<segment_queue> in;
+        std::shared_ptr<reliable_channel> channel;
+        std::thread thread;
+
+    private:
+        int sockets[2];    // [0]: client end, [1]: channel end
+    };
+
+    // segment carried by a frame a channel queued for transmission
+    std::shared_ptr<message_segment> decode(const frame_buffer &frame)
+    {
+        std::vector<uint8_t> bytes(frame.begin(), frame.end());
+        auto parsed_frame = uart_frame::parse_frame(bytes.cbegin(), bytes.cend());
+        if (parsed_frame == nullptr)
+        {
+            return nullptr;
+        }
+
+        auto request = std::static_pointer_cast<tx_request_64_frame>(parsed_frame->get_data());
+        return std::make_shared<message_segment>(request->get_rf_data());
+    }
+
+    // carries the frames each channel of a pair sends to the other, deliver sees every segment on
+    // the way (along with whether a sent it) and drops it by returning false
+    //  - note: deliver runs on the link thread
+    class test_link
+    {
+    public:
+        typedef std::function<bool(std::shared_ptr<message_segment> segment, bool from_a)> filter;
+
+        test_link(test_channel &a, test_channel &b, filter deliver)
+            : running(true), deliver(deliver),
+              thread(&test_link::run, this, a.out, a.in, b.out, b.in)
+        {
+        }
+
+        ~test_link()
+        {
+            stop();
+        }
+
+        // note: channels still running past this point can't reach each other anymore
+        void stop()
+        {
+            running = false;
+            if (thread.joinable())
+            {
+                thread.join();
+            }
+        }
+
+    private:
+        void run(std::shared_ptr<frame_queue> a_out, std::shared_ptr<segment_queue> a_in,
+            std::shared_ptr<frame_queue> b_out, std::shared_ptr<segment_queue> b_in)
+        {
+            while (running)
+            {
+                std::shared_ptr<frame_buffer> frame;
+                bool idle = true;
+
+                if (a_out->try_pop(frame))
+                {
+                    forward(frame, *b_in, true);
+                    idle = false;
+                }
+
+                if (b_out->try_pop(frame))
+                {
+                    forward(frame, *a_in, false);
+                    idle = false;
+                }
+
+                if (idle)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        }
+
+        void forward(std::shared_ptr<frame_buffer> frame, segment_queue &destination, bool from_a)
+        {
+            auto segment = frame != nullptr ? decode(*frame) : nullptr;
+            if (segment != nullptr && deliver(segment, from_a))
+            {
+                destination.push(segment);
+            }
+        }
+
+        std::atomic<bool> running;
+        filter deliver;
+        std::thread thread;    // note: must be initialized last
+    };
+
+    // reads from fd until length bytes arrived or the stream ended
+    std::vector<uint8_t> receive(int fd, size_t length)
+    {
+        std::vector<uint8_t> buffer(length);
+        size_t received = 0;
+        while (received < length)
+        {
+            ssize_t bytes_received = recv(fd, buffer.data() + received, length - received, 0);
+            if (bytes_received <= 0)
+            {
+                break;
+            }
+
+            received += bytes_received;
+        }
+
+        buffer.resize(received);
+        return buffer;
+    }
+
+    // stream segment with a single byte of payload, as the peer would send it
+    std::shared_ptr<message_segment> create_data(uint16_t sequence_number)
+    {
+        return std::make_shared<message_segment>(PEER_PORT, LOCAL_PORT, sequence_number,
+            message_segment::type::stream_segment, message_segment::flag::none,
+            inline_buffer(std::vector<uint8_t>{static_cast<uint8_t>(sequence_number)}));
+    }
+
+    // ACK block of the next frame channel queues within timeout, nullptr if there was none
+    std::shared_ptr<selective_ack> pop_ack(
+        test_channel &channel, const std::chrono::milliseconds &timeout)
+    {
+        std::shared_ptr<frame_buffer> frame;
+        if (!channel.out->timed_wait_and_pop(frame, timeout))
+        {
+            return nullptr;
+        }
+
+        auto segment = decode(*frame);
+        if (segment == nullptr || !segment->is_ack())
+        {
+            return nullptr;
+        }
+
+        return selective_ack::parse(segment->get_message_begin(), segment->get_message_end());
+    }
+
+    bool is_data(const message_segment &segment)
+    {
+        return !segment.is_ack() && !segment.is_fin() && !segment.is_parity()
+            && segment.get_message_length() != 0;
+    }
+
+    std::vector<uint8_t> create_random_payload(size_t length)
+    {
+        std::mt19937 random(1);
+        std::vector<uint8_t> payload(length);
+        for (auto &byte : payload)
+        {
+            byte = static_cast<uint8_t>(random());
+        }
+
+        return payload;
+    }
+
+    // a full send window holding back coalesced client bytes (incompressible ones read ahead for
+    // compression) has nothing to flush, the channel has to sleep until an ACK arrives
+    TEST(ReliableChannelTest, FullWindowCoalesceWaitTest)
+    {
+        channel_services services;
+        beehive_config config;
+        test_channel local(config, services);
+        local.channel->set_send_policy(reliable_channel::coalesce);
+        local.channel->set_compression(true);
+
+        auto payload = create_random_payload(16 * message_segment::MAX_SEGMENT_LENGTH);
+        ASSERT_EQ(static_cast<ssize_t>(payload.size()),
+            ::send(local.get_client_fd(), payload.data(), payload.size(), 0));
+        local.start();
+
+        // the peer never answers: the initial congestion window goes out, the rest waits
+        std::shared_ptr<frame_buffer> frame;
+        for (uint16_t i = 0; i < congestion_controller::INITIAL_WINDOW_SIZE; ++i)
+        {
+            ASSERT_TRUE(local.out->timed_wait_and_pop(frame, std::chrono::seconds(1)));
+        }
+
+        // well past the coalesce delay, short of the first retransmission timeout
+        auto cpu_time = local.get_cpu_time();
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        auto busy = std::chrono::duration_cast<std::chrono::milliseconds>(
+            local.get_cpu_time() - cpu_time);
+        ASSERT_GT(30, busy.count());
+        ASSERT_EQ(
+            congestion_controller::INITIAL_WINDOW_SIZE, local.channel->get_stats().segments_sent);
+    }
+
+    // a lost segment is resent once FAST_RETRANSMIT_THRESHOLD segments above it were SACK'd, well
+    // ahead of the retransmission timeout, and SACKs that still report the hole after that don't
+    // resend it again (only the retransmission timer does)
+    TEST(ReliableChannelTest, FastRetransmitTest)
+    {
+        channel_services services;
+        beehive_config config;
+        test_channel sender(config, services);
+        test_channel receiver(config, services, false);
+
+        bool dropped = false;
+        uint16_t lost_sequence_number = 0;
+        int retransmissions = 0;
+        std::shared_ptr<message_segment> last_hole_sack;
+        auto deliver = [&](std::shared_ptr<message_segment> segment, bool from_a) {
+            if (!from_a)
+            {
+                auto ack = segment->is_ack()
+                    ? selective_ack::parse(segment->get_message_begin(), segment->get_message_end())
+                    : nullptr;
+                if (dropped && ack != nullptr && ack->get_cumulative_ack() == lost_sequence_number)
+                {
+                    last_hole_sack = segment;
+                }
+
+                return true;
+            }
+
+            if (!is_data(*segment))
+            {
+                return true;
+            }
+
+            if (!dropped)
+            {
+                dropped = true;
+                lost_sequence_number = segment->get_sequence_num();
+                return false;
+            }
+
+            // the sender gets to see the hole reported once more before the retransmission fills
+            // it, as it would if more segments above the hole were in flight
+            if (segment->get_sequence_num() == lost_sequence_number && ++retransmissions == 1)
+            {
+                sender.in->push(std::make_shared<message_segment>(*last_hole_sack));
+            }
+
+            return true;
+        };
+        test_link link(sender, receiver, deliver);
+
+        auto payload = create_random_payload(8 * message_segment::MAX_SEGMENT_LENGTH);
+        ASSERT_EQ(static_cast<ssize_t>(payload.size()),
+            ::send(sender.get_client_fd(), payload.data(), payload.size(), 0));
+        shutdown(receiver.get_client_fd(), SHUT_WR);
+        sender.start();
+        receiver.start();
+        sender.channel->request_channel_close();
+
+        ASSERT_EQ(payload, receive(receiver.get_client_fd(), payload.size()));
+        sender.thread.join();
+        receiver.thread.join();
+        link.stop();
+
+        // a timer driven retransmission would show up as a second one
+        auto stats = sender.channel->get_stats();
+        ASSERT_TRUE(dropped);
+        ASSERT_EQ(1, retransmissions);
+        ASSERT_EQ(1, stats.fast_retransmits);
+        ASSERT_EQ(1, stats.segments_retransmitted);
+    }
+
+    // in-order segments are acknowledged every ack_frequency segments, long before ack_delay
+    TEST(ReliableChannelTest, AckFrequencyTest)
+    {
+        channel_services services;
+        beehive_config config;
+        config.set_ack_frequency(2);
+        config.set_ack_delay(std::chrono::seconds(5));
+        test_channel local(config, services);
+        local.start();
+
+        for (uint16_t sequence_number = 0; sequence_number < 6; sequence_number += 2)
+        {
+            local.in->push(create_data(sequence_number));
+            ASSERT_EQ(nullptr, pop_ack(local, std::chrono::milliseconds(100)));
+
+            local.in->push(create_data(sequence_number + 1));
+            auto ack = pop_ack(local, std::chrono::seconds(1));
+            ASSERT_NE(nullptr, ack);
+            ASSERT_EQ(sequence_number + 2, ack->get_cumulative_ack());
+            ASSERT_TRUE(ack->get_bitmap().empty());
+        }
+    }
+
+    // a lone in-order segment is acknowledged once ack_delay ran out
+    TEST(ReliableChannelTest, DelayedAckTimeoutTest)
+    {
+        channel_services services;
+        beehive_config config;
+        config.set_ack_frequency(2);
+        config.set_ack_delay(std::chrono::milliseconds(20));
+        test_channel local(config, services);
+        local.start();
+
+        auto received = std::chrono::steady_clock::now();
+        local.in->push(create_data(0));
+        auto ack = pop_ack(local, std::chrono::seconds(1));
+        auto elapsed = std::chrono::steady_clock::now() - received;
+
+        ASSERT_NE(nullptr, ack);
+        ASSERT_EQ(1, ack->get_cumulative_ack());
+        ASSERT_LE(config.get_ack_delay(), elapsed);
+        ASSERT_GT(std::chrono::milliseconds(500), elapsed);
+    }
+
+    // out-of-order arrivals and the segment filling the hole are acknowledged right away, the
+    // sender needs to hear about the hole (and its repair) to retransmit in time
+    TEST(ReliableChannelTest, OutOfOrderAckTest)
+    {
+        channel_services services;
+        beehive_config config;
+        config.set_ack_frequency(2);
+        config.set_ack_delay(std::chrono::seconds(5));
+        test_channel local(config, services);
+        local.start();
+
+        local.in->push(create_data(1));
+        auto ack = pop_ack(local, std::chrono::seconds(1));
+        ASSERT_NE(nullptr, ack);
+        ASSERT_EQ(0, ack->get_cumulative_ack());
+        ASSERT_TRUE(ack->is_selectively_acknowledged(1));
+
+        local.in->push(create_data(2));
+        ack = pop_ack(local, std::chrono::seconds(1));
+        ASSERT_NE(nullptr, ack);
+        ASSERT_EQ(0, ack->get_cumulative_ack());
+        ASSERT_TRUE(ack->is_selectively_acknowledged(1));
+        ASSERT_TRUE(ack->is_selectively_acknowledged(2));
+
+        local.in->push(create_data(0));
+        ack = pop_ack(local, std::chrono::seconds(1));
+        ASSERT_NE(nullptr, ack);
+        ASSERT_EQ(3, ack->get_cumulative_ack());
+        ASSERT_TRUE(ack->get_bitmap().empty());
+    }
+
+    // the first FIN|ACK is lost: the sender retransmits its FIN once the retransmission timeout
+    // runs out and backs off, the receiver has closed by then and answers it while lingering
+    TEST(ReliableChannelTest, CleanCloseLostFinAckTest)
+    {
+        channel_services services;
+        beehive_config config;
+        test_channel sender(config, services);
+        test_channel receiver(config, services, false);
+
+        int fins_sent = 0;
+        int finacks_sent = 0;
+        std::chrono::steady_clock::time_point first_fin_sent;
+        std::chrono::microseconds fin_timeout(0);
+        std::chrono::steady_clock::duration fin_retransmit_delay(0);
+        auto deliver = [&](std::shared_ptr<message_segment> segment, bool from_a) {
+            if (from_a && segment->is_fin())
+            {
+                auto now = std::chrono::steady_clock::now();
+                if (++fins_sent == 1)
+                {
+                    first_fin_sent = now;
+                    fin_timeout = sender.channel->get_stats().retransmission_timeout;
+                }
+                else if (fins_sent == 2)
+                {
+                    fin_retransmit_delay = now - first_fin_sent;
+                }
+            }
+
+            return from_a || !segment->is_finack() || ++finacks_sent != 1;
+        };
+        test_link link(sender, receiver, deliver);
+
+        auto payload = create_random_payload(4 * message_segment::MAX_SEGMENT_LENGTH);
+        ASSERT_EQ(static_cast<ssize_t>(payload.size()),
+            ::send(sender.get_client_fd(), payload.data(), payload.size(), 0));
+        shutdown(receiver.get_client_fd(), SHUT_WR);
+        sender.start();
+        receiver.thread = std::thread([&receiver] {
+            receiver.channel->start();
+            receiver.channel->linger();
+        });
+        sender.channel->request_channel_close();
+
+        ASSERT_EQ(payload, receive(receiver.get_client_fd(), payload.size() + 1));
+        ASSERT_TRUE(receive(sender.get_client_fd(), 1).empty());
+        sender.thread.join();
+        receiver.thread.join();
+        link.stop();
+
+        // the sender only returns this early once its FIN was answered, giving up takes
+        // MAX_FIN_RETRANSMISSIONS retransmissions
+        auto stats = sender.channel->get_stats();
+        ASSERT_EQ(2, fins_sent);
+        ASSERT_EQ(2, finacks_sent);
+        ASSERT_LE(fin_timeout, fin_retransmit_delay);
+        ASSERT_EQ(1, stats.segments_retransmitted);
+        ASSERT_EQ(2 * fin_timeout, stats.retransmission_timeout);
+    }
+
+    // a peer that never answers is given up on after idle_timeout: keepalives go out meanwhile,
+    // then the channel resets the connection and shuts the client socket down
+    TEST(ReliableChannelTest, IdleAbortTest)
+    {
+        channel_services services;
+        beehive_config config;
+        config.set_keepalive_interval(std::chrono::milliseconds(20));
+        config.set_idle_timeout(std::chrono::milliseconds(200));
+        test_channel local(config, services);
+
+        auto started = std::chrono::steady_clock::now();
+        local.start();
+
+        int keepalives = 0;
+        std::shared_ptr<message_segment> segment;
+        std::shared_ptr<frame_buffer> frame;
+        while (local.out->timed_wait_and_pop(frame, std::chrono::seconds(1)))
+        {
+            segment = decode(*frame);
+            ASSERT_NE(nullptr, segment);
+            if (!segment->is_ack())
+            {
+                break;
+            }
+
+            ++keepalives;
+        }
+
+        auto elapsed = std::chrono::steady_clock::now() - started;
+        ASSERT_NE(nullptr, segment);
+        ASSERT_TRUE(segment->is_rst());
+        ASSERT_LE(config.get_idle_timeout(), elapsed);
+        ASSERT_LE(config.get_idle_timeout() / config.get_keepalive_interval() / 2, keepalives);
+
+        local.thread.join();
+        ASSERT_TRUE(receive(local.get_client_fd(), 1).empty());
+    }
+}
@@ -0,0 +1,73 @@
+#include "rtt_estimator.h"
+
+// initial value matches the previously hard-coded timeout until a sample is taken
+const std::chrono::microseconds rtt_estimator::INITIAL_RETRANSMISSION_TIMEOUT(500000);
+const std::chrono::microseconds rtt_estimator::MIN_RETRANSMISSION_TIMEOUT(50000);
+const std::chrono::microseconds rtt_estimator::MAX_RETRANSMISSION_TIMEOUT(4000000);
+const uint32_t rtt_estimator::RTT_VARIANCE_MULTIPLIER = 4;
+const uint32_t rtt_estimator::SMOOTHED_RTT_GAIN_SHIFT = 3;
+const uint32_t rtt_estimator::RTT_VARIANCE_GAIN_SHIFT = 2;
+
+rtt_estimator::rtt_estimator()
+    : sampled(false), backoff_count(0), smoothed_rtt(0), rtt_variance(0),
+      retransmission_timeout(INITIAL_RETRANSMISSION_TIMEOUT)
+{
+}
+
+void rtt_estimator::add_sample(const std::chrono::microseconds &rtt)
+{
+    if (!sampled)
+    {
+        sampled = true;
+        smoothed_rtt = rtt;
+        rtt_variance = rtt / 2;
+    }
+    else
+    {
+        // note: RTTVAR must be updated before SRTT since it uses the previous SRTT value
+        auto error = smoothed_rtt > rtt ? smoothed_rtt - rtt : rtt - smoothed_rtt;
+        rtt_variance += (error - rtt_variance) / (1 << RTT_VARIANCE_GAIN_SHIFT);
+        smoothed_rtt += (rtt - smoothed_rtt) / (1 << SMOOTHED_RTT_GAIN_SHIFT);
+    }
+
+    // a fresh sample collapses any backoff that was applied since the last one
+    backoff_count = 0;
+    retransmission_timeout = clamp_timeout(smoothed_rtt + rtt_variance * RTT_VARIANCE_MULTIPLIER);
+}
+
+// exponential backoff, invoked once per retransmission timeout event
+void rtt_estimator::backoff()
+{
+    ++backoff_count;
+    retransmission_timeout = clamp_timeout(retransmission_timeout * 2);
+}
+
+bool rtt_estimator::has_sample() const
+{
+    return sampled;
+}
+
+uint32_t rtt_estimator::get_backoff_count() const
+{
+    return backoff_count;
+}
+
+std::chrono::microseconds rtt_estimator::get_smoothed_rtt() const
+{
+    return smoothed_rtt;
+}
+
+std::chrono::microseconds rtt_estimator::get_rtt_variance() const
+{
+    return rtt_variance;
+}
+
+std::chrono::microseconds rtt_estimator::get_retransmission_timeout() const
+{
+    return retransmission_timeout;
+}
+
+std::chrono::microseconds rtt_estimator::clamp_timeout(const std::chrono::microseconds &timeout)
+{
+    return std::min(std::max(timeout, MIN_RETRANSMISSION_TIMEOUT), MAX_RETRANSMISSION_TIMEOUT);
+}
@@ -0,0 +1,43 @@
+#ifndef RTT_ESTIMATOR_H
+#define RTT_ESTIMATOR_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+// smoothed round trip time estimator used to derive a reliable_channel's retransmission timeout,
+// follows the SRTT/RTTVAR computation described in RFC 6298
+//  - samples must only be taken from segments that were never retransmitted (Karn's algorithm)
+//  - note: not threadsafe, owner is expected to serialize access
+class rtt_estimator
+{
+public:
+    static const std::chrono::microseconds INITIAL_RETRANSMISSION_TIMEOUT;
+    static const std::chrono::microseconds MIN_RETRANSMISSION_TIMEOUT;
+    static const std::chrono::microseconds MAX_RETRANSMISSION_TIMEOUT;
+    static const uint32_t RTT_VARIANCE_MULTIPLIER;    // K
+    static const uint32_t SMOOTHED_RTT_GAIN_SHIFT;    // alpha = 1/8
+    static const uint32_t RTT_VARIANCE_GAIN_SHIFT;    // beta = 1/4
+
+    rtt_estimator();
+
+    void add_sample(const std::chrono::microseconds &rtt);
+    void backoff();
+
+    bool has_sample() const;
+    uint32_t get_backoff_count() const;
+    std::chrono::microseconds get_smoothed_rtt() const;
+    std::chrono::microseconds get_rtt_variance() const;
+    std::chrono::microseconds get_retransmission_timeout() const;
+
+private:
+    static std::chrono::microseconds clamp_timeout(const std::chrono::microseconds &timeout);
+
+    bool sampled;
+    uint32_t backoff_count;
+    std::chrono::microseconds smoothed_rtt;
+    std::chrono::microseconds rtt_variance;
+    std::chrono::microseconds retransmission_timeout;
+};
+
+#endif
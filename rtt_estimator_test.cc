@@ -0,0 +1,82 @@
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include "rtt_estimator.h"
+
+namespace rtt_estimator_test
+{
+    TEST(RTTEstimatorTest, ConstValuesSpec)
+    {
+        ASSERT_EQ(std::chrono::milliseconds(500), rtt_estimator::INITIAL_RETRANSMISSION_TIMEOUT);
+        ASSERT_EQ(std::chrono::milliseconds(50), rtt_estimator::MIN_RETRANSMISSION_TIMEOUT);
+        ASSERT_EQ(std::chrono::milliseconds(4000), rtt_estimator::MAX_RETRANSMISSION_TIMEOUT);
+        ASSERT_EQ(4, rtt_estimator::RTT_VARIANCE_MULTIPLIER);
+        ASSERT_EQ(3, rtt_estimator::SMOOTHED_RTT_GAIN_SHIFT);
+        ASSERT_EQ(2, rtt_estimator::RTT_VARIANCE_GAIN_SHIFT);
+    }
+
+    TEST(RTTEstimatorTest, InitialTimeoutTest)
+    {
+        rtt_estimator estimator;
+        ASSERT_FALSE(estimator.has_sample());
+        ASSERT_EQ(
+            rtt_estimator::INITIAL_RETRANSMISSION_TIMEOUT, estimator.get_retransmission_timeout());
+    }
+
+    TEST(RTTEstimatorTest, FirstSampleTest)
+    {
+        rtt_estimator estimator;
+        estimator.add_sample(std::chrono::milliseconds(40));
+        ASSERT_TRUE(estimator.has_sample());
+        ASSERT_EQ(std::chrono::milliseconds(40), estimator.get_smoothed_rtt());
+        ASSERT_EQ(std::chrono::milliseconds(20), estimator.get_rtt_variance());
+        ASSERT_EQ(std::chrono::milliseconds(120), estimator.get_retransmission_timeout());
+    }
+
+    TEST(RTTEstimatorTest, SmoothedSampleTest)
+    {
+        rtt_estimator estimator;
+        estimator.add_sample(std::chrono::milliseconds(40));
+        estimator.add_sample(std::chrono::milliseconds(80));
+
+        // rttvar = 3/4 * 20 + 1/4 * |40 - 80|, srtt = 7/8 * 40 + 1/8 * 80
+        ASSERT_EQ(std::chrono::milliseconds(25), estimator.get_rtt_variance());
+        ASSERT_EQ(std::chrono::milliseconds(45), estimator.get_smoothed_rtt());
+        ASSERT_EQ(std::chrono::milliseconds(145), estimator.get_retransmission_timeout());
+    }
+
+    TEST(RTTEstimatorTest, MinTimeoutTest)
+    {
+        rtt_estimator estimator;
+        estimator.add_sample(std::chrono::milliseconds(1));
+        ASSERT_EQ(
+            rtt_estimator::MIN_RETRANSMISSION_TIMEOUT, estimator.get_retransmission_timeout());
+    }
+
+    TEST(RTTEstimatorTest, BackoffTest)
+    {
+        rtt_estimator estimator;
+        estimator.backoff();
+        ASSERT_EQ(1, estimator.get_backoff_count());
+        ASSERT_EQ(std::chrono::milliseconds(1000), estimator.get_retransmission_timeout());
+
+        for (int i = 0; i < 10; ++i)
+        {
+            estimator.backoff();
+        }
+
+        ASSERT_EQ(
+            rtt_estimator::MAX_RETRANSMISSION_TIMEOUT, estimator.get_retransmission_timeout());
+    }
+
+    TEST(RTTEstimatorTest, SampleResetsBackoffTest)
+    {
+        rtt_estimator estimator;
+        estimator.backoff();
+        estimator.backoff();
+        estimator.add_sample(std::chrono::milliseconds(40));
+        ASSERT_EQ(0, estimator.get_backoff_count());
+        ASSERT_EQ(std::chrono::milliseconds(120), estimator.get_retransmission_timeout());
+    }
+}
@@ -1,10 +1,9 @@
 #include "rx_packet_64_frame.h"
 
-const size_t rx_packet_64_frame::SOURCE_ADDRESS_OFFSET
-    = frame_data::API_IDENTIFIER_OFFSET + sizeof(frame_data::api_identifier_value);
-const size_t rx_packet_64_frame::RSSI_OFFSET = SOURCE_ADDRESS_OFFSET + sizeof(source_address);
-const size_t rx_packet_64_frame::OPTIONS_OFFSET = RSSI_OFFSET + sizeof(rssi);
-const size_t rx_packet_64_frame::RF_DATA_OFFSET = OPTIONS_OFFSET + sizeof(options);
+const size_t rx_packet_64_frame::SOURCE_ADDRESS_OFFSET = source_address_field::OFFSET;
+const size_t rx_packet_64_frame::RSSI_OFFSET = rssi_field::OFFSET;
+const size_t rx_packet_64_frame::OPTIONS_OFFSET = options_field::OFFSET;
+const size_t rx_packet_64_frame::RF_DATA_OFFSET = layout::LENGTH;
 // TODO: rf_data can't be empty, xbee discards packet (double check)
 const size_t rx_packet_64_frame::MIN_FRAME_DATA_LENGTH = RF_DATA_OFFSET;
 
@@ -12,32 +11,30 @@ std::shared_ptr<rx_packet_64_frame> rx_packet_64_frame::parse_frame(
     std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end)
 {
     auto size = static_cast<size_t>(std::distance(begin, end));
-    if (size < MIN_FRAME_DATA_LENGTH)
+    if (!layout::fits(size) || size - layout::LENGTH > inline_buffer::CAPACITY)
     {
         return nullptr;
     }
 
-    if (begin[frame_data::API_IDENTIFIER_OFFSET] != api_identifier::rx_packet_64)
+    const uint8_t *frame = &*begin;
+    if (layout::read<api_identifier_field>(frame) != api_identifier::rx_packet_64)
     {
         return nullptr;
     }
 
-    // unpack 8 byte address from bytes 1-8
-    uint64_t source_address = util::unpack_bytes_to_width<uint64_t>(begin + SOURCE_ADDRESS_OFFSET);
-    uint8_t rssi = begin[RSSI_OFFSET];
-    uint8_t options = begin[OPTIONS_OFFSET];
-    std::vector<uint8_t> rf_data;
-
-    if (size > RF_DATA_OFFSET)
-    {
-        rf_data = std::vector<uint8_t>(begin + RF_DATA_OFFSET, end);
-    }
+    return allocate_pooled<rx_packet_64_frame>(layout::read<source_address_field>(frame),
+        layout::read<rssi_field>(frame), layout::read<options_field>(frame),
+        inline_buffer(frame + layout::LENGTH, frame + size));
+}
 
-    return std::make_shared<rx_packet_64_frame>(source_address, rssi, options, rf_data);
+bool rx_packet_64_frame::is_broadcast_options(uint8_t options)
+{
+    return (options & (1 << options_bit::address_broadcast))
+        || (options & (1 << options_bit::pan_broadcast));
 }
 
 rx_packet_64_frame::rx_packet_64_frame(
-    uint64_t source_address, uint8_t rssi, uint8_t options, std::vector<uint8_t> rf_data)
+    uint64_t source_address, uint8_t rssi, uint8_t options, const inline_buffer &rf_data)
     : frame_data(api_identifier::rx_packet_64), source_address(source_address), rssi(rssi),
       options(options), rf_data(rf_data)
 {
@@ -48,27 +45,29 @@ uint64_t rx_packet_64_frame::get_source_address() const
     return source_address;
 }
 
-const std::vector<uint8_t> &rx_packet_64_frame::get_rf_data() const
+const inline_buffer &rx_packet_64_frame::get_rf_data() const
 {
     return rf_data;
 }
 
 bool rx_packet_64_frame::is_broadcast_frame() const
 {
-    return (options & (1 << options_bit::address_broadcast))
-        || (options & (1 << options_bit::pan_broadcast));
+    return is_broadcast_options(options);
 }
 
 rx_packet_64_frame::operator std::vector<uint8_t>() const
 {
-    std::vector<uint8_t> frame;
-
-    frame.push_back(api_identifier_value);
-    util::pack_value_as_bytes(
-        std::back_inserter(frame), source_address);    // pack 8 byte address as 8 single bytes
-    frame.push_back(rssi);
-    frame.push_back(options);
-    frame.insert(frame.end(), rf_data.begin(), rf_data.end());
-
+    inline_buffer frame;
+    write_to(frame);
     return frame;
 }
+
+void rx_packet_64_frame::write_to(inline_buffer &buffer) const
+{
+    uint8_t *header = buffer.append(layout::LENGTH);
+    layout::write<api_identifier_field>(header, api_identifier_value);
+    layout::write<source_address_field>(header, source_address);
+    layout::write<rssi_field>(header, rssi);
+    layout::write<options_field>(header, options);
+    buffer.append(rf_data.begin(), rf_data.end());
+}
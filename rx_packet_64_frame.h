@@ -6,7 +6,10 @@
 #include <memory>
 #include <vector>
 
+#include "field_layout.h"
 #include "frame_data.h"
+#include "inline_buffer.h"
+#include "pool_allocator.h"
 #include "util.h"
 
 class rx_packet_64_frame : public frame_data
@@ -18,6 +21,13 @@ public:
     static const size_t RF_DATA_OFFSET;
     static const size_t MIN_FRAME_DATA_LENGTH;
 
+    typedef next_field<api_identifier_field, uint64_t> source_address_field;
+    typedef next_field<source_address_field, uint8_t> rssi_field;
+    typedef next_field<rssi_field, uint8_t> options_field;
+    // rf data follows
+    typedef field_layout<api_identifier_field, source_address_field, rssi_field, options_field>
+        layout;
+
     static std::shared_ptr<rx_packet_64_frame> parse_frame(
         std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end);
 
@@ -28,20 +38,24 @@ public:
         pan_broadcast = 2
     };
 
+    // whether a frame with these options was sent to the broadcast address or pan
+    static bool is_broadcast_options(uint8_t options);
+
     rx_packet_64_frame(
-        uint64_t source_address, uint8_t rssi, uint8_t options, std::vector<uint8_t> rf_data);
+        uint64_t source_address, uint8_t rssi, uint8_t options, const inline_buffer &rf_data);
 
     uint64_t get_source_address() const;
-    const std::vector<uint8_t> &get_rf_data() const;
+    const inline_buffer &get_rf_data() const;
     bool is_broadcast_frame() const;
 
     operator std::vector<uint8_t>() const override;
+    void write_to(inline_buffer &buffer) const override;
 
 private:
     uint64_t source_address;
     uint8_t rssi;    // received signal strength indicator, hex equivalent of (-dBm) value
     uint8_t options;
-    std::vector<uint8_t> rf_data;
+    inline_buffer rf_data;
 };
 
 #endif
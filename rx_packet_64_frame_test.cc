@@ -71,7 +71,7 @@ namespace rx_packet_64_frame_test
     TEST(RXPacket64FrameTest, GetRFDataTest)
     {
         rx_packet_64_frame frame = get_valid_rx_packet_64_frame();
-        ASSERT_EQ(any_valid_payload, frame.get_rf_data());
+        ASSERT_EQ(any_valid_payload, static_cast<std::vector<uint8_t>>(frame.get_rf_data()));
     }
 
     TEST(RXPacket64FrameTest, IsBroadcastFrameTest)
@@ -0,0 +1,74 @@
+#include "rx_packet_64_view.h"
+
+bool rx_packet_64_view::parse(const uint8_t *begin, const uint8_t *end, rx_packet_64_view &view)
+{
+    auto size = static_cast<size_t>(std::distance(begin, end));
+    if (size < uart_frame::HEADER_LENGTH + rx_packet_64_frame::MIN_FRAME_DATA_LENGTH + 1
+        || size > uart_frame::MAX_FRAME_SIZE)
+    {
+        return false;
+    }
+
+    typedef uart_frame::header_layout header;
+    typedef rx_packet_64_frame::layout frame_data_header;
+
+    const uint8_t *frame_data_begin = begin + header::LENGTH;
+    if (header::read<uart_frame::delimiter_field>(begin) != uart_frame::FRAME_DELIMITER
+        || frame_data_header::read<frame_data::api_identifier_field>(frame_data_begin)
+            != frame_data::api_identifier::rx_packet_64)
+    {
+        return false;
+    }
+
+    if (header::read<uart_frame::length_field>(begin) != size - header::LENGTH - 1)
+    {
+        return false;
+    }
+
+    view.frame_data_begin = frame_data_begin;
+    view.rf_data_begin = frame_data_begin + frame_data_header::LENGTH;
+    view.rf_data_end = end - 1;
+    view.source_address
+        = frame_data_header::read<rx_packet_64_frame::source_address_field>(frame_data_begin);
+    view.options = frame_data_header::read<rx_packet_64_frame::options_field>(frame_data_begin);
+    view.checksum = *view.rf_data_end;
+    return true;
+}
+
+uint64_t rx_packet_64_view::get_source_address() const
+{
+    return source_address;
+}
+
+bool rx_packet_64_view::is_broadcast_frame() const
+{
+    return rx_packet_64_frame::is_broadcast_options(options);
+}
+
+const uint8_t *rx_packet_64_view::get_rf_data_begin() const
+{
+    return rf_data_begin;
+}
+
+const uint8_t *rx_packet_64_view::get_rf_data_end() const
+{
+    return rf_data_end;
+}
+
+bool rx_packet_64_view::verify_checksums(const segment_view &segment) const
+{
+    if (segment.get_message_end() != rf_data_end)
+    {
+        return false;
+    }
+
+    // headers are summed on their own, every payload byte is only read once
+    uint8_t frame_sum = std::accumulate(
+        frame_data_begin, segment.get_message_begin(), static_cast<uint8_t>(0));
+    uint16_t message_sum = std::accumulate(
+        segment.get_message_begin(), segment.get_message_end(), static_cast<uint16_t>(0));
+    frame_sum += static_cast<uint8_t>(message_sum);
+
+    return static_cast<uint8_t>(uart_frame::CHECKSUM_TARGET - frame_sum) == checksum
+        && segment.compute_checksum(message_sum) == segment.get_checksum();
+}
@@ -0,0 +1,42 @@
+#ifndef RX_PACKET_64_VIEW_H
+#define RX_PACKET_64_VIEW_H
+
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+
+#include "frame_data.h"
+#include "rx_packet_64_frame.h"
+#include "segment_view.h"
+#include "uart_frame.h"
+#include "util.h"
+
+// uart frame holding an rx_packet_64 frame read in place over the receive buffer, counterpart of
+// uart_frame::parse_frame() + rx_packet_64_frame::parse_frame() that copies nothing
+//  - non-owning: only valid for as long as the bytes it was parsed from
+//  - parse() only checks the framing (delimiter, length and api identifier), checksums are left to
+//  verify_checksums() which covers the message segment carried in rf_data as well
+class rx_packet_64_view
+{
+public:
+    // false unless [begin, end) is a complete API mode 1 (unescaped) rx_packet_64 uart frame
+    static bool parse(const uint8_t *begin, const uint8_t *end, rx_packet_64_view &view);
+
+    uint64_t get_source_address() const;
+    bool is_broadcast_frame() const;
+    const uint8_t *get_rf_data_begin() const;
+    const uint8_t *get_rf_data_end() const;
+    // checks the uart frame checksum and the checksum of segment (parsed from rf_data) in a single
+    // pass, the 16 bit sum of the segment payload also makes up the low byte of the frame sum
+    bool verify_checksums(const segment_view &segment) const;
+
+private:
+    const uint8_t *frame_data_begin;    // api identifier
+    const uint8_t *rf_data_begin;
+    const uint8_t *rf_data_end;    // trailing checksum
+    uint64_t source_address;
+    uint8_t options;
+    uint8_t checksum;
+};
+
+#endif
@@ -0,0 +1,120 @@
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "message_segment.h"
+#include "rx_packet_64_frame.h"
+#include "rx_packet_64_view.h"
+#include "segment_view.h"
+#include "tx_request_64_frame.h"
+#include "uart_frame.h"
+
+namespace rx_packet_64_view_test
+{
+    uint64_t any_source_address = 0xabcdef0123456789;
+    uint8_t any_rssi = 0x0f;
+    std::vector<uint8_t> any_message{'t', 'e', 's', 't'};
+
+    std::vector<uint8_t> get_valid_segment()
+    {
+        return message_segment(1, 2, 3, message_segment::type::stream_segment,
+            message_segment::flag::none, any_message);
+    }
+
+    std::vector<uint8_t> get_valid_frame(uint8_t options = 0)
+    {
+        return uart_frame(std::make_shared<rx_packet_64_frame>(
+            any_source_address, any_rssi, options, get_valid_segment()));
+    }
+
+    bool parse_and_verify(const std::vector<uint8_t> &frame)
+    {
+        rx_packet_64_view view;
+        segment_view segment;
+        return rx_packet_64_view::parse(frame.data(), frame.data() + frame.size(), view)
+            && segment_view::parse(view.get_rf_data_begin(), view.get_rf_data_end(), segment)
+            && view.verify_checksums(segment);
+    }
+
+    TEST(RXPacket64ViewTest, ParseTest)
+    {
+        auto frame = get_valid_frame();
+        rx_packet_64_view view;
+        ASSERT_TRUE(rx_packet_64_view::parse(frame.data(), frame.data() + frame.size(), view));
+        ASSERT_EQ(any_source_address, view.get_source_address());
+        ASSERT_FALSE(view.is_broadcast_frame());
+
+        // rf_data is left in place, up to the trailing checksum
+        ASSERT_EQ(
+            frame.data() + uart_frame::HEADER_LENGTH + rx_packet_64_frame::RF_DATA_OFFSET,
+            view.get_rf_data_begin());
+        ASSERT_EQ(frame.data() + frame.size() - 1, view.get_rf_data_end());
+        ASSERT_EQ(get_valid_segment(),
+            std::vector<uint8_t>(view.get_rf_data_begin(), view.get_rf_data_end()));
+        ASSERT_TRUE(parse_and_verify(frame));
+    }
+
+    TEST(RXPacket64ViewTest, ParseInvalidFramingTest)
+    {
+        rx_packet_64_view view;
+        auto frame = get_valid_frame();
+
+        auto no_delimiter = frame;
+        no_delimiter[uart_frame::FRAME_DELIMITER_OFFSET] = 0x00;
+        ASSERT_FALSE(rx_packet_64_view::parse(
+            no_delimiter.data(), no_delimiter.data() + no_delimiter.size(), view));
+
+        auto truncated = std::vector<uint8_t>(frame.begin(), frame.end() - 1);
+        ASSERT_FALSE(rx_packet_64_view::parse(
+            truncated.data(), truncated.data() + truncated.size(), view));
+
+        std::vector<uint8_t> tx_request
+            = uart_frame(std::make_shared<tx_request_64_frame>(any_source_address, any_message));
+        ASSERT_FALSE(rx_packet_64_view::parse(
+            tx_request.data(), tx_request.data() + tx_request.size(), view));
+
+        // frame data shorter than an rx_packet_64 header
+        std::vector<uint8_t> header_only(frame.begin(),
+            frame.begin() + uart_frame::HEADER_LENGTH + rx_packet_64_frame::RF_DATA_OFFSET - 1);
+        header_only[uart_frame::LENGTH_LSB_OFFSET] = rx_packet_64_frame::RF_DATA_OFFSET - 2;
+        header_only.push_back(0x00);
+        ASSERT_FALSE(rx_packet_64_view::parse(
+            header_only.data(), header_only.data() + header_only.size(), view));
+    }
+
+    TEST(RXPacket64ViewTest, VerifyChecksumsTest)
+    {
+        auto frame = get_valid_frame();
+
+        // caught by the uart checksum
+        auto corrupt_payload = frame;
+        ++corrupt_payload[frame.size() - 2];
+        ASSERT_FALSE(parse_and_verify(corrupt_payload));
+
+        auto corrupt_checksum = frame;
+        ++corrupt_checksum.back();
+        ASSERT_FALSE(parse_and_verify(corrupt_checksum));
+
+        // uart checksum fixed up to match, caught by the segment checksum
+        --corrupt_payload.back();
+        ASSERT_FALSE(parse_and_verify(corrupt_payload));
+
+        // a segment payload byte moved to the header keeps the frame sum, not the segment sum
+        auto moved = frame;
+        size_t message_offset = uart_frame::HEADER_LENGTH + rx_packet_64_frame::RF_DATA_OFFSET
+            + message_segment::MESSAGE_OFFSET;
+        --moved[message_offset];
+        ++moved[uart_frame::HEADER_LENGTH + rx_packet_64_frame::RSSI_OFFSET];
+        ASSERT_FALSE(parse_and_verify(moved));
+    }
+
+    TEST(RXPacket64ViewTest, BroadcastTest)
+    {
+        auto frame = get_valid_frame(1 << rx_packet_64_frame::options_bit::address_broadcast);
+        rx_packet_64_view view;
+        ASSERT_TRUE(rx_packet_64_view::parse(frame.data(), frame.data() + frame.size(), view));
+        ASSERT_TRUE(view.is_broadcast_frame());
+    }
+}
@@ -0,0 +1,99 @@
+#include "segment_view.h"
+
+#include "message_segment.h"
+
+bool segment_view::parse(const uint8_t *begin, const uint8_t *end, segment_view &view)
+{
+    typedef message_segment::header_layout header;
+    typedef message_segment::compact_header_layout compact_header;
+
+    auto size = static_cast<size_t>(std::distance(begin, end));
+    if (compact_header::fits(size)
+        && (compact_header::read<message_segment::compact_flags_field>(begin)
+               & ~message_segment::MESSAGE_FLAGS_MASK)
+            == message_segment::COMPACT_HEADER_MARKER)
+    {
+        uint8_t compact_flags = compact_header::read<message_segment::compact_flags_field>(begin);
+        uint8_t connection_id = compact_header::read<message_segment::connection_id_field>(begin);
+        view.compact = true;
+        view.connection_id = connection_id & message_segment::CONNECTION_ID_MASK;
+        view.source_port = 0;
+        view.destination_port = 0;
+        view.sequence_num
+            = compact_header::read<message_segment::compact_sequence_num_field>(begin);
+        view.checksum = compact_header::read<message_segment::compact_checksum_field>(begin);
+        view.flags = (connection_id & message_segment::COMPRESSED_MASK)
+            | message_segment::type::stream_segment << message_segment::MESSAGE_TYPE_SHIFT_BITS
+            | (compact_flags & message_segment::MESSAGE_FLAGS_MASK);
+        view.message_begin = begin + compact_header::LENGTH;
+        view.message_end = end;
+        return true;
+    }
+
+    if (!header::fits(size))
+    {
+        return false;
+    }
+
+    view.compact = false;
+    view.connection_id = 0;
+    view.source_port = header::read<message_segment::source_port_field>(begin);
+    view.destination_port = header::read<message_segment::destination_port_field>(begin);
+    view.sequence_num = header::read<message_segment::sequence_num_field>(begin);
+    view.checksum = header::read<message_segment::checksum_field>(begin);
+    view.flags = header::read<message_segment::flags_field>(begin);
+    view.message_begin = begin + header::LENGTH;
+    view.message_end = end;
+    return true;
+}
+
+uint16_t segment_view::get_source_port() const
+{
+    return source_port;
+}
+
+uint16_t segment_view::get_destination_port() const
+{
+    return destination_port;
+}
+
+uint16_t segment_view::get_sequence_num() const
+{
+    return sequence_num;
+}
+
+uint16_t segment_view::get_checksum() const
+{
+    return checksum;
+}
+
+uint8_t segment_view::get_flags() const
+{
+    return flags;
+}
+
+bool segment_view::is_compact() const
+{
+    return compact;
+}
+
+uint8_t segment_view::get_connection_id() const
+{
+    return connection_id;
+}
+
+const uint8_t *segment_view::get_message_begin() const
+{
+    return message_begin;
+}
+
+const uint8_t *segment_view::get_message_end() const
+{
+    return message_end;
+}
+
+uint16_t segment_view::compute_checksum(uint16_t message_sum) const
+{
+    return message_segment::compute_checksum(
+        compact ? connection_id : source_port + destination_port, sequence_num, flags, message_sum);
+}
@@ -0,0 +1,45 @@
+#ifndef SEGMENT_VIEW_H
+#define SEGMENT_VIEW_H
+
+#include <cstdint>
+#include <iterator>
+
+#include "util.h"
+
+// header fields of a received message segment read in place, the payload is left where it is
+//  - non-owning: only valid for as long as the bytes it was parsed from, message_segment keeps
+//  those alive for segments that are passed on, see message_segment::create_received()
+//  - covers both the full and the compact header, fields take the values message_segment gives
+//  them (e.g. both ports 0 for a compact segment)
+class segment_view
+{
+public:
+    // false if [begin, end) is too short for the header it starts with
+    static bool parse(const uint8_t *begin, const uint8_t *end, segment_view &view);
+
+    uint16_t get_source_port() const;
+    uint16_t get_destination_port() const;
+    uint16_t get_sequence_num() const;
+    uint16_t get_checksum() const;
+    // as laid out in a full header: compressed bit, type and flags
+    uint8_t get_flags() const;
+    bool is_compact() const;
+    uint8_t get_connection_id() const;
+    const uint8_t *get_message_begin() const;
+    const uint8_t *get_message_end() const;
+    // checksum the segment should carry, message_sum is the 16 bit sum of its payload bytes
+    uint16_t compute_checksum(uint16_t message_sum) const;
+
+private:
+    uint16_t source_port;
+    uint16_t destination_port;
+    uint16_t sequence_num;
+    uint16_t checksum;
+    uint8_t flags;
+    bool compact;
+    uint8_t connection_id;
+    const uint8_t *message_begin;
+    const uint8_t *message_end;
+};
+
+#endif
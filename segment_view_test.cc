@@ -0,0 +1,89 @@
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "message_segment.h"
+#include "segment_view.h"
+
+namespace segment_view_test
+{
+    uint16_t any_source_port = 0x1234;
+    uint16_t any_destination_port = 0x00ab;
+    uint16_t any_sequence_number = 123;
+    std::vector<uint8_t> any_message{'t', 'e', 's', 't'};
+
+    message_segment get_valid_message_segment()
+    {
+        return message_segment(any_source_port, any_destination_port, any_sequence_number,
+            message_segment::type::stream_segment, message_segment::flag::ack, any_message, true);
+    }
+
+    uint16_t get_message_sum(const segment_view &view)
+    {
+        return std::accumulate(
+            view.get_message_begin(), view.get_message_end(), static_cast<uint16_t>(0));
+    }
+
+    TEST(SegmentViewTest, ParseTest)
+    {
+        message_segment segment = get_valid_message_segment();
+        std::vector<uint8_t> encoded = segment;
+
+        segment_view view;
+        ASSERT_TRUE(segment_view::parse(encoded.data(), encoded.data() + encoded.size(), view));
+        ASSERT_FALSE(view.is_compact());
+        ASSERT_EQ(any_source_port, view.get_source_port());
+        ASSERT_EQ(any_destination_port, view.get_destination_port());
+        ASSERT_EQ(any_sequence_number, view.get_sequence_num());
+        ASSERT_EQ(segment.get_checksum(), view.get_checksum());
+        ASSERT_EQ(encoded[message_segment::FLAGS_OFFSET], view.get_flags());
+
+        // payload is left in place
+        ASSERT_EQ(encoded.data() + message_segment::MESSAGE_OFFSET, view.get_message_begin());
+        ASSERT_EQ(encoded.data() + encoded.size(), view.get_message_end());
+        ASSERT_EQ(view.get_checksum(), view.compute_checksum(get_message_sum(view)));
+    }
+
+    TEST(SegmentViewTest, ParseCompactTest)
+    {
+        message_segment segment = get_valid_message_segment();
+        segment.set_connection_id(0x15);
+        std::vector<uint8_t> encoded = segment;
+
+        segment_view view;
+        ASSERT_TRUE(segment_view::parse(encoded.data(), encoded.data() + encoded.size(), view));
+        ASSERT_TRUE(view.is_compact());
+        ASSERT_EQ(0x15, view.get_connection_id());
+        ASSERT_EQ(0, view.get_source_port());
+        ASSERT_EQ(0, view.get_destination_port());
+        ASSERT_EQ(any_sequence_number, view.get_sequence_num());
+        ASSERT_EQ(
+            encoded.data() + message_segment::COMPACT_MESSAGE_OFFSET, view.get_message_begin());
+        ASSERT_EQ(view.get_checksum(), view.compute_checksum(get_message_sum(view)));
+
+        // same header values as a parsed message_segment
+        message_segment parsed(encoded);
+        ASSERT_EQ(parsed.get_message_type(), message_segment::type::stream_segment);
+        ASSERT_TRUE(parsed.is_compressed());
+        ASSERT_EQ(parsed.get_checksum(), view.get_checksum());
+    }
+
+    TEST(SegmentViewTest, ParseTooShortTest)
+    {
+        segment_view view;
+        std::vector<uint8_t> full(message_segment::MIN_SEGMENT_LENGTH - 1, 0x00);
+        ASSERT_FALSE(segment_view::parse(full.data(), full.data() + full.size(), view));
+
+        std::vector<uint8_t> compact(message_segment::MIN_COMPACT_SEGMENT_LENGTH - 1,
+            message_segment::COMPACT_HEADER_MARKER);
+        ASSERT_FALSE(segment_view::parse(compact.data(), compact.data() + compact.size(), view));
+
+        // header only
+        std::vector<uint8_t> empty_message(message_segment::MIN_SEGMENT_LENGTH, 0x00);
+        ASSERT_TRUE(segment_view::parse(
+            empty_message.data(), empty_message.data() + empty_message.size(), view));
+        ASSERT_EQ(view.get_message_end(), view.get_message_begin());
+    }
+}
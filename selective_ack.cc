@@ -0,0 +1,98 @@
+#include "selective_ack.h"
+
+const size_t selective_ack::CUMULATIVE_ACK_OFFSET = 0;
+const size_t selective_ack::RECEIVE_WINDOW_OFFSET = CUMULATIVE_ACK_OFFSET + sizeof(cumulative_ack);
+const size_t selective_ack::BITMAP_LENGTH_OFFSET = RECEIVE_WINDOW_OFFSET + sizeof(receive_window);
+const size_t selective_ack::BITMAP_OFFSET = BITMAP_LENGTH_OFFSET + sizeof(uint8_t);
+const size_t selective_ack::MIN_LENGTH = BITMAP_OFFSET;
+
+std::shared_ptr<selective_ack> selective_ack::parse(const uint8_t *begin, const uint8_t *end)
+{
+    auto size = static_cast<size_t>(std::distance(begin, end));
+    if (size < MIN_LENGTH)
+    {
+        return nullptr;
+    }
+
+    uint8_t bitmap_length = begin[BITMAP_LENGTH_OFFSET];
+    if (size < BITMAP_OFFSET + bitmap_length)
+    {
+        return nullptr;
+    }
+
+    return std::make_shared<selective_ack>(
+        util::unpack_bytes_to_width<uint16_t>(begin + CUMULATIVE_ACK_OFFSET),
+        util::unpack_bytes_to_width<uint16_t>(begin + RECEIVE_WINDOW_OFFSET),
+        std::vector<uint8_t>(begin + BITMAP_OFFSET, begin + BITMAP_OFFSET + bitmap_length));
+}
+
+selective_ack::selective_ack(uint16_t cumulative_ack, uint16_t receive_window)
+    : cumulative_ack(cumulative_ack), receive_window(receive_window)
+{
+}
+
+selective_ack::selective_ack(
+    uint16_t cumulative_ack, uint16_t receive_window, const std::vector<uint8_t> &bitmap)
+    : cumulative_ack(cumulative_ack), receive_window(receive_window), bitmap(bitmap)
+{
+}
+
+bool selective_ack::set_received(uint16_t sequence_number, size_t max_bitmap_length)
+{
+    // note: cumulative_ack itself is by definition missing, so bit 0 maps to cumulative_ack + 1
+    auto bit = static_cast<uint16_t>(sequence_number - cumulative_ack - 1);
+    size_t byte = bit / 8;
+
+    if (byte >= max_bitmap_length || byte > std::numeric_limits<uint8_t>::max() - 1)
+    {
+        return false;
+    }
+
+    if (byte >= bitmap.size())
+    {
+        bitmap.resize(byte + 1);
+    }
+
+    bitmap[byte] |= 0x80 >> (bit % 8);
+    return true;
+}
+
+bool selective_ack::is_selectively_acknowledged(uint16_t sequence_number) const
+{
+    auto bit = static_cast<uint16_t>(sequence_number - cumulative_ack - 1);
+    size_t byte = bit / 8;
+
+    return byte < bitmap.size() && (bitmap[byte] & (0x80 >> (bit % 8)));
+}
+
+uint16_t selective_ack::get_cumulative_ack() const
+{
+    return cumulative_ack;
+}
+
+uint16_t selective_ack::get_receive_window() const
+{
+    return receive_window;
+}
+
+const std::vector<uint8_t> &selective_ack::get_bitmap() const
+{
+    return bitmap;
+}
+
+size_t selective_ack::get_length() const
+{
+    return BITMAP_OFFSET + bitmap.size();
+}
+
+selective_ack::operator std::vector<uint8_t>() const
+{
+    std::vector<uint8_t> block;
+
+    util::pack_value_as_bytes(std::back_inserter(block), cumulative_ack);
+    util::pack_value_as_bytes(std::back_inserter(block), receive_window);
+    block.push_back(static_cast<uint8_t>(bitmap.size()));
+    block.insert(block.end(), bitmap.begin(), bitmap.end());
+
+    return block;
+}
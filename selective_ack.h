@@ -0,0 +1,51 @@
+#ifndef SELECTIVE_ACK_H
+#define SELECTIVE_ACK_H
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "util.h"
+
+// acknowledgement block carried in the payload of stream ACK segments
+//  - cumulative_ack: next sequence number expected in order, all preceding segments were received
+//  - receive_window: number of segments starting at cumulative_ack the receiver can currently take,
+//  senders must not have more than that outstanding
+//  - bitmap: bit i (MSB first) set if segment (cumulative_ack + 1 + i) was received out of order
+//
+// wire format: [cumulative_ack (2)][receive_window (2)][bitmap_length (1)][bitmap (bitmap_length)]
+class selective_ack
+{
+public:
+    static const size_t CUMULATIVE_ACK_OFFSET;
+    static const size_t RECEIVE_WINDOW_OFFSET;
+    static const size_t BITMAP_LENGTH_OFFSET;
+    static const size_t BITMAP_OFFSET;
+    static const size_t MIN_LENGTH;
+
+    static std::shared_ptr<selective_ack> parse(const uint8_t *begin, const uint8_t *end);
+
+    selective_ack(uint16_t cumulative_ack, uint16_t receive_window);
+    selective_ack(
+        uint16_t cumulative_ack, uint16_t receive_window, const std::vector<uint8_t> &bitmap);
+
+    // returns false if sequence_number can't be represented relative to cumulative_ack
+    bool set_received(uint16_t sequence_number, size_t max_bitmap_length);
+    bool is_selectively_acknowledged(uint16_t sequence_number) const;
+
+    uint16_t get_cumulative_ack() const;
+    uint16_t get_receive_window() const;
+    const std::vector<uint8_t> &get_bitmap() const;
+    size_t get_length() const;
+
+    operator std::vector<uint8_t>() const;
+
+private:
+    uint16_t cumulative_ack;
+    uint16_t receive_window;
+    std::vector<uint8_t> bitmap;
+};
+
+#endif
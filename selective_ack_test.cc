@@ -0,0 +1,86 @@
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "selective_ack.h"
+
+namespace selective_ack_test
+{
+    uint16_t any_cumulative_ack = 0xfffe;
+    uint16_t any_receive_window = 64;
+    size_t any_max_bitmap_length = 4;
+
+    TEST(SelectiveAckTest, ConstValuesSpec)
+    {
+        ASSERT_EQ(0, selective_ack::CUMULATIVE_ACK_OFFSET);
+        ASSERT_EQ(2, selective_ack::RECEIVE_WINDOW_OFFSET);
+        ASSERT_EQ(4, selective_ack::BITMAP_LENGTH_OFFSET);
+        ASSERT_EQ(5, selective_ack::BITMAP_OFFSET);
+        ASSERT_EQ(5, selective_ack::MIN_LENGTH);
+    }
+
+    TEST(SelectiveAckTest, CumulativeOnlyTest)
+    {
+        selective_ack ack(any_cumulative_ack, any_receive_window);
+        ASSERT_EQ(any_cumulative_ack, ack.get_cumulative_ack());
+        ASSERT_EQ(any_receive_window, ack.get_receive_window());
+        ASSERT_TRUE(ack.get_bitmap().empty());
+        ASSERT_EQ(selective_ack::MIN_LENGTH, ack.get_length());
+        ASSERT_FALSE(ack.is_selectively_acknowledged(any_cumulative_ack));
+        ASSERT_FALSE(ack.is_selectively_acknowledged(any_cumulative_ack + 1));
+    }
+
+    TEST(SelectiveAckTest, SetReceivedWraparoundTest)
+    {
+        selective_ack ack(any_cumulative_ack, any_receive_window);
+        ASSERT_TRUE(ack.set_received(0xffff, any_max_bitmap_length));
+        ASSERT_TRUE(ack.set_received(8, any_max_bitmap_length));
+        ASSERT_EQ(std::vector<uint8_t>({0x80, 0x40}), ack.get_bitmap());
+        ASSERT_TRUE(ack.is_selectively_acknowledged(0xffff));
+        ASSERT_FALSE(ack.is_selectively_acknowledged(0));
+        ASSERT_TRUE(ack.is_selectively_acknowledged(8));
+    }
+
+    TEST(SelectiveAckTest, SetReceivedOutOfRangeTest)
+    {
+        selective_ack ack(0, any_receive_window);
+        ASSERT_FALSE(ack.set_received(1 + any_max_bitmap_length * 8, any_max_bitmap_length));
+        ASSERT_FALSE(ack.set_received(0, any_max_bitmap_length));
+        ASSERT_TRUE(ack.get_bitmap().empty());
+    }
+
+    TEST(SelectiveAckTest, OperatorVectorTest)
+    {
+        selective_ack ack(0x0102, 0x0304, std::vector<uint8_t>{0xa0});
+        ASSERT_EQ(std::vector<uint8_t>({0x01, 0x02, 0x03, 0x04, 0x01, 0xa0}),
+            static_cast<std::vector<uint8_t>>(ack));
+    }
+
+    TEST(SelectiveAckTest, ParseTooSmall)
+    {
+        std::vector<uint8_t> block{0x00, 0x01, 0x00, 0x40};
+        ASSERT_EQ(nullptr, selective_ack::parse(block.data(), block.data() + block.size()));
+    }
+
+    TEST(SelectiveAckTest, ParseTruncatedBitmap)
+    {
+        std::vector<uint8_t> block{0x00, 0x01, 0x00, 0x40, 0x02, 0xff};
+        ASSERT_EQ(nullptr, selective_ack::parse(block.data(), block.data() + block.size()));
+    }
+
+    TEST(SelectiveAckTest, ParseValidBlockWithTrailingData)
+    {
+        std::vector<uint8_t> block{0x01, 0x02, 0x00, 0x40, 0x01, 0xa0, 't', 'e', 's', 't'};
+        auto ack = selective_ack::parse(block.data(), block.data() + block.size());
+        ASSERT_NE(nullptr, ack);
+        ASSERT_EQ(0x0102, ack->get_cumulative_ack());
+        ASSERT_EQ(0x40, ack->get_receive_window());
+        ASSERT_EQ(std::vector<uint8_t>{0xa0}, ack->get_bitmap());
+        ASSERT_EQ(6, ack->get_length());
+        ASSERT_TRUE(ack->is_selectively_acknowledged(0x0103));
+        ASSERT_FALSE(ack->is_selectively_acknowledged(0x0104));
+        ASSERT_TRUE(ack->is_selectively_acknowledged(0x0105));
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef SEQUENCE_RING_H
+#define SEQUENCE_RING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// fixed capacity ring of slots indexed by sequence_number % capacity, holds the per-segment state
+// of a sliding window without any per-segment allocation
+//  - capacity is rounded up to a power of two so the mapping stays contiguous across sequence
+//  number wraparound
+//  - at most capacity consecutive sequence numbers can be held at once, callers are expected to
+//  only insert sequence numbers within their window
+//  - note: not threadsafe, owner is expected to serialize access
+template <typename T>
+class sequence_ring
+{
+public:
+    sequence_ring(size_t min_capacity)
+        : slots(round_up_capacity(min_capacity)), occupied(slots.size()),
+          sequence_numbers(slots.size()), count(0)
+    {
+    }
+
+    size_t capacity() const
+    {
+        return slots.size();
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    bool contains(uint16_t sequence_number) const
+    {
+        auto i = index(sequence_number);
+        return occupied[i] && sequence_numbers[i] == sequence_number;
+    }
+
+    // occupies the slot for sequence_number (evicting whatever else was mapped there) and returns
+    // its value, note: previous slot contents are left as is so their storage can be reused
+    T &insert(uint16_t sequence_number)
+    {
+        auto i = index(sequence_number);
+        if (!occupied[i])
+        {
+            occupied[i] = true;
+            ++count;
+        }
+
+        sequence_numbers[i] = sequence_number;
+        return slots[i];
+    }
+
+    // note: only valid if contains(sequence_number)
+    T &at(uint16_t sequence_number)
+    {
+        return slots[index(sequence_number)];
+    }
+
+    const T &at(uint16_t sequence_number) const
+    {
+        return slots[index(sequence_number)];
+    }
+
+    bool erase(uint16_t sequence_number)
+    {
+        if (!contains(sequence_number))
+        {
+            return false;
+        }
+
+        occupied[index(sequence_number)] = false;
+        --count;
+        return true;
+    }
+
+private:
+    static size_t round_up_capacity(size_t min_capacity)
+    {
+        size_t capacity = 1;
+        while (capacity < min_capacity && capacity <= UINT16_MAX)
+        {
+            capacity <<= 1;
+        }
+
+        return capacity;
+    }
+
+    size_t index(uint16_t sequence_number) const
+    {
+        return sequence_number & (slots.size() - 1);
+    }
+
+    std::vector<T> slots;
+    std::vector<bool> occupied;    // received/in-flight bitmap
+    std::vector<uint16_t> sequence_numbers;
+    size_t count;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include "sequence_ring.h"
+
+namespace sequence_ring_test
+{
+    uint16_t any_sequence_number = 123;
+
+    TEST(SequenceRingTest, CapacityTest)
+    {
+        ASSERT_EQ(1, sequence_ring<int>(0).capacity());
+        ASSERT_EQ(64, sequence_ring<int>(64).capacity());
+        ASSERT_EQ(128, sequence_ring<int>(65).capacity());
+        ASSERT_EQ(32768, sequence_ring<int>(32767).capacity());
+        ASSERT_EQ(65536, sequence_ring<int>(0x1ffff).capacity());
+    }
+
+    TEST(SequenceRingTest, InsertTest)
+    {
+        sequence_ring<int> ring(4);
+        ASSERT_TRUE(ring.empty());
+
+        ring.insert(any_sequence_number) = 1;
+        ring.insert(any_sequence_number) = 2;
+        ASSERT_EQ(1, ring.size());
+        ASSERT_TRUE(ring.contains(any_sequence_number));
+        ASSERT_EQ(2, ring.at(any_sequence_number));
+    }
+
+    TEST(SequenceRingTest, EraseTest)
+    {
+        sequence_ring<int> ring(4);
+        ring.insert(any_sequence_number);
+        ASSERT_TRUE(ring.erase(any_sequence_number));
+        ASSERT_FALSE(ring.erase(any_sequence_number));
+        ASSERT_FALSE(ring.contains(any_sequence_number));
+        ASSERT_TRUE(ring.empty());
+    }
+
+    TEST(SequenceRingTest, AliasedSequenceNumberTest)
+    {
+        sequence_ring<int> ring(4);
+        ring.insert(any_sequence_number);
+        ASSERT_FALSE(ring.contains(any_sequence_number + 4));
+        ASSERT_FALSE(ring.erase(any_sequence_number + 4));
+
+        ring.insert(any_sequence_number + 4);
+        ASSERT_EQ(1, ring.size());
+        ASSERT_FALSE(ring.contains(any_sequence_number));
+        ASSERT_TRUE(ring.contains(any_sequence_number + 4));
+    }
+
+    TEST(SequenceRingTest, WraparoundTest)
+    {
+        sequence_ring<uint16_t> ring(4);
+        for (uint16_t sequence_number = 0xfffe; sequence_number != 2; ++sequence_number)
+        {
+            ring.insert(sequence_number) = sequence_number;
+        }
+
+        ASSERT_EQ(4, ring.size());
+        for (uint16_t sequence_number = 0xfffe; sequence_number != 2; ++sequence_number)
+        {
+            ASSERT_TRUE(ring.contains(sequence_number));
+            ASSERT_EQ(sequence_number, ring.at(sequence_number));
+        }
+    }
+}
@@ -0,0 +1,292 @@
+#include "serial_port.h"
+
+const std::chrono::milliseconds serial_port::WRITE_TIMEOUT(2000);
+
+serial_port::serial_port(const std::string &device, uint32_t baud)
+    : fd(open(device.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC)), baud(0)
+{
+    if (fd == -1)
+    {
+        perror("open");
+        return;
+    }
+
+    termios settings;
+    if (tcgetattr(fd, &settings) == -1)
+    {
+        perror("tcgetattr");
+        return;
+    }
+
+    cfmakeraw(&settings);
+    settings.c_cflag |= CLOCAL | CREAD;
+    settings.c_cflag &= ~(CSTOPB | CRTSCTS);
+    settings.c_cc[VMIN] = 0;
+    settings.c_cc[VTIME] = 0;
+
+    if (tcsetattr(fd, TCSANOW, &settings) == -1)
+    {
+        perror("tcsetattr");
+        return;
+    }
+
+    set_baud(baud);
+    tcflush(fd, TCIOFLUSH);
+}
+
+serial_port::~serial_port()
+{
+    if (fd != -1)
+    {
+        close(fd);
+    }
+}
+
+bool serial_port::is_open() const
+{
+    return fd != -1;
+}
+
+int serial_port::get_fd() const
+{
+    return fd;
+}
+
+bool serial_port::set_baud(uint32_t baud)
+{
+    speed_t speed;
+    if (!try_get_speed(baud, speed))
+    {
+        fprintf(stderr, "serial_port: unsupported baud %u\n", baud);
+        return false;
+    }
+
+    termios settings;
+    if (tcgetattr(fd, &settings) == -1)
+    {
+        perror("tcgetattr");
+        return false;
+    }
+
+    cfsetispeed(&settings, speed);
+    cfsetospeed(&settings, speed);
+
+    // note: TCSADRAIN lets bytes written at the previous baud go out first
+    if (tcsetattr(fd, TCSADRAIN, &settings) == -1)
+    {
+        perror("tcsetattr");
+        return false;
+    }
+
+    this->baud = baud;
+    return true;
+}
+
+uint32_t serial_port::get_baud() const
+{
+    return baud;
+}
+
+bool serial_port::set_two_stop_bits(bool enabled)
+{
+    termios settings;
+    if (tcgetattr(fd, &settings) == -1)
+    {
+        perror("tcgetattr");
+        return false;
+    }
+
+    if (enabled)
+    {
+        settings.c_cflag |= CSTOPB;
+    }
+    else
+    {
+        settings.c_cflag &= ~CSTOPB;
+    }
+
+    if (tcsetattr(fd, TCSADRAIN, &settings) == -1)
+    {
+        perror("tcsetattr");
+        return false;
+    }
+
+    return true;
+}
+
+bool serial_port::get_cts() const
+{
+    int status;
+    if (ioctl(fd, TIOCMGET, &status) == -1)
+    {
+        // e.g. a pty, lines without modem control are always clear to send
+        return true;
+    }
+
+    return status & TIOCM_CTS;
+}
+
+int serial_port::wait_readable(const std::chrono::milliseconds &timeout) const
+{
+    pollfd entry{fd, POLLIN, 0};
+    int ready = poll(&entry, 1, static_cast<int>(timeout.count()));
+    if (ready == -1)
+    {
+        if (errno == EINTR)
+        {
+            return 0;
+        }
+
+        perror("poll");
+        return -1;
+    }
+
+    if (entry.revents & (POLLERR | POLLHUP | POLLNVAL))
+    {
+        fprintf(stderr, "serial_port: device error or hangup\n");
+        return -1;
+    }
+
+    return ready;
+}
+
+ssize_t serial_port::read(uint8_t *buffer, size_t length)
+{
+    ssize_t bytes_read = ::read(fd, buffer, length);
+    if (bytes_read == -1)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+        {
+            return 0;
+        }
+
+        perror("read");
+    }
+
+    return bytes_read;
+}
+
+std::string serial_port::read_line(const std::chrono::milliseconds &timeout)
+{
+    std::string line;
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (true)
+    {
+        // one byte at a time, bytes following the line are left for the next reader
+        uint8_t byte;
+        ssize_t bytes_read = read(&byte, sizeof(byte));
+        if (bytes_read == -1)
+        {
+            return line;
+        }
+        else if (bytes_read == 1)
+        {
+            if (byte == '\r' || byte == '\n')
+            {
+                return line;
+            }
+
+            line.push_back(static_cast<char>(byte));
+            continue;
+        }
+
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0 || wait_readable(remaining) != 1)
+        {
+            return line;
+        }
+    }
+}
+
+size_t serial_port::write(const uint8_t *data, size_t length)
+{
+    size_t written = 0;
+    auto deadline = std::chrono::steady_clock::now() + WRITE_TIMEOUT;
+
+    while (written < length)
+    {
+        ssize_t bytes_written = ::write(fd, data + written, length - written);
+        if (bytes_written >= 0)
+        {
+            written += bytes_written;
+            continue;
+        }
+
+        if (errno == EINTR)
+        {
+            continue;
+        }
+        else if (errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            perror("write");
+            break;
+        }
+
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        pollfd entry{fd, POLLOUT, 0};
+        if (remaining.count() <= 0 || poll(&entry, 1, static_cast<int>(remaining.count())) <= 0)
+        {
+            break;
+        }
+    }
+
+    return written;
+}
+
+size_t serial_port::write(const std::vector<uint8_t> &data)
+{
+    return write(data.data(), data.size());
+}
+
+size_t serial_port::write(const std::string &data)
+{
+    return write(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+}
+
+bool serial_port::try_get_speed(uint32_t baud, speed_t &speed)
+{
+    switch (baud)
+    {
+        case 1200:
+            speed = B1200;
+            return true;
+
+        case 2400:
+            speed = B2400;
+            return true;
+
+        case 4800:
+            speed = B4800;
+            return true;
+
+        case 9600:
+            speed = B9600;
+            return true;
+
+        case 19200:
+            speed = B19200;
+            return true;
+
+        case 38400:
+            speed = B38400;
+            return true;
+
+        case 57600:
+            speed = B57600;
+            return true;
+
+        case 115200:
+            speed = B115200;
+            return true;
+
+        case 230400:
+            speed = B230400;
+            return true;
+
+        default:
+            return false;
+    }
+}
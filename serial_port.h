@@ -0,0 +1,58 @@
+#ifndef SERIAL_PORT_H
+#define SERIAL_PORT_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <errno.h>
+#include <stdio.h>
+
+// raw (8N1/8N2, no flow control) tty opened nonblocking, every wait is a poll() on its fd so a
+// reader wakes up as soon as bytes arrive rather than after a sleep quantum
+//  - reads never block, writes block until everything is written or WRITE_TIMEOUT expires
+//  - errors are reported with perror() and a -1/false return value
+class serial_port
+{
+public:
+    static const std::chrono::milliseconds WRITE_TIMEOUT;
+
+    serial_port(const std::string &device, uint32_t baud);
+    ~serial_port();
+    serial_port(const serial_port &) = delete;
+    serial_port &operator=(const serial_port &) = delete;
+
+    bool is_open() const;
+    int get_fd() const;
+
+    bool set_baud(uint32_t baud);
+    uint32_t get_baud() const;
+    bool set_two_stop_bits(bool enabled);
+    bool get_cts() const;
+
+    // returns 1 once bytes are buffered, 0 on timeout, -1 on error (e.g. the device went away)
+    int wait_readable(const std::chrono::milliseconds &timeout) const;
+    // returns the number of bytes read, 0 if none are buffered, -1 on error
+    ssize_t read(uint8_t *buffer, size_t length);
+    // reads up to a '\r' or '\n' (dropped), returns whatever arrived if timeout expires first
+    std::string read_line(const std::chrono::milliseconds &timeout);
+    size_t write(const uint8_t *data, size_t length);
+    size_t write(const std::vector<uint8_t> &data);
+    size_t write(const std::string &data);
+
+private:
+    static bool try_get_speed(uint32_t baud, speed_t &speed);
+
+    int fd;
+    uint32_t baud;
+};
+
+#endif
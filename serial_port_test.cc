@@ -0,0 +1,98 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "serial_port.h"
+
+namespace serial_port_test
+{
+    // pseudo terminal standing in for the device, bytes written to master arrive on the port
+    class pseudo_terminal
+    {
+    public:
+        pseudo_terminal()
+            : master_fd(posix_openpt(O_RDWR | O_NOCTTY))
+        {
+            grantpt(master_fd);
+            unlockpt(master_fd);
+        }
+
+        ~pseudo_terminal()
+        {
+            close(master_fd);
+        }
+
+        std::string get_device() const
+        {
+            return ptsname(master_fd);
+        }
+
+        void write_bytes(const std::string &bytes)
+        {
+            ASSERT_EQ(static_cast<ssize_t>(bytes.size()),
+                ::write(master_fd, bytes.data(), bytes.size()));
+        }
+
+        int master_fd;
+    };
+
+    TEST(SerialPortTest, OpenTest)
+    {
+        serial_port missing("/dev/beehive-missing-device", 9600);
+        ASSERT_FALSE(missing.is_open());
+
+        pseudo_terminal terminal;
+        serial_port port(terminal.get_device(), 115200);
+        ASSERT_TRUE(port.is_open());
+        ASSERT_EQ(115200, port.get_baud());
+        ASSERT_FALSE(port.set_baud(12345));
+        ASSERT_TRUE(port.set_baud(9600));
+        ASSERT_EQ(9600, port.get_baud());
+    }
+
+    TEST(SerialPortTest, ReadTest)
+    {
+        pseudo_terminal terminal;
+        serial_port port(terminal.get_device(), 9600);
+
+        uint8_t buffer[16];
+        ASSERT_EQ(0, port.read(buffer, sizeof(buffer)));
+        ASSERT_EQ(0, port.wait_readable(std::chrono::milliseconds(0)));
+
+        terminal.write_bytes("abc");
+        ASSERT_EQ(1, port.wait_readable(std::chrono::milliseconds(1000)));
+        ASSERT_EQ(3, port.read(buffer, sizeof(buffer)));
+        ASSERT_EQ(std::string("abc"), std::string(buffer, buffer + 3));
+    }
+
+    TEST(SerialPortTest, ReadLineTest)
+    {
+        pseudo_terminal terminal;
+        serial_port port(terminal.get_device(), 9600);
+
+        terminal.write_bytes("OK\rnext");
+        ASSERT_EQ("OK", port.read_line(std::chrono::milliseconds(1000)));
+
+        // no line ending before the timeout
+        ASSERT_EQ("next", port.read_line(std::chrono::milliseconds(10)));
+    }
+
+    TEST(SerialPortTest, WriteTest)
+    {
+        pseudo_terminal terminal;
+        serial_port port(terminal.get_device(), 9600);
+        ASSERT_TRUE(port.get_cts());
+        ASSERT_EQ(3, port.write(std::vector<uint8_t>{'a', 'b', 'c'}));
+
+        char buffer[16];
+        ASSERT_EQ(3, ::read(terminal.master_fd, buffer, sizeof(buffer)));
+        ASSERT_EQ(std::string("abc"), std::string(buffer, buffer + 3));
+    }
+}
@@ -5,15 +5,16 @@ simulated_broadcast_medium::simulated_broadcast_medium(uint32_t packet_loss_perc
 {
 }
 
-// TODO: change signature to return failure status as bool and frame payload as out param? (0 sized
-// payload is 'valid')
-std::vector<uint8_t> simulated_broadcast_medium::read_frame(int socket_fd)
+bool simulated_broadcast_medium::read_frame(int socket_fd, std::vector<uint8_t> &frame)
 {
-    std::vector<uint8_t> buffer;
-    ssize_t bytes_read = util::recv(socket_fd, buffer, uart_frame::MAX_FRAME_SIZE);
-    return bytes_read <= 0
-        ? std::vector<uint8_t>()
-        : buffer;
+    ssize_t bytes_read = util::recv(socket_fd, frame, uart_frame::MAX_FRAME_SIZE);
+    if (bytes_read <= 0)
+    {
+        frame.clear();
+        return false;
+    }
+
+    return true;
 }
 
 // TODO: cleanup socket fds
@@ -30,6 +31,7 @@ bool simulated_broadcast_medium::start()
         return false;
     }
 
+    std::vector<uint8_t> frame;
     while (true)
     {
         int client_socket_fd = util::accept_connection(listen_socket_fd);
@@ -38,10 +40,8 @@ bool simulated_broadcast_medium::start()
             continue;
         }
 
-        std::vector<uint8_t> frame = read_frame(client_socket_fd);
-
         // first frame is expected to be address of node
-        if (frame.size() != sizeof(uint64_t))
+        if (!read_frame(client_socket_fd, frame) || frame.size() != sizeof(uint64_t))
         {
             // TODO: send ack back?
             LOG_ERROR("invalid address supplied by node");
@@ -49,9 +49,7 @@ bool simulated_broadcast_medium::start()
         }
 
         uint64_t address = util::unpack_bytes_to_width<uint64_t>(frame.begin());
-        node_sockets[address] = client_socket_fd;
-
-        LOG("client ", util::to_hex_string(address), " connected");
+        add_node(address, client_socket_fd);
 
         std::thread traffic_forwarder(
             &simulated_broadcast_medium::node_traffic_forwarder, this, address, client_socket_fd);
@@ -61,11 +59,19 @@ bool simulated_broadcast_medium::start()
     return true;
 }
 
+void simulated_broadcast_medium::add_node(uint64_t node_address, int node_socket_fd)
+{
+    node_sockets[node_address] = node_socket_fd;
+
+    LOG("client ", util::to_hex_string(node_address), " connected");
+}
+
 void simulated_broadcast_medium::node_traffic_forwarder(uint64_t node_address, int node_socket_fd)
 {
     std::vector<uint8_t> buffer;
+    std::vector<std::pair<uint64_t, int>> destinations;
 
-    while (!(buffer = read_frame(node_socket_fd)).empty())
+    while (read_frame(node_socket_fd, buffer))
     {
         std::shared_ptr<uart_frame> frame = uart_frame::parse_frame(buffer.begin(), buffer.end());
         if (frame == nullptr)
@@ -82,13 +88,15 @@ void simulated_broadcast_medium::node_traffic_forwarder(uint64_t node_address, i
             uint8_t options = destination_address == xbee_s1::BROADCAST_ADDRESS
                 ? (1 << rx_packet_64_frame::options_bit::address_broadcast)
                 : 0;
-            uart_frame rx_frame(std::make_shared<rx_packet_64_frame>(
-                node_address, 0, options, tx_frame->get_rf_data()));    // TODO: simulate rssi
-            auto payload = static_cast<std::vector<uint8_t>>(rx_frame);
+            rx_packet_64_frame rx_frame(
+                node_address, 0, options, tx_frame->get_rf_data());    // TODO: simulate rssi
+            inline_buffer payload;
+            uart_frame::encode(rx_frame, payload);
 
             if (destination_address == xbee_s1::BROADCAST_ADDRESS)
             {
-                for (auto &entry : node_sockets.get_data())
+                node_sockets.get_entries(destinations);
+                for (auto &entry : destinations)
                 {
                     if (dist(mt) < packet_loss_percent)
                     {
@@ -98,7 +106,8 @@ void simulated_broadcast_medium::node_traffic_forwarder(uint64_t node_address, i
 
                     if (entry.first != node_address)
                     {
-                        util::send(entry.second, payload);  // TODO: error handling
+                        // TODO: error handling
+                        util::send(entry.second, payload.data(), payload.size());
                     }
                 }
             }
@@ -116,7 +125,8 @@ void simulated_broadcast_medium::node_traffic_forwarder(uint64_t node_address, i
                     continue;
                 }
 
-                util::send(destination_node_socket_fd, payload);    // TODO: error handling
+                // TODO: error handling
+                util::send(destination_node_socket_fd, payload.data(), payload.size());
             }
         }
         else
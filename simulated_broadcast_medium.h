@@ -5,6 +5,7 @@
 #include <random>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include <sys/socket.h>
@@ -12,6 +13,7 @@
 
 #include "beehive_config.h"
 #include "frame_data.h"
+#include "inline_buffer.h"
 #include "logger.h"
 #include "rx_packet_64_frame.h"
 #include "threadsafe_unordered_map.h"
@@ -22,14 +24,21 @@
 
 // TODO: can add connectivity graph later to simulate different topologies
 // TODO: handle node disconnect/expiration
+//  - forwarding a frame doesn't allocate once the frame pools are warmed up, the receive buffer
+//  and the snapshot of broadcast destinations are reused for every frame of a node
 class simulated_broadcast_medium
 {
 public:
     simulated_broadcast_medium(uint32_t packet_loss_percent);
 
-    static std::vector<uint8_t> read_frame(int socket_fd);
+    // false on error or once the node disconnected, frame is resized to the frame read (0 sized
+    // frames are valid)
+    static bool read_frame(int socket_fd, std::vector<uint8_t> &frame);
 
     bool start();
+    // registers a connected node, start() does this for nodes connecting to the broadcast server
+    void add_node(uint64_t node_address, int node_socket_fd);
+    // forwards frames sent by a node until it disconnects
     void node_traffic_forwarder(uint64_t node_address, int node_socket_fd);
 
 private:
@@ -0,0 +1,202 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "frame_buffer_pool.h"
+#include "message_segment.h"
+#include "pool_allocator.h"
+#include "rx_packet_64_view.h"
+#include "segment_view.h"
+#include "simulated_broadcast_medium_test.h"
+#include "uart_frame.h"
+#include "xbee_s1.h"
+
+namespace simulated_broadcast_medium_allocation_test
+{
+    // heap allocations made by any thread while counting_allocations is set
+    std::atomic<bool> counting_allocations(false);
+    std::atomic<uint64_t> allocation_count(0);
+}
+
+// note: replaces the global allocation functions of the whole binary (why these tests are built into
+// beehive-allocation-tests rather than beehive-tests), every form is replaced so that new and
+// delete always match up (sanitizers check that)
+// note: gcc inlines these into new and delete expressions and then takes malloc() and free() for
+// a mismatched pair
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(size_t size)
+{
+    if (simulated_broadcast_medium_allocation_test::counting_allocations)
+    {
+        ++simulated_broadcast_medium_allocation_test::allocation_count;
+    }
+
+    void *memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return memory;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return operator new(size);
+    }
+    catch (const std::bad_alloc &)
+    {
+        return nullptr;
+    }
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept
+{
+    std::free(memory);
+}
+
+namespace simulated_broadcast_medium_allocation_test
+{
+    using simulated_broadcast_medium_test::DESTINATION_ADDRESS;
+    using simulated_broadcast_medium_test::create_tx_frame;
+    using simulated_broadcast_medium_test::forwarding_medium;
+
+    // once the frame pools are warmed up a forwarded frame doesn't touch the heap
+    TEST(SimulatedBroadcastMediumAllocationTest, SteadyStateTest)
+    {
+        const int WARM_UP_FRAMES = 16;
+        const int FRAMES = 1000;
+
+        forwarding_medium forwarding;
+        std::vector<uint8_t> unicast_frame = create_tx_frame(DESTINATION_ADDRESS);
+        std::vector<uint8_t> broadcast_frame = create_tx_frame(xbee_s1::BROADCAST_ADDRESS);
+        std::vector<uint8_t> received(uart_frame::MAX_FRAME_SIZE);
+
+        for (int i = 0; i < WARM_UP_FRAMES; ++i)
+        {
+            ASSERT_LT(0, forwarding.forward(unicast_frame, received));
+            ASSERT_LT(0, forwarding.forward(broadcast_frame, received));
+        }
+
+        uint64_t pool_hits = pool_allocator<uart_frame>::get_stats().hits;
+        int frames_lost = 0;
+
+        allocation_count = 0;
+        counting_allocations = true;
+        for (int i = 0; i < FRAMES; ++i)
+        {
+            frames_lost += forwarding.forward(unicast_frame, received) <= 0;
+            frames_lost += forwarding.forward(broadcast_frame, received) <= 0;
+        }
+        counting_allocations = false;
+
+        ASSERT_EQ(0, frames_lost);
+        ASSERT_EQ(0, allocation_count);
+        ASSERT_LE(pool_hits + 2 * FRAMES, pool_allocator<uart_frame>::get_stats().hits);
+    }
+
+    // parses a received frame in place and hands it on as a segment the way beehive's
+    // frame_processor does, nullptr if it isn't a valid rx_packet_64 carrying a segment
+    std::shared_ptr<message_segment> create_received_segment(frame_buffer_pool::unique_buffer frame)
+    {
+        rx_packet_64_view rx_packet;
+        segment_view segment_header;
+        if (!rx_packet_64_view::parse(frame->begin(), frame->end(), rx_packet)
+            || !segment_view::parse(
+                rx_packet.get_rf_data_begin(), rx_packet.get_rf_data_end(), segment_header)
+            || !rx_packet.verify_checksums(segment_header))
+        {
+            return nullptr;
+        }
+
+        return message_segment::create_received(std::move(frame), segment_header);
+    }
+
+    // once the pools are warmed up a frame goes from the medium to a received segment (and back
+    // into the pool once the segment is dropped) without touching the heap
+    //  - note: ends where the segment is handed to its channel, the channel itself isn't covered
+    TEST(SimulatedBroadcastMediumAllocationTest, ReceivePathTest)
+    {
+        const int WARM_UP_FRAMES = 16;
+        const int FRAMES = 1000;
+
+        forwarding_medium forwarding;
+        std::vector<uint8_t> tx_frame = create_tx_frame(DESTINATION_ADDRESS);
+
+        for (int i = 0; i < WARM_UP_FRAMES; ++i)
+        {
+            auto received = forwarding.forward(tx_frame);
+            ASSERT_NE(nullptr, received);
+            ASSERT_NE(nullptr, create_received_segment(std::move(received)));
+        }
+
+        int segments_lost = 0;
+        uint64_t payload_sum = 0;
+
+        allocation_count = 0;
+        counting_allocations = true;
+        for (int i = 0; i < FRAMES; ++i)
+        {
+            auto received = forwarding.forward(tx_frame);
+            auto segment = received != nullptr ? create_received_segment(std::move(received))
+                                               : nullptr;
+            if (segment == nullptr)
+            {
+                ++segments_lost;
+                continue;
+            }
+
+            payload_sum += segment->get_message_begin()[0];
+        }
+        counting_allocations = false;
+
+        ASSERT_EQ(0, segments_lost);
+        ASSERT_EQ(0, allocation_count);
+        ASSERT_EQ(static_cast<uint64_t>(FRAMES), payload_sum);
+    }
+}
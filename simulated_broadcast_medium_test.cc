@@ -0,0 +1,54 @@
+#include <cstdint>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include <gtest/gtest.h>
+
+#include "rx_packet_64_view.h"
+#include "segment_view.h"
+#include "simulated_broadcast_medium_test.h"
+#include "uart_frame.h"
+#include "xbee_s1.h"
+
+namespace simulated_broadcast_medium_test
+{
+    TEST(SimulatedBroadcastMediumTest, ForwardTest)
+    {
+        forwarding_medium forwarding;
+        std::vector<uint8_t> received(uart_frame::MAX_FRAME_SIZE);
+        ssize_t size = forwarding.forward(create_tx_frame(DESTINATION_ADDRESS), received);
+        ASSERT_LT(0, size);
+
+        rx_packet_64_view frame;
+        ASSERT_TRUE(rx_packet_64_view::parse(received.data(), received.data() + size, frame));
+        ASSERT_EQ(SOURCE_ADDRESS, frame.get_source_address());
+        ASSERT_FALSE(frame.is_broadcast_frame());
+
+        segment_view segment;
+        ASSERT_TRUE(
+            segment_view::parse(frame.get_rf_data_begin(), frame.get_rf_data_end(), segment));
+        ASSERT_TRUE(frame.verify_checksums(segment));
+        ASSERT_EQ(0x5678, segment.get_destination_port());
+        ASSERT_EQ(std::vector<uint8_t>({0x01, 0x02, 0x03, 0x04, 0x05}),
+            std::vector<uint8_t>(segment.get_message_begin(), segment.get_message_end()));
+    }
+
+    TEST(SimulatedBroadcastMediumTest, ForwardBroadcastTest)
+    {
+        forwarding_medium forwarding;
+        std::vector<uint8_t> received(uart_frame::MAX_FRAME_SIZE);
+        ssize_t size = forwarding.forward(create_tx_frame(xbee_s1::BROADCAST_ADDRESS), received);
+        ASSERT_LT(0, size);
+
+        rx_packet_64_view frame;
+        ASSERT_TRUE(rx_packet_64_view::parse(received.data(), received.data() + size, frame));
+        ASSERT_EQ(SOURCE_ADDRESS, frame.get_source_address());
+        ASSERT_TRUE(frame.is_broadcast_frame());
+
+        // not echoed back to the source node
+        ASSERT_EQ(-1, ::recv(forwarding.source.fds[1], received.data(), received.size(),
+            MSG_DONTWAIT));
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef SIMULATED_BROADCAST_MEDIUM_TEST_H
+#define SIMULATED_BROADCAST_MEDIUM_TEST_H
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "frame_buffer.h"
+#include "frame_buffer_pool.h"
+#include "inline_buffer.h"
+#include "message_segment.h"
+#include "simulated_broadcast_medium.h"
+#include "uart_frame.h"
+
+// medium shared by simulated_broadcast_medium_test.cc and the allocation counting tests, which
+// run in a binary of their own (see simulated_broadcast_medium_allocation_test.cc)
+namespace simulated_broadcast_medium_test
+{
+    const uint64_t SOURCE_ADDRESS = 0x0013a20040a1b2c3;
+    const uint64_t DESTINATION_ADDRESS = 0x0013a20040d4e5f6;
+
+    class node_connection
+    {
+    public:
+        node_connection()
+        {
+            socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds);
+        }
+
+        ~node_connection()
+        {
+            close(fds[0]);
+            close(fds[1]);
+        }
+
+        // fds[0] is the end of the medium, fds[1] the end of the node
+        int fds[2];
+    };
+
+    // forwards frames sent by the source node until the test is done with them
+    class forwarding_medium
+    {
+    public:
+        forwarding_medium()
+            : medium(0)
+        {
+            medium.add_node(SOURCE_ADDRESS, source.fds[0]);
+            medium.add_node(DESTINATION_ADDRESS, destination.fds[0]);
+            forwarder = std::thread(&simulated_broadcast_medium::node_traffic_forwarder, &medium,
+                SOURCE_ADDRESS, source.fds[0]);
+        }
+
+        ~forwarding_medium()
+        {
+            // source node disconnects
+            shutdown(source.fds[1], SHUT_WR);
+            forwarder.join();
+        }
+
+        // sends frame from the source node, returns the size of what the destination node received
+        ssize_t forward(const std::vector<uint8_t> &frame, std::vector<uint8_t> &received)
+        {
+            if (::send(source.fds[1], frame.data(), frame.size(), 0)
+                != static_cast<ssize_t>(frame.size()))
+            {
+                return -1;
+            }
+
+            return ::recv(destination.fds[1], received.data(), received.size(), 0);
+        }
+
+        // as forward(), but the destination node reads the frame into a pooled buffer the way
+        // simulated_communication_endpoint does, nullptr if nothing arrived
+        frame_buffer_pool::unique_buffer forward(const std::vector<uint8_t> &frame)
+        {
+            if (::send(source.fds[1], frame.data(), frame.size(), 0)
+                != static_cast<ssize_t>(frame.size()))
+            {
+                return nullptr;
+            }
+
+            auto received = frame_buffer_pool::get_default().acquire_unique();
+            received->clear(0);
+            ssize_t size = ::recv(destination.fds[1], received->append(frame_buffer::CAPACITY),
+                frame_buffer::CAPACITY, 0);
+            if (size <= 0)
+            {
+                return nullptr;
+            }
+
+            received->resize(static_cast<size_t>(size));
+            return received;
+        }
+
+        simulated_broadcast_medium medium;
+        node_connection source;
+        node_connection destination;
+        std::thread forwarder;
+    };
+
+    inline std::vector<uint8_t> create_tx_frame(uint64_t destination_address)
+    {
+        inline_buffer payload(std::vector<uint8_t>{0x01, 0x02, 0x03, 0x04, 0x05});
+        message_segment segment(
+            0x1234, 0x5678, 9, message_segment::type::datagram_segment, 0, payload);
+        auto frame = uart_frame::encode_tx_request_64(destination_address, segment);
+        return std::vector<uint8_t>(frame->cbegin(), frame->cend());
+    }
+}
+
+#endif
@@ -1,5 +1,7 @@
 #include "simulated_communication_endpoint.h"
 
+const size_t simulated_communication_endpoint::MAX_BATCH_FRAMES = 16;
+
 uint64_t simulated_communication_endpoint::get_random_address()
 {
     std::random_device rd;
@@ -11,10 +13,10 @@ uint64_t simulated_communication_endpoint::get_random_address()
 }
 
 simulated_communication_endpoint::simulated_communication_endpoint()
-    : address(get_random_address())
+    : simulated_communication_endpoint(get_random_address(),
+          util::create_active_abstract_domain_socket(
+              beehive_config::BROADCAST_SERVER_SOCKET_PATH, SOCK_SEQPACKET))
 {
-    socket_fd = util::create_active_abstract_domain_socket(
-        beehive_config::BROADCAST_SERVER_SOCKET_PATH, SOCK_SEQPACKET);
     if (socket_fd == -1)
     {
         // TODO
@@ -27,25 +29,39 @@ simulated_communication_endpoint::simulated_communication_endpoint()
     util::send(socket_fd, buffer);  // TODO: error handling
 }
 
+simulated_communication_endpoint::simulated_communication_endpoint(uint64_t address, int socket_fd)
+    : address(address), socket_fd(socket_fd), receive_buffers(MAX_BATCH_FRAMES),
+      receive_vectors(MAX_BATCH_FRAMES), receive_messages(MAX_BATCH_FRAMES)
+{
+    for (size_t i = 0; i < MAX_BATCH_FRAMES; ++i)
+    {
+        receive_messages[i].msg_hdr.msg_iov = &receive_vectors[i];
+        receive_messages[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+
 uint64_t simulated_communication_endpoint::get_address()
 {
     return address;
 }
 
-void simulated_communication_endpoint::transmit_frame(const std::vector<uint8_t> &payload)
+void simulated_communication_endpoint::transmit_frame(const frame_buffer &frame)
 {
-    LOG("sim_write: [", util::get_frame_hex(payload), "]");
-    util::send(socket_fd, payload); // TODO: error handling
+    LOG("sim_write: [", util::get_frame_hex(frame.data(), frame.size()), "]");
+    if (::send(socket_fd, frame.data(), frame.size(), 0) == -1)
+    {
+        perror("send");    // TODO: error handling
+    }
 }
 
-// TODO: change signature to return failure status as bool and frame payload as out param? (0 sized
-// payload is 'valid')
-std::shared_ptr<uart_frame> simulated_communication_endpoint::receive_frame()
+frame_buffer_pool::unique_buffer simulated_communication_endpoint::receive_frame()
 {
-    int error;
-    std::vector<uint8_t> buffer;
+    // note: blocks until the broadcast server forwards a frame, transmit_frame isn't held up by
+    // this as the socket is full duplex
+    auto frame = frame_buffer_pool::get_default().acquire_unique();
+    frame->clear(0);
     ssize_t bytes_read
-        = util::nonblocking_recv(socket_fd, buffer, uart_frame::MAX_FRAME_SIZE, error);
+        = ::recv(socket_fd, frame->append(frame_buffer::CAPACITY), frame_buffer::CAPACITY, 0);
 
     if (bytes_read == 0)
     {
@@ -54,35 +70,77 @@ std::shared_ptr<uart_frame> simulated_communication_endpoint::receive_frame()
     }
     else if (bytes_read == -1)
     {
-        if (error == EAGAIN || error == EWOULDBLOCK)
+        perror("recv");
+        return nullptr;    // TODO: fatal
+    }
+
+    frame->resize(static_cast<size_t>(bytes_read));
+    LOG("sim_read:  [", util::get_frame_hex(frame->data(), frame->size()), "]");
+    return frame;
+}
+
+bool simulated_communication_endpoint::transmit_frames(
+    const std::vector<std::shared_ptr<frame_buffer>> &frames)
+{
+    // one message per frame, the broadcast server still reads every frame on its own
+    std::vector<iovec> buffers(frames.size());
+    std::vector<mmsghdr> messages(frames.size());
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        LOG("sim_write: [", util::get_frame_hex(frames[i]->data(), frames[i]->size()), "]");
+        buffers[i].iov_base = const_cast<uint8_t *>(frames[i]->data());
+        buffers[i].iov_len = frames[i]->size();
+        messages[i].msg_hdr.msg_iov = &buffers[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    size_t messages_sent = 0;
+    while (messages_sent < messages.size())
+    {
+        int count = sendmmsg(
+            socket_fd, messages.data() + messages_sent, messages.size() - messages_sent, 0);
+        if (count == -1)
         {
-            std::this_thread::sleep_for(
-                std::chrono::milliseconds(25));    // TODO: make configurable in beehive_config?
-            return nullptr;
+            perror("sendmmsg");
+            return false;
         }
 
-        return nullptr;    // TODO: fatal
+        messages_sent += count;
     }
 
-    LOG("sim_read:  [", util::get_frame_hex(buffer), "]");
+    return true;
+}
 
-    std::shared_ptr<uart_frame> frame = uart_frame::parse_frame(buffer.begin(), buffer.end());
-    if (frame == nullptr)
+bool simulated_communication_endpoint::receive_frames(
+    std::vector<frame_buffer_pool::unique_buffer> &frames)
+{
+    for (size_t i = 0; i < MAX_BATCH_FRAMES; ++i)
     {
-        return nullptr;
+        if (receive_buffers[i] == nullptr)
+        {
+            receive_buffers[i] = frame_buffer_pool::get_default().acquire_unique();
+            receive_buffers[i]->clear(0);
+            receive_vectors[i].iov_base = receive_buffers[i]->append(frame_buffer::CAPACITY);
+            receive_vectors[i].iov_len = frame_buffer::CAPACITY;
+        }
     }
 
-    // TODO: util method verify_checksum
-    uint8_t received_checksum = *(buffer.end() - 1);
-    uint8_t calculated_checksum
-        = uart_frame::compute_checksum(buffer.begin() + uart_frame::HEADER_LENGTH,
-            buffer.end() - 1);    // ignore frame header and trailing checksum
+    // blocks for the first frame only, whatever else is already queued comes along with it
+    int count = recvmmsg(
+        socket_fd, receive_messages.data(), receive_messages.size(), MSG_WAITFORONE, nullptr);
+    if (count == -1)
+    {
+        perror("recvmmsg");
+        return false;
+    }
 
-    if (calculated_checksum != received_checksum)
+    for (int i = 0; i < count; ++i)
     {
-        LOG_ERROR("invalid checksum");
-        return nullptr;
+        auto &frame = receive_buffers[i];
+        frame->resize(receive_messages[i].msg_len);
+        LOG("sim_read:  [", util::get_frame_hex(frame->data(), frame->size()), "]");
+        frames.push_back(std::move(frame));
     }
 
-    return frame;
+    return true;
 }
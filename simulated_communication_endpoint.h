@@ -7,13 +7,17 @@
 #include <limits>
 #include <memory>
 #include <random>
+#include <utility>
 #include <vector>
 
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include "beehive_config.h"
 #include "communication_endpoint.h"
+#include "frame_buffer.h"
+#include "frame_buffer_pool.h"
 #include "simulated_broadcast_medium.h"
 #include "uart_frame.h"
 #include "util.h"
@@ -22,16 +26,28 @@ class simulated_communication_endpoint : public communication_endpoint
 {
 public:
     simulated_communication_endpoint();
+    // uses socket_fd as is, it's a SOCK_SEQPACKET socket already registered with the broadcast
+    // server (or connected to another endpoint directly)
+    simulated_communication_endpoint(uint64_t address, int socket_fd);
 
     virtual uint64_t get_address();
-    virtual void transmit_frame(const std::vector<uint8_t> &payload);
-    virtual std::shared_ptr<uart_frame> receive_frame();
+    virtual void transmit_frame(const frame_buffer &frame);
+    virtual frame_buffer_pool::unique_buffer receive_frame();
+    virtual bool transmit_frames(const std::vector<std::shared_ptr<frame_buffer>> &frames);
+    virtual bool receive_frames(std::vector<frame_buffer_pool::unique_buffer> &frames);
 
 private:
+    static const size_t MAX_BATCH_FRAMES;    // per recvmmsg call
+
     static uint64_t get_random_address();
 
     uint64_t address;
     int socket_fd;
+    // recvmmsg reads straight into these, the ones handed out are replaced on the next call
+    //  - note: only receive_frames uses them, it's called from a single thread
+    std::vector<frame_buffer_pool::unique_buffer> receive_buffers;
+    std::vector<iovec> receive_vectors;
+    std::vector<mmsghdr> receive_messages;
 };
 
 #endif
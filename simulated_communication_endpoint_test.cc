@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "frame_buffer.h"
+#include "frame_buffer_pool.h"
+#include "simulated_communication_endpoint.h"
+
+namespace simulated_communication_endpoint_test
+{
+    // frames sent in one sendmmsg batch arrive intact and in order, spread over as many recvmmsg
+    // batches as it takes
+    TEST(SimulatedCommunicationEndpointTest, BatchTransferTest)
+    {
+        int sockets[2];
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets));
+        simulated_communication_endpoint sender(0xa, sockets[0]);
+        simulated_communication_endpoint receiver(0xb, sockets[1]);
+        ASSERT_EQ(0xa, sender.get_address());
+
+        const size_t FRAME_COUNT = 40;
+        std::vector<std::shared_ptr<frame_buffer>> tx_frames;
+        for (size_t i = 0; i < FRAME_COUNT; ++i)
+        {
+            std::vector<uint8_t> bytes;
+            for (size_t j = 0; j <= i; ++j)
+            {
+                bytes.push_back(static_cast<uint8_t>(i + j));
+            }
+
+            auto frame = std::make_shared<frame_buffer>();
+            ASSERT_TRUE(frame->append(bytes.data(), bytes.size()));
+            tx_frames.push_back(frame);
+        }
+
+        ASSERT_TRUE(sender.transmit_frames(tx_frames));
+
+        std::vector<frame_buffer_pool::unique_buffer> rx_frames;
+        size_t receive_calls = 0;
+        while (rx_frames.size() < FRAME_COUNT)
+        {
+            ASSERT_TRUE(receiver.receive_frames(rx_frames));
+            ++receive_calls;
+        }
+
+        ASSERT_EQ(FRAME_COUNT, rx_frames.size());
+        ASSERT_LT(1, receive_calls);
+        ASSERT_GE(FRAME_COUNT, receive_calls);
+        for (size_t i = 0; i < FRAME_COUNT; ++i)
+        {
+            ASSERT_EQ(tx_frames[i]->size(), rx_frames[i]->size());
+            ASSERT_TRUE(std::equal(tx_frames[i]->begin(), tx_frames[i]->end(), rx_frames[i]->begin()));
+        }
+
+        close(sockets[0]);
+        close(sockets[1]);
+    }
+
+    TEST(SimulatedCommunicationEndpointTest, SocketErrorTest)
+    {
+        simulated_communication_endpoint endpoint(0xa, -1);
+
+        const uint8_t byte = 0x7e;
+        std::vector<std::shared_ptr<frame_buffer>> tx_frames{std::make_shared<frame_buffer>()};
+        ASSERT_TRUE(tx_frames[0]->append(&byte, sizeof(byte)));
+        ASSERT_FALSE(endpoint.transmit_frames(tx_frames));
+
+        std::vector<frame_buffer_pool::unique_buffer> rx_frames;
+        ASSERT_FALSE(endpoint.receive_frames(rx_frames));
+        ASSERT_TRUE(rx_frames.empty());
+    }
+}
@@ -0,0 +1,178 @@
+#include "socket_reactor.h"
+
+const size_t socket_reactor::MAX_EVENTS = 32;
+const uint32_t socket_reactor::STOP_EVENT_ID = 0;
+
+socket_reactor::socket_reactor()
+    : epoll_fd(epoll_create1(EPOLL_CLOEXEC)), stop_event_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+      next_registration_id(STOP_EVENT_ID + 1), running_handler_id(STOP_EVENT_ID),
+      stop_requested(false)
+{
+    if (epoll_fd == -1 || stop_event_fd == -1)
+    {
+        perror("socket_reactor");
+        return;
+    }
+
+    // level triggered, stays ready once stop() was called
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = pack_event_data(STOP_EVENT_ID, stop_event_fd);
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, stop_event_fd, &event) == -1)
+    {
+        perror("epoll_ctl");
+    }
+}
+
+socket_reactor::~socket_reactor()
+{
+    close(stop_event_fd);
+    close(epoll_fd);
+}
+
+bool socket_reactor::try_add(int socket_fd, handler on_ready)
+{
+    std::lock_guard<std::mutex> lock(access_lock);
+    if (registrations.count(socket_fd) != 0)
+    {
+        return false;
+    }
+
+    uint32_t id = next_registration_id++;
+    if (next_registration_id == STOP_EVENT_ID)
+    {
+        ++next_registration_id;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLONESHOT;
+    event.data.u64 = pack_event_data(id, socket_fd);
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, socket_fd, &event) == -1)
+    {
+        perror("epoll_ctl");
+        return false;
+    }
+
+    registrations[socket_fd] = registration{id, on_ready};
+    return true;
+}
+
+bool socket_reactor::arm(int socket_fd, uint32_t events)
+{
+    std::lock_guard<std::mutex> lock(access_lock);
+    auto entry = registrations.find(socket_fd);
+    if (entry == registrations.end())
+    {
+        return false;
+    }
+
+    epoll_event event{};
+    event.events = events | EPOLLONESHOT;
+    event.data.u64 = pack_event_data(entry->second.id, socket_fd);
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, socket_fd, &event) == -1)
+    {
+        perror("epoll_ctl");
+        return false;
+    }
+
+    return true;
+}
+
+void socket_reactor::remove(int socket_fd)
+{
+    std::unique_lock<std::mutex> lock(access_lock);
+    auto entry = registrations.find(socket_fd);
+    if (entry == registrations.end())
+    {
+        return;
+    }
+
+    uint32_t id = entry->second.id;
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, socket_fd, nullptr);
+    registrations.erase(entry);
+
+    // an event already returned by epoll_wait may still be dispatched, see dispatch
+    if (std::this_thread::get_id() != dispatch_thread_id)
+    {
+        handler_returned.wait(lock, [this, id] { return running_handler_id != id; });
+    }
+}
+
+size_t socket_reactor::size() const
+{
+    std::lock_guard<std::mutex> lock(access_lock);
+    return registrations.size();
+}
+
+size_t socket_reactor::dispatch(int timeout_ms)
+{
+    epoll_event events[MAX_EVENTS];
+    int event_count = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout_ms);
+    if (event_count == -1)
+    {
+        if (errno != EINTR)
+        {
+            perror("epoll_wait");
+        }
+
+        return 0;
+    }
+
+    size_t handlers_run = 0;
+    for (int i = 0; i < event_count; ++i)
+    {
+        auto id = static_cast<uint32_t>(events[i].data.u64 >> 32);
+        auto socket_fd = static_cast<int>(events[i].data.u64 & UINT32_MAX);
+        if (id == STOP_EVENT_ID)
+        {
+            continue;
+        }
+
+        // socket may have been removed (and its fd reused) since epoll_wait returned
+        std::unique_lock<std::mutex> lock(access_lock);
+        auto entry = registrations.find(socket_fd);
+        if (entry == registrations.end() || entry->second.id != id)
+        {
+            continue;
+        }
+
+        auto on_ready = entry->second.on_ready;
+        running_handler_id = id;
+        dispatch_thread_id = std::this_thread::get_id();
+        lock.unlock();
+
+        on_ready(events[i].events);
+        ++handlers_run;
+
+        lock.lock();
+        running_handler_id = STOP_EVENT_ID;
+        lock.unlock();
+        handler_returned.notify_all();
+    }
+
+    return handlers_run;
+}
+
+void socket_reactor::run()
+{
+    while (!stop_requested)
+    {
+        dispatch(-1);
+    }
+}
+
+void socket_reactor::stop()
+{
+    stop_requested = true;
+
+    uint64_t value = 1;
+    if (write(stop_event_fd, &value, sizeof(value)) == -1)
+    {
+        perror("write");
+    }
+}
+
+uint64_t socket_reactor::pack_event_data(uint32_t id, int socket_fd)
+{
+    return static_cast<uint64_t>(id) << 32 | static_cast<uint32_t>(socket_fd);
+}
@@ -0,0 +1,76 @@
+#ifndef SOCKET_REACTOR_H
+#define SOCKET_REACTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <errno.h>
+
+// epoll based readiness notification for the client facing sockets of the daemon, a single thread
+// waits on every registered socket and dispatches events to the handler of the socket
+//  - registrations are one shot: a socket is registered disarmed, its handler fires once per arm()
+//  (with whatever subset of the armed events is ready) and the socket stays quiet until armed
+//  again, so owners only hear about the readiness they can act on
+//  - arm() reports readiness that is already there, an owner can drain a socket, arm it and then
+//  block without missing anything arriving in between
+//  - handlers run on the thread calling dispatch()/run() without any lock held and must not block,
+//  typically they just wake up the thread owning the socket (e.g. by pushing onto its queue)
+//  - note: EPOLLHUP/EPOLLERR are reported whether or not they were armed for
+class socket_reactor
+{
+public:
+    typedef std::function<void(uint32_t events)> handler;
+
+    static const size_t MAX_EVENTS;    // per epoll_wait call
+
+    socket_reactor();
+    ~socket_reactor();
+
+    bool try_add(int socket_fd, handler on_ready);
+    // events: EPOLLIN and/or EPOLLOUT
+    bool arm(int socket_fd, uint32_t events);
+    // once this returns the handler of socket_fd is neither running nor called anymore (unless
+    // called from the handler itself)
+    void remove(int socket_fd);
+    size_t size() const;
+
+    // waits up to timeout_ms (-1: indefinitely) for events and runs their handlers, returns the
+    // number of handlers run
+    size_t dispatch(int timeout_ms);
+    // dispatches events until stop() is called
+    void run();
+    void stop();
+
+private:
+    struct registration
+    {
+        uint32_t id;    // tells a socket apart from a later one reusing its fd
+        handler on_ready;
+    };
+
+    static const uint32_t STOP_EVENT_ID;
+
+    static uint64_t pack_event_data(uint32_t id, int socket_fd);
+
+    mutable std::mutex access_lock;
+    std::condition_variable handler_returned;
+    int epoll_fd;
+    int stop_event_fd;
+    uint32_t next_registration_id;
+    std::unordered_map<int, registration> registrations;
+    uint32_t running_handler_id;    // STOP_EVENT_ID if none
+    std::thread::id dispatch_thread_id;
+    std::atomic<bool> stop_requested;
+};
+
+#endif
@@ -0,0 +1,179 @@
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "socket_reactor.h"
+
+namespace socket_reactor_test
+{
+    class socket_pair
+    {
+    public:
+        socket_pair()
+        {
+            socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+        }
+
+        ~socket_pair()
+        {
+            close(fds[0]);
+            close(fds[1]);
+        }
+
+        void write_byte()
+        {
+            uint8_t byte = 0;
+            ASSERT_EQ(1, ::send(fds[1], &byte, sizeof(byte), 0));
+        }
+
+        void read_byte()
+        {
+            uint8_t byte;
+            ASSERT_EQ(1, ::recv(fds[0], &byte, sizeof(byte), 0));
+        }
+
+        int fds[2];
+    };
+
+    TEST(SocketReactorTest, ConstValuesSpec)
+    {
+        ASSERT_EQ(32, socket_reactor::MAX_EVENTS);
+    }
+
+    TEST(SocketReactorTest, AddTest)
+    {
+        socket_reactor reactor;
+        socket_pair sockets;
+        ASSERT_TRUE(reactor.try_add(sockets.fds[0], [](uint32_t) {}));
+        ASSERT_FALSE(reactor.try_add(sockets.fds[0], [](uint32_t) {}));
+        ASSERT_EQ(1, reactor.size());
+        ASSERT_FALSE(reactor.arm(sockets.fds[1], EPOLLIN));
+    }
+
+    TEST(SocketReactorTest, RegisteredDisarmedTest)
+    {
+        socket_reactor reactor;
+        socket_pair sockets;
+        int fired = 0;
+        reactor.try_add(sockets.fds[0], [&fired](uint32_t) { ++fired; });
+
+        sockets.write_byte();
+        ASSERT_EQ(0, reactor.dispatch(0));
+        ASSERT_EQ(0, fired);
+    }
+
+    TEST(SocketReactorTest, OneShotTest)
+    {
+        socket_reactor reactor;
+        socket_pair sockets;
+        std::vector<uint32_t> fired;
+        reactor.try_add(sockets.fds[0], [&fired](uint32_t events) { fired.push_back(events); });
+        reactor.arm(sockets.fds[0], EPOLLIN);
+        ASSERT_EQ(0, reactor.dispatch(0));
+
+        sockets.write_byte();
+        ASSERT_EQ(1, reactor.dispatch(0));
+        ASSERT_EQ(std::vector<uint32_t>({EPOLLIN}), fired);
+
+        // still readable, but not armed anymore
+        ASSERT_EQ(0, reactor.dispatch(0));
+
+        // readiness that is already there is reported on arm
+        reactor.arm(sockets.fds[0], EPOLLIN);
+        ASSERT_EQ(1, reactor.dispatch(0));
+        ASSERT_EQ(2, fired.size());
+
+        sockets.read_byte();
+        reactor.arm(sockets.fds[0], EPOLLIN);
+        ASSERT_EQ(0, reactor.dispatch(0));
+    }
+
+    TEST(SocketReactorTest, ArmedEventsTest)
+    {
+        socket_reactor reactor;
+        socket_pair sockets;
+        uint32_t fired = 0;
+        reactor.try_add(sockets.fds[0], [&fired](uint32_t events) { fired = events; });
+
+        // writable, not readable
+        reactor.arm(sockets.fds[0], EPOLLIN | EPOLLOUT);
+        ASSERT_EQ(1, reactor.dispatch(0));
+        ASSERT_EQ(static_cast<uint32_t>(EPOLLOUT), fired);
+    }
+
+    TEST(SocketReactorTest, HangupTest)
+    {
+        socket_reactor reactor;
+        socket_pair sockets;
+        uint32_t fired = 0;
+        reactor.try_add(sockets.fds[0], [&fired](uint32_t events) { fired = events; });
+        reactor.arm(sockets.fds[0], EPOLLIN);
+
+        shutdown(sockets.fds[1], SHUT_WR);
+        ASSERT_EQ(1, reactor.dispatch(0));
+        ASSERT_TRUE(fired & EPOLLIN);
+    }
+
+    TEST(SocketReactorTest, RemoveTest)
+    {
+        socket_reactor reactor;
+        socket_pair sockets;
+        int fired = 0;
+        reactor.try_add(sockets.fds[0], [&fired](uint32_t) { ++fired; });
+        reactor.arm(sockets.fds[0], EPOLLIN);
+        sockets.write_byte();
+
+        reactor.remove(sockets.fds[0]);
+        ASSERT_EQ(0, reactor.size());
+        ASSERT_EQ(0, reactor.dispatch(0));
+        ASSERT_EQ(0, fired);
+        ASSERT_FALSE(reactor.arm(sockets.fds[0], EPOLLIN));
+    }
+
+    TEST(SocketReactorTest, RemoveFromHandlerTest)
+    {
+        socket_reactor reactor;
+        socket_pair sockets;
+        int fired = 0;
+        reactor.try_add(sockets.fds[0], [&reactor, &sockets, &fired](uint32_t) {
+            ++fired;
+            reactor.remove(sockets.fds[0]);
+        });
+        reactor.arm(sockets.fds[0], EPOLLIN);
+        sockets.write_byte();
+
+        ASSERT_EQ(1, reactor.dispatch(0));
+        ASSERT_EQ(1, fired);
+        ASSERT_EQ(0, reactor.size());
+    }
+
+    TEST(SocketReactorTest, RunStopTest)
+    {
+        socket_reactor reactor;
+        socket_pair sockets;
+        std::atomic<int> fired(0);
+        reactor.try_add(sockets.fds[0], [&fired](uint32_t) { ++fired; });
+        reactor.arm(sockets.fds[0], EPOLLIN);
+
+        std::thread reactor_thread(&socket_reactor::run, &reactor);
+        sockets.write_byte();
+
+        // remove waits on a running handler, afterwards nothing fires anymore
+        while (fired == 0)
+        {
+            std::this_thread::yield();
+        }
+
+        reactor.remove(sockets.fds[0]);
+        reactor.stop();
+        reactor_thread.join();
+        ASSERT_EQ(1, fired);
+    }
+}
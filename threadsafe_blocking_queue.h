@@ -5,6 +5,7 @@
 #include <condition_variable>
 #include <mutex>
 #include <queue>
+#include <utility>
 
 // TODO: have contructor that sets default timeout for wait_and_pop ?
 template <typename T>
@@ -24,25 +25,60 @@ public:
         condition.notify_one();
     }
 
+    // note: values are moved out again on pop, so move-only types (e.g. unique_ptr) can be queued
+    void push(T &&value)
+    {
+        std::lock_guard<std::mutex> lock(access_lock);
+        data.push(std::move(value));
+        condition.notify_one();
+    }
+
     // TODO: return T or shared_ptr<T> ?
     T wait_and_pop()
     {
         std::unique_lock<std::mutex> lock(access_lock);
         condition.wait(lock, [this] { return !data.empty(); });
 
-        auto value = data.front();
+        auto value = std::move(data.front());
         data.pop();
 
         return value;
     }
 
+    // takes everything queued at once, so a consumer pays for a single wakeup per burst
+    std::queue<T> wait_and_pop_all()
+    {
+        std::unique_lock<std::mutex> lock(access_lock);
+        condition.wait(lock, [this] { return !data.empty(); });
+
+        std::queue<T> values;
+        values.swap(data);
+
+        return values;
+    }
+
+    bool try_pop(T &value)
+    {
+        std::lock_guard<std::mutex> lock(access_lock);
+
+        if (data.empty())
+        {
+            return false;
+        }
+
+        value = std::move(data.front());
+        data.pop();
+
+        return true;
+    }
+
     bool timed_wait_and_pop(T &value, const std::chrono::milliseconds &timeout)
     {
         std::unique_lock<std::mutex> lock(access_lock);
 
         if (condition.wait_for(lock, timeout, [this] { return !data.empty(); }))
         {
-            value = data.front();
+            value = std::move(data.front());
             data.pop();
 
             return true;
@@ -1,4 +1,5 @@
 #include <chrono>
+#include <memory>
 
 #include <gtest/gtest.h>
 
@@ -22,6 +23,29 @@ namespace threadsafe_blocking_queue_test
         ASSERT_TRUE(queue.empty());
     }
 
+    TEST(ThreadsafeBlockingQueueTest, WaitAndPopAllTest)
+    {
+        threadsafe_blocking_queue<int> queue;
+        queue.push(0);
+        queue.push(1);
+        auto values = queue.wait_and_pop_all();
+        ASSERT_TRUE(queue.empty());
+        ASSERT_EQ(2, values.size());
+        ASSERT_EQ(0, values.front());
+        ASSERT_EQ(1, values.back());
+    }
+
+    TEST(ThreadsafeBlockingQueueTest, TryPopTest)
+    {
+        int value;
+        threadsafe_blocking_queue<int> queue;
+        ASSERT_FALSE(queue.try_pop(value));
+        queue.push(0);
+        ASSERT_TRUE(queue.try_pop(value));
+        ASSERT_TRUE(queue.empty());
+        ASSERT_EQ(0, value);
+    }
+
     TEST(ThreadsafeBlockingQueueTest, TimedWaitAndPopTest)
     {
         int value;
@@ -32,4 +56,20 @@ namespace threadsafe_blocking_queue_test
         ASSERT_TRUE(queue.empty());
         ASSERT_EQ(0, value);
     }
+
+    TEST(ThreadsafeBlockingQueueTest, MoveOnlyTest)
+    {
+        std::unique_ptr<int> value;
+        threadsafe_blocking_queue<std::unique_ptr<int>> queue;
+        queue.push(std::unique_ptr<int>(new int(0)));
+        queue.push(std::unique_ptr<int>(new int(1)));
+        queue.push(std::unique_ptr<int>(new int(2)));
+
+        ASSERT_EQ(0, *queue.wait_and_pop());
+        ASSERT_TRUE(queue.try_pop(value));
+        ASSERT_EQ(1, *value);
+        ASSERT_TRUE(queue.timed_wait_and_pop(value, std::chrono::milliseconds(1000)));
+        ASSERT_EQ(2, *value);
+        ASSERT_TRUE(queue.empty());
+    }
 }
@@ -4,6 +4,8 @@
 #include <functional>
 #include <mutex>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 template <typename K, typename V, typename Hash = std::hash<K>>
 class threadsafe_unordered_map
@@ -26,13 +28,8 @@ public:
     bool try_add(const K &key, const V &value)
     {
         std::lock_guard<std::mutex> lock(access_lock);
-        if (table.count(key) > 0)
-        {
-            return false;
-        }
-
-        table[key] = value;
-        return true;
+        // note: doesn't require V to be default constructible, unlike operator[]
+        return table.emplace(key, value).second;
     }
 
     bool try_get(const K &key, V &value) const
@@ -55,12 +52,36 @@ public:
         return table.erase(key);
     }
 
+    // erases key only if predicate(value) holds, check and erase are atomic
+    template <typename Predicate>
+    typename std::unordered_map<K, V, Hash>::size_type erase_if(
+        const K &key, Predicate predicate)
+    {
+        std::lock_guard<std::mutex> lock(access_lock);
+
+        auto iter = table.find(key);
+        if (iter == table.end() || !predicate(iter->second))
+        {
+            return 0;
+        }
+
+        table.erase(iter);
+        return 1;
+    }
+
     std::unordered_map<K, V, Hash> get_data() const
     {
         std::lock_guard<std::mutex> lock(access_lock);
         return table;
     }
 
+    // snapshot of the entries like get_data(), reusing the storage of entries
+    void get_entries(std::vector<std::pair<K, V>> &entries) const
+    {
+        std::lock_guard<std::mutex> lock(access_lock);
+        entries.assign(table.cbegin(), table.cend());
+    }
+
 private:
     mutable std::mutex access_lock;
     std::unordered_map<K, V, Hash> table;
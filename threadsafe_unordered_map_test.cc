@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "threadsafe_unordered_map.h"
@@ -47,4 +51,30 @@ namespace threadsafe_unordered_map_test
         ASSERT_EQ(1, map.erase(0));
         ASSERT_FALSE(map.try_get(0, value));
     }
+
+    TEST(ThreadsafeUnorderedMapTest, EraseIfTest)
+    {
+        int value;
+        threadsafe_unordered_map<int, int> map;
+        ASSERT_EQ(0, map.erase_if(0, [](int) { return true; }));
+        map[0] = 1;
+        ASSERT_EQ(0, map.erase_if(0, [](int v) { return v == 2; }));
+        ASSERT_TRUE(map.try_get(0, value));
+        ASSERT_EQ(1, map.erase_if(0, [](int v) { return v == 1; }));
+        ASSERT_FALSE(map.try_get(0, value));
+    }
+
+    TEST(ThreadsafeUnorderedMapTest, GetEntriesTest)
+    {
+        threadsafe_unordered_map<int, int> map;
+        std::vector<std::pair<int, int>> entries{{5, 5}};
+        map.get_entries(entries);
+        ASSERT_TRUE(entries.empty());
+
+        map[0] = 1;
+        map[1] = 2;
+        map.get_entries(entries);
+        std::sort(entries.begin(), entries.end());
+        ASSERT_EQ((std::vector<std::pair<int, int>>{{0, 1}, {1, 2}}), entries);
+    }
 }
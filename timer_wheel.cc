@@ -0,0 +1,228 @@
+#include "timer_wheel.h"
+
+const timer_wheel::timer_id timer_wheel::INVALID_TIMER_ID = 0;
+const std::chrono::microseconds timer_wheel::TICK(5000);
+const size_t timer_wheel::SLOT_BITS = 6;
+const size_t timer_wheel::SLOTS_PER_LEVEL = 1 << SLOT_BITS;
+const size_t timer_wheel::LEVELS = 4;    // ~23h range with 5ms ticks
+
+timer_wheel::timer_wheel()
+    : timer_wheel(std::chrono::steady_clock::now())
+{
+}
+
+timer_wheel::timer_wheel(std::chrono::steady_clock::time_point start_time)
+    : running(false), start_time(start_time), current_tick(0),
+      next_timer_id(INVALID_TIMER_ID + 1),
+      slots(LEVELS * SLOTS_PER_LEVEL), stop_requested(false)
+{
+}
+
+timer_wheel::timer_id timer_wheel::schedule(
+    std::chrono::steady_clock::duration delay, callback action)
+{
+    // round up so a timer never fires early, and always at least one tick from now
+    auto delay_us = std::chrono::duration_cast<std::chrono::microseconds>(delay).count();
+    uint64_t ticks = delay_us <= 0 ? 1 : (delay_us + TICK.count() - 1) / TICK.count();
+    ticks = std::min(ticks, (static_cast<uint64_t>(1) << (SLOT_BITS * LEVELS)) - 1);
+
+    std::unique_lock<std::mutex> lock(access_lock);
+    uint64_t now_tick = current_tick;
+    if (running)
+    {
+        // the wheel is only advanced when something is due, so current_tick may lag behind
+        now_tick = std::max(current_tick, get_tick(std::chrono::steady_clock::now()));
+        if (timers.empty())
+        {
+            // nothing to fire or cascade on the way
+            current_tick = now_tick;
+        }
+
+        // part of the current tick has already passed
+        ++ticks;
+    }
+
+    uint64_t max_ticks = (static_cast<uint64_t>(1) << (SLOT_BITS * LEVELS)) - 1;
+    uint64_t expiry_tick = std::min(now_tick + ticks, current_tick + max_ticks);
+
+    timer_id id = next_timer_id++;
+    timer_slot pending;
+    pending.push_back(timer_entry{id, expiry_tick, action});
+    insert(pending, pending.begin());
+    lock.unlock();
+
+    // the new timer may be due before the one run() is waiting for
+    wakeup.notify_one();
+    return id;
+}
+
+bool timer_wheel::cancel(timer_id id)
+{
+    std::lock_guard<std::mutex> lock(access_lock);
+    auto timer = timers.find(id);
+    if (timer == timers.end())
+    {
+        return false;
+    }
+
+    slots[timer->second.first].erase(timer->second.second);
+    timers.erase(timer);
+    return true;
+}
+
+void timer_wheel::advance(std::chrono::steady_clock::time_point now)
+{
+    uint64_t target_tick = get_tick(now);
+
+    while (true)
+    {
+        timer_slot expired;
+        std::unique_lock<std::mutex> lock(access_lock);
+        if (current_tick >= target_tick)
+        {
+            return;
+        }
+
+        ++current_tick;
+
+        // a higher level slot is cascaded each time every level below it completes a rotation
+        for (size_t level = 1; level < LEVELS; ++level)
+        {
+            if ((current_tick & ((static_cast<uint64_t>(1) << (SLOT_BITS * level)) - 1)) != 0)
+            {
+                break;
+            }
+
+            cascade(level);
+        }
+
+        expired.splice(expired.end(), slots[current_tick & (SLOTS_PER_LEVEL - 1)]);
+        for (auto &entry : expired)
+        {
+            timers.erase(entry.id);
+        }
+
+        lock.unlock();
+
+        for (auto &entry : expired)
+        {
+            entry.action();
+        }
+    }
+}
+
+size_t timer_wheel::size() const
+{
+    std::lock_guard<std::mutex> lock(access_lock);
+    return timers.size();
+}
+
+void timer_wheel::run()
+{
+    std::unique_lock<std::mutex> lock(access_lock);
+    running = true;
+
+    while (!stop_requested)
+    {
+        if (timers.empty())
+        {
+            wakeup.wait(lock);
+        }
+        else
+        {
+            wakeup.wait_until(
+                lock, start_time + TICK * static_cast<int64_t>(get_next_event_tick()));
+        }
+
+        // note: woken up by schedule() nothing may be due yet, advance() is a no-op then
+        lock.unlock();
+        advance(std::chrono::steady_clock::now());
+        lock.lock();
+    }
+
+    running = false;
+}
+
+void timer_wheel::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(access_lock);
+        stop_requested = true;
+    }
+
+    wakeup.notify_all();
+}
+
+uint64_t timer_wheel::get_tick(std::chrono::steady_clock::time_point time) const
+{
+    return static_cast<uint64_t>(
+        std::max(std::chrono::duration_cast<std::chrono::microseconds>(time - start_time),
+            std::chrono::microseconds::zero())
+        / TICK);
+}
+
+uint64_t timer_wheel::get_next_event_tick() const
+{
+    uint64_t next_event_tick = UINT64_MAX;
+
+    for (size_t level = 0; level < LEVELS; ++level)
+    {
+        // level 0 slots are due at their tick, higher level slots at the start of their span
+        size_t shift = SLOT_BITS * level;
+        for (uint64_t step = 1; step <= SLOTS_PER_LEVEL; ++step)
+        {
+            uint64_t slot_tick = ((current_tick >> shift) + step) << shift;
+            if (slot_tick >= next_event_tick)
+            {
+                break;
+            }
+
+            if (!slots[level * SLOTS_PER_LEVEL + ((slot_tick >> shift) & (SLOTS_PER_LEVEL - 1))]
+                     .empty())
+            {
+                next_event_tick = slot_tick;
+                break;
+            }
+        }
+    }
+
+    return next_event_tick;
+}
+
+// lowest level whose range covers the remaining delay, slot is picked by the expiry tick's digit
+// for that level
+size_t timer_wheel::get_slot_index(uint64_t expiry_tick) const
+{
+    uint64_t remaining_ticks = expiry_tick - current_tick;
+    size_t level = 0;
+
+    while (level < LEVELS - 1
+        && remaining_ticks >= (static_cast<uint64_t>(1) << (SLOT_BITS * (level + 1))))
+    {
+        ++level;
+    }
+
+    return level * SLOTS_PER_LEVEL
+        + ((expiry_tick >> (SLOT_BITS * level)) & (SLOTS_PER_LEVEL - 1));
+}
+
+// note: splice keeps entry valid, so iterators held in timers survive cascading
+void timer_wheel::insert(timer_slot &source, timer_slot::iterator entry)
+{
+    auto index = get_slot_index(entry->expiry_tick);
+    slots[index].splice(slots[index].end(), source, entry);
+    timers[entry->id] = std::make_pair(index, entry);
+}
+
+void timer_wheel::cascade(size_t level)
+{
+    timer_slot cascading;
+    cascading.splice(cascading.end(),
+        slots[level * SLOTS_PER_LEVEL
+            + ((current_tick >> (SLOT_BITS * level)) & (SLOTS_PER_LEVEL - 1))]);
+
+    while (!cascading.empty())
+    {
+        insert(cascading, cascading.begin());
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// hierarchical timing wheel on the steady clock, drives every protocol timer in the daemon
+// (retransmissions, handshake retries, neighbour expiry) from a single thread
+//  - LEVELS wheels of SLOTS_PER_LEVEL slots, level 0 slots span one TICK and each slot of a higher
+//  level spans a full rotation of the level below, timers cascade down a level as their expiry
+//  gets closer
+//  - schedule/cancel are O(1), expiry is rounded up to the next tick, delays beyond the range of
+//  the wheel are clamped
+//  - callbacks run on the thread calling advance()/run() without any lock held, so they may
+//  schedule or cancel timers themselves
+//  - run() only wakes up when the next occupied slot is due (or a cascade is), an empty wheel
+//  waits until schedule() is called
+class timer_wheel
+{
+public:
+    typedef uint64_t timer_id;
+    typedef std::function<void()> callback;
+
+    static const timer_id INVALID_TIMER_ID;
+    static const std::chrono::microseconds TICK;
+    static const size_t SLOT_BITS;
+    static const size_t SLOTS_PER_LEVEL;
+    static const size_t LEVELS;
+
+    timer_wheel();
+    timer_wheel(std::chrono::steady_clock::time_point start_time);
+
+    timer_id schedule(std::chrono::steady_clock::duration delay, callback action);
+    // returns false if timer already fired (or is firing) or was never scheduled
+    bool cancel(timer_id id);
+    // fires every timer that expired up to now
+    void advance(std::chrono::steady_clock::time_point now);
+    size_t size() const;
+
+    // advances the wheel whenever a timer is due until stop() is called
+    //  - note: while run() drives the wheel, schedule() counts delays from the current time rather
+    //  than from the last tick advanced to
+    void run();
+    void stop();
+
+private:
+    struct timer_entry
+    {
+        timer_id id;
+        uint64_t expiry_tick;
+        callback action;
+    };
+
+    typedef std::list<timer_entry> timer_slot;
+
+    uint64_t get_tick(std::chrono::steady_clock::time_point time) const;
+    // earliest tick at which advance() has something to do: the expiry of the next occupied level
+    //  0 slot or the cascade of an occupied higher level slot, wheel must not be empty
+    uint64_t get_next_event_tick() const;
+    size_t get_slot_index(uint64_t expiry_tick) const;
+    void insert(timer_slot &source, timer_slot::iterator entry);
+    void cascade(size_t level);
+
+    mutable std::mutex access_lock;
+    std::condition_variable wakeup;    // notified by schedule() and stop()
+    bool running;    // run() drives the wheel
+    std::chrono::steady_clock::time_point start_time;
+    uint64_t current_tick;
+    timer_id next_timer_id;
+    std::vector<timer_slot> slots;    // LEVELS * SLOTS_PER_LEVEL, level major
+    std::unordered_map<timer_id, std::pair<size_t, timer_slot::iterator>> timers;
+    std::atomic<bool> stop_requested;
+};
+
+#endif
@@ -0,0 +1,142 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "timer_wheel.h"
+
+namespace timer_wheel_test
+{
+    std::chrono::steady_clock::time_point any_start_time;
+
+    TEST(TimerWheelTest, ConstValuesSpec)
+    {
+        ASSERT_EQ(0, timer_wheel::INVALID_TIMER_ID);
+        ASSERT_EQ(std::chrono::microseconds(5000), timer_wheel::TICK);
+        ASSERT_EQ(6, timer_wheel::SLOT_BITS);
+        ASSERT_EQ(64, timer_wheel::SLOTS_PER_LEVEL);
+        ASSERT_EQ(4, timer_wheel::LEVELS);
+    }
+
+    TEST(TimerWheelTest, FireTest)
+    {
+        timer_wheel timers(any_start_time);
+        int fired = 0;
+        timers.schedule(std::chrono::milliseconds(12), [&fired] { ++fired; });
+        ASSERT_EQ(1, timers.size());
+
+        // rounded up to 3 ticks
+        timers.advance(any_start_time + std::chrono::milliseconds(14));
+        ASSERT_EQ(0, fired);
+        timers.advance(any_start_time + std::chrono::milliseconds(15));
+        ASSERT_EQ(1, fired);
+        ASSERT_EQ(0, timers.size());
+    }
+
+    TEST(TimerWheelTest, ZeroDelayTest)
+    {
+        timer_wheel timers(any_start_time);
+        int fired = 0;
+        timers.schedule(std::chrono::milliseconds::zero(), [&fired] { ++fired; });
+        timers.advance(any_start_time + timer_wheel::TICK);
+        ASSERT_EQ(1, fired);
+    }
+
+    TEST(TimerWheelTest, CancelTest)
+    {
+        timer_wheel timers(any_start_time);
+        int fired = 0;
+        auto id = timers.schedule(std::chrono::milliseconds(10), [&fired] { ++fired; });
+
+        ASSERT_TRUE(timers.cancel(id));
+        ASSERT_FALSE(timers.cancel(id));
+        ASSERT_FALSE(timers.cancel(timer_wheel::INVALID_TIMER_ID));
+        timers.advance(any_start_time + std::chrono::seconds(1));
+        ASSERT_EQ(0, fired);
+    }
+
+    TEST(TimerWheelTest, CascadeOrderTest)
+    {
+        timer_wheel timers(any_start_time);
+        std::vector<int> order;
+        timers.schedule(std::chrono::seconds(30), [&order] { order.push_back(3); });
+        timers.schedule(std::chrono::milliseconds(330), [&order] { order.push_back(2); });
+        timers.schedule(std::chrono::milliseconds(5), [&order] { order.push_back(1); });
+
+        timers.advance(any_start_time + std::chrono::milliseconds(325));
+        ASSERT_EQ(std::vector<int>({1}), order);
+        timers.advance(any_start_time + std::chrono::milliseconds(330));
+        ASSERT_EQ(std::vector<int>({1, 2}), order);
+        timers.advance(any_start_time + std::chrono::milliseconds(29995));
+        ASSERT_EQ(std::vector<int>({1, 2}), order);
+        timers.advance(any_start_time + std::chrono::seconds(30));
+        ASSERT_EQ(std::vector<int>({1, 2, 3}), order);
+    }
+
+    TEST(TimerWheelTest, CancelAfterCascadeTest)
+    {
+        timer_wheel timers(any_start_time);
+        int fired = 0;
+        auto id = timers.schedule(std::chrono::seconds(1), [&fired] { ++fired; });
+
+        timers.advance(any_start_time + std::chrono::milliseconds(990));
+        ASSERT_TRUE(timers.cancel(id));
+        timers.advance(any_start_time + std::chrono::seconds(2));
+        ASSERT_EQ(0, fired);
+    }
+
+    TEST(TimerWheelTest, RescheduleFromCallbackTest)
+    {
+        timer_wheel timers(any_start_time);
+        int fired = 0;
+        std::function<void()> periodic = [&] {
+            if (++fired < 3)
+            {
+                timers.schedule(std::chrono::milliseconds(100), periodic);
+            }
+        };
+
+        timers.schedule(std::chrono::milliseconds(100), periodic);
+        timers.advance(any_start_time + std::chrono::seconds(1));
+        ASSERT_EQ(3, fired);
+        ASSERT_EQ(0, timers.size());
+    }
+
+    // run() sleeps while the wheel is empty, timers scheduled afterwards still count from now
+    TEST(TimerWheelTest, RunAfterIdleTest)
+    {
+        timer_wheel timers;
+        std::thread timer_thread(&timer_wheel::run, &timers);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        std::atomic<int> fired(0);
+        auto scheduled = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point short_fired;
+        std::chrono::steady_clock::time_point long_fired;
+        timers.schedule(std::chrono::milliseconds(30), [&] {
+            short_fired = std::chrono::steady_clock::now();
+            ++fired;
+        });
+        // cascades down from level 1
+        timers.schedule(std::chrono::milliseconds(400), [&] {
+            long_fired = std::chrono::steady_clock::now();
+            ++fired;
+        });
+
+        auto deadline = scheduled + std::chrono::seconds(5);
+        while (fired < 2 && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+
+        timers.stop();
+        timer_thread.join();
+
+        ASSERT_EQ(2, fired);
+        ASSERT_LE(std::chrono::milliseconds(30), short_fired - scheduled);
+        ASSERT_LE(std::chrono::milliseconds(400), long_fired - scheduled);
+        ASSERT_EQ(0, timers.size());
+    }
+}
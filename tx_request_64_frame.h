@@ -6,7 +6,11 @@
 #include <memory>
 #include <vector>
 
+#include "field_layout.h"
+#include "frame_buffer.h"
 #include "frame_data.h"
+#include "inline_buffer.h"
+#include "pool_allocator.h"
 #include "util.h"
 
 class tx_request_64_frame : public frame_data
@@ -18,8 +22,19 @@ public:
     static const size_t RF_DATA_OFFSET;
     static const size_t MIN_FRAME_DATA_LENGTH;
 
+    typedef next_field<api_identifier_field, uint8_t> frame_id_field;
+    typedef next_field<frame_id_field, uint64_t> destination_address_field;
+    typedef next_field<destination_address_field, uint8_t> options_field;
+    // rf data follows
+    typedef field_layout<api_identifier_field, frame_id_field, destination_address_field,
+        options_field>
+        layout;
+
     static std::shared_ptr<tx_request_64_frame> parse_frame(
         std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end);
+    // prepends the frame data header (api identifier up to the options) to the rf data already in
+    // buffer, the frame is sent without a response frame or ack, false if headroom is exhausted
+    static bool prepend_header(frame_buffer &buffer, uint64_t destination_address);
 
     enum options : uint8_t
     {
@@ -30,21 +45,22 @@ public:
 
     // TODO: can have diagnostic tx_requests sent with enable_response_frame = true to see if writes
     // are actually occurring
-    tx_request_64_frame(uint64_t destination_address, const std::vector<uint8_t> &rf_data,
+    tx_request_64_frame(uint64_t destination_address, const inline_buffer &rf_data,
         bool enable_response_frame = false);
     tx_request_64_frame(uint8_t frame_id, uint64_t destination_address, uint8_t options_value,
-        const std::vector<uint8_t> &rf_data);
+        const inline_buffer &rf_data);
 
     uint64_t get_destination_address() const;
-    const std::vector<uint8_t> &get_rf_data() const;
+    const inline_buffer &get_rf_data() const;
 
     operator std::vector<uint8_t>() const override;
+    void write_to(inline_buffer &buffer) const override;
 
 private:
     uint8_t frame_id;
     uint64_t destination_address;
     uint8_t options_value;
-    std::vector<uint8_t> rf_data;    // TODO: max size 100 bytes
+    inline_buffer rf_data;    // TODO: max size 100 bytes
 };
 
 #endif
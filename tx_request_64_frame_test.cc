@@ -73,7 +73,7 @@ namespace tx_request_64_frame_test
     TEST(TXRequest64FrameTest, GetRFDataTest)
     {
         tx_request_64_frame frame = get_valid_tx_request_64_frame();
-        ASSERT_EQ(any_valid_payload, frame.get_rf_data());
+        ASSERT_EQ(any_valid_payload, static_cast<std::vector<uint8_t>>(frame.get_rf_data()));
     }
 
     TEST(TXRequest64FrameTest, OperatorVectorTest)
@@ -1,27 +1,25 @@
 #include "tx_status_frame.h"
 
-const size_t tx_status_frame::FRAME_ID_OFFSET
-    = frame_data::API_IDENTIFIER_OFFSET + sizeof(frame_data::api_identifier);
-const size_t tx_status_frame::STATUS_OFFSET = FRAME_ID_OFFSET + sizeof(frame_id);
-const size_t tx_status_frame::MIN_FRAME_DATA_LENGTH = STATUS_OFFSET + sizeof(status);
+const size_t tx_status_frame::FRAME_ID_OFFSET = frame_id_field::OFFSET;
+const size_t tx_status_frame::STATUS_OFFSET = status_field::OFFSET;
+const size_t tx_status_frame::MIN_FRAME_DATA_LENGTH = layout::LENGTH;
 
 std::shared_ptr<tx_status_frame> tx_status_frame::parse_frame(
     std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end)
 {
-    if (static_cast<size_t>(std::distance(begin, end)) < MIN_FRAME_DATA_LENGTH)
+    if (!layout::fits(static_cast<size_t>(std::distance(begin, end))))
     {
         return nullptr;
     }
 
-    if (begin[frame_data::API_IDENTIFIER_OFFSET] != api_identifier::tx_status)
+    const uint8_t *frame = &*begin;
+    if (layout::read<api_identifier_field>(frame) != api_identifier::tx_status)
     {
         return nullptr;
     }
 
-    uint8_t frame_id = begin[FRAME_ID_OFFSET];
-    uint8_t status = begin[STATUS_OFFSET];
-
-    return std::make_shared<tx_status_frame>(frame_id, status);
+    return allocate_pooled<tx_status_frame>(
+        layout::read<frame_id_field>(frame), layout::read<status_field>(frame));
 }
 
 tx_status_frame::tx_status_frame(uint8_t frame_id, uint8_t status)
@@ -31,11 +29,10 @@ tx_status_frame::tx_status_frame(uint8_t frame_id, uint8_t status)
 
 tx_status_frame::operator std::vector<uint8_t>() const
 {
-    std::vector<uint8_t> frame;
-
-    frame.push_back(api_identifier_value);
-    frame.push_back(frame_id);
-    frame.push_back(status_value);
+    std::vector<uint8_t> frame(layout::LENGTH);
+    layout::write<api_identifier_field>(frame.data(), api_identifier_value);
+    layout::write<frame_id_field>(frame.data(), frame_id);
+    layout::write<status_field>(frame.data(), status_value);
 
     return frame;
 }
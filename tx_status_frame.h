@@ -6,7 +6,9 @@
 #include <memory>
 #include <vector>
 
+#include "field_layout.h"
 #include "frame_data.h"
+#include "pool_allocator.h"
 
 class tx_status_frame : public frame_data
 {
@@ -15,6 +17,10 @@ public:
     static const size_t STATUS_OFFSET;
     static const size_t MIN_FRAME_DATA_LENGTH;
 
+    typedef next_field<api_identifier_field, uint8_t> frame_id_field;
+    typedef next_field<frame_id_field, uint8_t> status_field;
+    typedef field_layout<api_identifier_field, frame_id_field, status_field> layout;
+
     static std::shared_ptr<tx_status_frame> parse_frame(
         std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end);
 
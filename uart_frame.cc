@@ -1,15 +1,18 @@
 #include "uart_frame.h"
 
+#include "escape_codec.h"
+#include "message_segment.h"
+
 const uint8_t uart_frame::FRAME_DELIMITER = 0x7e;
 const uint8_t uart_frame::ESCAPE = 0x7d;
 const uint8_t uart_frame::XON = 0x11;
 const uint8_t uart_frame::XOFF = 0x13;
 const uint8_t uart_frame::XOR_CONST = 0x20;
 const uint8_t uart_frame::CHECKSUM_TARGET = 0xff;
-const size_t uart_frame::FRAME_DELIMITER_OFFSET = 0;
-const size_t uart_frame::LENGTH_MSB_OFFSET = FRAME_DELIMITER_OFFSET + sizeof(FRAME_DELIMITER);
+const size_t uart_frame::FRAME_DELIMITER_OFFSET = delimiter_field::OFFSET;
+const size_t uart_frame::LENGTH_MSB_OFFSET = length_field::OFFSET;
 const size_t uart_frame::LENGTH_LSB_OFFSET = LENGTH_MSB_OFFSET + sizeof(length_msb);
-const size_t uart_frame::API_IDENTIFIER_OFFSET = LENGTH_LSB_OFFSET + sizeof(length_lsb);
+const size_t uart_frame::API_IDENTIFIER_OFFSET = header_layout::LENGTH;
 const size_t uart_frame::IDENTIFIER_DATA_OFFSET
     = API_IDENTIFIER_OFFSET + sizeof(frame_data::api_identifier_value);
 const size_t uart_frame::HEADER_LENGTH = API_IDENTIFIER_OFFSET;
@@ -19,6 +22,27 @@ const size_t uart_frame::MIN_FRAME_SIZE
 // max size seen so far: 115 byte tx_request_64 frame (100 byte payload) -> 115 byte rx_packet_64 frame
 const size_t uart_frame::MAX_FRAME_SIZE = 115;
 
+template <typename Frame>
+std::shared_ptr<frame_data> uart_frame::parse_frame_data(
+    std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end)
+{
+    return Frame::parse_frame(begin, end);
+}
+
+constexpr uart_frame::frame_data_parsers uart_frame::create_frame_data_parsers()
+{
+    frame_data_parsers table{};
+    table.parsers[frame_data::api_identifier::tx_request_64]
+        = &parse_frame_data<tx_request_64_frame>;
+    table.parsers[frame_data::api_identifier::rx_packet_64] = &parse_frame_data<rx_packet_64_frame>;
+    table.parsers[frame_data::api_identifier::at_command_response]
+        = &parse_frame_data<at_command_response_frame>;
+    table.parsers[frame_data::api_identifier::tx_status] = &parse_frame_data<tx_status_frame>;
+    return table;
+}
+
+const uart_frame::frame_data_parsers uart_frame::FRAME_DATA_PARSERS = create_frame_data_parsers();
+
 std::shared_ptr<uart_frame> uart_frame::parse_frame(
     std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end)
 {
@@ -28,49 +52,111 @@ std::shared_ptr<uart_frame> uart_frame::parse_frame(
         return nullptr;
     }
 
-    if (begin[FRAME_DELIMITER_OFFSET] != FRAME_DELIMITER)
+    const uint8_t *frame = &*begin;
+    if (header_layout::read<delimiter_field>(frame) != FRAME_DELIMITER
+        || header_layout::read<length_field>(frame) != size - HEADER_LENGTH - sizeof(checksum))
+    {
+        return nullptr;
+    }
+
+    frame_data_parser parser = FRAME_DATA_PARSERS.parsers[begin[API_IDENTIFIER_OFFSET]];
+    if (parser == nullptr)
+    {
+        LOG_ERROR("invalid api identifier value: ", +begin[API_IDENTIFIER_OFFSET]);
+        return nullptr;
+    }
+
+    std::shared_ptr<frame_data> data = parser(begin + API_IDENTIFIER_OFFSET, end - 1);
+    if (data == nullptr)
     {
+        LOG_ERROR("failed to parse frame");
         return nullptr;
     }
 
-    if (util::unpack_bytes_to_width<uint16_t>(begin + LENGTH_MSB_OFFSET)
-        != std::distance(begin + API_IDENTIFIER_OFFSET, end - 1))
+    return allocate_pooled<uart_frame>(
+        begin[LENGTH_MSB_OFFSET], begin[LENGTH_LSB_OFFSET], data, *(end - 1));
+}
+
+std::shared_ptr<uart_frame> uart_frame::parse_escaped_frame(
+    std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end)
+{
+    if (begin == end || *begin != FRAME_DELIMITER)
     {
         return nullptr;
     }
 
-    std::shared_ptr<frame_data> data;
-    switch (begin[API_IDENTIFIER_OFFSET])
+    std::vector<uint8_t> frame{FRAME_DELIMITER};
+    if (!escape_codec().unescape(&*begin + 1, &*begin + std::distance(begin, end), frame))
     {
-        case frame_data::api_identifier::tx_request_64:
-            data = tx_request_64_frame::parse_frame(begin + API_IDENTIFIER_OFFSET, end - 1);
-            break;
+        LOG_ERROR("invalid escape sequence");
+        return nullptr;
+    }
+
+    return parse_frame(frame.cbegin(), frame.cend());
+}
 
-        case frame_data::api_identifier::rx_packet_64:
-            data = rx_packet_64_frame::parse_frame(begin + API_IDENTIFIER_OFFSET, end - 1);
-            break;
+std::vector<uint8_t> uart_frame::escape_frame(const std::vector<uint8_t> &frame)
+{
+    std::vector<uint8_t> escaped_frame;
+    escape_frame(frame.data(), frame.size(), escaped_frame);
+    return escaped_frame;
+}
 
-        case frame_data::api_identifier::at_command_response:
-            data = at_command_response_frame::parse_frame(begin + API_IDENTIFIER_OFFSET, end - 1);
-            break;
+void uart_frame::escape_frame(const uint8_t *frame, size_t length, std::vector<uint8_t> &output)
+{
+    if (length == 0)
+    {
+        return;
+    }
 
-        case frame_data::api_identifier::tx_status:
-            data = tx_status_frame::parse_frame(begin + API_IDENTIFIER_OFFSET, end - 1);
-            break;
+    output.push_back(frame[FRAME_DELIMITER_OFFSET]);
+    escape_codec().escape(frame + 1, frame + length, output);
+}
 
-        default:
-            LOG_ERROR("invalid api identifier value: ", +begin[API_IDENTIFIER_OFFSET]);
-            return nullptr;
+bool uart_frame::encapsulate(frame_buffer &buffer)
+{
+    if (buffer.get_headroom() < HEADER_LENGTH || buffer.get_tailroom() < sizeof(checksum))
+    {
+        return false;
     }
 
-    if (data == nullptr)
+    uint8_t frame_checksum
+        = CHECKSUM_TARGET - std::accumulate(buffer.begin(), buffer.end(), static_cast<uint8_t>(0));
+    auto payload_length = static_cast<uint16_t>(buffer.size());
+
+    uint8_t *header = buffer.prepend(header_layout::LENGTH);
+    header_layout::write<delimiter_field>(header, FRAME_DELIMITER);
+    header_layout::write<length_field>(header, payload_length);
+    *buffer.append(sizeof(checksum)) = frame_checksum;
+    return true;
+}
+
+std::shared_ptr<frame_buffer> uart_frame::encode_tx_request_64(
+    uint64_t destination_address, const message_segment &segment)
+{
+    auto buffer = frame_buffer_pool::get_default().acquire();
+    if (!segment.write_to(*buffer)
+        || !tx_request_64_frame::prepend_header(*buffer, destination_address)
+        || !encapsulate(*buffer))
     {
-        LOG_ERROR("failed to parse frame");
+        LOG_ERROR("segment does not fit in a frame");
         return nullptr;
     }
 
-    return std::make_shared<uart_frame>(
-        begin[LENGTH_MSB_OFFSET], begin[LENGTH_LSB_OFFSET], data, *(end - 1));
+    return buffer;
+}
+
+void uart_frame::encode(const frame_data &data, inline_buffer &frame)
+{
+    uint8_t *header = frame.append(header_layout::LENGTH);
+    header_layout::write<delimiter_field>(header, FRAME_DELIMITER);
+    data.write_to(frame);
+
+    // note: inline storage doesn't move, header is still valid
+    const uint8_t *payload_begin = header + header_layout::LENGTH;
+    header_layout::write<length_field>(header, static_cast<uint16_t>(frame.end() - payload_begin));
+    frame.push_back(
+        CHECKSUM_TARGET - std::accumulate(payload_begin, frame.end(), static_cast<uint8_t>(0)));
 }
 
 uart_frame::uart_frame(std::shared_ptr<frame_data> data)
@@ -102,15 +188,7 @@ uint8_t uart_frame::compute_checksum(
 
 uart_frame::operator std::vector<uint8_t>() const
 {
-    std::vector<uint8_t> frame;
-
-    frame.push_back(FRAME_DELIMITER);
-    auto payload = static_cast<std::vector<uint8_t>>(*data);
-    auto payload_length = static_cast<uint16_t>(payload.size());
-    util::pack_value_as_bytes(
-        std::back_inserter(frame), payload_length);    // pack 2 byte length as 2 single bytes
-    frame.insert(frame.end(), payload.begin(), payload.end());
-    frame.push_back(compute_checksum(payload.begin(), payload.end()));
-
+    inline_buffer frame;
+    encode(*data, frame);
     return frame;
 }
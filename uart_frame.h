@@ -8,13 +8,20 @@
 #include <vector>
 
 #include "at_command_response_frame.h"
+#include "field_layout.h"
+#include "frame_buffer.h"
+#include "frame_buffer_pool.h"
 #include "frame_data.h"
+#include "inline_buffer.h"
 #include "logger.h"
+#include "pool_allocator.h"
 #include "rx_packet_64_frame.h"
 #include "tx_request_64_frame.h"
 #include "tx_status_frame.h"
 #include "util.h"
 
+class message_segment;
+
 class uart_frame
 {
 public:
@@ -33,8 +40,31 @@ public:
     static const size_t MIN_FRAME_SIZE;
     static const size_t MAX_FRAME_SIZE;
 
+    typedef field<uint8_t, 0> delimiter_field;
+    // length of the frame data, api identifier up to the checksum (excluded)
+    typedef next_field<delimiter_field, uint16_t> length_field;
+    // frame data and checksum follow
+    typedef field_layout<delimiter_field, length_field> header_layout;
+
     static std::shared_ptr<uart_frame> parse_frame(
         std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end);
+    // API mode 2 (escaped) counterpart of parse_frame, nullptr if an escape sequence is malformed
+    static std::shared_ptr<uart_frame> parse_escaped_frame(
+        std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end);
+    // API mode 2 encoding of an API mode 1 frame, everything but the leading delimiter is escaped
+    static std::vector<uint8_t> escape_frame(const std::vector<uint8_t> &frame);
+    // appends the escaped frame to output
+    static void escape_frame(const uint8_t *frame, size_t length, std::vector<uint8_t> &output);
+    // turns the frame data in buffer into a uart frame in place: prepends the delimiter and length
+    // and appends the checksum, false if buffer is out of room
+    static bool encapsulate(frame_buffer &buffer);
+    // segment wrapped in a tx_request, serialized straight into a pooled buffer
+    static std::shared_ptr<frame_buffer> encode_tx_request_64(
+        uint64_t destination_address, const message_segment &segment);
+
+    // appends data as a uart frame to frame, same bytes as the vector conversion of a uart_frame
+    // holding it, without data having to be shared
+    static void encode(const frame_data &data, inline_buffer &frame);
 
     uart_frame(std::shared_ptr<frame_data> data);
     uart_frame(
@@ -49,6 +79,24 @@ public:
     operator std::vector<uint8_t>() const;
 
 private:
+    typedef std::shared_ptr<frame_data> (*frame_data_parser)(
+        std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end);
+
+    // parser of each api identifier value, nullptr for frame types that aren't parsed
+    struct frame_data_parsers
+    {
+        frame_data_parser parsers[256];
+    };
+
+    // built at compile time, a frame type is added with a single entry in
+    // create_frame_data_parsers()
+    static const frame_data_parsers FRAME_DATA_PARSERS;
+
+    static constexpr frame_data_parsers create_frame_data_parsers();
+    template <typename Frame>
+    static std::shared_ptr<frame_data> parse_frame_data(
+        std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end);
+
     // note: length and checksum fields only populated when reading response frames
     uint8_t length_msb;
     uint8_t length_lsb;
@@ -5,7 +5,9 @@
 #include <gtest/gtest.h>
 
 #include "frame_data.h"
+#include "message_segment.h"
 #include "tx_request_64_frame.h"
+#include "tx_status_frame.h"
 #include "uart_frame.h"
 #include "xbee_s1.h"
 
@@ -73,6 +75,82 @@ namespace uart_frame_test
         ASSERT_NE(uart_frame::parse_frame(frame.cbegin(), frame.cend()), nullptr);
     }
 
+    TEST(UARTFrameTest, ParseFrameDispatchesOnApiIdentifier)
+    {
+        std::vector<uint8_t> frame
+            = uart_frame(std::make_shared<tx_status_frame>(0x01, tx_status_frame::status::purged));
+        auto parsed_frame = uart_frame::parse_frame(frame.cbegin(), frame.cend());
+        ASSERT_NE(parsed_frame, nullptr);
+        ASSERT_EQ(frame_data::api_identifier::tx_status, parsed_frame->get_api_identifier());
+        ASSERT_EQ(frame, static_cast<std::vector<uint8_t>>(*parsed_frame));
+    }
+
+    TEST(UARTFrameTest, ParseFrameUnsupportedApiIdentifier)
+    {
+        std::vector<uint8_t> frame = get_valid_tx_request_64_uart_frame();
+        frame[uart_frame::API_IDENTIFIER_OFFSET] = frame_data::api_identifier::at_command;
+        ASSERT_EQ(uart_frame::parse_frame(frame.cbegin(), frame.cend()), nullptr);
+    }
+
+    TEST(UARTFrameTest, EscapeFrame)
+    {
+        std::vector<uint8_t> frame = get_valid_tx_request_64_uart_frame();
+        frame[frame.size() - 2] = uart_frame::XON;
+        auto escaped_frame = uart_frame::escape_frame(frame);
+
+        // only the leading delimiter is left unescaped
+        ASSERT_EQ(frame.size() + 1, escaped_frame.size());
+        ASSERT_EQ(uart_frame::FRAME_DELIMITER, escaped_frame[uart_frame::FRAME_DELIMITER_OFFSET]);
+        ASSERT_EQ(uart_frame::ESCAPE, escaped_frame[escaped_frame.size() - 3]);
+        ASSERT_EQ(uart_frame::XON ^ uart_frame::XOR_CONST, escaped_frame[escaped_frame.size() - 2]);
+    }
+
+    TEST(UARTFrameTest, ParseEscapedFrame)
+    {
+        uart_frame frame(std::make_shared<tx_request_64_frame>(
+            xbee_s1::BROADCAST_ADDRESS, std::vector<uint8_t>{0x7e, 0x7d, 0x11, 0x13}));
+        auto escaped_frame = uart_frame::escape_frame(frame);
+        ASSERT_EQ(nullptr, uart_frame::parse_frame(escaped_frame.cbegin(), escaped_frame.cend()));
+
+        auto parsed_frame
+            = uart_frame::parse_escaped_frame(escaped_frame.cbegin(), escaped_frame.cend());
+        ASSERT_NE(nullptr, parsed_frame);
+        ASSERT_EQ(static_cast<std::vector<uint8_t>>(frame),
+            static_cast<std::vector<uint8_t>>(*parsed_frame));
+
+        escaped_frame.back() = uart_frame::ESCAPE;
+        ASSERT_EQ(nullptr,
+            uart_frame::parse_escaped_frame(escaped_frame.cbegin(), escaped_frame.cend()));
+    }
+
+    TEST(UARTFrameTest, EncodeTxRequest64)
+    {
+        message_segment segment(0x1234, 0x00ab, 7, message_segment::type::stream_segment,
+            message_segment::flag::none, std::vector<uint8_t>{'t', 'e', 's', 't'});
+        uint64_t any_destination_address = 0x0013a20040a1b2c3;
+
+        // same bytes as building the frame out of frame_data objects
+        auto frame = uart_frame::encode_tx_request_64(any_destination_address, segment);
+        ASSERT_NE(nullptr, frame);
+        std::vector<uint8_t> expected = uart_frame(std::make_shared<tx_request_64_frame>(
+            any_destination_address, static_cast<std::vector<uint8_t>>(segment)));
+        ASSERT_EQ(expected, std::vector<uint8_t>(frame->begin(), frame->end()));
+    }
+
+    TEST(UARTFrameTest, EncodeTxRequest64MaxSegment)
+    {
+        // note: MAX_SEGMENT_LENGTH is the longest payload
+        std::vector<uint8_t> payload(message_segment::MAX_SEGMENT_LENGTH, 'a');
+        message_segment segment(0x1234, 0x00ab, 7, message_segment::type::stream_segment,
+            message_segment::flag::none, payload);
+        auto frame = uart_frame::encode_tx_request_64(xbee_s1::BROADCAST_ADDRESS, segment);
+        ASSERT_NE(nullptr, frame);
+        ASSERT_EQ(uart_frame::MAX_FRAME_SIZE, frame->size());
+
+        std::vector<uint8_t> bytes(frame->begin(), frame->end());
+        ASSERT_NE(nullptr, uart_frame::parse_frame(bytes.cbegin(), bytes.cend()));
+    }
+
     TEST(UARTFrameTest, ComputeChecksumEmptyPayload)
     {
         std::vector<uint8_t> frame;
@@ -50,11 +50,16 @@ std::string util::strip_newline(const std::string &str)
 
 // TODO: add option to enable colour with escape seqs?
 std::string util::get_frame_hex(const std::vector<uint8_t> &frame, bool show_prefix)
+{
+    return get_frame_hex(frame.data(), frame.size(), show_prefix);
+}
+
+std::string util::get_frame_hex(const uint8_t *frame, size_t length, bool show_prefix)
 {
     std::ostringstream oss;
 
     // TODO: refactor this? (used in util::to_hex_string as well, overload for vector?)
-    for (std::vector<uint8_t>::size_type i = 0; i < frame.size(); ++i)
+    for (size_t i = 0; i < length; ++i)
     {
         if (show_prefix)
         {
@@ -64,7 +69,7 @@ std::string util::get_frame_hex(const std::vector<uint8_t> &frame, bool show_pre
         // +frame[i] promotes to type printable as number so that value isn't printed as char
         oss << std::setfill('0') << std::setw(2) << std::hex << +frame[i];
 
-        if (i < frame.size() - 1)
+        if (i < length - 1)
         {
             oss << " ";
         }
@@ -220,20 +225,30 @@ ssize_t util::send(int socket_fd, const std::vector<uint8_t> &buffer)
 
 ssize_t util::send(int socket_fd, const std::vector<uint8_t> &buffer, int &error)
 {
-    if (buffer.empty())
+    return send(socket_fd, buffer.data(), buffer.size(), error);
+}
+
+ssize_t util::send(int socket_fd, const uint8_t *buffer, size_t length)
+{
+    int error;
+    return send(socket_fd, buffer, length, error);
+}
+
+ssize_t util::send(int socket_fd, const uint8_t *buffer, size_t length, int &error)
+{
+    if (length == 0)
     {
         LOG_ERROR(__PRETTY_FUNCTION__, ": empty buffer");
         return -1;
     }
 
-    size_t bytes_left = buffer.size();
+    size_t bytes_left = length;
     size_t buffer_bytes_sent = 0;
 
     // TODO: static number of attempts?
-    for (int attempts_left = 5; attempts_left > 0 && buffer_bytes_sent != buffer.size();
-         --attempts_left)
+    for (int attempts_left = 5; attempts_left > 0 && buffer_bytes_sent != length; --attempts_left)
     {
-        ssize_t bytes_sent = ::send(socket_fd, buffer.data() + buffer_bytes_sent, bytes_left, 0);
+        ssize_t bytes_sent = ::send(socket_fd, buffer + buffer_bytes_sent, bytes_left, 0);
         error = errno;
 
         if (bytes_sent == -1)
@@ -251,7 +266,7 @@ ssize_t util::send(int socket_fd, const std::vector<uint8_t> &buffer, int &error
     }
 
     // consider partial send a failure
-    if (buffer_bytes_sent != buffer.size())
+    if (buffer_bytes_sent != length)
     {
         LOG_ERROR(__PRETTY_FUNCTION__, ": partial send");
         return -1;
@@ -341,3 +356,45 @@ ssize_t util::nonblocking_recv(
     buffer.resize(bytes_read);
     return bytes_read;
 }
+
+// writes as much of buffer as the socket currently has room for, returns number of bytes written
+// (possibly less than buffer.size()) or -1 with error set (EAGAIN/EWOULDBLOCK if the socket is full)
+//  - note: MSG_NOSIGNAL so a client that went away surfaces as EPIPE rather than SIGPIPE
+ssize_t util::nonblocking_send(int socket_fd, const std::vector<uint8_t> &buffer, int &error)
+{
+    if (buffer.empty())
+    {
+        return 0;
+    }
+
+    ssize_t bytes_sent
+        = ::send(socket_fd, buffer.data(), buffer.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+    error = errno;
+
+    if (bytes_sent == -1 && error != EAGAIN && error != EWOULDBLOCK)
+    {
+        char buf[256];
+        strerror_r(error, buf, sizeof(buf));
+        LOG_ERROR(__PRETTY_FUNCTION__, ": ", buf);
+    }
+
+    return bytes_sent;
+}
+
+// returns number of bytes that can be queued on socket before a send would block (SO_SNDBUF minus
+// bytes still queued, see SIOCOUTQ in unix(7)/tcp(7)), -1 on error
+//  - note: the kernel accounts for per-buffer overhead, so this is an upper bound on payload bytes
+ssize_t util::get_send_buffer_space(int socket_fd)
+{
+    int send_buffer_size;
+    socklen_t option_length = sizeof(send_buffer_size);
+    int queued_bytes;
+
+    if (getsockopt(socket_fd, SOL_SOCKET, SO_SNDBUF, &send_buffer_size, &option_length) == -1
+        || ioctl(socket_fd, SIOCOUTQ, &queued_bytes) == -1)
+    {
+        return -1;
+    }
+
+    return std::max(send_buffer_size - queued_bytes, 0);
+}
@@ -1,6 +1,7 @@
 #ifndef UTIL_H
 #define UTIL_H
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <functional>
@@ -10,16 +11,19 @@
 #include <iterator>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include <boost/tokenizer.hpp>
 
+#include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/un.h>
 
 #include <errno.h>
+#include <linux/sockios.h>
 #include <unistd.h>
 
 #include "logger.h"
@@ -30,6 +34,7 @@ namespace util
     std::string get_escaped_string(const std::string &str);
     std::string strip_newline(const std::string &str);
     std::string get_frame_hex(const std::vector<uint8_t> &frame, bool show_prefix = false);
+    std::string get_frame_hex(const uint8_t *frame, size_t length, bool show_prefix = false);
     void sleep(unsigned int seconds);    // TODO: use chrono?
     int create_passive_abstract_domain_socket(const std::string &name, int type);
     int create_passive_domain_socket(const std::string &name, int type);
@@ -42,10 +47,47 @@ namespace util
     bool try_parse_uint32_t(const std::string &str, uint32_t &out);
     ssize_t send(int socket_fd, const std::vector<uint8_t> &buffer);
     ssize_t send(int socket_fd, const std::vector<uint8_t> &buffer, int &error);
+    ssize_t send(int socket_fd, const uint8_t *buffer, size_t length);
+    ssize_t send(int socket_fd, const uint8_t *buffer, size_t length, int &error);
     ssize_t recv(int socket_fd, std::vector<uint8_t> &buffer, size_t buffer_length);
     ssize_t recv(int socket_fd, std::vector<uint8_t> &buffer, size_t buffer_length, int &error);
     ssize_t nonblocking_recv(
         int socket_fd, std::vector<uint8_t> &buffer, size_t buffer_length, int &error);
+    ssize_t nonblocking_send(int socket_fd, const std::vector<uint8_t> &buffer, int &error);
+    ssize_t get_send_buffer_space(int socket_fd);
+
+    // reverses the byte order of value
+    inline uint8_t byte_swap(uint8_t value)
+    {
+        return value;
+    }
+
+    inline uint16_t byte_swap(uint16_t value)
+    {
+        return __builtin_bswap16(value);
+    }
+
+    inline uint32_t byte_swap(uint32_t value)
+    {
+        return __builtin_bswap32(value);
+    }
+
+    inline uint64_t byte_swap(uint64_t value)
+    {
+        return __builtin_bswap64(value);
+    }
+
+    // converts value between host byte order and big endian (MSB first), either way round
+    template <typename T>
+    T swap_big_endian(T value)
+    {
+        static_assert(std::is_unsigned<T>::value, "only unsigned values are byte swapped");
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        return byte_swap(value);
+#else
+        return value;
+#endif
+    }
 
     // unpack byte vector of size n into single value of width n bytes, MSB first, n = sizeof(T)
     template <typename T, typename Iterator>
@@ -63,6 +105,22 @@ namespace util
         return unpacked_value;
     }
 
+    // unpack_bytes_to_width() over contiguous bytes, a single load and a byte swap
+    template <typename T>
+    T unpack_bytes_to_width(const uint8_t *begin)
+    {
+        T value;
+        std::memcpy(&value, begin, sizeof(T));
+        return swap_big_endian(value);
+    }
+
+    // note: a mutable pointer would otherwise resolve to the bytewise Iterator template
+    template <typename T>
+    T unpack_bytes_to_width(uint8_t *begin)
+    {
+        return unpack_bytes_to_width<T>(static_cast<const uint8_t *>(begin));
+    }
+
     // pack value of width n bytes into byte vector, MSB first
     template <typename T>
     void pack_value_as_bytes(std::back_insert_iterator<std::vector<uint8_t>> inserter, T value)
@@ -77,6 +135,14 @@ namespace util
         }
     }
 
+    // pack value of width n bytes into the sizeof(T) bytes starting at destination, MSB first
+    template <typename T>
+    void pack_value_as_bytes(uint8_t *destination, T value)
+    {
+        value = swap_big_endian(value);
+        std::memcpy(destination, &value, sizeof(T));
+    }
+
     // promotes to type printable as number so that value isn't printed as char
     template <typename T>
     auto promote_to_printable_integer_type(T i) -> decltype(+i)
@@ -132,6 +132,26 @@ namespace util_test
         ASSERT_EQ(0, unpacked);
     }
 
+    TEST(UtilTest, UnpackBytesToWidthContiguousUint16)
+    {
+        const std::vector<uint8_t> buffer{0xab, 0xcd};
+        ASSERT_EQ(0xabcd, util::unpack_bytes_to_width<uint16_t>(buffer.data()));
+    }
+
+    TEST(UtilTest, UnpackBytesToWidthContiguousUint64)
+    {
+        const std::vector<uint8_t> buffer{0xab, 0xcd, 0xef, 0x01, 0x23, 0x45, 0x67, 0x89};
+        ASSERT_EQ(0xabcdef0123456789, util::unpack_bytes_to_width<uint64_t>(buffer.data()));
+    }
+
+    TEST(UtilTest, UnpackBytesToWidthMutablePointer)
+    {
+        uint8_t buffer[] = {0x00, 0xab, 0xcd, 0xef, 0x01};
+        uint8_t *begin = buffer;
+        ASSERT_EQ(0xabcdef01u, util::unpack_bytes_to_width<uint32_t>(begin + 1));
+        ASSERT_EQ(0x00abu, util::unpack_bytes_to_width<uint16_t>(begin));
+    }
+
     TEST(UtilTest, PackValueAsBytesUint8)
     {
         std::vector<uint8_t> buffer;
@@ -160,6 +180,20 @@ namespace util_test
         ASSERT_EQ(std::vector<uint8_t>({0x00, 0x11, 0x22, 0xab, 0xcd, 0xef, 0x01}), buffer);
     }
 
+    TEST(UtilTest, PackValueAsBytesContiguousUint32)
+    {
+        std::vector<uint8_t> buffer{0x00, 0x11, 0x22, 0x33, 0x44};
+        util::pack_value_as_bytes(buffer.data() + 1, uint32_t(0xabcdef01));
+        ASSERT_EQ(std::vector<uint8_t>({0x00, 0xab, 0xcd, 0xef, 0x01}), buffer);
+    }
+
+    TEST(UtilTest, SwapBigEndianRoundTrip)
+    {
+        uint64_t value = 0xabcdef0123456789;
+        ASSERT_EQ(value, util::swap_big_endian(util::swap_big_endian(value)));
+        ASSERT_EQ(0x0f, util::swap_big_endian(uint8_t(0x0f)));
+    }
+
     // verifies that uint8_t/char is printed as an integer and not as a character
     TEST(UtilTest, ToHexStringPromoteCharacterTypeToIntegralType)
     {
@@ -175,4 +209,52 @@ namespace util_test
     {
         ASSERT_EQ(util::to_hex_string(uint64_t(0x123456789)), "0x0000000123456789");
     }
+
+    TEST(UtilTest, NonblockingSendFullSocket)
+    {
+        int fds[2];
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+
+        int error;
+        std::vector<uint8_t> buffer(4096, 0xaa);
+        ASSERT_EQ(4096, util::nonblocking_send(fds[0], buffer, error));
+
+        // peer never reads, socket eventually fills up instead of blocking
+        ssize_t bytes_sent;
+        while ((bytes_sent = util::nonblocking_send(fds[0], buffer, error)) > 0)
+        {
+        }
+
+        ASSERT_EQ(-1, bytes_sent);
+        ASSERT_TRUE(error == EAGAIN || error == EWOULDBLOCK);
+        ASSERT_EQ(0, util::get_send_buffer_space(fds[0]));
+
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    TEST(UtilTest, GetSendBufferSpaceShrinksWhileUnread)
+    {
+        int fds[2];
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+
+        ssize_t initial_space = util::get_send_buffer_space(fds[0]);
+        ASSERT_GT(initial_space, 0);
+
+        int error;
+        ASSERT_EQ(100, util::nonblocking_send(fds[0], std::vector<uint8_t>(100), error));
+        ASSERT_LT(util::get_send_buffer_space(fds[0]), initial_space);
+
+        std::vector<uint8_t> buffer;
+        ASSERT_EQ(100, util::recv(fds[1], buffer, 100));
+        ASSERT_EQ(initial_space, util::get_send_buffer_space(fds[0]));
+
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    TEST(UtilTest, GetSendBufferSpaceInvalidSocket)
+    {
+        ASSERT_EQ(-1, util::get_send_buffer_space(-1));
+    }
 }
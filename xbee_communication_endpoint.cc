@@ -1,7 +1,8 @@
 #include "xbee_communication_endpoint.h"
 
-xbee_communication_endpoint::xbee_communication_endpoint(const std::string &device, uint32_t baud)
-    : xbee(device, baud)
+xbee_communication_endpoint::xbee_communication_endpoint(
+    const std::string &device, uint32_t baud, uint8_t api_mode)
+    : xbee(device, baud, api_mode)
 {
     if (!xbee.initialize())
     {
@@ -15,12 +16,24 @@ uint64_t xbee_communication_endpoint::get_address()
     return xbee.get_address();
 }
 
-void xbee_communication_endpoint::transmit_frame(const std::vector<uint8_t> &payload)
+void xbee_communication_endpoint::transmit_frame(const frame_buffer &frame)
 {
-    xbee.write_frame(payload);
+    xbee.write_frame(frame.data(), frame.size());
 }
 
-std::shared_ptr<uart_frame> xbee_communication_endpoint::receive_frame()
+frame_buffer_pool::unique_buffer xbee_communication_endpoint::receive_frame()
 {
     return xbee.read_frame();
 }
+
+bool xbee_communication_endpoint::transmit_frames(
+    const std::vector<std::shared_ptr<frame_buffer>> &frames)
+{
+    return xbee.write_frames(frames);
+}
+
+bool xbee_communication_endpoint::receive_frames(
+    std::vector<frame_buffer_pool::unique_buffer> &frames)
+{
+    return xbee.read_frames(frames);
+}
@@ -11,11 +11,14 @@
 class xbee_communication_endpoint : public communication_endpoint
 {
 public:
-    xbee_communication_endpoint(const std::string &device, uint32_t baud);
+    xbee_communication_endpoint(const std::string &device, uint32_t baud,
+        uint8_t api_mode = xbee_s1::DEFAULT_API_MODE);
 
     virtual uint64_t get_address();
-    virtual void transmit_frame(const std::vector<uint8_t> &payload);
-    virtual std::shared_ptr<uart_frame> receive_frame();
+    virtual void transmit_frame(const frame_buffer &frame);
+    virtual frame_buffer_pool::unique_buffer receive_frame();
+    virtual bool transmit_frames(const std::vector<std::shared_ptr<frame_buffer>> &frames);
+    virtual bool receive_frames(std::vector<frame_buffer_pool::unique_buffer> &frames);
 
 private:
     xbee_s1 xbee;
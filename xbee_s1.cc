@@ -6,16 +6,18 @@ const uint64_t xbee_s1::BROADCAST_ADDRESS = 0xffff;
 const uint32_t xbee_s1::FACTORY_DEFAULT_BAUD = 9600;
 const uint32_t xbee_s1::MIN_BAUD_TWO_STOP_BITS = 115200;
 const uint32_t xbee_s1::DEFAULT_BAUD = 9600;
+const uint8_t xbee_s1::API_MODE_UNESCAPED = 1;
+const uint8_t xbee_s1::API_MODE_ESCAPED = 2;
+const uint8_t xbee_s1::DEFAULT_API_MODE = API_MODE_UNESCAPED;
 const uint32_t xbee_s1::DEFAULT_SERIAL_TIMEOUT_MS = 2000;
 const uint32_t xbee_s1::DEFAULT_GUARD_TIME_S = 1;
 const uint32_t xbee_s1::DEFAULT_COMMAND_MODE_TIMEOUT_S = 10;
 const uint32_t xbee_s1::CTS_LOW_RETRIES = 100;
-const uint32_t xbee_s1::MAX_INVALID_FRAME_READS = 20;
+const size_t xbee_s1::DATA_IN_BUFFER_LENGTH = 202;
 const std::chrono::milliseconds xbee_s1::CTS_LOW_SLEEP(5);
-const std::chrono::milliseconds xbee_s1::INVALID_FRAME_READ_BACKOFF_SLEEP(200);
+const std::chrono::milliseconds xbee_s1::SERIAL_ERROR_BACKOFF_SLEEP(200);
 const std::chrono::milliseconds xbee_s1::RX_PACKET_SERIAL_READ_THRESHOLD(10);
 const std::chrono::milliseconds xbee_s1::AT_COMMAND_RESPONSE_SERIAL_READ_THRESHOLD(50);
-const std::chrono::microseconds xbee_s1::SERIAL_READ_BACKOFF_SLEEP(100);
 const char *const xbee_s1::COMMAND_SEQUENCE = "+++";
 
 const std::map<uint8_t, uint32_t> xbee_s1::baud_config_map
@@ -35,16 +37,22 @@ xbee_s1::xbee_s1(const std::string &device)
 {
 }
 
-// TODO: check for exceptions when initializing serial object
 xbee_s1::xbee_s1(const std::string &device, uint32_t baud)
-    : address(ADDRESS_UNKNOWN), serial(device, baud, serial::Timeout::simpleTimeout(DEFAULT_SERIAL_TIMEOUT_MS))
+    : xbee_s1(device, baud, DEFAULT_API_MODE)
 {
-    LOG("using port: ", device, ", baud: ", baud);
+}
+
+xbee_s1::xbee_s1(const std::string &device, uint32_t baud, uint8_t api_mode)
+    : address(ADDRESS_UNKNOWN), api_mode(api_mode), serial(device, baud),
+      parser(api_mode == API_MODE_ESCAPED)
+{
+    LOG("using port: ", device, ", baud: ", baud, ", api mode: ", +api_mode);
 }
 
 bool xbee_s1::reset_firmware_settings()
 {
     std::lock_guard<std::mutex> lock(access_lock);
+    std::lock_guard<std::mutex> write_guard(write_lock);
 
     std::vector<uint32_t> baud_attempts;
     for (auto &entry : baud_config_map)
@@ -60,7 +68,7 @@ bool xbee_s1::reset_firmware_settings()
     for (auto &baud_attempt : baud_attempts)
     {
         LOG("attempting api mode configuration at ", baud_attempt, " baud");
-        serial.setBaudrate(baud_attempt);
+        serial.set_baud(baud_attempt);
 
         // enable API mode for configuration since AT command mode can be flaky
         if (enable_api_mode())
@@ -82,7 +90,7 @@ bool xbee_s1::reset_firmware_settings()
         return false;
     }
 
-    serial.setBaudrate(FACTORY_DEFAULT_BAUD);
+    serial.set_baud(FACTORY_DEFAULT_BAUD);
 
     if (!enable_api_mode())
     {
@@ -101,6 +109,13 @@ bool xbee_s1::reset_firmware_settings()
 bool xbee_s1::initialize()
 {
     std::lock_guard<std::mutex> lock(access_lock);
+    std::lock_guard<std::mutex> write_guard(write_lock);
+
+    if (!serial.is_open())
+    {
+        return false;
+    }
+
     configure_stop_bits();
 
     if (read_and_set_address())
@@ -115,6 +130,7 @@ bool xbee_s1::initialize()
 bool xbee_s1::configure_firmware_settings()
 {
     std::lock_guard<std::mutex> lock(access_lock);
+    std::lock_guard<std::mutex> write_guard(write_lock);
     configure_stop_bits();
     return enable_api_mode() && enable_64_bit_addressing() && enable_strict_802_15_4_mode()
         && configure_baud() && write_to_non_volatile_memory();
@@ -123,10 +139,10 @@ bool xbee_s1::configure_firmware_settings()
 void xbee_s1::configure_stop_bits()
 {
     // use two stop bits to increase success rate of frame reads/writes at higher baud
-    if (serial.getBaudrate() >= MIN_BAUD_TWO_STOP_BITS)
+    if (serial.get_baud() >= MIN_BAUD_TWO_STOP_BITS)
     {
         LOG("using two stop bits");
-        serial.setStopbits(serial::stopbits_two);
+        serial.set_two_stop_bits(true);
     }
 }
 
@@ -146,8 +162,8 @@ bool xbee_s1::test_at_command_mode()
 
 bool xbee_s1::enable_api_mode()
 {
-    // put device in API mode 1 (enabled without escape characters)
-    std::string response = execute_command(at_command(at_command::API_ENABLE, "1"));
+    // put device in API mode 1 (enabled without escape characters) or 2 (with escape characters)
+    std::string response = execute_command(at_command(at_command::API_ENABLE, std::to_string(api_mode)));
     if (response != at_command::RESPONSE_SUCCESS)
     {
         LOG_ERROR("could not configure api mode");
@@ -382,7 +398,7 @@ bool xbee_s1::configure_baud()
     }
 
     // update serial object to interface at newly configured baud
-    serial.setBaudrate(baud);
+    serial.set_baud(baud);
     configure_stop_bits();
     LOG("target baud successfully configured");
 
@@ -458,6 +474,7 @@ bool xbee_s1::enter_command_mode()
 {
     // note: sleep is required before AND after input of COMMAND_SEQUENCE
     util::sleep(DEFAULT_GUARD_TIME_S);
+    parser.clear();    // command mode responses are read as lines, straight off the serial line
     unlocked_write_string(COMMAND_SEQUENCE);
     util::sleep(DEFAULT_GUARD_TIME_S);
     std::string response = unlocked_read_line();
@@ -471,49 +488,6 @@ bool xbee_s1::enter_command_mode()
     return true;
 }
 
-// returns true if read was attempted, otherwise false
-bool xbee_s1::try_serial_read(std::function<void()> read_operation, const std::chrono::milliseconds &read_timeout,
-    const std::chrono::microseconds &initial_read_backoff)
-{
-    /*
-     * Ideally we'd check serial.available() once to see if there are bytes available to be read before incurring the potential read
-     * timeout cost of serial.read() when there aren't bytes available, but it seems available() has a bit of a delay.
-     *
-     * After some testing it looks like the average response for available() to reflect the presence of bytes on the serial line is 2ms
-     * and 3-4ms for available() to reflect the correct value. So far there hasn't been a case where calling serial.read(), after available()
-     * returned a non-zero value other than the full expected frame size, resulted in a failed frame read. Therefore we only wait until a
-     * presence of bytes is detected and then try to read a frame.
-     *
-     * An effort is made to reduce the amount of calls made to the serial interface as it seems that writing too many frames to the xbee
-     * can cause the device to lock up and stop responding in certain situations. So far it seems this lockup has only been triggered by
-     * repeated AT command frame writes and hasn't been reproducable by having two xbees constantly transmitting to each other.
-     *
-     * The only solution in the case of the xbee locking up seems to be removing and reinserting the USB to serial adapter or using the
-     * physical reset button if the adapter has one.
-     *
-     * TODO: ensure beehive can handle adapter being removed and reinserted
-     *  - expose state to indicate that device is no longer responding
-     */
-
-    auto backoff_duration = initial_read_backoff;
-    auto start_time = std::chrono::high_resolution_clock::now();
-
-    while (serial.available() == 0)
-    {
-        if (std::chrono::high_resolution_clock::now() - start_time >= read_timeout)
-        {
-            return false;
-        }
-
-        // TODO: bounded exponential backoff between calls? reset backoff duration upon successful frame read
-        std::this_thread::sleep_for(backoff_duration);
-        backoff_duration *= 2;
-    }
-
-    read_operation();
-    return true;
-}
-
 // returns true if write was attempted, otherwise false
 bool xbee_s1::try_serial_write(std::function<void()> write_operation)
 {
@@ -521,7 +495,7 @@ bool xbee_s1::try_serial_write(std::function<void()> write_operation)
 
     util::retry([&]
         {
-            if (serial.getCTS())
+            if (serial.get_cts())
             {
                 write_attempted = true;
                 write_operation();
@@ -539,33 +513,14 @@ bool xbee_s1::try_serial_write(std::function<void()> write_operation)
 
 void xbee_s1::unlocked_write_string(const std::string &str)
 {
-    size_t bytes_written;
-
-    try
-    {
-        auto write_operation = [&]
-            {
-                bytes_written = serial.write(str);
-            };
-
-        if (!try_serial_write(write_operation))
+    size_t bytes_written = 0;
+    auto write_operation = [&]
         {
-            return;
-        }
-    }
-    catch (const serial::PortNotOpenedException &e)
-    {
-        LOG_ERROR("write_string: caught PortNotOpenedException: ", e.what());
-        return;
-    }
-    catch (const serial::SerialException &e)
-    {
-        LOG_ERROR("write_string: caught SerialException: ", e.what());
-        return;
-    }
-    catch (const serial::IOException &e)
+            bytes_written = serial.write(str);
+        };
+
+    if (!try_serial_write(write_operation))
     {
-        LOG_ERROR("write_string: caught IOException: ", e.what());
         return;
     }
 
@@ -581,17 +536,61 @@ void xbee_s1::unlocked_write_string(const std::string &str)
 // TODO: return status
 void xbee_s1::write_frame(const std::vector<uint8_t> &payload)
 {
-    std::lock_guard<std::mutex> lock(access_lock);
-    unlocked_write_frame(payload);
+    write_frame(payload.data(), payload.size());
+}
+
+void xbee_s1::write_frame(const uint8_t *frame, size_t length)
+{
+    std::vector<uint8_t> encoded_frame;
+    encode_frame(frame, length, encoded_frame);
+
+    std::lock_guard<std::mutex> lock(write_lock);
+    unlocked_write_frame(encoded_frame);
+}
+
+bool xbee_s1::write_frames(const std::vector<std::shared_ptr<frame_buffer>> &frames)
+{
+    std::vector<std::vector<uint8_t>> batches;
+    encode_batches(frames, batches);
+
+    std::lock_guard<std::mutex> lock(write_lock);
+    for (auto &batch : batches)
+    {
+        if (!unlocked_write_frame(batch))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void xbee_s1::encode_batches(const std::vector<std::shared_ptr<frame_buffer>> &frames,
+    std::vector<std::vector<uint8_t>> &batches) const
+{
+    std::vector<uint8_t> encoded_frame;
+
+    for (auto &frame : frames)
+    {
+        // note: frames are escaped one at a time, their leading delimiters must stay unescaped
+        encoded_frame.clear();
+        encode_frame(frame->data(), frame->size(), encoded_frame);
+        if (batches.empty() || batches.back().size() + encoded_frame.size() > DATA_IN_BUFFER_LENGTH)
+        {
+            batches.emplace_back();
+        }
+
+        batches.back().insert(batches.back().end(), encoded_frame.begin(), encoded_frame.end());
+    }
 }
 
 std::shared_ptr<at_command_response_frame> xbee_s1::write_at_command_frame(std::shared_ptr<at_command_frame> command,
-    const std::chrono::milliseconds &read_timeout, const std::chrono::microseconds &initial_read_backoff)
+    const std::chrono::milliseconds &read_timeout)
 {
-    auto response = unlocked_write_and_read_frame(uart_frame(command), read_timeout, initial_read_backoff);
+    auto response = unlocked_write_and_read_frame(uart_frame(command), read_timeout);
     if (response == nullptr)
     {
-        LOG_ERROR("could not read response to ", command->get_at_command(), " command, is API mode (1) enabled?");
+        LOG_ERROR("could not read response to ", command->get_at_command(), " command, is API mode (", +api_mode, ") enabled?");
         return nullptr;
     }
 
@@ -607,84 +606,92 @@ std::shared_ptr<at_command_response_frame> xbee_s1::write_at_command_frame(std::
 
 std::string xbee_s1::unlocked_read_line()
 {
-    std::string result;
-    size_t bytes_read;
+    std::string result = serial.read_line(std::chrono::milliseconds(DEFAULT_SERIAL_TIMEOUT_MS));
+    LOG("read  [", util::get_escaped_string(result), "] (", result.size(), " bytes)");
 
-    try
-    {
-        auto read_operation = [&]
-            {
-                bytes_read = serial.readline(result);
-            };
+    return result;
+}
 
-        if (!try_serial_read(read_operation))
+frame_buffer_pool::unique_buffer xbee_s1::read_frame()
+{
+    std::lock_guard<std::mutex> lock(access_lock);
+    auto frame = frame_buffer_pool::get_default().acquire_unique();
+    int result = unlocked_read_frame(*frame, std::chrono::milliseconds(DEFAULT_SERIAL_TIMEOUT_MS));
+    if (result != 1)
+    {
+        if (result == -1)
         {
-            return std::string();
+            // don't spin on a broken line (e.g. adapter removed)
+            std::this_thread::sleep_for(SERIAL_ERROR_BACKOFF_SLEEP);
         }
-    }
-    catch (const serial::PortNotOpenedException &e)
-    {
-        LOG_ERROR("read_line: caught PortNotOpenedException: ", e.what());
-        return std::string();
-    }
-    catch (const serial::SerialException &e)
-    {
-        LOG_ERROR("read_line: caught SerialException: ", e.what());
-        return std::string();
-    }
-    catch (const serial::IOException &e)
-    {
-        LOG_ERROR("read_line: caught IOException: ", e.what());
-        return std::string();
-    }
 
-    LOG("read  [", util::get_escaped_string(result), "] (", bytes_read, " bytes)");
+        return nullptr;
+    }
 
-    return util::strip_newline(result);
+    return frame;
 }
 
-std::shared_ptr<uart_frame> xbee_s1::read_frame()
+bool xbee_s1::read_frames(std::vector<frame_buffer_pool::unique_buffer> &frames)
 {
     std::lock_guard<std::mutex> lock(access_lock);
-    return unlocked_read_frame();
+
+    auto frame = frame_buffer_pool::get_default().acquire_unique();
+    int result = unlocked_read_frame(*frame, std::chrono::milliseconds(DEFAULT_SERIAL_TIMEOUT_MS));
+    if (result != 1)
+    {
+        return result == 0;
+    }
+
+    // note: frames still on their way aren't waited for
+    bool read_ok = unlocked_read_available();
+    frames.push_back(std::move(frame));
+    while (true)
+    {
+        frame = frame_buffer_pool::get_default().acquire_unique();
+        if (!parser.next_frame(*frame))
+        {
+            break;
+        }
+
+        LOG("read  [", util::get_frame_hex(frame->data(), frame->size()), "]");
+        frames.push_back(std::move(frame));
+    }
+
+    return read_ok;
 }
 
 std::shared_ptr<uart_frame> xbee_s1::write_and_read_frame(const std::vector<uint8_t> &payload)
 {
     std::lock_guard<std::mutex> lock(access_lock);
+    std::lock_guard<std::mutex> write_guard(write_lock);
     return unlocked_write_and_read_frame(payload);
 }
 
-void xbee_s1::unlocked_write_frame(const std::vector<uint8_t> &payload)
+// appends the frame as it goes on the serial line in the configured api mode to output
+void xbee_s1::encode_frame(const uint8_t *frame, size_t length, std::vector<uint8_t> &output) const
 {
-    size_t bytes_written = 0;
-
-    try
+    if (api_mode == API_MODE_ESCAPED)
     {
-        auto write_operation = [&]
-            {
-                bytes_written = serial.write(payload);
-            };
-
-        if (!try_serial_write(write_operation))
-        {
-            return;
-        }
+        uart_frame::escape_frame(frame, length, output);
     }
-    catch (const serial::PortNotOpenedException &e)
+    else
     {
-        LOG_ERROR("write_frame: caught PortNotOpenedException: ", e.what());
-        return;
+        output.insert(output.end(), frame, frame + length);
     }
-    catch (const serial::SerialException &e)
-    {
-        LOG_ERROR("write_frame: caught SerialException: ", e.what());
-        return;
-    }
-    catch (const serial::IOException &e)
+}
+
+// returns false if the frame didn't make it onto the serial line
+bool xbee_s1::unlocked_write_frame(const std::vector<uint8_t> &payload)
+{
+    size_t bytes_written = 0;
+    auto write_operation = [&]
+        {
+            bytes_written = serial.write(payload);
+        };
+
+    if (!try_serial_write(write_operation))
     {
-        LOG_ERROR("write_frame: caught IOException: ", e.what());
-        return;
+        return false;
     }
 
     if (bytes_written != payload.size())
@@ -692,119 +699,101 @@ void xbee_s1::unlocked_write_frame(const std::vector<uint8_t> &payload)
         if (bytes_written != 0)
         {
             LOG_ERROR("could not write frame (expected: ", payload.size(), ", wrote: ", bytes_written, " bytes)");
-            return;
         }
 
-        return;
+        return false;
     }
 
     LOG("write [", util::get_frame_hex(payload), "] (", bytes_written, " bytes)");
+    return true;
 }
 
-std::shared_ptr<uart_frame> xbee_s1::unlocked_read_frame(const std::chrono::milliseconds &read_timeout,
-    const std::chrono::microseconds &initial_read_backoff)
+// parses the next frame read off the serial line, frames that don't parse are skipped
+std::shared_ptr<uart_frame> xbee_s1::unlocked_read_frame(const std::chrono::milliseconds &read_timeout)
 {
-    static uint32_t invalid_frame_reads = 0;
-
-    // read up to length header first to determine how many more bytes to read from serial line
-    std::vector<uint8_t> frame;
-    size_t bytes_read_head;
-
-    try
+    frame_buffer frame;
+    int result;
+    while ((result = unlocked_read_frame(frame, read_timeout)) == 1)
     {
-        auto read_operation = [&]
-            {
-                bytes_read_head = serial.read(frame, uart_frame::HEADER_LENGTH);
-            };
-
-        if (!try_serial_read(read_operation, read_timeout, initial_read_backoff))
+        auto parsed_frame = uart_frame::parse_frame(frame.cbegin(), frame.cend());
+        if (parsed_frame != nullptr)
         {
-            return nullptr;
+            return parsed_frame;
         }
     }
-    catch (const serial::PortNotOpenedException &e)
-    {
-        LOG_ERROR("read_frame: caught PortNotOpenedException: ", e.what());
-        return nullptr;
-    }
-    catch (const serial::SerialException &e)
+
+    if (result == -1)
     {
-        LOG_ERROR("read_frame: caught SerialException: ", e.what());
-        return nullptr;
-    }
-    catch (const serial::IOException &e)
-    {
-        LOG_ERROR("read_frame: caught IOException: ", e.what());
-        return nullptr;
+        std::this_thread::sleep_for(SERIAL_ERROR_BACKOFF_SLEEP);
     }
 
-    if (bytes_read_head != uart_frame::HEADER_LENGTH)
+    return nullptr;
+}
+
+// waits up to read_timeout for a frame to begin arriving, once it has it gets up to
+// DEFAULT_SERIAL_TIMEOUT_MS to complete
+//  - returns 1 once a frame was copied into frame, 0 if none arrived and -1 on a serial error
+int xbee_s1::unlocked_read_frame(frame_buffer &frame, const std::chrono::milliseconds &read_timeout)
+{
+    auto start_time = std::chrono::steady_clock::now();
+
+    while (true)
     {
-        if (bytes_read_head != 0)
+        if (!unlocked_read_available())
         {
-            LOG_ERROR("could not read frame delimiter + length");
+            return -1;
         }
 
-        return nullptr;
-    }
-
-    if (frame[uart_frame::FRAME_DELIMITER_OFFSET] != uart_frame::FRAME_DELIMITER)
-    {
-        ++invalid_frame_reads;
+        if (parser.next_frame(frame))
+        {
+            LOG("read  [", util::get_frame_hex(frame.data(), frame.size()), "]");
+            return 1;
+        }
 
-        if (invalid_frame_reads >= MAX_INVALID_FRAME_READS)
+        auto timeout = parser.size() == 0 ? read_timeout : std::chrono::milliseconds(DEFAULT_SERIAL_TIMEOUT_MS);
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            start_time + timeout - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0)
         {
-            std::this_thread::sleep_for(INVALID_FRAME_READ_BACKOFF_SLEEP);
-            invalid_frame_reads = 0;
+            return 0;
         }
 
-        return nullptr;
+        int ready = serial.wait_readable(remaining);
+        if (ready != 1)
+        {
+            return ready;
+        }
     }
+}
 
-    // note:
-    //  - in API mode 2 (enabled with escape characters) length field doesn't account for escaped chars
-    //  - checksum can be escaped
-    uint16_t length = util::unpack_bytes_to_width<uint16_t>(frame.begin() + uart_frame::LENGTH_MSB_OFFSET);
-    size_t bytes_read_tail;
-
-    try
-    {
-        // note: try_serial_read() helper not used here since we've already begun reading from the serial device
-        bytes_read_tail = serial.read(frame, length + 1);    // payload + checksum
-    }
-    catch (const serial::PortNotOpenedException &e)
-    {
-        LOG_ERROR("read_frame: caught PortNotOpenedException: ", e.what());
-        return nullptr;
-    }
-    catch (const serial::SerialException &e)
-    {
-        LOG_ERROR("read_frame: caught SerialException: ", e.what());
-        return nullptr;
-    }
+// moves everything buffered on the serial line into parser without waiting, returns false on error
+bool xbee_s1::unlocked_read_available()
+{
+    uint8_t buffer[frame_parser::CAPACITY];
 
-    if (bytes_read_tail != length + 1)
+    while (parser.get_free_space() > 0)
     {
-        LOG_ERROR("could not read rest of frame (expected: ", length + 1, ", read: ", bytes_read_tail, " bytes)");
-        return nullptr;
-    }
-
-    LOG("read  [", util::get_frame_hex(frame), "] (", frame.size(), " bytes)");
-    uint8_t received_checksum = *(frame.end() - 1);
-    uint8_t calculated_checksum = uart_frame::compute_checksum(frame.begin() + uart_frame::HEADER_LENGTH, frame.end() - 1); // ignore frame header and trailing checksum
+        ssize_t bytes_read = serial.read(buffer, parser.get_free_space());
+        if (bytes_read == -1)
+        {
+            return false;
+        }
+        else if (bytes_read == 0)
+        {
+            break;
+        }
 
-    if (calculated_checksum != received_checksum)
-    {
-        LOG_ERROR("invalid checksum");
-        return nullptr;
+        parser.feed(buffer, bytes_read);
     }
 
-    return uart_frame::parse_frame(frame.begin(), frame.end());
+    return true;
 }
 
 std::shared_ptr<uart_frame> xbee_s1::unlocked_write_and_read_frame(const std::vector<uint8_t> &payload,
-    const std::chrono::milliseconds &read_timeout, const std::chrono::microseconds &initial_read_backoff)
+    const std::chrono::milliseconds &read_timeout)
 {
-    unlocked_write_frame(payload);
-    return unlocked_read_frame(read_timeout, initial_read_backoff);
+    std::vector<uint8_t> encoded_frame;
+    encode_frame(payload.data(), payload.size(), encoded_frame);
+    unlocked_write_frame(encoded_frame);
+    return unlocked_read_frame(read_timeout);
 }
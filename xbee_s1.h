@@ -13,12 +13,14 @@
 #include <thread>
 #include <vector>
 
-#include <serial/serial.h>
-
 #include "at_command_frame.h"
 #include "at_command.h"
 #include "at_command_response_frame.h"
+#include "frame_buffer.h"
+#include "frame_buffer_pool.h"
+#include "frame_parser.h"
 #include "logger.h"
+#include "serial_port.h"
 #include "uart_frame.h"
 #include "util.h"
 
@@ -38,20 +40,23 @@ public:
     static const uint32_t FACTORY_DEFAULT_BAUD;
     static const uint32_t MIN_BAUD_TWO_STOP_BITS;
     static const uint32_t DEFAULT_BAUD;
-    static const uint32_t DEFAULT_SERIAL_TIMEOUT_MS;    // primarily controls how long a read in the underlying serial library will wait until it times out
+    static const uint8_t API_MODE_UNESCAPED;
+    static const uint8_t API_MODE_ESCAPED;  // frame bytes matching a delimiter, escape or XON/XOFF are escaped, needed with software flow control
+    static const uint8_t DEFAULT_API_MODE;
+    static const uint32_t DEFAULT_SERIAL_TIMEOUT_MS;    // how long a read waits for a frame (or line) that has begun arriving to complete
     static const uint32_t DEFAULT_GUARD_TIME_S;
     static const uint32_t DEFAULT_COMMAND_MODE_TIMEOUT_S;
     static const uint32_t CTS_LOW_RETRIES;  // how many times to retry frame writes to serial line when CTS (clear to send) is low
-    static const uint32_t MAX_INVALID_FRAME_READS;  // TODO: haven't pinpointed why this happens, but sleeping seems to 'fix' corrupt frame reads
+    static const size_t DATA_IN_BUFFER_LENGTH;  // serial receive buffer of the xbee, bounds how many bytes a batched frame write puts on the line at once
     static const std::chrono::milliseconds CTS_LOW_SLEEP;   // how long to sleep when CTS is low
-    static const std::chrono::milliseconds INVALID_FRAME_READ_BACKOFF_SLEEP;    // how long to backoff for if MAX_INVALID_FRAME_READS is hit
-    static const std::chrono::milliseconds RX_PACKET_SERIAL_READ_THRESHOLD;     // max duration to poll when checking for a single rx packet
+    static const std::chrono::milliseconds SERIAL_ERROR_BACKOFF_SLEEP;  // how long to backoff for when the serial line reports an error, keeps a removed adapter from spinning readers
+    static const std::chrono::milliseconds RX_PACKET_SERIAL_READ_THRESHOLD;     // max duration to wait for a single rx packet to begin arriving
     static const std::chrono::milliseconds AT_COMMAND_RESPONSE_SERIAL_READ_THRESHOLD;   // at commands can have a larger delay between request and response frames
-    static const std::chrono::microseconds SERIAL_READ_BACKOFF_SLEEP;   // initial sleep duration when checking serial line for bytes available
     static const char *const COMMAND_SEQUENCE;
 
     xbee_s1(const std::string &device);
     xbee_s1(const std::string &device, uint32_t baud);
+    xbee_s1(const std::string &device, uint32_t baud, uint8_t api_mode);
     bool reset_firmware_settings();
     bool initialize();
     bool configure_firmware_settings();
@@ -59,10 +64,22 @@ public:
     bool read_and_set_address();
     uint64_t get_address() const;
     void write_frame(const std::vector<uint8_t> &payload);
+    void write_frame(const uint8_t *frame, size_t length);
+    // concatenates frames into as few serial writes as DATA_IN_BUFFER_LENGTH allows, returns false
+    // if a write failed (frames of the batches after it are dropped)
+    bool write_frames(const std::vector<std::shared_ptr<frame_buffer>> &frames);
+    // appends frames encoded for the serial line to batches, each at most DATA_IN_BUFFER_LENGTH bytes
+    // unless a single frame is longer, frames are never split across batches
+    void encode_batches(const std::vector<std::shared_ptr<frame_buffer>> &frames,
+        std::vector<std::vector<uint8_t>> &batches) const;
     std::shared_ptr<at_command_response_frame> write_at_command_frame(std::shared_ptr<at_command_frame> command,
-        const std::chrono::milliseconds &read_timeout = AT_COMMAND_RESPONSE_SERIAL_READ_THRESHOLD,
-        const std::chrono::microseconds &initial_read_backoff = SERIAL_READ_BACKOFF_SLEEP);
-    std::shared_ptr<uart_frame> read_frame();
+        const std::chrono::milliseconds &read_timeout = AT_COMMAND_RESPONSE_SERIAL_READ_THRESHOLD);
+    // waits up to DEFAULT_SERIAL_TIMEOUT_MS for a frame, wakes up as soon as its last byte arrived
+    //  - frames are returned unescaped and unparsed in a buffer from frame_buffer_pool, nullptr if none arrived
+    frame_buffer_pool::unique_buffer read_frame();
+    // waits like read_frame, then also appends every other complete frame already buffered to frames
+    //  - returns false on a serial error, the caller is expected to back off
+    bool read_frames(std::vector<frame_buffer_pool::unique_buffer> &frames);
     std::shared_ptr<uart_frame> write_and_read_frame(const std::vector<uint8_t> &payload);
     bool read_configuration_registers();
 
@@ -82,24 +99,28 @@ private:
     bool read_ieee_source_address(uint64_t &address);
     template <typename T>
         bool read_configuration_register(const std::string &at_command_str, const std::string &command_description, T &register_value);
-    bool try_serial_read(std::function<void()> read_operation, const std::chrono::milliseconds &read_timeout = RX_PACKET_SERIAL_READ_THRESHOLD,
-        const std::chrono::microseconds &initial_read_backoff = SERIAL_READ_BACKOFF_SLEEP);
     bool try_serial_write(std::function<void()> write_operation);
 
     void unlocked_write_string(const std::string &str);
     std::string unlocked_read_line();
-    void unlocked_write_frame(const std::vector<uint8_t> &payload);
+    void encode_frame(const uint8_t *frame, size_t length, std::vector<uint8_t> &output) const;
+    bool unlocked_write_frame(const std::vector<uint8_t> &payload);
     std::shared_ptr<uart_frame> unlocked_read_frame(
-        const std::chrono::milliseconds &read_timeout = RX_PACKET_SERIAL_READ_THRESHOLD,
-        const std::chrono::microseconds &initial_read_backoff = SERIAL_READ_BACKOFF_SLEEP);
+        const std::chrono::milliseconds &read_timeout = RX_PACKET_SERIAL_READ_THRESHOLD);
+    int unlocked_read_frame(frame_buffer &frame, const std::chrono::milliseconds &read_timeout);
+    bool unlocked_read_available();
     std::shared_ptr<uart_frame> unlocked_write_and_read_frame(const std::vector<uint8_t> &payload,
-        const std::chrono::milliseconds &read_timeout = RX_PACKET_SERIAL_READ_THRESHOLD,
-        const std::chrono::microseconds &initial_read_backoff = SERIAL_READ_BACKOFF_SLEEP);
+        const std::chrono::milliseconds &read_timeout = RX_PACKET_SERIAL_READ_THRESHOLD);
 
-    // note: although serial library employs its own line access protection, access_lock is used to ensure multi-frame read/write methods are atomic
+    // note: access_lock is used to ensure multi-frame read/write methods are atomic, it also guards parser
+    //  - reads only take access_lock and single frame writes only take write_lock, so frames can be written while a read is in progress
+    //  - lock order: access_lock before write_lock
     std::mutex access_lock;
+    std::mutex write_lock;
     uint64_t address;
-    serial::Serial serial;
+    uint8_t api_mode;
+    serial_port serial;
+    frame_parser parser;    // bytes read off the serial line that aren't part of a returned frame yet
 };
 
 #endif
@@ -1,16 +1,181 @@
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <gtest/gtest.h>
 
+#include "frame_buffer.h"
+#include "frame_buffer_pool.h"
+#include "frame_parser.h"
+#include "tx_request_64_frame.h"
+#include "uart_frame.h"
 #include "xbee_s1.h"
 
 namespace xbee_s1_test
 {
+    // pseudo terminal standing in for the xbee, master_fd sees the bytes put on the serial line
+    class pseudo_terminal
+    {
+    public:
+        pseudo_terminal()
+            : master_fd(posix_openpt(O_RDWR | O_NOCTTY))
+        {
+            grantpt(master_fd);
+            unlockpt(master_fd);
+        }
+
+        ~pseudo_terminal()
+        {
+            hang_up();
+        }
+
+        std::string get_device() const
+        {
+            return ptsname(master_fd);
+        }
+
+        void hang_up()
+        {
+            if (master_fd != -1)
+            {
+                close(master_fd);
+                master_fd = -1;
+            }
+        }
+
+        int master_fd;
+    };
+
+    // frames whose rf data holds bytes that have to be escaped, of growing length
+    std::vector<std::shared_ptr<frame_buffer>> create_frames(size_t count)
+    {
+        std::vector<std::shared_ptr<frame_buffer>> frames;
+        for (size_t i = 0; i < count; ++i)
+        {
+            std::vector<uint8_t> rf_data(10 + 7 * i, static_cast<uint8_t>(i));
+            rf_data[0] = 0x7e;
+            rf_data[1] = 0x7d;
+            std::vector<uint8_t> bytes = uart_frame(
+                std::make_shared<tx_request_64_frame>(0x0013a20040a1b2c3, rf_data));
+
+            // no headroom, the longest frames only fit that way
+            auto frame = std::make_shared<frame_buffer>();
+            frame->clear(0);
+            EXPECT_TRUE(frame->append(bytes.data(), bytes.size()));
+            frames.push_back(frame);
+        }
+
+        return frames;
+    }
+
+    std::vector<uint8_t> escape_frames(const std::vector<std::shared_ptr<frame_buffer>> &frames)
+    {
+        std::vector<uint8_t> escaped;
+        for (auto &frame : frames)
+        {
+            uart_frame::escape_frame(frame->data(), frame->size(), escaped);
+        }
+
+        return escaped;
+    }
+
     TEST(XBeeS1Test, ConstValuesSpec)
     {
         ASSERT_EQ(0xffffffffffffffff, xbee_s1::ADDRESS_UNKNOWN);
         ASSERT_EQ(sizeof(uint64_t), sizeof(xbee_s1::BROADCAST_ADDRESS));
         ASSERT_EQ(0xffff, xbee_s1::BROADCAST_ADDRESS);
+        ASSERT_EQ(1, xbee_s1::API_MODE_UNESCAPED);
+        ASSERT_EQ(2, xbee_s1::API_MODE_ESCAPED);
+        ASSERT_EQ(xbee_s1::API_MODE_UNESCAPED, xbee_s1::DEFAULT_API_MODE);
         ASSERT_STREQ("+++", xbee_s1::COMMAND_SEQUENCE);
+        ASSERT_EQ(202, xbee_s1::DATA_IN_BUFFER_LENGTH);
+    }
+
+    // batches fill up to DATA_IN_BUFFER_LENGTH, each holds whole escaped frames only
+    TEST(XBeeS1Test, EncodeBatchesTest)
+    {
+        pseudo_terminal terminal;
+        xbee_s1 xbee(terminal.get_device(), 9600, xbee_s1::API_MODE_ESCAPED);
+        auto frames = create_frames(12);
+
+        std::vector<std::vector<uint8_t>> batches;
+        xbee.encode_batches(frames, batches);
+        ASSERT_LT(1, batches.size());
+
+        std::vector<uint8_t> concatenated;
+        size_t next_frame = 0;
+        for (auto &batch : batches)
+        {
+            ASSERT_GE(xbee_s1::DATA_IN_BUFFER_LENGTH, batch.size());
+            concatenated.insert(concatenated.end(), batch.begin(), batch.end());
+
+            frame_parser parser(true);
+            ASSERT_EQ(batch.size(), parser.feed(batch.data(), batch.size()));
+            frame_buffer frame;
+            while (parser.next_frame(frame))
+            {
+                ASSERT_LT(next_frame, frames.size());
+                ASSERT_EQ(frames[next_frame]->size(), frame.size());
+                ASSERT_TRUE(std::equal(frame.begin(), frame.end(), frames[next_frame]->begin()));
+                ++next_frame;
+            }
+
+            ASSERT_EQ(0, parser.size());
+
+            // a batch is only cut when the next frame doesn't fit
+            if (next_frame < frames.size())
+            {
+                ASSERT_LT(xbee_s1::DATA_IN_BUFFER_LENGTH,
+                    batch.size() + escape_frames({frames[next_frame]}).size());
+            }
+        }
+
+        ASSERT_EQ(frames.size(), next_frame);
+        ASSERT_EQ(escape_frames(frames), concatenated);
+    }
+
+    TEST(XBeeS1Test, WriteReadFramesTest)
+    {
+        pseudo_terminal terminal;
+        xbee_s1 xbee(terminal.get_device(), 9600, xbee_s1::API_MODE_ESCAPED);
+        auto frames = create_frames(12);
+        auto escaped = escape_frames(frames);
+
+        ASSERT_TRUE(xbee.write_frames(frames));
+        std::vector<uint8_t> line(escaped.size());
+        size_t bytes_read = 0;
+        while (bytes_read < line.size())
+        {
+            ssize_t count = ::read(terminal.master_fd, &line[bytes_read], line.size() - bytes_read);
+            ASSERT_LT(0, count);
+            bytes_read += count;
+        }
+
+        ASSERT_EQ(escaped, line);
+
+        ASSERT_EQ(static_cast<ssize_t>(escaped.size()),
+            ::write(terminal.master_fd, escaped.data(), escaped.size()));
+        std::vector<frame_buffer_pool::unique_buffer> received;
+        while (received.size() < frames.size())
+        {
+            ASSERT_TRUE(xbee.read_frames(received));
+        }
+
+        ASSERT_EQ(frames.size(), received.size());
+        for (size_t i = 0; i < frames.size(); ++i)
+        {
+            ASSERT_TRUE(std::equal(received[i]->begin(), received[i]->end(), frames[i]->begin()));
+        }
+
+        // e.g. the adapter was unplugged, the caller hears about it
+        terminal.hang_up();
+        ASSERT_FALSE(xbee.read_frames(received));
+        ASSERT_EQ(frames.size(), received.size());
     }
 }
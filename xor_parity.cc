@@ -0,0 +1,93 @@
+#include "xor_parity.h"
+
+const size_t xor_parity::BLOCK_LENGTH_OFFSET = 0;
+const size_t xor_parity::LENGTH_PARITY_OFFSET = BLOCK_LENGTH_OFFSET + sizeof(block_length);
+const size_t xor_parity::PAYLOAD_PARITY_OFFSET = LENGTH_PARITY_OFFSET + sizeof(length_parity);
+const size_t xor_parity::HEADER_LENGTH = PAYLOAD_PARITY_OFFSET;
+const uint8_t xor_parity::COMPRESSED_MASK = 0x80;
+const size_t xor_parity::MAX_PAYLOAD_LENGTH = 0x7f;
+const uint8_t xor_parity::MAX_BLOCK_LENGTH = 16;
+
+std::shared_ptr<xor_parity> xor_parity::parse(const uint8_t *begin, const uint8_t *end)
+{
+    auto size = static_cast<size_t>(std::distance(begin, end));
+    if (size < HEADER_LENGTH || begin[BLOCK_LENGTH_OFFSET] == 0
+        || begin[BLOCK_LENGTH_OFFSET] > MAX_BLOCK_LENGTH
+        || size > HEADER_LENGTH + MAX_PAYLOAD_LENGTH)
+    {
+        return nullptr;
+    }
+
+    auto parity = std::make_shared<xor_parity>();
+    parity->block_length = begin[BLOCK_LENGTH_OFFSET];
+    parity->length_parity = begin[LENGTH_PARITY_OFFSET];
+    parity->payload_parity.assign(begin + PAYLOAD_PARITY_OFFSET, end);
+    return parity;
+}
+
+xor_parity::xor_parity()
+    : block_length(0), length_parity(0)
+{
+}
+
+void xor_parity::add(std::vector<uint8_t>::const_iterator begin,
+    std::vector<uint8_t>::const_iterator end, bool compressed)
+{
+    fold(begin, end, compressed);
+    ++block_length;
+}
+
+void xor_parity::remove(std::vector<uint8_t>::const_iterator begin,
+    std::vector<uint8_t>::const_iterator end, bool compressed)
+{
+    fold(begin, end, compressed);
+    --block_length;
+}
+
+void xor_parity::clear()
+{
+    block_length = 0;
+    length_parity = 0;
+    payload_parity.clear();
+}
+
+uint8_t xor_parity::get_block_length() const
+{
+    return block_length;
+}
+
+bool xor_parity::get_remaining_payload(std::vector<uint8_t> &payload, bool &compressed) const
+{
+    size_t length = length_parity & ~COMPRESSED_MASK;
+    if (block_length != 1 || length > payload_parity.size()
+        || std::any_of(payload_parity.begin() + length, payload_parity.end(),
+               [](uint8_t byte) { return byte != 0; }))
+    {
+        return false;
+    }
+
+    payload.assign(payload_parity.begin(), payload_parity.begin() + length);
+    compressed = length_parity & COMPRESSED_MASK;
+    return true;
+}
+
+xor_parity::operator std::vector<uint8_t>() const
+{
+    std::vector<uint8_t> parity{block_length, length_parity};
+    parity.insert(parity.end(), payload_parity.begin(), payload_parity.end());
+    return parity;
+}
+
+void xor_parity::fold(std::vector<uint8_t>::const_iterator begin,
+    std::vector<uint8_t>::const_iterator end, bool compressed)
+{
+    auto length = static_cast<size_t>(std::distance(begin, end));
+    if (length > payload_parity.size())
+    {
+        payload_parity.resize(length, 0);
+    }
+
+    std::transform(begin, end, payload_parity.begin(), payload_parity.begin(),
+        [](uint8_t byte, uint8_t parity) { return byte ^ parity; });
+    length_parity ^= static_cast<uint8_t>(length) | (compressed ? COMPRESSED_MASK : 0);
+}
@@ -0,0 +1,58 @@
+#ifndef XOR_PARITY_H
+#define XOR_PARITY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+// single parity forward error correction over a block of consecutive stream segments: XOR of every
+// payload in the block (zero padded to the longest one), any one payload of the block can be
+// rebuilt from the parity and the rest of the block
+//  - sender add()s each payload as it is sent and sends the parity once the block is complete
+//  - receiver parses the parity and remove()s every payload of the block it did receive, once a
+//  single one is left it is the missing one
+//  - length_parity: XOR of every payload length, with COMPRESSED_MASK set for compressed payloads
+//
+// wire format: [block_length (1)][length_parity (1)][payload_parity]
+class xor_parity
+{
+public:
+    static const size_t BLOCK_LENGTH_OFFSET;
+    static const size_t LENGTH_PARITY_OFFSET;
+    static const size_t PAYLOAD_PARITY_OFFSET;
+    static const size_t HEADER_LENGTH;
+    static const uint8_t COMPRESSED_MASK;
+    static const size_t MAX_PAYLOAD_LENGTH;
+    static const uint8_t MAX_BLOCK_LENGTH;
+
+    static std::shared_ptr<xor_parity> parse(const uint8_t *begin, const uint8_t *end);
+
+    xor_parity();
+
+    // note: payloads must not be longer than MAX_PAYLOAD_LENGTH
+    void add(std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end,
+        bool compressed);
+    void remove(std::vector<uint8_t>::const_iterator begin,
+        std::vector<uint8_t>::const_iterator end, bool compressed);
+    void clear();
+
+    uint8_t get_block_length() const;
+    // only valid once a single payload is left in the block, returns false if the parity turns out
+    // to be inconsistent with the payloads removed from it
+    bool get_remaining_payload(std::vector<uint8_t> &payload, bool &compressed) const;
+
+    operator std::vector<uint8_t>() const;
+
+private:
+    void fold(std::vector<uint8_t>::const_iterator begin, std::vector<uint8_t>::const_iterator end,
+        bool compressed);
+
+    uint8_t block_length;
+    uint8_t length_parity;
+    std::vector<uint8_t> payload_parity;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "xor_parity.h"
+
+namespace xor_parity_test
+{
+    std::vector<std::vector<uint8_t>> any_block{
+        {'t', 'e', 's', 't'}, {0x00, 0xff, 0x10}, {'l', 'o', 'n', 'g', 'e', 's', 't'}};
+    std::vector<bool> any_compressed{false, true, false};
+
+    xor_parity get_block_parity()
+    {
+        xor_parity parity;
+        for (size_t i = 0; i < any_block.size(); ++i)
+        {
+            parity.add(any_block[i].begin(), any_block[i].end(), any_compressed[i]);
+        }
+
+        return parity;
+    }
+
+    TEST(XorParityTest, ConstValuesSpec)
+    {
+        ASSERT_EQ(0, xor_parity::BLOCK_LENGTH_OFFSET);
+        ASSERT_EQ(1, xor_parity::LENGTH_PARITY_OFFSET);
+        ASSERT_EQ(2, xor_parity::PAYLOAD_PARITY_OFFSET);
+        ASSERT_EQ(2, xor_parity::HEADER_LENGTH);
+        ASSERT_EQ(0x80, xor_parity::COMPRESSED_MASK);
+        ASSERT_EQ(127, xor_parity::MAX_PAYLOAD_LENGTH);
+        ASSERT_EQ(16, xor_parity::MAX_BLOCK_LENGTH);
+    }
+
+    TEST(XorParityTest, OperatorVectorTest)
+    {
+        std::vector<uint8_t> encoded = get_block_parity();
+        ASSERT_EQ(xor_parity::HEADER_LENGTH + any_block[2].size(), encoded.size());
+        ASSERT_EQ(3, encoded[xor_parity::BLOCK_LENGTH_OFFSET]);
+        ASSERT_EQ(4 ^ (3 | 0x80) ^ 7, encoded[xor_parity::LENGTH_PARITY_OFFSET]);
+        ASSERT_EQ('t' ^ 0x00 ^ 'l', encoded[xor_parity::PAYLOAD_PARITY_OFFSET]);
+        ASSERT_EQ('t', encoded.back());
+    }
+
+    TEST(XorParityTest, RecoverEachPayloadTest)
+    {
+        std::vector<uint8_t> encoded = get_block_parity();
+
+        for (size_t missing = 0; missing < any_block.size(); ++missing)
+        {
+            auto parity = xor_parity::parse(encoded.data(), encoded.data() + encoded.size());
+            ASSERT_NE(nullptr, parity);
+            ASSERT_EQ(3, parity->get_block_length());
+
+            for (size_t i = 0; i < any_block.size(); ++i)
+            {
+                if (i != missing)
+                {
+                    parity->remove(any_block[i].begin(), any_block[i].end(), any_compressed[i]);
+                }
+            }
+
+            std::vector<uint8_t> payload;
+            bool compressed;
+            ASSERT_EQ(1, parity->get_block_length());
+            ASSERT_TRUE(parity->get_remaining_payload(payload, compressed));
+            ASSERT_EQ(any_block[missing], payload);
+            ASSERT_EQ(any_compressed[missing], compressed);
+        }
+    }
+
+    TEST(XorParityTest, RemainingPayloadNeedsSinglePayloadTest)
+    {
+        std::vector<uint8_t> encoded = get_block_parity();
+        auto parity = xor_parity::parse(encoded.data(), encoded.data() + encoded.size());
+        parity->remove(any_block[0].begin(), any_block[0].end(), any_compressed[0]);
+
+        std::vector<uint8_t> payload;
+        bool compressed;
+        ASSERT_FALSE(parity->get_remaining_payload(payload, compressed));
+    }
+
+    TEST(XorParityTest, InconsistentParityTest)
+    {
+        std::vector<uint8_t> encoded = get_block_parity();
+        auto parity = xor_parity::parse(encoded.data(), encoded.data() + encoded.size());
+
+        // payload that was never part of the block leaves garbage past the remaining length
+        std::vector<uint8_t> other{'o', 't', 'h', 'e', 'r'};
+        parity->remove(any_block[0].begin(), any_block[0].end(), any_compressed[0]);
+        parity->remove(other.begin(), other.end(), any_compressed[1]);
+
+        std::vector<uint8_t> payload;
+        bool compressed;
+        ASSERT_FALSE(parity->get_remaining_payload(payload, compressed));
+    }
+
+    TEST(XorParityTest, ParseInvalidTest)
+    {
+        std::vector<uint8_t> too_short{1};
+        ASSERT_EQ(nullptr, xor_parity::parse(
+            too_short.data(), too_short.data() + too_short.size()));
+
+        std::vector<uint8_t> empty_block{0, 0};
+        ASSERT_EQ(nullptr, xor_parity::parse(
+            empty_block.data(), empty_block.data() + empty_block.size()));
+
+        std::vector<uint8_t> block_too_long{
+            static_cast<uint8_t>(xor_parity::MAX_BLOCK_LENGTH + 1), 0};
+        ASSERT_EQ(nullptr, xor_parity::parse(
+            block_too_long.data(), block_too_long.data() + block_too_long.size()));
+
+        std::vector<uint8_t> payload_too_long(
+            xor_parity::HEADER_LENGTH + xor_parity::MAX_PAYLOAD_LENGTH + 1, 0);
+        payload_too_long[xor_parity::BLOCK_LENGTH_OFFSET] = 1;
+        ASSERT_EQ(nullptr, xor_parity::parse(
+            payload_too_long.data(), payload_too_long.data() + payload_too_long.size()));
+    }
+
+    TEST(XorParityTest, ClearTest)
+    {
+        xor_parity parity = get_block_parity();
+        parity.clear();
+        ASSERT_EQ(0, parity.get_block_length());
+        ASSERT_EQ(std::vector<uint8_t>({0, 0}), static_cast<std::vector<uint8_t>>(parity));
+    }
+}